@@ -0,0 +1,205 @@
+// 报警规则自动机测试: 直接调用 AlarmAutomaton / AlarmEngine, 不经过串口
+// 用法: alarmbench [--total MB] [--chunk 字节] [--rules 1,10,100,500,1000] [--naive-max 规则数]
+// - 数据和模式都是固定种子生成的可打印字符, 与文本协议的故障码相近; 扫描吞吐按规则数分别测量
+// - 对比逐条规则用 QByteArrayMatcher 查找的做法(不处理跨块, 只作耗时下限), 规则多时很慢, 只测到 naive-max
+// - 校验: 在数据中插入模式(其中一部分跨过块边界), 分块扫描的匹配必须与整段逐条查找的结果完全一致
+// 结果为一个 JSON 对象; 退出码: 0 成功, 2 匹配结果不一致
+#include "alarmengine.h"
+
+#include <QByteArrayMatcher>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const int kDataSize = 1024 * 1024;
+
+QByteArray randomText(std::mt19937 &rng, int size)
+{
+    std::uniform_int_distribution<int> printable(0x20, 0x7e);
+    QByteArray text(size, Qt::Uninitialized);
+    for (char &c : text) c = char(printable(rng));
+    return text;
+}
+
+QVector<QByteArray> randomPatterns(std::mt19937 &rng, int count)
+{
+    std::uniform_int_distribution<int> length(6, 12);
+    QVector<QByteArray> patterns;
+    for (int i = 0; i < count; ++i) patterns.append(randomText(rng, length(rng)));
+    return patterns;
+}
+
+// (模式序号, 匹配末尾的绝对偏移 + 1), 排序后比较
+using MatchList = std::vector<std::pair<int, qint64>>;
+
+MatchList naiveMatches(const QVector<QByteArray> &patterns, const QByteArray &data)
+{
+    MatchList matches;
+    for (int p = 0; p < patterns.size(); ++p) {
+        const QByteArrayMatcher matcher(patterns.at(p));
+        for (qsizetype at = matcher.indexIn(data); at >= 0; at = matcher.indexIn(data, int(at + 1)))
+            matches.emplace_back(p, at + patterns.at(p).size());
+    }
+    std::sort(matches.begin(), matches.end());
+    return matches;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("PyroCom 报警规则自动机测试");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"total", "每个规则数下扫描的数据量(MB)", "mb", "256"},
+        {"chunk", "每次扫描的字节数", "bytes", "4096"},
+        {"rules", "逗号分隔的规则数", "list", "1,10,100,500,1000"},
+        {"naive-max", "逐条查找对比的最大规则数", "count", "100"},
+    });
+    parser.process(app);
+
+    const qint64 total = parser.value("total").toLongLong() * 1048576;
+    const qsizetype chunkSize = qBound<qsizetype>(1, parser.value("chunk").toLongLong(), kDataSize);
+    const int naiveMax = parser.value("naive-max").toInt();
+    QVector<int> ruleCounts;
+    for (const QString &item : parser.value("rules").split(',', Qt::SkipEmptyParts)) {
+        const int n = item.trimmed().toInt();
+        if (n > 0) ruleCounts.append(n);
+    }
+    const int maxRules = ruleCounts.isEmpty() ? 0 : *std::max_element(ruleCounts.cbegin(), ruleCounts.cend());
+
+    std::mt19937 rng(20240901);
+    const QVector<QByteArray> allPatterns = randomPatterns(rng, maxRules);
+    // 预先生成一段数据加一块, 扫描时循环使用, 测的是自动机而不是数据生成
+    const QByteArray data = randomText(rng, kDataSize + int(chunkSize));
+
+    QJsonArray runs;
+    double firstMbPerSec = 0, lastMbPerSec = 0;
+    for (int count : ruleCounts) {
+        const QVector<QByteArray> patterns = allPatterns.mid(0, count);
+        AlarmAutomaton automaton;
+        QElapsedTimer timer;
+        timer.start();
+        automaton.compile(patterns);
+        const qint64 compileNs = timer.nsecsElapsed();
+
+        quint64 matches = 0;
+        int state = 0;
+        timer.restart();
+        for (qint64 offset = 0; offset < total; offset += chunkSize) {
+            const qsizetype n = qsizetype(qMin<qint64>(chunkSize, total - offset));
+            state = automaton.scan(state, data.constData() + offset % kDataSize, n, [&](int, qsizetype) { ++matches; });
+        }
+        const qint64 scanNs = timer.nsecsElapsed();
+        const double mbPerSec = scanNs > 0 ? double(total) / 1048576.0 / (scanNs / 1e9) : 0;
+        if (runs.isEmpty()) firstMbPerSec = mbPerSec;
+        lastMbPerSec = mbPerSec;
+
+        QJsonObject run;
+        run["rules"] = count;
+        run["states"] = automaton.stateCount();
+        run["byte_classes"] = automaton.classCount();
+        run["table_bytes"] = double(automaton.tableBytes());
+        run["compile_ms"] = compileNs / 1e6;
+        run["mb_per_sec"] = mbPerSec;
+        run["ns_per_byte"] = double(scanNs) / double(total);
+        run["matches"] = double(matches);
+
+        if (count <= naiveMax) {
+            // 逐条查找与规则数成正比, 只扫一小段
+            const qint64 naiveTotal = qMin<qint64>(total, 16 * 1048576);
+            QVector<QByteArrayMatcher> matchers;
+            for (const QByteArray &pattern : patterns) matchers.append(QByteArrayMatcher(pattern));
+            quint64 naiveMatches = 0;
+            timer.restart();
+            for (qint64 offset = 0; offset < naiveTotal; offset += chunkSize) {
+                const qsizetype n = qsizetype(qMin<qint64>(chunkSize, naiveTotal - offset));
+                const char *chunk = data.constData() + offset % kDataSize;
+                for (const QByteArrayMatcher &matcher : matchers) {
+                    if (matcher.indexIn(chunk, int(n)) >= 0) ++naiveMatches;
+                }
+            }
+            const qint64 naiveNs = timer.nsecsElapsed();
+            run["naive_mb_per_sec"] = naiveNs > 0 ? double(naiveTotal) / 1048576.0 / (naiveNs / 1e9) : 0;
+            run["naive_ns_per_byte"] = double(naiveNs) / double(naiveTotal);
+        }
+        runs.append(run);
+    }
+
+    // 跨块校验: 每个模式插入两次, 第二次跨过块边界; 块边界处的插入可能覆盖相邻插入, 以逐条查找的结果为准
+    QByteArray sample = data.left(kDataSize);
+    std::uniform_int_distribution<int> position(0, kDataSize - 16);
+    for (int p = 0; p < allPatterns.size(); ++p) {
+        const QByteArray &pattern = allPatterns.at(p);
+        sample.replace(position(rng), pattern.size(), pattern);
+        const qsizetype boundary = (position(rng) / chunkSize + 1) * chunkSize;
+        const qsizetype at = qBound<qsizetype>(0, boundary - pattern.size() / 2, kDataSize - pattern.size());
+        sample.replace(at, pattern.size(), pattern);
+    }
+    const MatchList expected = naiveMatches(allPatterns, sample);
+
+    AlarmAutomaton automaton;
+    automaton.compile(allPatterns);
+    MatchList actual;
+    int state = 0;
+    for (qsizetype offset = 0; offset < sample.size(); offset += chunkSize) {
+        const qsizetype n = qMin<qsizetype>(chunkSize, sample.size() - offset);
+        state = automaton.scan(state, sample.constData() + offset, n, [&](int p, qsizetype end) {
+            actual.emplace_back(p, offset + end);
+        });
+    }
+    std::sort(actual.begin(), actual.end());
+    quint64 crossing = 0;
+    for (const auto &match : actual) {
+        const qint64 start = match.second - allPatterns.at(match.first).size();
+        if (start / chunkSize != (match.second - 1) / chunkSize) ++crossing;
+    }
+
+    // 引擎: holdoff 为 0 时每个匹配都通知, 次数必须与自动机一致
+    QVector<AlarmRule> rules;
+    for (const QByteArray &pattern : allPatterns) {
+        AlarmRule rule;
+        rule.pattern = pattern;
+        rule.holdoffNs = 0;
+        rules.append(rule);
+    }
+    AlarmEngine engine;
+    engine.setRules(rules);
+    quint64 notified = 0;
+    for (qsizetype offset = 0; offset < sample.size(); offset += chunkSize) {
+        const qsizetype n = qMin<qsizetype>(chunkSize, sample.size() - offset);
+        engine.feed(0, offset, sample.constData() + offset, n, [&](const AlarmMatch &) { ++notified; });
+    }
+
+    const bool matchesOk = actual == expected;
+    const bool engineOk = engine.totalMatches() == expected.size() && notified == expected.size();
+
+    QJsonObject result;
+    result["benchmark"] = "alarmbench";
+    result["chunk_bytes"] = double(chunkSize);
+    result["scan_bytes"] = double(total);
+    result["runs"] = runs;
+    result["throughput_ratio_max_vs_min_rules"] = firstMbPerSec > 0 ? lastMbPerSec / firstMbPerSec : 0;
+    result["check_rules"] = allPatterns.size();
+    result["check_expected_matches"] = double(expected.size());
+    result["check_matches"] = double(actual.size());
+    result["check_crossing_matches"] = double(crossing);
+    result["check_matches_ok"] = matchesOk;
+    result["check_engine_ok"] = engineOk;
+    QTextStream(stdout) << QJsonDocument(result).toJson(QJsonDocument::Indented);
+
+    return matchesOk && engineOk ? 0 : 2;
+}
@@ -0,0 +1,205 @@
+// 接收路径的堆分配计数
+// 替换全局 operator new/delete 统计分配次数, 驱动与界面相同的真实接收路径:
+// 伪终端主端写入 -> SessionManager 打开从端, SerialWorker 读取写入环形缓冲区
+// -> 每10ms SessionManager::drain(SerialSession::stage 暂存) -> ReceiveFormatter 按会话的UTF-8解码器格式化
+// -> ScrollbackView::appendUtf8 缓存 -> LogWriter 追加; 每3次拉取刷新一次 ScrollbackView(ScrollbackModel 追加)
+// 预热使各缓冲区达到峰值容量、回滚区开始复用块之后, 分别统计:
+// - 拉取: 界面线程中 drain 及其回调(暂存、格式化、缓存、写日志)每个数据块的分配次数, 目标为 0
+// - 刷新: 界面线程中 ScrollbackView 刷新(模型追加、裁剪、视图更新)每次的分配次数, 目标为 0
+// - 其他线程: I/O线程、日志线程等, 含 QSerialPort 内部, 只作参考
+// 用法: allocbench [--log 日志文件] [--seconds 测量秒数]   日志默认写入 /dev/null
+// 退出码: 0 成功, 1 环境错误, 2 稳态下仍有分配
+#include "receiveformatter.h"
+#include "scrollbackmodel.h"
+#include "scrollbackview.h"
+#include "serialsession.h"
+#include "serialworker.h"
+#include "sessionmanager.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <QTimer>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+#include <poll.h>
+#include <pty.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+
+std::atomic<quint64> g_allocations{0};
+thread_local quint64 t_allocations = 0;
+
+} // namespace
+
+void *operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    ++t_allocations;
+    if (void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+int main(int argc, char *argv[])
+{
+    // 视图不显示, 也不需要图形环境
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("PyroCom 接收路径堆分配计数");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"log", "日志文件", "file", "/dev/null"},
+        {"seconds", "测量时长(秒), 之前另有2秒预热", "seconds", "5"},
+    });
+    parser.process(app);
+    QTextStream out(stdout);
+
+    int master = -1, slave = -1;
+    termios raw = {};
+    cfmakeraw(&raw);
+    if (::openpty(&master, &slave, nullptr, &raw, nullptr) != 0) {
+        out << "openpty 失败\n";
+        return 1;
+    }
+
+    // 80列文本行, 数据块大小 1~512 字节, 中文字符使解码器经常持有跨块的不完整字符
+    QRandomGenerator rng(7);
+    QByteArray pattern;
+    while (pattern.size() < 64 * 1024) {
+        for (int i = 0; i < 70; ++i) pattern.append(char(rng.bounded(0x20, 0x7F)));
+        pattern.append("温度正常\n");
+    }
+    std::atomic<bool> stop{false};
+    std::thread generator([&]() {
+        qint64 offset = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            pollfd pfd = {master, POLLOUT, 0};
+            if (::poll(&pfd, 1, 100) <= 0) continue;
+            const qint64 at = offset % pattern.size();
+            const qint64 len = qMin<qint64>(rng.bounded(1, 513), pattern.size() - at);
+            const ssize_t n = ::write(master, pattern.constData() + at, size_t(len));
+            if (n > 0) offset += n;
+            // 约 2MB/s, 与高速串口相当, 也让每次拉取有数十个数据块
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    });
+
+    SessionManager sessions;
+    ScrollbackView view;
+    view.setLimits(20000, 4 * 1024 * 1024);   // 较小的上限, 预热期间就开始裁剪和复用块
+    view.setMaxFlushRate(1);                   // 由本程序按拉取次数刷新, 不依赖视图的定时器
+    ReceiveFormatter formatter;
+    formatter.setTimestamps(true);
+
+    static const QByteArray noTag;
+    quint64 chunks = 0, polls = 0, flushes = 0;
+    quint64 drainAllocs = 0, flushAllocs = 0;
+    bool measuring = false;
+    QTimer pollTimer;
+    QObject::connect(&pollTimer, &QTimer::timeout, [&]() {
+        const quint64 before = t_allocations;
+        sessions.drain([&](SerialSession *s, qint64 timestampNs, const char *data, qsizetype size) {
+            if (formatter.format(timestampNs, noTag, data, size, &s->textDecoder())) {
+                const QByteArray &line = formatter.displayLine();
+                view.appendUtf8(line.constData(), line.size(), timestampNs);
+                if (s->logWriter().isOpen()) s->logWriter().append(formatter.logLine());
+            }
+            if (measuring) ++chunks;
+        });
+        if (measuring) drainAllocs += t_allocations - before;
+
+        // 与界面约30Hz刷新相同, 每3次拉取刷新一次; flush 是私有槽, 按名称直接调用
+        if (++polls % 3 == 0) {
+            const quint64 flushBefore = t_allocations;
+            QMetaObject::invokeMethod(&view, "flush", Qt::DirectConnection);
+            if (measuring) {
+                flushAllocs += t_allocations - flushBefore;
+                ++flushes;
+            }
+        }
+    });
+
+    quint64 guiBefore = 0, totalBefore = 0, guiAllocs = 0, totalAllocs = 0;
+    const int seconds = qMax(1, parser.value("seconds").toInt());
+    QObject::connect(&sessions, &SessionManager::sessionOpened, [&](SerialSession *s) {
+        QString error;
+        if (!s->logWriter().open(parser.value("log"), false, &error)) {
+            out << "无法打开日志文件: " << error << "\n";
+            QCoreApplication::exit(1);
+            return;
+        }
+        pollTimer.start(10);
+        QTimer::singleShot(2000, [&]() {
+            measuring = true;
+            guiBefore = t_allocations;
+            totalBefore = g_allocations.load(std::memory_order_relaxed);
+        });
+        QTimer::singleShot(2000 + seconds * 1000, [&]() {
+            guiAllocs = t_allocations - guiBefore;
+            totalAllocs = g_allocations.load(std::memory_order_relaxed) - totalBefore;
+            QCoreApplication::quit();
+        });
+    });
+    QObject::connect(&sessions, &SessionManager::sessionFailed, [&](SerialSession *, const QString &error) {
+        out << "无法打开伪终端: " << error << "\n";
+        QCoreApplication::exit(1);
+    });
+
+    PortSettings settings;
+    settings.portName = QString::fromLocal8Bit(ttyname(slave));
+    sessions.openSession(settings);
+
+    const int rc = app.exec();
+    stop.store(true);
+    generator.join();
+    if (rc != 0) return rc;
+
+    const double perChunk = chunks ? double(drainAllocs) / double(chunks) : 0;
+    const double perFlush = flushes ? double(flushAllocs) / double(flushes) : 0;
+    const quint64 otherThreads = totalAllocs - guiAllocs;
+    out << QString("chunks=%1 polls=%2 flushes=%3 rows=%4\n")
+               .arg(chunks).arg(polls).arg(flushes).arg(view.scrollbackModel()->rowCount());
+    out << QString("drain   allocations=%1 (%2 per chunk)\n").arg(drainAllocs).arg(perChunk, 0, 'f', 4);
+    out << QString("flush   allocations=%1 (%2 per flush)\n").arg(flushAllocs).arg(perFlush, 0, 'f', 4);
+    out << QString("gui     allocations=%1 (含事件循环)\n").arg(guiAllocs);
+    out << QString("other   allocations=%1 (%2 per chunk, I/O与日志线程, 含 QSerialPort 内部)\n")
+               .arg(otherThreads).arg(chunks ? double(otherThreads) / double(chunks) : 0, 0, 'f', 4);
+    out.flush();
+
+    if (chunks == 0) return 1;
+    // 日志写出的唤醒等偶发分配不应出现在拉取路径上; 刷新允许极少量(视图内部偶尔扩容)
+    return perChunk <= 0.001 && perFlush <= 0.01 ? 0 : 2;
+}
@@ -0,0 +1,265 @@
+// 串口桥接回环测试: 伪终端代替串口, 本地 TCP 客户端代替测试脚本
+// 用法: bridgebench [--rate 字节/秒, 0为不限] [--duration 秒] [--policy drop|disconnect] [--max-lag KB]
+// - 生成线程写伪终端主端, 程序打开从端并桥接到 127.0.0.1 的随机端口
+// - 快客户端全速读取并按偏移校验每个字节; 慢客户端每 100ms 才读 4KB, 应被跳过积压或断开
+// - 两个发送客户端各自不停发送 64 字节的命令('A'/'B'), 读取线程从主端统计两者所占份额
+// 结果为一个 JSON 对象; 退出码: 0 成功, 1 环境错误, 2 快客户端数据错误或发送不公平
+#include "portbridge.h"
+#include "serialsession.h"
+#include "serialworker.h"
+#include "sessionmanager.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QTimer>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pty.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+
+const int kPatternSize = 65521;   // 质数, 与各处的块大小错开
+
+char patternAt(qint64 offset)
+{
+    return char((offset % kPatternSize) * 31 % 251);
+}
+
+int connectLoopback(quint16 port)
+{
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// 等待 fd 可读/可写, 超时返回 false, 便于检查停止标志
+bool waitFd(int fd, short events)
+{
+    pollfd pfd = {fd, events, 0};
+    return ::poll(&pfd, 1, 100) > 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("PyroCom 串口桥接回环测试");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"rate", "串口接收速率(字节/秒), 0 为不限速", "bytes", "1200000"},
+        {"duration", "测试时长(秒)", "seconds", "5"},
+        {"policy", "慢客户端处理: drop / disconnect", "policy", "drop"},
+        {"max-lag", "客户端最多落后(KB)", "kb", "1024"},
+    });
+    parser.process(app);
+
+    QTextStream err(stderr);
+    const qint64 rate = parser.value("rate").toLongLong();
+    const double duration = parser.value("duration").toDouble();
+    BridgeOptions options;
+    options.maxLagBytes = parser.value("max-lag").toLongLong() * 1024;
+    if (!BridgeOptions::parsePolicy(parser.value("policy"), &options.policy)) {
+        err << "未知策略: " << parser.value("policy") << "\n";
+        return 1;
+    }
+
+    int master = -1, slave = -1;
+    termios raw = {};
+    cfmakeraw(&raw);
+    if (::openpty(&master, &slave, nullptr, &raw, nullptr) != 0) {
+        err << "openpty 失败\n";
+        return 1;
+    }
+    const QString slavePath = QString::fromLocal8Bit(ttyname(slave));
+
+    SessionManager sessions;
+    PortBridge bridge(options);
+    QString error;
+    if (!bridge.listen("tcp:127.0.0.1:0", &error)) {
+        err << "无法监听: " << error << "\n";
+        return 1;
+    }
+    const quint16 port = quint16(bridge.address().section(':', -1).toUInt());
+
+    std::atomic<bool> stop{false};
+    std::atomic<qint64> generated{0};
+    std::atomic<qint64> fastBytes{0};
+    std::atomic<quint64> fastMismatches{0};
+    std::atomic<qint64> slowBytes{0};
+    std::atomic<bool> slowClosed{false};
+    std::atomic<qint64> txShare[2] = {{0}, {0}};
+    std::atomic<qint64> txOther{0};
+    std::vector<std::thread> threads;
+
+    // 快客户端: 连接之后才开始生成数据, 所以从偏移0开始
+    threads.emplace_back([&]() {
+        const int fd = connectLoopback(port);
+        std::vector<char> buffer(65536);
+        qint64 offset = 0;
+        while (fd >= 0 && !stop.load(std::memory_order_relaxed)) {
+            if (!waitFd(fd, POLLIN)) continue;
+            const ssize_t n = ::recv(fd, buffer.data(), buffer.size(), 0);
+            if (n <= 0) break;
+            for (ssize_t i = 0; i < n; ++i) {
+                if (buffer[size_t(i)] != patternAt(offset + i)) fastMismatches.fetch_add(1, std::memory_order_relaxed);
+            }
+            offset += n;
+            fastBytes.store(offset, std::memory_order_relaxed);
+        }
+        if (fd >= 0) ::close(fd);
+    });
+
+    // 慢客户端: 远低于串口速率, 积压很快超过上限
+    threads.emplace_back([&]() {
+        const int fd = connectLoopback(port);
+        std::vector<char> buffer(4096);
+        while (fd >= 0 && !stop.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            const ssize_t n = ::recv(fd, buffer.data(), buffer.size(), MSG_DONTWAIT);
+            if (n == 0) {
+                slowClosed.store(true);
+                break;
+            }
+            if (n > 0) slowBytes.fetch_add(n, std::memory_order_relaxed);
+        }
+        if (fd >= 0) ::close(fd);
+    });
+
+    // 两个发送客户端, 阻塞发送: 桥接不读取时由 TCP 窗口挡住
+    // 发送客户端同样会收到串口数据, 顺带丢弃, 否则 disconnect 策略下会被当作慢客户端
+    for (int k = 0; k < 2; ++k) {
+        threads.emplace_back([&, k]() {
+            const int fd = connectLoopback(port);
+            const std::vector<char> command(64, k == 0 ? 'A' : 'B');
+            std::vector<char> discard(65536);
+            while (fd >= 0 && !stop.load(std::memory_order_relaxed)) {
+                while (::recv(fd, discard.data(), discard.size(), MSG_DONTWAIT) > 0) {}
+                if (!waitFd(fd, POLLOUT)) continue;
+                if (::send(fd, command.data(), command.size(), MSG_NOSIGNAL) <= 0) break;
+            }
+            if (fd >= 0) ::close(fd);
+        });
+    }
+
+    // 从主端读取桥接写入串口的数据
+    threads.emplace_back([&]() {
+        std::vector<char> buffer(65536);
+        while (!stop.load(std::memory_order_relaxed)) {
+            if (!waitFd(master, POLLIN)) continue;
+            const ssize_t n = ::read(master, buffer.data(), buffer.size());
+            for (ssize_t i = 0; i < n; ++i) {
+                const char c = buffer[size_t(i)];
+                if (c == 'A') txShare[0].fetch_add(1, std::memory_order_relaxed);
+                else if (c == 'B') txShare[1].fetch_add(1, std::memory_order_relaxed);
+                else txOther.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    });
+
+    auto generate = [&]() {
+        const qint64 startNs = SerialWorker::monotonicNs();
+        std::vector<char> chunk(4096);
+        qint64 offset = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            if (rate > 0) {
+                const qint64 dueNs = startNs + qint64(double(offset) * 1e9 / double(rate));
+                const qint64 waitNs = dueNs - SerialWorker::monotonicNs();
+                if (waitNs > 0) std::this_thread::sleep_for(std::chrono::nanoseconds(qMin<qint64>(waitNs, 100000000)));
+                if (SerialWorker::monotonicNs() < dueNs) continue;
+            }
+            if (!waitFd(master, POLLOUT)) continue;
+            for (size_t i = 0; i < chunk.size(); ++i) chunk[i] = patternAt(offset + qint64(i));
+            const ssize_t n = ::write(master, chunk.data(), chunk.size());
+            if (n <= 0) continue;
+            offset += n;
+            generated.store(offset, std::memory_order_relaxed);
+        }
+    };
+
+    SerialSession *session = nullptr;
+    qint64 wallStart = 0;
+    QTimer pollTimer;
+    QObject::connect(&pollTimer, &QTimer::timeout, [&]() {
+        sessions.drain([&](SerialSession *, qint64, const char *data, qsizetype size) { bridge.onReceive(data, size); });
+    });
+    // 串口已打开且四个客户端都接入后开始生成数据, 两者的先后不确定
+    bool started = false;
+    auto tryStart = [&]() {
+        if (started || bridge.stats().clients < 4 || !session || !session->isOpen()) return;
+        started = true;
+        wallStart = SerialWorker::monotonicNs();
+        threads.emplace_back(generate);
+        QTimer::singleShot(int(duration * 1000), &app, &QCoreApplication::quit);
+    };
+    QObject::connect(&bridge, &PortBridge::clientsChanged, tryStart);
+    QObject::connect(&sessions, &SessionManager::sessionOpened, [&](SerialSession *opened) {
+        bridge.setSession(opened);
+        pollTimer.start(10);
+        tryStart();
+    });
+    QObject::connect(&sessions, &SessionManager::sessionFailed, [&](SerialSession *, const QString &message) {
+        err << "无法打开 " << slavePath << ": " << message << "\n";
+        QCoreApplication::exit(1);
+    });
+
+    PortSettings settings;
+    settings.portName = slavePath;
+    session = sessions.openSession(settings);
+
+    const int rc = app.exec();
+    const double wallSec = double(SerialWorker::monotonicNs() - wallStart) / 1e9;
+    stop.store(true);
+    for (std::thread &thread : threads) thread.join();
+    if (rc != 0) return rc;
+
+    const BridgeStats stats = bridge.stats();
+    const qint64 a = txShare[0].load(), b = txShare[1].load();
+    const double fairness = qMax(a, b) > 0 ? double(qMin(a, b)) / double(qMax(a, b)) : 0;
+
+    QJsonObject result;
+    result["benchmark"] = "bridgebench";
+    result["policy"] = parser.value("policy");
+    result["max_lag_kb"] = double(options.maxLagBytes / 1024);
+    result["requested_rate_bytes_per_sec"] = double(rate);
+    result["duration_sec"] = wallSec;
+    result["port_rx_bytes"] = double(session->worker()->rxBytes());
+    result["port_rx_bytes_per_sec"] = wallSec > 0 ? double(session->worker()->rxBytes()) / wallSec : 0;
+    result["ring_stalls"] = double(session->worker()->ringStalls());
+    result["generated_bytes"] = double(generated.load());
+    result["fast_client_bytes"] = double(fastBytes.load());
+    result["fast_client_mismatches"] = double(fastMismatches.load());
+    result["slow_client_bytes"] = double(slowBytes.load());
+    result["slow_client_disconnected"] = slowClosed.load();
+    result["rx_dropped_bytes"] = double(stats.rxDropped);
+    result["slow_disconnects"] = double(stats.slowDisconnects);
+    result["tx_bytes"] = double(stats.txBytes);
+    result["tx_client_a_bytes"] = double(a);
+    result["tx_client_b_bytes"] = double(b);
+    result["tx_corrupt_bytes"] = double(txOther.load());
+    result["tx_fairness"] = fairness;
+    QTextStream(stdout) << QJsonDocument(result).toJson(QJsonDocument::Indented);
+
+    // 串口上只应出现两个客户端发送的字节, 且两者的份额接近
+    return fastMismatches.load() == 0 && txOther.load() == 0 && fairness > 0.8 ? 0 : 2;
+}
@@ -0,0 +1,119 @@
+// 十六进制/控制字符内核与原实现的对比测试
+// 输入大小 1KB ~ 16MB, 每项输出 MB/s; 内核分别测当前CPU最优实现和标量实现
+#include "hexkernels.h"
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QString>
+#include <QTextStream>
+#include <functional>
+
+namespace {
+
+// 原 MainWindow 中的实现, 作为基准
+QString escapeControlCharsOld(const QString &input)
+{
+    QString result;
+    for (QChar ch : input) {
+        ushort unicode = ch.unicode();
+        if (unicode < 32 && unicode != '\n' && unicode != '\r' && unicode != '\t') {
+            result += QString("\\x%1").arg(unicode, 2, 16, QChar('0'));
+        } else {
+            result += ch;
+        }
+    }
+    return result;
+}
+
+QString filterControlCharsOld(const QString &input)
+{
+    QString result;
+    for (QChar ch : input) {
+        ushort unicode = ch.unicode();
+        if (unicode >= 32 || unicode == '\n' || unicode == '\r' || unicode == '\t') {
+            result += ch;
+        }
+    }
+    return result;
+}
+
+// 重复运行至少 200ms, 返回 MB/s
+double measure(qsizetype bytes, const std::function<void()> &fn)
+{
+    QElapsedTimer timer;
+    timer.start();
+    qint64 iterations = 0;
+    do {
+        fn();
+        ++iterations;
+    } while (timer.elapsed() < 200);
+    return double(bytes) * iterations / 1048576.0 / (timer.nsecsElapsed() / 1e9);
+}
+
+} // namespace
+
+int main()
+{
+    QTextStream out(stdout);
+    out << "isa=" << HexKernels::activeIsa() << "\n";
+    out << QString("%1 %2 %3 %4\n").arg("kernel", -22).arg("size", 10).arg("old MB/s", 12).arg("new MB/s", 12);
+
+    QRandomGenerator rng(42);
+    volatile size_t sink = 0;
+    for (qsizetype size = 1024; size <= 16 * 1024 * 1024; size *= 4) {
+        // 文本: 可打印字符为主, 约1%控制字节
+        QByteArray text(int(size), Qt::Uninitialized);
+        for (qsizetype i = 0; i < size; ++i)
+            text[int(i)] = rng.bounded(100) == 0 ? char(rng.bounded(32)) : char(rng.bounded(32, 127));
+        QByteArray binary(int(size), Qt::Uninitialized);
+        for (qsizetype i = 0; i < size; ++i) binary[int(i)] = char(rng.bounded(256));
+
+        QByteArray encoded(int(HexKernels::encodedSpacedSize(size_t(size))), Qt::Uninitialized);
+        QByteArray decoded(int(size), Qt::Uninitialized);
+        const QByteArray hexText = binary.toHex();
+        const uint8_t *bin = reinterpret_cast<const uint8_t *>(binary.constData());
+        const uint8_t *txt = reinterpret_cast<const uint8_t *>(text.constData());
+
+        struct Row { const char *name; std::function<void()> oldFn; std::function<void()> newFn; };
+        const Row rows[] = {
+            {"hex encode",
+             [&] { sink += size_t(binary.toHex(' ').toUpper().size()); },
+             [&] { sink += HexKernels::encodeSpacedUpper(bin, size_t(size), encoded.data()); }},
+            {"hex decode",
+             [&] { bool ok; hexText.left(16).toULongLong(&ok, 16); sink += size_t(QByteArray::fromHex(hexText).size()); },
+             [&] { size_t n = 0; HexKernels::decodeHex(hexText.constData(), size_t(hexText.size()),
+                                                       reinterpret_cast<uint8_t *>(decoded.data()), &n); sink += n; }},
+            {"escape control",
+             [&] { sink += size_t(escapeControlCharsOld(QString::fromUtf8(text)).size()); },
+             [&] { sink += HexKernels::findControl(txt, size_t(size)); }},
+            {"filter control",
+             [&] { sink += size_t(filterControlCharsOld(QString::fromUtf8(text)).size()); },
+             [&] {
+                 // 与 MainWindow::filterControlChars 相同: 扫描后整段拷贝
+                 QByteArray result;
+                 result.reserve(text.size());
+                 size_t pos = 0, n = size_t(size);
+                 while (pos < n) {
+                     const size_t hit = pos + HexKernels::findControl(txt + pos, n - pos);
+                     result.append(text.constData() + pos, int(hit - pos));
+                     pos = hit + 1;
+                 }
+                 sink += size_t(QString::fromUtf8(result).size());
+             }},
+        };
+
+        for (const Row &row : rows) {
+            const double oldRate = measure(size, row.oldFn);
+            HexKernels::forceScalar(true);
+            const double scalarRate = measure(size, row.newFn);
+            HexKernels::forceScalar(false);
+            const double newRate = measure(size, row.newFn);
+            out << QString("%1 %2 %3 %4  (scalar %5)\n")
+                       .arg(row.name, -22).arg(size, 10)
+                       .arg(oldRate, 12, 'f', 1).arg(newRate, 12, 'f', 1).arg(scalarRate, 0, 'f', 1);
+            out.flush();
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,393 @@
+// 伪终端回环压力测试: 用 openpty 代替真实串口, 驱动程序的接收/发送路径
+// 用法: ptybench [--mode rx|tx] [--rate 字节/秒, 0为不限] [--pattern text|binary|control]
+//               [--chunk 字节] [--duration 秒] [--frame 帧格式] [--output 结果.json]
+// - rx: 生成线程写伪终端主端, 程序经 SessionManager 打开从端, 像界面一样每10ms拉取并渲染
+// - tx: 程序经 SerialSession::write 发送, 读取线程从主端收取并校验
+// 结果为一个 JSON 对象: 吞吐、CPU占用、内存增长、延迟百分位、数据校验错误
+// 退出码: 0 成功, 1 参数或环境错误, 2 数据校验失败
+#include "datarender.h"
+#include "frameparser.h"
+#include "latencyhistogram.h"
+#include "receiveformatter.h"
+#include "serialsession.h"
+#include "serialworker.h"
+#include "sessionmanager.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <QTimer>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <pty.h>
+#include <sys/resource.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+
+// 发送端每写出一块记录一次(累计字节, 写出时刻), 接收端越过该字节数时计算延迟
+// 预先分配, 单生产者追加、单消费者读取, 不加锁
+class CheckpointLog
+{
+public:
+    struct Checkpoint
+    {
+        qint64 endOffset;
+        qint64 sentNs;
+    };
+
+    explicit CheckpointLog(size_t capacity) : m_items(capacity) {}
+
+    void push(qint64 endOffset, qint64 sentNs)
+    {
+        const size_t n = m_count.load(std::memory_order_relaxed);
+        if (n == m_items.size()) return;   // 记满后不再记录, 只影响延迟样本数
+        m_items[n] = {endOffset, sentNs};
+        m_count.store(n + 1, std::memory_order_release);
+    }
+
+    // 消费者: 对 offset 之前的每个检查点调用 fn(sentNs)
+    template <typename Fn>
+    void consume(qint64 offset, Fn &&fn)
+    {
+        const size_t count = m_count.load(std::memory_order_acquire);
+        while (m_cursor < count && m_items[m_cursor].endOffset <= offset) {
+            fn(m_items[m_cursor].sentNs);
+            ++m_cursor;
+        }
+    }
+
+private:
+    std::vector<Checkpoint> m_items;
+    std::atomic<size_t> m_count{0};
+    size_t m_cursor = 0;
+};
+
+// 64KB 循环样本, 接收端按偏移校验每个字节
+QByteArray makePattern(const QString &kind)
+{
+    const int size = 64 * 1024;
+    QByteArray pattern(size, Qt::Uninitialized);
+    QRandomGenerator rng(2024);
+    for (int i = 0; i < size; ++i) {
+        char c;
+        if (kind == "binary") {
+            c = char(rng.bounded(256));
+        } else if (kind == "control") {
+            // 约一半是需要转义/过滤的控制字符
+            c = rng.bounded(2) ? char(rng.bounded(0x20)) : char(rng.bounded(0x20, 0x7F));
+        } else {
+            c = (i % 80 == 79) ? '\n' : char(rng.bounded(0x20, 0x7F));
+        }
+        pattern[i] = c;
+    }
+    return pattern;
+}
+
+qint64 threadCpuNs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+qint64 processCpuNs()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (qint64(usage.ru_utime.tv_sec) + usage.ru_stime.tv_sec) * 1000000000
+           + (qint64(usage.ru_utime.tv_usec) + usage.ru_stime.tv_usec) * 1000;
+}
+
+qint64 rssKb()
+{
+    QFile status("/proc/self/status");
+    if (!status.open(QIODevice::ReadOnly)) return 0;
+    for (const QByteArray &line : status.readAll().split('\n')) {
+        if (line.startsWith("VmRSS:")) return line.mid(6).trimmed().split(' ').value(0).toLongLong();
+    }
+    return 0;
+}
+
+QJsonObject latencyJson(const LatencyHistogram &histogram)
+{
+    QJsonObject object;
+    object["samples"] = double(histogram.count());
+    object["p50_us"] = histogram.percentileNs(50) / 1000.0;
+    object["p99_us"] = histogram.percentileNs(99) / 1000.0;
+    object["p999_us"] = histogram.percentileNs(99.9) / 1000.0;
+    object["max_us"] = histogram.maxNs() / 1000.0;
+    return object;
+}
+
+// 等待 fd 可读/可写, 超时返回 false, 便于检查停止标志
+bool waitFd(int fd, short events)
+{
+    pollfd pfd = {fd, events, 0};
+    return ::poll(&pfd, 1, 100) > 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("PyroCom 伪终端回环压力测试");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"mode", "rx 测接收路径, tx 测发送路径", "mode", "rx"},
+        {"rate", "目标速率(字节/秒), 0 为不限速", "bytes", "0"},
+        {"pattern", "数据样式 text/binary/control", "kind", "text"},
+        {"chunk", "每次写入的字节数", "bytes", "256"},
+        {"duration", "测试时长(秒)", "seconds", "10"},
+        {"frame", "接收时启用分帧, 如 head=AA55;len=2:1;adj=4", "spec"},
+        {"output", "结果写入文件, 默认输出到标准输出", "file"},
+    });
+    parser.process(app);
+
+    QTextStream err(stderr);
+    const QString mode = parser.value("mode");
+    const QString patternKind = parser.value("pattern");
+    const qint64 rate = parser.value("rate").toLongLong();
+    const int chunk = qMax(1, parser.value("chunk").toInt());
+    const double duration = parser.value("duration").toDouble();
+    if (mode != "rx" && mode != "tx") {
+        err << "未知模式: " << mode << "\n";
+        return 1;
+    }
+
+    FrameSpec frameSpec;
+    if (parser.isSet("frame")) {
+        QString error;
+        frameSpec = FrameSpec::parse(parser.value("frame"), &error);
+        if (!frameSpec.isValid()) {
+            err << "无效的帧格式: " << error << "\n";
+            return 1;
+        }
+    }
+
+    // 两端都设为原始模式, 伪终端不做换行转换和回显
+    int master = -1, slave = -1;
+    termios raw = {};
+    cfmakeraw(&raw);
+    if (::openpty(&master, &slave, nullptr, &raw, nullptr) != 0) {
+        err << "openpty 失败\n";
+        return 1;
+    }
+    const QString slavePath = QString::fromLocal8Bit(ttyname(slave));
+
+    const QByteArray pattern = makePattern(patternKind);
+    const DataRender::Mode renderMode = patternKind == "binary" ? DataRender::Mode::Hex
+                                      : patternKind == "control" ? DataRender::Mode::Escape
+                                                                  : DataRender::Mode::Filter;
+    CheckpointLog checkpoints(4 * 1024 * 1024);
+    LatencyHistogram ioLatency;    // 写入伪终端 -> I/O线程读到(rx) / 调用 write -> 主端读到(tx)
+    LatencyHistogram e2eLatency;   // 写入伪终端 -> 拉取并渲染完成(仅rx)
+    std::atomic<bool> stop{false};
+    std::atomic<qint64> sentBytes{0};
+    std::atomic<qint64> peerBytes{0};      // tx: 读取线程收到的字节数
+    std::atomic<quint64> mismatches{0};
+    std::atomic<qint64> peerCpuNs{0};      // 生成/读取线程自身的CPU时间, 从进程占用中扣除
+
+    SessionManager sessions;
+    SerialSession *session = nullptr;
+    qint64 received = 0;
+    ReceiveFormatter formatter;
+    formatter.setMode(renderMode);
+    formatter.setTimestamps(true);
+    qint64 renderedBytes = 0;
+    qint64 rssPeak = 0;
+    qint64 rssStart = 0;
+    qint64 cpuStart = 0;
+    qint64 wallStart = 0;
+    std::thread peer;
+    QTimer pollTimer;
+    QTimer sendTimer;
+    QTimer rssTimer;
+    qint64 txSent = 0;
+
+    // rx 生成线程: 按速率写主端; 对端读不过来时 write 阻塞, 即串口的背压
+    auto generate = [&]() {
+        const qint64 startNs = SerialWorker::monotonicNs();
+        qint64 offset = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            if (rate > 0) {
+                const qint64 dueNs = startNs + qint64(double(offset) * 1e9 / double(rate));
+                const qint64 waitNs = dueNs - SerialWorker::monotonicNs();
+                if (waitNs > 0) std::this_thread::sleep_for(std::chrono::nanoseconds(qMin<qint64>(waitNs, 100000000)));
+                if (SerialWorker::monotonicNs() < dueNs) continue;
+            }
+            if (!waitFd(master, POLLOUT)) continue;
+            const qint64 at = offset % pattern.size();
+            const qint64 len = qMin<qint64>(chunk, pattern.size() - at);
+            const qint64 sentNs = SerialWorker::monotonicNs();
+            const ssize_t n = ::write(master, pattern.constData() + at, size_t(len));
+            if (n <= 0) continue;
+            offset += n;
+            checkpoints.push(offset, sentNs);
+            sentBytes.store(offset, std::memory_order_relaxed);
+        }
+        peerCpuNs.store(threadCpuNs(), std::memory_order_relaxed);
+    };
+
+    // tx 读取线程: 从主端收取程序发出的数据并校验
+    auto collect = [&]() {
+        std::vector<char> buffer(65536);
+        qint64 offset = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            if (!waitFd(master, POLLIN)) continue;
+            const ssize_t n = ::read(master, buffer.data(), buffer.size());
+            if (n <= 0) continue;
+            const qint64 nowNs = SerialWorker::monotonicNs();
+            for (ssize_t i = 0; i < n; ++i) {
+                if (buffer[size_t(i)] != pattern.at(int((offset + i) % pattern.size())))
+                    mismatches.fetch_add(1, std::memory_order_relaxed);
+            }
+            offset += n;
+            checkpoints.consume(offset, [&](qint64 sentNs) { ioLatency.record(nowNs - sentNs); });
+            peerBytes.store(offset, std::memory_order_relaxed);
+        }
+        peerCpuNs.store(threadCpuNs(), std::memory_order_relaxed);
+    };
+
+    auto startMeasuring = [&]() {
+        rssStart = rssKb();
+        rssPeak = rssStart;
+        cpuStart = processCpuNs();
+        wallStart = SerialWorker::monotonicNs();
+        rssTimer.start(200);
+        QTimer::singleShot(int(duration * 1000), &app, &QCoreApplication::quit);
+    };
+
+    QObject::connect(&rssTimer, &QTimer::timeout, [&]() { rssPeak = qMax(rssPeak, rssKb()); });
+
+    // 与界面相同: 10ms 拉取一次, 按设置分帧并格式化为显示行
+    QObject::connect(&pollTimer, &QTimer::timeout, [&]() {
+        sessions.drain([&](SerialSession *, qint64 timestampNs, const char *data, qsizetype size) {
+            const char *expected = pattern.constData();
+            for (qsizetype i = 0; i < size; ++i) {
+                if (data[i] != expected[(received + i) % pattern.size()])
+                    mismatches.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (frameSpec.isValid()) {
+                session->frameParser().feed(data, size, [&](const FrameView &frame) {
+                    formatter.format(timestampNs, QByteArray(), frame.data, frame.size);
+                    renderedBytes += formatter.textSize();
+                });
+            } else {
+                formatter.format(timestampNs, QByteArray(), data, size);
+                renderedBytes += formatter.textSize();
+            }
+            received += size;
+            const qint64 nowNs = SerialWorker::monotonicNs();
+            // I/O线程时间戳表示整块数据读到的时刻, 同一块内的检查点共用
+            checkpoints.consume(received, [&](qint64 sentNs) {
+                ioLatency.record(timestampNs - sentNs);
+                e2eLatency.record(nowNs - sentNs);
+            });
+        });
+    });
+
+    // tx: 按速率调用 SerialSession::write; 不限速时最多保持 256KB 未送达, 避免无限排队
+    QObject::connect(&sendTimer, &QTimer::timeout, [&]() {
+        const qint64 elapsedNs = SerialWorker::monotonicNs() - wallStart;
+        const qint64 budget = rate > 0 ? qint64(double(elapsedNs) * double(rate) / 1e9) - txSent
+                                       : 256 * 1024 - (txSent - peerBytes.load(std::memory_order_relaxed));
+        qint64 remaining = budget;
+        while (remaining >= chunk || (rate > 0 && remaining > 0)) {
+            const qint64 at = txSent % pattern.size();
+            const qint64 len = qMin<qint64>(qMin<qint64>(chunk, remaining), pattern.size() - at);
+            const qint64 sentNs = SerialWorker::monotonicNs();
+            session->write(pattern.mid(int(at), int(len)));
+            txSent += len;
+            remaining -= len;
+            checkpoints.push(txSent, sentNs);
+        }
+        sentBytes.store(txSent, std::memory_order_relaxed);
+    });
+
+    QObject::connect(&sessions, &SessionManager::sessionOpened, [&](SerialSession *) {
+        startMeasuring();
+        if (mode == "rx") {
+            pollTimer.start(10);
+            peer = std::thread(generate);
+        } else {
+            peer = std::thread(collect);
+            sendTimer.setTimerType(Qt::PreciseTimer);
+            sendTimer.start(1);
+        }
+    });
+    QObject::connect(&sessions, &SessionManager::sessionFailed, [&](SerialSession *, const QString &error) {
+        err << "无法打开 " << slavePath << ": " << error << "\n";
+        QCoreApplication::exit(1);
+    });
+
+    PortSettings settings;
+    settings.portName = slavePath;
+    session = sessions.openSession(settings);
+    if (frameSpec.isValid()) session->frameParser().setSpec(frameSpec);
+
+    const int rc = app.exec();
+    stop.store(true);
+    if (peer.joinable()) peer.join();
+    if (rc != 0) return rc;
+
+    const double wallSec = double(SerialWorker::monotonicNs() - wallStart) / 1e9;
+    const double cpuSec = double(processCpuNs() - cpuStart) / 1e9;
+    const double peerCpuSec = double(peerCpuNs.load()) / 1e9;
+    const qint64 delivered = mode == "rx" ? received : peerBytes.load();
+    rssPeak = qMax(rssPeak, rssKb());
+
+    QJsonObject latency;
+    latency["io"] = latencyJson(ioLatency);
+    if (mode == "rx") latency["end_to_end"] = latencyJson(e2eLatency);
+
+    QJsonObject result;
+    result["benchmark"] = "ptybench";
+    result["mode"] = mode;
+    result["pattern"] = patternKind;
+    result["chunk_bytes"] = chunk;
+    result["requested_rate_bytes_per_sec"] = double(rate);
+    result["frame_spec"] = parser.value("frame");
+    result["duration_sec"] = wallSec;
+    result["bytes_sent"] = double(sentBytes.load());
+    result["bytes_delivered"] = double(delivered);
+    result["throughput_bytes_per_sec"] = wallSec > 0 ? double(delivered) / wallSec : 0;
+    result["rendered_bytes"] = double(renderedBytes);
+    result["mismatches"] = double(mismatches.load());
+    result["cpu_percent"] = wallSec > 0 ? cpuSec / wallSec * 100 : 0;
+    result["app_cpu_percent"] = wallSec > 0 ? qMax(0.0, cpuSec - peerCpuSec) / wallSec * 100 : 0;
+    result["rss_start_kb"] = double(rssStart);
+    result["rss_peak_kb"] = double(rssPeak);
+    result["rss_growth_kb"] = double(rssPeak - rssStart);
+    result["ring_high_water"] = double(session->worker()->ring().highWaterMark());
+    result["ring_stalls"] = double(session->worker()->ringStalls());
+    result["latency"] = latency;
+
+    const QByteArray json = QJsonDocument(result).toJson(QJsonDocument::Indented);
+    if (parser.isSet("output")) {
+        QFile file(parser.value("output"));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            err << "无法写入结果: " << file.errorString() << "\n";
+            return 1;
+        }
+        file.write(json);
+    } else {
+        QTextStream(stdout) << json;
+    }
+    // 伪终端在 SessionManager 析构关闭从端之后随进程退出关闭
+    return mismatches.load() == 0 ? 0 : 2;
+}
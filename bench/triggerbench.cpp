@@ -0,0 +1,158 @@
+// 触发捕获测试: 直接调用 TriggerCapture, 不经过串口
+// 用法: triggerbench [--total MB] [--chunk 字节, 最大64KB] [--spec 触发格式]
+// - 合成时间戳为 起点 + 字节偏移(纳秒), 即 1 字节/ns, spec 中的秒数因此等于字节数: pre=0.032 即 32MB
+// - 先不触发地写入 total MB, 测稳态吞吐(含模式扫描, 默认模式 FFFE 在数据中不会出现), 期间不应有文件
+// - 再手动触发并继续写入到触发后窗口结束, 读回文件按时间戳逐字节校验, 并检查窗口边界
+// - 触发本身只记下窗口, 由写盘线程从内存环写出; 写入比磁盘快时触发后的新记录会被丢弃, 结果中单独列出
+// 结果为一个 JSON 对象; 退出码: 0 成功, 1 环境错误, 2 窗口内容或边界错误
+#include "capturefile.h"
+#include "triggercapture.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+#include <vector>
+
+namespace {
+
+const int kPatternSize = 65521;   // 质数, 与块大小错开
+
+char patternAt(qint64 offset)
+{
+    return char((offset % kPatternSize) * 31 % 251);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.setApplicationDescription("PyroCom 触发捕获测试");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"total", "触发前写入的数据量(MB)", "mb", "512"},
+        {"chunk", "每次写入的字节数", "bytes", "4096"},
+        {"spec", "触发格式", "spec", "buffer=64;pre=0.032;post=0.008;pattern=FFFE"},
+    });
+    parser.process(app);
+
+    QTextStream err(stderr);
+    TriggerSpec spec;
+    QString error;
+    if (!TriggerSpec::parse(parser.value("spec"), &spec, &error)) {
+        err << "无效的触发格式: " << error << "\n";
+        return 1;
+    }
+    const qint64 total = parser.value("total").toLongLong() * 1048576;
+    // 超过单条上限的块会拆成同一时间戳的多条记录, 按时间戳校验时无法区分, 所以限制在上限以内
+    const qint64 chunkSize = qBound<qint64>(1, parser.value("chunk").toLongLong(), TriggerCapture::kMaxRecordPayload);
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        err << "无法创建临时目录\n";
+        return 1;
+    }
+
+    TriggerCapture trigger;
+    trigger.configure(spec, dir.path());
+    QString savedPath;
+    qint64 savedBytes = 0;
+    // 由写盘线程直接调用, disable() 等待该线程结束后才读取
+    QObject::connect(&trigger, &TriggerCapture::saved, [&](const QString &path, qint64 bytes) {
+        savedPath = path;
+        savedBytes = bytes;
+    });
+
+    // 预先生成一个模式周期加一块, 写入时按偏移取, 测的是 record() 而不是数据生成
+    std::vector<char> pattern(size_t(kPatternSize + chunkSize));
+    for (size_t i = 0; i < pattern.size(); ++i) pattern[i] = patternAt(qint64(i));
+    const qint64 baseNs = 1000000000;
+    qint64 offset = 0;
+    auto feed = [&](qint64 until) {
+        while (offset < until) {
+            const qint64 n = qMin(chunkSize, until - offset);
+            trigger.record(baseNs + offset, CaptureDirection::Rx, 0, pattern.data() + offset % kPatternSize, n);
+            offset += n;
+        }
+    };
+
+    QElapsedTimer timer;
+    timer.start();
+    feed(total);
+    const qint64 steadyNs = timer.nsecsElapsed();
+    const bool quiet = trigger.savedCount() == 0 && trigger.triggerCount() == 0
+                       && QDir(dir.path()).entryList(QDir::Files).isEmpty();
+    const qint64 bufferedBytes = trigger.bufferedBytes();
+
+    const qint64 triggerNs = baseNs + offset;
+    timer.restart();
+    trigger.trigger(TriggerReason::Manual, 0, triggerNs);
+    const qint64 triggerCallNs = timer.nsecsElapsed();
+    // 多写一块, 时间戳越过窗口结束时刻后窗口结束
+    feed(offset + spec.postNs + chunkSize);
+    const qint64 droppedBytes = trigger.windowDroppedBytes();
+    timer.restart();
+    trigger.disable();
+    const qint64 drainNs = timer.nsecsElapsed();
+
+    CaptureReader reader;
+    if (savedPath.isEmpty() || !reader.open(savedPath, &error)) {
+        err << "没有保存触发窗口: " << error << "\n";
+        return 2;
+    }
+    quint64 mismatches = 0, records = 0;
+    qint64 preBytes = 0, postBytes = 0, firstNs = -1, lastNs = 0, expectedNs = -1;
+    bool contiguous = true;
+    CaptureReader::Record record;
+    for (qint64 position = reader.firstOffset(), next = 0; reader.readNext(position, &record, &next); position = next) {
+        ++records;
+        if (firstNs < 0) firstNs = record.timestampNs;
+        if (expectedNs >= 0 && record.timestampNs != expectedNs) contiguous = false;
+        expectedNs = record.timestampNs + record.length;
+        lastNs = record.timestampNs;
+        const qint64 start = record.timestampNs - baseNs;
+        for (quint32 i = 0; i < record.length; ++i) {
+            if (record.data[i] != patternAt(start + i)) ++mismatches;
+        }
+        (record.timestampNs < triggerNs ? preBytes : postBytes) += record.length;
+    }
+
+    // 触发前窗口由 pre 和内存环中的数据(扣除记录头)较小的一个决定; 记录按块写入, 边界允许差一块
+    const qint64 ringPayload = bufferedBytes / (chunkSize + TriggerCapture::kRecordHeaderSize) * chunkSize;
+    const qint64 expectedPre = qMin(spec.preNs, ringPayload);
+    const bool preOk = firstNs >= triggerNs - spec.preNs && preBytes + chunkSize >= expectedPre && preBytes <= expectedPre;
+    const bool postOk = lastNs <= triggerNs + spec.postNs && postBytes + droppedBytes + chunkSize >= spec.postNs;
+    // 丢弃的记录在文件中留下时间空洞
+    const bool contiguousOk = contiguous || droppedBytes > 0;
+
+    QJsonObject result;
+    result["benchmark"] = "triggerbench";
+    result["spec"] = parser.value("spec");
+    result["chunk_bytes"] = double(chunkSize);
+    result["steady_bytes"] = double(total);
+    result["steady_mb_per_sec"] = steadyNs > 0 ? double(total) / 1048576.0 / (steadyNs / 1e9) : 0;
+    result["steady_ns_per_chunk"] = double(steadyNs) / double((total + chunkSize - 1) / chunkSize);
+    result["steady_disk_quiet"] = quiet;
+    result["ring_capacity_bytes"] = double(trigger.capacity());
+    result["ring_buffered_bytes"] = double(bufferedBytes);
+    result["trigger_call_us"] = triggerCallNs / 1e3;
+    result["drain_after_window_ms"] = drainNs / 1e6;
+    result["window_dropped_bytes"] = double(droppedBytes);
+    result["file_bytes"] = double(savedBytes);
+    result["records"] = double(records);
+    result["pre_bytes"] = double(preBytes);
+    result["post_bytes"] = double(postBytes);
+    result["mismatches"] = double(mismatches);
+    result["contiguous"] = contiguous;
+    result["pre_window_ok"] = preOk;
+    result["post_window_ok"] = postOk;
+    QTextStream(stdout) << QJsonDocument(result).toJson(QJsonDocument::Indented);
+
+    return mismatches == 0 && contiguousOk && quiet && preOk && postOk ? 0 : 2;
+}
@@ -0,0 +1,136 @@
+#ifndef ALARMENGINE_H
+#define ALARMENGINE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <array>
+#include <functional>
+
+#include "latencyhistogram.h"
+
+// 报警规则, 规则文件每行一条, 键值格式与分帧格式相同, 例如:
+//   name=超压;text=E201
+//   name=电机堵转;hex=AA5501FF;action=status,sound,command;cmd=notify-send "$PYROCOM_ALARM"
+// 键: name(名称, 省略时为模式本身) text(文本模式, 支持 \r \n \t \\ \xNN 转义, ';' 写作 \x3B)
+//     hex(字节模式) action(status/highlight/sound/command, 逗号分隔, 默认 status,highlight)
+//     cmd(外部命令, 由系统 shell 执行, 环境变量 PYROCOM_ALARM/PYROCOM_PORT 为规则名和端口名)
+//     holdoff(同一规则在同一串口上两次通知的最短间隔, 毫秒, 默认1000; 期间的匹配只计数;
+//             带 command 动作的规则不得小于1000, 持续匹配时每秒最多启动一个进程)
+// 空行和 # 开头的行被忽略
+struct AlarmRule
+{
+    enum Action { Status = 1, Highlight = 2, Sound = 4, Command = 8 };
+
+    QString name;
+    QByteArray pattern;
+    int actions = Status | Highlight;
+    QString command;
+    qint64 holdoffNs = 1000000000;
+    static constexpr qint64 kMinCommandHoldoffNs = 1000000000;
+
+    static bool parse(const QString &line, AlarmRule *rule, QString *errorString = nullptr);
+    // 整个规则文件, 出错时 errorString 带行号
+    static bool parseList(const QString &text, QVector<AlarmRule> *rules, QString *errorString = nullptr);
+};
+
+// 多模式匹配自动机(Aho-Corasick), 编译为完整的状态转移表
+// - 字节先映射为等价类: 模式中出现过的字节各占一类, 其余字节共用一类, 表大小为 状态数 × 类数
+// - 失败转移在编译时展开, 扫描时每个字节只查两次表, 没有回溯, 与模式数无关
+// - 表项是目标状态的行偏移, 目标状态有匹配输出时最高位置1, 没有匹配的字节只走一个分支
+// - 状态是不透明的 int, 0 为初始状态, 由调用方按流保存, 跨数据块的匹配因此不会丢失
+class AlarmAutomaton
+{
+public:
+    void compile(const QVector<QByteArray> &patterns);
+    bool isEmpty() const { return m_outputs.isEmpty(); }
+    int stateCount() const { return m_outputStart.size() - 1; }
+    int classCount() const { return m_classCount; }
+    qint64 tableBytes() const { return qint64(m_next.size()) * qint64(sizeof(qint32)); }
+
+    // 从 state 开始扫描, 每个匹配调用 onMatch(模式序号, 匹配末尾在 data 中的偏移 + 1); 返回结束时的状态
+    template <typename F>
+    int scan(int state, const char *data, qsizetype size, F &&onMatch) const
+    {
+        if (m_next.isEmpty()) return state;
+        const qint32 *next = m_next.constData();
+        for (qsizetype i = 0; i < size; ++i) {
+            const qint32 v = next[state + m_classOf[uchar(data[i])]];
+            if (v >= 0) {
+                state = v;
+                continue;
+            }
+            state = v & kStateMask;
+            const int id = state / m_classCount;
+            for (int k = m_outputStart.at(id); k < m_outputStart.at(id + 1); ++k) onMatch(m_outputs.at(k), i + 1);
+        }
+        return state;
+    }
+
+private:
+    static constexpr qint32 kStateMask = 0x7fffffff;
+
+    std::array<quint16, 256> m_classOf{};
+    int m_classCount = 0;
+    QVector<qint32> m_next;          // 状态数 × 类数
+    QVector<qint32> m_outputStart;   // 各状态的匹配输出在 m_outputs 中的范围, 含失败链上的输出
+    QVector<qint32> m_outputs;
+};
+
+// 一次报警通知
+struct AlarmMatch
+{
+    int rule;
+    quint8 stream;
+    qint64 timestampNs;          // 匹配末尾所在数据块在I/O线程读到的时刻
+    quint64 count;               // 该规则累计匹配次数
+    quint64 suppressed;          // 上次通知以来因抑制间隔未通知的匹配数
+};
+
+// 报警引擎: 所有规则编译为一个自动机, 在原始接收流上单遍扫描
+// - 每个流(端口号)保存自己的自动机状态, 与显示用的分帧和解码无关
+// - 匹配都计数; 同一规则在同一流上 holdoff 内的匹配不通知, 持续出现的故障码不会刷屏
+// - 不是线程安全的, 与分帧一样在取出数据的线程(GUI线程或无界面模式的主线程)中使用
+class AlarmEngine
+{
+public:
+    using Handler = std::function<void(const AlarmMatch &match)>;
+
+    // 重新编译并清空各流的状态和计数
+    void setRules(const QVector<AlarmRule> &rules);
+    const QVector<AlarmRule> &rules() const { return m_rules; }
+    const AlarmAutomaton &automaton() const { return m_automaton; }
+    bool isEnabled() const { return !m_rules.isEmpty(); }
+
+    // 扫描一个数据块, 需要通知的匹配交给 handler; 返回本块中所有匹配规则的动作之和(含被抑制的)
+    int feed(quint8 stream, qint64 timestampNs, const char *data, qsizetype size, const Handler &handler);
+    void resetStream(quint8 stream) { m_states[stream] = 0; }
+
+    quint64 matchCount(int rule) const { return m_counts.value(rule); }
+    quint64 totalMatches() const { return m_totalMatches; }
+    quint64 notifications() const { return m_notifications; }
+    // 从I/O线程读到数据到发出通知的延迟, 上限约为取数据的周期
+    const LatencyHistogram &latency() const { return m_latency; }
+
+    // 由系统 shell 执行规则的外部命令, 不等待结束
+    static bool runCommand(const AlarmRule &rule, const QString &portName, QString *errorString = nullptr);
+
+private:
+    struct Holdoff
+    {
+        qint64 lastNs = 0;
+        quint64 suppressed = 0;
+    };
+
+    QVector<AlarmRule> m_rules;
+    AlarmAutomaton m_automaton;
+    std::array<int, 256> m_states{};
+    QVector<quint64> m_counts;
+    QHash<quint32, Holdoff> m_holdoffs;     // 按 规则序号 << 8 | 流
+    LatencyHistogram m_latency;
+    quint64 m_totalMatches = 0;
+    quint64 m_notifications = 0;
+};
+
+#endif // ALARMENGINE_H
@@ -0,0 +1,80 @@
+#ifndef BIGRAMFILTER_H
+#define BIGRAMFILTER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+#include <algorithm>
+#include <vector>
+
+// 二元组(相邻两个字符)位图, 作为搜索的块级预过滤
+// - 每块一个 65536 位(8KB)的位图, 记录块内出现过的所有相邻字符对
+// - 查询串中任意一个字符对不在位图中, 该块一定不包含查询串, 整块跳过; 只会误报不会漏报
+// - 字符先折叠为8位键: ASCII字母不区分大小写, 非ASCII字符按低7位合并, 大小写不敏感的查询也能使用
+// - 文本(显示行)和原始字节(捕获文件)分别使用各自的 add/mayContain 重载, 不要混用
+class BigramFilter
+{
+public:
+    BigramFilter() : m_bits(kWords, 0) {}
+
+    void clear() { std::fill(m_bits.begin(), m_bits.end(), 0); }
+
+    void add(const QChar *text, qsizetype n)
+    {
+        for (qsizetype i = 1; i < n; ++i) set(key(text[i - 1]), key(text[i]));
+    }
+    void add(const char *data, qsizetype n)
+    {
+        for (qsizetype i = 1; i < n; ++i) set(key(uchar(data[i - 1])), key(uchar(data[i])));
+    }
+    // 跨越两段数据的字符对, 例如同一串口相邻两条捕获记录的交界
+    void addPair(char a, char b) { set(key(uchar(a)), key(uchar(b))); }
+
+    bool mayContain(const QString &needle) const { return mayContain(needle, nullptr); }
+    bool mayContain(const QByteArray &needle) const { return mayContain(needle, nullptr); }
+
+    // 每个字符对出现在本位图或 other 中: 用于可能跨越两块的匹配
+    bool mayContain(const QString &needle, const BigramFilter *other) const
+    {
+        for (qsizetype i = 1; i < needle.size(); ++i) {
+            if (!test(key(needle[i - 1]), key(needle[i]), other)) return false;
+        }
+        return true;
+    }
+    bool mayContain(const QByteArray &needle, const BigramFilter *other) const
+    {
+        for (qsizetype i = 1; i < needle.size(); ++i) {
+            if (!test(key(uchar(needle[i - 1])), key(uchar(needle[i])), other)) return false;
+        }
+        return true;
+    }
+
+    static constexpr qint64 kBytes = 65536 / 8;
+
+private:
+    static constexpr size_t kWords = 65536 / 64;
+
+    static uint fold(uint c) { return (c >= 'A' && c <= 'Z') ? c | 0x20 : c; }
+    static uint key(uchar c) { return fold(c); }
+    static uint key(QChar c)
+    {
+        const uint u = c.unicode();
+        return u < 0x80 ? fold(u) : (0x80 | (u & 0x7F));
+    }
+
+    void set(uint a, uint b)
+    {
+        const uint bit = (a << 8) | b;
+        m_bits[bit >> 6] |= quint64(1) << (bit & 63);
+    }
+    bool test(uint a, uint b, const BigramFilter *other) const
+    {
+        const uint bit = (a << 8) | b;
+        const quint64 mask = quint64(1) << (bit & 63);
+        return (m_bits[bit >> 6] & mask) || (other && (other->m_bits[bit >> 6] & mask));
+    }
+
+    std::vector<quint64> m_bits;
+};
+
+#endif // BIGRAMFILTER_H
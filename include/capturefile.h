@@ -0,0 +1,120 @@
+#ifndef CAPTUREFILE_H
+#define CAPTUREFILE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <atomic>
+
+#include "logwriter.h"
+
+// 原始二进制捕获格式(小端):
+//   文件头   16字节: "PYROCAP\0" | u16 版本 | u16 文件头长度 | u32 保留
+//   记录头   16字节: u8 类型 | u8 方向 | u8 端口号 | u8 保留 | u32 负载长度 | i64 单调时钟纳秒
+//   数据记录 (类型1): 记录头 + 原始字节
+//   索引块   (类型2): 记录头 + u64 上一个索引块偏移 | u32 条目数 | 条目数 × (i64 时间戳, u64 记录偏移)
+//   文件尾   16字节: u64 最后一个索引块偏移 | "PYROEND\0" (正常关闭时写入)
+// 索引是稀疏的: 每 kIndexStride 字节记录一个条目, 每 kIndexBlockBytes 字节写出一个索引块
+// 数据按线路上的原样保存, 十六进制/文本渲染在查看时才做
+
+enum class CaptureDirection : quint8 { Rx = 0, Tx = 1 };
+
+namespace CaptureFormat {
+constexpr char kMagic[8] = {'P', 'Y', 'R', 'O', 'C', 'A', 'P', '\0'};
+constexpr char kEndMagic[8] = {'P', 'Y', 'R', 'O', 'E', 'N', 'D', '\0'};
+constexpr quint16 kVersion = 1;
+constexpr int kFileHeaderSize = 16;
+constexpr int kRecordHeaderSize = 16;
+constexpr int kTrailerSize = 16;
+constexpr quint8 kDataRecord = 1;
+constexpr quint8 kIndexRecord = 2;
+constexpr qint64 kIndexStride = 64 * 1024;
+constexpr qint64 kIndexBlockBytes = 4 * 1024 * 1024;
+}
+
+struct CaptureIndexEntry
+{
+    qint64 timestampNs;
+    qint64 offset;
+};
+
+// 捕获写入器: 编码记录后交给 LogWriter 异步写盘
+// 只能在一个线程中调用(串口I/O线程), 收发两个方向都在该线程中记录, 因此记录天然按时间排序
+class CaptureWriter
+{
+public:
+    bool open(const QString &path, QString *errorString = nullptr);
+    void close();
+    bool isOpen() const { return m_writer.isOpen(); }
+    // 写盘队列上限; 超出时新记录被丢弃并计入 droppedRecords(), 阻塞模式下则等待写出
+    void setMaxQueueBytes(qint64 maxQueueBytes) { m_writer.setMaxQueueBytes(maxQueueBytes); }
+    void setBlocking(bool blocking) { m_writer.setBlocking(blocking); }
+
+    void record(qint64 timestampNs, CaptureDirection direction, quint8 portId,
+                const char *data, qsizetype len);
+
+    qint64 bytesCaptured() const { return m_offset; }
+    // 写盘队列满时丢弃的数据记录; 文件仍然完整可读, 只是缺少这些记录
+    quint64 droppedRecords() const { return m_droppedRecords.load(std::memory_order_relaxed); }
+    const LogWriter &writer() const { return m_writer; }
+
+private:
+    void writeIndexBlock();
+
+    LogWriter m_writer;
+    QByteArray m_staging;                   // 记录头+负载, 复用以避免每条记录分配
+    QVector<CaptureIndexEntry> m_pending;   // 尚未写出的索引条目
+    qint64 m_offset = 0;                    // 下一条记录在文件中的偏移
+    qint64 m_lastIndexOffset = 0;
+    qint64 m_lastEntryOffset = 0;
+    qint64 m_lastBlockOffset = 0;
+    qint64 m_lastTimestampNs = 0;
+    std::atomic<quint64> m_droppedRecords{0};    // 其他线程只读
+};
+
+// 捕获读取器: 内存映射整个文件, 打开多GB文件也无需读入内存
+// 正常关闭的文件沿索引链加载稀疏索引; 没有文件尾(例如程序崩溃)时跳跃扫描记录头重建索引
+class CaptureReader
+{
+public:
+    struct Record
+    {
+        qint64 offset = -1;
+        qint64 timestampNs = 0;
+        CaptureDirection direction = CaptureDirection::Rx;
+        quint8 portId = 0;
+        const char *data = nullptr;
+        quint32 length = 0;
+    };
+
+    ~CaptureReader();
+
+    bool open(const QString &path, QString *errorString = nullptr);
+    void close();
+    bool isOpen() const { return m_base != nullptr; }
+
+    qint64 size() const { return m_size; }
+    qint64 firstOffset() const { return CaptureFormat::kFileHeaderSize; }
+    // 从 offset 开始读取下一条数据记录(跳过索引块), 成功时 next 为其后一条记录的偏移
+    bool readNext(qint64 offset, Record *record, qint64 *next) const;
+    // 第一条时间戳 >= timestampNs 的数据记录偏移
+    qint64 seekToTime(qint64 timestampNs) const;
+    qint64 firstTimestampNs() const;
+    qint64 lastTimestampNs() const;
+    const QVector<CaptureIndexEntry> &index() const { return m_index; }
+
+    static QString renderHex(const Record &record);
+
+private:
+    bool loadIndexChain();
+    void rebuildIndex();
+
+    QFile m_file;
+    const uchar *m_base = nullptr;
+    qint64 m_size = 0;
+    qint64 m_dataEnd = 0;    // 不含文件尾
+    QVector<CaptureIndexEntry> m_index;
+};
+
+#endif // CAPTUREFILE_H
@@ -0,0 +1,98 @@
+#ifndef CAPTUREREPLAYER_H
+#define CAPTUREREPLAYER_H
+
+#include <QObject>
+#include <QHash>
+#include <QMetaType>
+#include <QVector>
+
+#include "capturefile.h"
+
+class QTimer;
+class SerialWorker;
+
+// 回放统计; 速率按实际运行时间计算(不含暂停)
+struct ReplayStats
+{
+    quint64 records = 0;            // 已送入接收路径的记录数
+    quint64 bytes = 0;
+    qint64 elapsedNs = 0;
+    quint64 ringStalls = 0;         // 接收方来不及取走, 环形缓冲区满而等待的次数
+    qint64 positionNs = 0;          // 当前回放到的捕获时刻
+    qint64 finishedAtNs = 0;        // 最后一条记录写入环形缓冲区的单调时刻, 未结束时为0
+    bool finished = false;          // 播放到了结尾; 被 stop() 中止时为 false
+
+    double bytesPerSec() const { return elapsedNs > 0 ? bytes * 1e9 / elapsedNs : 0.0; }
+    double recordsPerSec() const { return elapsedNs > 0 ? records * 1e9 / elapsedNs : 0.0; }
+};
+Q_DECLARE_METATYPE(ReplayStats)
+
+// 捕获回放: 把原始捕获中的接收记录按原来的时间间隔写回各回放会话的环形缓冲区
+// - 之后的分帧、显示、曲线、日志与真实串口完全相同, 取数据的一方不区分两者
+// - speed 为倍速, 0 表示尽快: 只受环形缓冲区和接收方处理速度限制, 结果即整条接收路径的吞吐
+// - 写入环形缓冲区的时间戳是回放时的单调时钟(按倍速换算), 与实时数据的时间轴一致
+// - 运行在 SessionManager 的I/O线程中, 是各回放会话环形缓冲区的唯一写入方
+// open()/addTarget() 在移动到I/O线程之前调用, 其余槽只能在I/O线程中调用
+class CaptureReplayer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CaptureReplayer(QObject *parent = nullptr);
+    ~CaptureReplayer();
+
+    bool open(const QString &path, QString *errorString = nullptr);
+    const CaptureReader &reader() const { return m_reader; }
+    // 捕获中出现过接收记录的端口号, 按升序; 扫描所有记录头, 不读取负载
+    QVector<quint8> receivePortIds() const;
+    // 捕获端口号的记录写入 worker 的环形缓冲区; 没有目标的端口被跳过
+    void addTarget(quint8 capturePortId, SerialWorker *worker);
+
+    static constexpr qint64 kProgressIntervalNs = 100000000;   // 进度通知间隔 100ms
+    static constexpr qint64 kBatchBytes = 1024 * 1024;         // 尽快模式下每批最多写入的字节数, 之后让出事件循环
+
+public slots:
+    void start(double speed);
+    void setSpeed(double speed);
+    void setPaused(bool paused);
+    void seek(qint64 timestampNs);
+    void stop();
+
+signals:
+    void progress(const ReplayStats &stats);
+    // 跳转后接收数据不连续, 接收方应丢弃分帧和解码的中间状态
+    void seeked(qint64 timestampNs);
+    void finished(const ReplayStats &stats);
+
+private slots:
+    void pump();
+
+private:
+    qint64 captureTimeNow(qint64 nowNs) const;
+    void rebase(qint64 captureNs, qint64 nowNs);
+    void schedule(qint64 delayNs);
+    void finish(bool completed);
+
+    CaptureReader m_reader;
+    QHash<quint8, SerialWorker *> m_targets;
+    QTimer *m_timer;
+    double m_speed = 1.0;
+    bool m_running = false;
+    bool m_paused = false;
+    bool m_stopped = false;         // 已结束, 每个回放器只播放一次
+
+    // 当前记录; m_recordPos 为已写入部分, 环形缓冲区满时下次从这里继续
+    qint64 m_offset = 0;
+    qint64 m_next = 0;
+    CaptureReader::Record m_record;
+    bool m_haveRecord = false;
+    quint32 m_recordPos = 0;
+
+    // 时间映射: 捕获时刻 anchorCapture 对应单调时刻 anchorWall, 之后按倍速推进
+    qint64 m_anchorCaptureNs = 0;
+    qint64 m_anchorWallNs = 0;
+    qint64 m_runStartNs = 0;        // 本段运行(开始/继续)的起点, 用于累计 elapsedNs
+    qint64 m_lastProgressNs = 0;
+    ReplayStats m_stats;
+};
+
+#endif // CAPTUREREPLAYER_H
@@ -0,0 +1,59 @@
+#ifndef CAPTURESEARCH_H
+#define CAPTURESEARCH_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+#include "bigramfilter.h"
+#include "capturefile.h"
+#include "searchquery.h"
+
+// 捕获文件搜索: 每 kRegionBytes 负载一个二元组位图, 查询时跳过不可能匹配的区域
+// - 索引在第一次打开时顺序建立; 同一文件再次 open() 时只为新追加的记录补建索引,
+//   因此正在写入的捕获文件可以反复搜索
+// - 文本/十六进制查询按"串口+方向"把相邻记录拼接起来匹配, 跨越记录边界的字节串也能找到
+// - 正则查询不能预过滤, 逐条记录检查, 不跨越记录边界
+class CaptureSearcher
+{
+public:
+    struct Hit
+    {
+        qint64 offset;               // 匹配结束所在记录的偏移
+        qint64 timestampNs;
+        quint8 portId;
+        CaptureDirection direction;
+    };
+
+    bool open(const QString &path, QString *errorString = nullptr);
+    const CaptureReader &reader() const { return m_reader; }
+    QString fileName() const { return m_path; }
+
+    QVector<Hit> search(const SearchQuery &query, int maxHits) const;
+
+    int regionCount() const { return m_regions.size(); }
+    int lastScannedRegions() const { return m_lastScanned; }
+
+private:
+    static constexpr qint64 kRegionBytes = 256 * 1024;
+
+    struct Region
+    {
+        qint64 firstOffset = 0;
+        qint64 endOffset = 0;
+        qint64 payloadBytes = 0;
+        BigramFilter filter;
+    };
+
+    void extendIndex();
+    bool regionMayMatch(int i, const SearchQuery &query) const;
+
+    CaptureReader m_reader;
+    QString m_path;
+    QVector<Region> m_regions;
+    qint64 m_indexedEnd = 0;         // 已建索引的最后一条记录之后的偏移
+    QHash<int, char> m_lastByte;     // 每个串口+方向上一条记录的最后一个字节, 用于交界字符对
+    mutable int m_lastScanned = 0;
+};
+
+#endif // CAPTURESEARCH_H
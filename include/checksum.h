@@ -0,0 +1,170 @@
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// 校验和/CRC 引擎
+// - CRC 参数(宽度、多项式、初值、是否反射、结果异或)是模板参数, 查找表在编译期生成,
+//   按 slice-by-8 每次处理8字节; 非反射的 CRC 在32位寄存器中左对齐, 与反射的共用同一套结构
+// - 运行时按名字选择算法(分帧的 check=, 发送时自动追加), 经一次函数指针调用进入特化后的实现
+// - CRC-32C 在支持 SSE4.2 的 CPU 上改用 crc32 指令, 首次调用时检测
+namespace Checksum {
+
+namespace Detail {
+
+constexpr uint32_t reflect(uint32_t value, int bits)
+{
+    uint32_t result = 0;
+    for (int i = 0; i < bits; ++i) result |= ((value >> i) & 1u) << (bits - 1 - i);
+    return result;
+}
+
+using CrcTables = std::array<std::array<uint32_t, 256>, 8>;
+
+// 第 k 张表是某字节之后再经过 k 个零字节的余数, slice-by-8 一次查8张表合并
+// 非反射时寄存器左对齐: 多项式左移 32-Width 位
+template <int Width, uint32_t Poly, bool Reflected>
+constexpr CrcTables makeCrcTables()
+{
+    CrcTables tables{};
+    const uint32_t poly = Reflected ? reflect(Poly, Width) : Poly << (32 - Width);
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = Reflected ? i : i << 24;
+        for (int bit = 0; bit < 8; ++bit) {
+            if (Reflected) crc = (crc & 1u) ? (crc >> 1) ^ poly : crc >> 1;
+            else crc = (crc & 0x80000000u) ? (crc << 1) ^ poly : crc << 1;
+        }
+        tables[0][i] = crc;
+    }
+    for (int k = 1; k < 8; ++k) {
+        for (uint32_t i = 0; i < 256; ++i) {
+            const uint32_t prev = tables[k - 1][i];
+            tables[k][i] = Reflected ? (prev >> 8) ^ tables[0][prev & 0xFF]
+                                     : (prev << 8) ^ tables[0][prev >> 24];
+        }
+    }
+    return tables;
+}
+
+} // namespace Detail
+
+template <int Width, uint32_t Poly, uint32_t Init, bool Reflected, uint32_t XorOut>
+class Crc
+{
+public:
+    static_assert(Width >= 8 && Width <= 32, "CRC 宽度必须为 8-32 位");
+    static constexpr int kWidth = Width;
+
+    static uint32_t compute(const uint8_t *data, size_t n) { return finish(update(start(), data, n)); }
+
+    // 分段计算: finish(update(update(start(), a), b)) == compute(a + b)
+    static constexpr uint32_t start() { return Reflected ? Detail::reflect(Init, Width) : Init << kShift; }
+    static constexpr uint32_t finish(uint32_t crc) { return ((Reflected ? crc : crc >> kShift) ^ XorOut) & kMask; }
+    static uint32_t update(uint32_t crc, const uint8_t *data, size_t n);
+
+    // 逐位计算, 只用于性能测试对比和校验查找表
+    static uint32_t bitwise(const uint8_t *data, size_t n);
+
+private:
+    static constexpr int kShift = 32 - Width;
+    static constexpr uint32_t kMask = 0xFFFFFFFFu >> kShift;
+    static constexpr Detail::CrcTables kTables = Detail::makeCrcTables<Width, Poly, Reflected>();
+};
+
+template <int Width, uint32_t Poly, uint32_t Init, bool Reflected, uint32_t XorOut>
+uint32_t Crc<Width, Poly, Init, Reflected, XorOut>::update(uint32_t crc, const uint8_t *data, size_t n)
+{
+    const auto &t = kTables;
+    while (n >= 8) {
+        if (Reflected) {
+            crc ^= uint32_t(data[0]) | uint32_t(data[1]) << 8 | uint32_t(data[2]) << 16 | uint32_t(data[3]) << 24;
+            crc = t[7][crc & 0xFF] ^ t[6][(crc >> 8) & 0xFF] ^ t[5][(crc >> 16) & 0xFF] ^ t[4][crc >> 24]
+                ^ t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+        } else {
+            crc ^= uint32_t(data[0]) << 24 | uint32_t(data[1]) << 16 | uint32_t(data[2]) << 8 | uint32_t(data[3]);
+            crc = t[7][crc >> 24] ^ t[6][(crc >> 16) & 0xFF] ^ t[5][(crc >> 8) & 0xFF] ^ t[4][crc & 0xFF]
+                ^ t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+        }
+        data += 8;
+        n -= 8;
+    }
+    for (; n > 0; --n, ++data) {
+        crc = Reflected ? (crc >> 8) ^ t[0][(crc ^ *data) & 0xFF]
+                        : (crc << 8) ^ t[0][(crc >> 24) ^ *data];
+    }
+    return crc;
+}
+
+template <int Width, uint32_t Poly, uint32_t Init, bool Reflected, uint32_t XorOut>
+uint32_t Crc<Width, Poly, Init, Reflected, XorOut>::bitwise(const uint8_t *data, size_t n)
+{
+    uint32_t crc = start();
+    for (size_t i = 0; i < n; ++i) {
+        if (Reflected) {
+            const uint32_t poly = Detail::reflect(Poly, Width);
+            crc ^= data[i];
+            for (int bit = 0; bit < 8; ++bit) crc = (crc & 1u) ? (crc >> 1) ^ poly : crc >> 1;
+        } else {
+            const uint32_t poly = Poly << kShift;
+            crc ^= uint32_t(data[i]) << 24;
+            for (int bit = 0; bit < 8; ++bit) crc = (crc & 0x80000000u) ? (crc << 1) ^ poly : crc << 1;
+        }
+    }
+    return finish(crc);
+}
+
+// 常用算法, 参数与 CRC RevEng 目录一致
+using Crc8        = Crc<8, 0x07, 0x00, false, 0x00>;                           // CRC-8/SMBUS
+using Crc8Maxim   = Crc<8, 0x31, 0x00, true, 0x00>;                            // 1-Wire
+using Crc16Modbus = Crc<16, 0x8005, 0xFFFF, true, 0x0000>;
+using Crc16Ccitt  = Crc<16, 0x1021, 0xFFFF, false, 0x0000>;                    // CCITT-FALSE
+using Crc16Xmodem = Crc<16, 0x1021, 0x0000, false, 0x0000>;
+using Crc16Kermit = Crc<16, 0x1021, 0x0000, true, 0x0000>;
+using Crc16X25    = Crc<16, 0x1021, 0xFFFF, true, 0xFFFF>;
+using Crc16Arc    = Crc<16, 0x8005, 0x0000, true, 0x0000>;
+using Crc32       = Crc<32, 0x04C11DB7, 0xFFFFFFFF, true, 0xFFFFFFFF>;         // zlib/以太网
+using Crc32C      = Crc<32, 0x1EDC6F41, 0xFFFFFFFF, true, 0xFFFFFFFF>;         // Castagnoli
+using Crc32Mpeg2  = Crc<32, 0x04C11DB7, 0xFFFFFFFF, false, 0x00000000>;
+
+uint32_t sum8(const uint8_t *data, size_t n);
+uint32_t xor8(const uint8_t *data, size_t n);
+
+enum class Kind {
+    None, Sum8, Xor8, Crc8, Crc8Maxim, Crc16Modbus, Crc16Ccitt, Crc16Xmodem, Crc16Kermit, Crc16X25, Crc16Arc,
+    Crc32, Crc32C, Crc32Mpeg2, Count
+};
+
+struct Algorithm
+{
+    Kind kind;
+    const char *name;                // 分帧格式和界面中使用的名字
+    int size;                        // 追加到帧尾的字节数
+    bool bigEndian;                  // 反射的 CRC 低字节在前(如 Modbus), 其余高字节在前
+    uint32_t check;                  // "123456789" 的校验值, 用于自检
+    uint32_t (*compute)(const uint8_t *data, size_t n);
+};
+
+const Algorithm &algorithm(Kind kind);
+// 名字不区分大小写; 未知名字返回 false
+bool kindForName(const QString &name, Kind *kind);
+QStringList names();
+
+inline uint32_t compute(Kind kind, const uint8_t *data, size_t n) { return algorithm(kind).compute(data, n); }
+// check 指向帧尾的校验字段, 按算法的字节序比较
+bool verify(Kind kind, const uint8_t *data, size_t n, const uint8_t *check);
+// 对 data 的全部内容计算校验值并追加到末尾
+void append(Kind kind, QByteArray *data);
+
+// CRC-32C 当前使用的实现, 用于性能测试输出
+const char *activeIsa();
+// 强制使用查表实现(性能测试对比用)
+void forceTable(bool table);
+
+} // namespace Checksum
+
+#endif // CHECKSUM_H
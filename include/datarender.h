@@ -0,0 +1,31 @@
+#ifndef DATARENDER_H
+#define DATARENDER_H
+
+#include <QByteArray>
+#include <QString>
+
+// 把接收到的原始字节渲染为显示文本, 界面和命令行模式共用
+namespace DataRender {
+
+enum class Mode
+{
+    Hex,      // 十六进制（格式：A1 B2 C3）
+    Escape,   // 文本, 控制字符显示为 \xNN
+    Filter    // 文本, 过滤控制字符
+};
+
+// scratch 为可复用的临时缓冲, 传 nullptr 时内部临时分配
+QString render(const QByteArray &data, Mode mode, QByteArray *scratch = nullptr);
+QString hexSpaced(const QByteArray &data, QByteArray *scratch = nullptr);
+QString escapeControlChars(const QByteArray &input);
+QString filterControlChars(const QByteArray &input);
+
+// 以下把渲染结果(UTF-8)追加到 out 末尾, out 容量足够时不分配内存, 用于高速接收路径
+void appendRendered(QByteArray *out, const char *data, qsizetype n, Mode mode);
+void appendHexSpaced(QByteArray *out, const char *data, qsizetype n);
+void appendEscaped(QByteArray *out, const char *data, qsizetype n);
+void appendFiltered(QByteArray *out, const char *data, qsizetype n);
+
+} // namespace DataRender
+
+#endif // DATARENDER_H
@@ -0,0 +1,134 @@
+#ifndef FRAMEPARSER_H
+#define FRAMEPARSER_H
+
+#include <QByteArray>
+#include <QString>
+
+#include "checksum.h"
+
+// 帧格式的声明式描述, 可由文本解析, 例如:
+//   "head=AA55;len=2:1;adj=5;check=sum8"   帧头AA55, 偏移2处1字节长度, 帧总长=长度值+5, 末尾累加和
+//   "fixed=8;head=A5"                      帧头A5的8字节定长帧
+//   "delim=0D0A"                           以\r\n结尾的文本行
+// 键: head(帧头, 十六进制) fixed(定长) len(偏移:字节数[:be]) adj(长度修正) delim(结束符, 十六进制)
+//     check(校验算法, 见 Checksum::names(), 如 sum8/xor8/crc16modbus/crc32; 覆盖帧首到校验字段之前) max(最大帧长)
+struct FrameSpec
+{
+    QByteArray header;
+    int fixedLength = 0;          // >0 时为定长帧(含帧头和校验)
+    int lengthOffset = -1;        // >=0 时从长度字段取帧长
+    int lengthSize = 1;           // 1/2/4 字节
+    bool lengthBigEndian = false;
+    int lengthAdjust = 0;         // 帧总长 = 长度字段值 + lengthAdjust
+    QByteArray delimiter;         // 非空时以结束符分帧
+    Checksum::Kind checksum = Checksum::Kind::None;
+    int maxFrameLength = 4096;
+
+    bool isValid() const;
+    int checksumSize() const;
+    static FrameSpec parse(const QString &text, QString *errorString = nullptr);
+};
+
+// 帧的只读视图, 指向解析器输入或其内部缓冲, 仅在回调期间有效
+struct FrameView
+{
+    const char *data;
+    qsizetype size;
+};
+
+// 流式分帧引擎: 输入任意切分的数据块, 输出完整的帧
+// - 完整落在本次输入内的帧直接以指向输入的视图回调, 不做拷贝
+// - 只有跨数据块的残余字节才会暂存到内部缓冲; 下一块只取补全这一帧所需的字节拼接,
+//   残余帧处理完后其余输入仍按快速路径直接解析
+// - 校验失败或长度非法时丢弃一个字节重新同步
+class FrameParser
+{
+public:
+    FrameParser() = default;
+    explicit FrameParser(const FrameSpec &spec) { setSpec(spec); }
+
+    void setSpec(const FrameSpec &spec);
+    const FrameSpec &spec() const { return m_spec; }
+    void reset();
+
+    template <typename Callback>
+    void feed(const char *data, qsizetype len, Callback &&onFrame);
+
+    quint64 frameCount() const { return m_frames; }
+    quint64 checksumErrors() const { return m_checksumErrors; }
+    quint64 discardedBytes() const { return m_discardedBytes; }
+    qsizetype pendingBytes() const { return m_pending.size(); }
+
+private:
+    enum class Result { Frame, NeedMore };
+    // 在 [data, data+len) 中查找下一帧; Frame 时 *frameStart/*frameSize 为帧位置,
+    // 两种结果下 *consumed 都是可以丢弃的字节数(含已识别的帧)
+    Result scan(const char *data, qsizetype len, qsizetype *frameStart, qsizetype *frameSize,
+                qsizetype *consumed);
+    qsizetype findHeader(const char *data, qsizetype len) const;
+    qsizetype frameLengthAt(const char *frame, qsizetype avail, bool *needMore) const;
+    bool verify(const char *frame, qsizetype size) const;
+    // 暂存的残余帧还需要从输入 [data, data+len) 开头取多少字节才能判断, 至少为1
+    qsizetype pendingNeed(const char *data, qsizetype len) const;
+
+    template <typename Callback>
+    qsizetype drain(const char *data, qsizetype len, Callback &onFrame);
+
+    FrameSpec m_spec;
+    QByteArray m_pending;
+    quint64 m_frames = 0;
+    quint64 m_checksumErrors = 0;
+    quint64 m_discardedBytes = 0;
+};
+
+template <typename Callback>
+qsizetype FrameParser::drain(const char *data, qsizetype len, Callback &onFrame)
+{
+    qsizetype pos = 0;
+    for (;;) {
+        qsizetype start = 0, size = 0, consumed = 0;
+        const Result result = scan(data + pos, len - pos, &start, &size, &consumed);
+        if (result == Result::Frame) {
+            ++m_frames;
+            onFrame(FrameView{data + pos + start, size});
+        }
+        pos += consumed;
+        if (result == Result::NeedMore) return pos;
+    }
+}
+
+template <typename Callback>
+void FrameParser::feed(const char *data, qsizetype len, Callback &&onFrame)
+{
+    if (!m_spec.isValid() || len <= 0) return;
+
+    if (m_pending.isEmpty()) {
+        // 快速路径: 直接在输入上解析, 只保存末尾不完整的部分
+        const qsizetype used = drain(data, len, onFrame);
+        if (used < len) m_pending.append(data + used, int(len - used));
+        return;
+    }
+
+    // 慢速路径: 每次只从输入开头取残余帧缺少的字节, 直到解析越过暂存的全部旧字节
+    qsizetype taken = 0;
+    while (taken < len) {
+        const qsizetype oldSize = m_pending.size();
+        const qsizetype n = qMin(pendingNeed(data + taken, len - taken), len - taken);
+        m_pending.append(data + taken, int(n));
+        taken += n;
+        const qsizetype used = drain(m_pending.constData(), m_pending.size(), onFrame);
+        if (used < oldSize) {
+            // 仍停在旧字节中(例如校验失败后重新同步), 残余帧换了起点, 重新计算所需字节
+            m_pending.remove(0, int(used));
+            continue;
+        }
+        // 旧字节已全部处理, 未消耗的部分都来自输入, 退回输入中继续快速路径
+        const qsizetype restart = taken - (m_pending.size() - used);
+        m_pending.clear();
+        const qsizetype rest = drain(data + restart, len - restart, onFrame);
+        if (restart + rest < len) m_pending.append(data + restart + rest, int(len - restart - rest));
+        return;
+    }
+}
+
+#endif // FRAMEPARSER_H
@@ -0,0 +1,19 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+// 无界面(命令行/守护进程)模式, 只依赖 QtCore、QtSerialPort 和 QtNetwork
+//   app0 --headless --port ttyUSB0 --baud 921600 --flow rtscts --low-latency --capture run.pyrocap
+//   app0 --headless --port ttyUSB0 --bridge tcp:5555 --quiet   (串口共享给本机的测试脚本: nc 127.0.0.1 5555)
+//   app0 --headless --port ttyUSB0 --trigger "pattern=1B5B;error" --trigger-dir traces --quiet
+//                                                           (平时只写内存, 出现事件或 kill -USR1 时保存前后窗口)
+//   app0 --headless --port ttyUSB0 --alarms alarms.txt --quiet   (规则匹配时在标准错误输出报警, 可执行外部命令)
+//   app0 --headless --replay run.pyrocap --speed 0 --quiet    (回放捕获, 测量整条接收路径的吞吐)
+// 收到的数据按 --hex/--escape 渲染后输出到标准输出, --quiet 时只记录不输出
+
+// 命令行中是否包含 --headless, 在创建 QApplication 之前调用
+bool isHeadlessInvocation(int argc, char *argv[]);
+
+// 创建 QCoreApplication 并运行到退出(SIGINT/SIGTERM 或 --duration 到期)
+int runHeadless(int argc, char *argv[]);
+
+#endif // HEADLESS_H
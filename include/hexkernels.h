@@ -0,0 +1,38 @@
+#ifndef HEXKERNELS_H
+#define HEXKERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// 十六进制编解码与控制字符扫描内核
+// 首次调用时按CPU能力选择实现(AVX2 / SSSE3 / 标量), 之后直接走函数指针
+namespace HexKernels {
+
+// 大写、空格分隔的十六进制: {0xA1,0xB2} -> "A1 B2"
+// out 至少 encodedSpacedSize(n) 字节, 返回写入的字节数
+inline size_t encodedSpacedSize(size_t n) { return n ? n * 3 - 1 : 0; }
+size_t encodeSpacedUpper(const uint8_t *in, size_t n, char *out);
+
+// 解析十六进制文本, 忽略空格; 非法字符或位数为奇数时返回 false
+// out 至少 n / 2 字节
+bool decodeHex(const char *in, size_t n, uint8_t *out, size_t *outLen);
+
+// 第一个需要处理的控制字节(< 0x20 且不是 \t \n \r)的下标, 没有时返回 n
+// 控制字节在UTF-8中不会出现在多字节序列内部, 因此可以在解码前按字节处理
+size_t findControl(const uint8_t *in, size_t n);
+
+// 当前使用的实现, 用于性能测试输出
+const char *activeIsa();
+
+// 强制使用标量实现(性能测试对比用)
+void forceScalar(bool scalar);
+
+namespace Scalar {
+size_t encodeSpacedUpper(const uint8_t *in, size_t n, char *out);
+bool decodeHex(const char *in, size_t n, uint8_t *out, size_t *outLen);
+size_t findControl(const uint8_t *in, size_t n);
+}
+
+} // namespace HexKernels
+
+#endif // HEXKERNELS_H
@@ -0,0 +1,45 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QtGlobal>
+#include <array>
+
+// 对数-线性分桶的延迟直方图(类似 HdrHistogram)
+// - 每个2的幂区间再均分为 kSubBuckets 个桶, 相对误差不超过 1/kSubBuckets
+// - record() 只做位运算和一次自增, 可以在每个数据块上调用
+// - 固定大小, 不分配内存; 不是线程安全的, 只在一个线程中使用
+class LatencyHistogram
+{
+public:
+    LatencyHistogram() { reset(); }
+
+    void record(qint64 valueNs);
+    void reset();
+
+    quint64 count() const { return m_count; }
+    qint64 minNs() const { return m_count ? m_min : 0; }
+    qint64 maxNs() const { return m_max; }
+    double meanNs() const { return m_count ? double(m_sum) / double(m_count) : 0; }
+    // 百分位(0-100), 返回所在桶的上界
+    qint64 percentileNs(double percentile) const;
+
+    // 合并另一个直方图, 用于按周期汇总
+    void add(const LatencyHistogram &other);
+
+private:
+    static constexpr int kSubBucketBits = 5;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    static constexpr int kOctaves = 64 - kSubBucketBits;
+    static constexpr int kBucketCount = (kOctaves + 1) * kSubBuckets;
+
+    static int bucketIndex(quint64 value);
+    static qint64 bucketUpperBound(int index);
+
+    std::array<quint64, kBucketCount> m_buckets;
+    quint64 m_count = 0;
+    qint64 m_min = 0;
+    qint64 m_max = 0;
+    qint64 m_sum = 0;
+};
+
+#endif // LATENCYHISTOGRAM_H
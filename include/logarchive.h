@@ -0,0 +1,173 @@
+#ifndef LOGARCHIVE_H
+#define LOGARCHIVE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QWaitCondition>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+// 日志分段与保留策略; 各项为0表示不限制
+struct LogRotation
+{
+    qint64 maxSegmentBytes = 0;     // 当前文件达到该大小时切换到新分段
+    int maxSegmentSeconds = 0;      // 当前分段写入超过该时长时切换
+    bool compress = false;          // 关闭的分段压缩为 .gz
+    qint64 retentionBytes = 0;      // 所有分段(含当前文件)的总大小上限, 超出时删除最旧的分段
+
+    bool isEnabled() const { return maxSegmentBytes > 0 || maxSegmentSeconds > 0; }
+};
+
+// 分块gzip格式: 文件由若干个独立的gzip成员依次拼接而成, 每个成员压缩不超过 kBlockBytes 的原文
+// - 仍是标准gzip, gunzip/zcat 可以直接解压
+// - 每个成员头部的扩展字段(子字段 'P','L')记录本成员的压缩长度和原文长度,
+//   读取时只需沿成员头跳跃即可建立索引, 不必先解压整个文件, 随后按块解压
+namespace BlockGzip {
+constexpr int kBlockBytes = 64 * 1024;
+constexpr int kHeaderSize = 24;     // 10字节gzip头 + 2字节XLEN + 12字节扩展字段
+constexpr int kTrailerSize = 8;     // CRC32 + ISIZE
+
+// 压缩一块原文, 追加一个完整的gzip成员到 out
+bool appendBlock(QByteArray *out, const char *data, qsizetype size);
+// 把 source 压缩为 target, 先写入临时文件再改名, 中途失败不会留下不完整的 target
+bool compressFile(const QString &source, const QString &target, QString *errorString = nullptr);
+}
+
+// 日志分段命名: log_COM3.txt 为当前文件, 关闭的分段为 log_COM3.20261017-031500.txt(.gz),
+// 同一秒内多次切换时在时间后加 _1, _2 ...; 按时间和序号(数值)排序即为先后顺序
+namespace LogArchive {
+QString segmentPath(const QString &activePath, const QString &stamp);
+// activePath 的所有已关闭分段(含已压缩的), 从旧到新
+QStringList segments(const QString &activePath);
+// 删除最旧的分段直到总大小(含当前文件)不超过 retentionBytes, 返回删除的文件数
+int enforceRetention(const QString &activePath, qint64 retentionBytes);
+}
+
+// 日志归档线程: 压缩已关闭的分段并执行保留上限
+// 全进程共用一个后台线程, 多个串口同时切换分段时依次压缩, 不占用写日志线程, 接收路径不受影响
+class LogArchiver
+{
+public:
+    static LogArchiver &instance();
+    ~LogArchiver();
+
+    // segment 为空时只执行保留上限
+    void submit(const QString &activePath, const QString &segment, const LogRotation &rotation);
+    // 等待已提交的任务全部完成
+    void waitForIdle();
+
+    quint64 segmentsCompressed() const { return m_compressed.load(std::memory_order_relaxed); }
+    quint64 segmentsRemoved() const { return m_removed.load(std::memory_order_relaxed); }
+
+private:
+    LogArchiver() = default;
+    void run();
+
+    struct Job
+    {
+        QString activePath;
+        QString segment;
+        LogRotation rotation;
+    };
+
+    std::thread m_thread;
+    QMutex m_mutex;
+    QWaitCondition m_wake;
+    QWaitCondition m_idle;
+    QVector<Job> m_jobs;
+    bool m_busy = false;
+    bool m_stopRequested = false;
+    std::atomic<quint64> m_compressed{0};
+    std::atomic<quint64> m_removed{0};
+};
+
+// 日志分段读取: 普通文本或分块gzip, 按块随机访问
+// - 文本文件做内存映射, 按 kBlockBytes 划分虚拟块
+// - 分块gzip只读取成员头建立索引, readBlock() 时才解压该块
+// - 其他工具生成的gzip没有成员长度, 视为一个块, 第一次读取时整体解压
+class LogSegmentReader
+{
+public:
+    ~LogSegmentReader();
+
+    bool open(const QString &path, QString *errorString = nullptr);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+    bool isCompressed() const { return m_compressed; }
+
+    qint64 size() const { return m_size; }   // 原文总长
+    qint64 compressedSize() const { return m_fileSize; }
+    int blockCount() const { return m_blocks.size(); }
+    qint64 blockOffset(int i) const { return m_blocks.at(i).offset; }
+    // 第 i 块的原文写入 out(覆盖), 缓冲区可复用
+    bool readBlock(int i, QByteArray *out) const;
+    // 原文的最后 maxBytes 字节(从完整的行开始), 只解压末尾的若干块
+    QByteArray tail(qint64 maxBytes) const;
+    // 逐块解压并按行回调 sink(原文偏移, 行, 长度), 不含换行符; sink 返回 false 时停止
+    // 任一时刻只保留一块原文和跨块的半行, 搜索多GB的日志也不需要先整体解压
+    template <typename Sink>
+    void forEachLine(Sink &&sink) const;
+
+private:
+    struct Block
+    {
+        qint64 offset;              // 原文偏移
+        qint64 length;              // 原文长度
+        qint64 fileOffset;          // 文件中的偏移
+        qint64 fileLength;
+    };
+
+    bool indexBlockGzip();
+
+    QFile m_file;
+    const uchar *m_base = nullptr;
+    qint64 m_fileSize = 0;
+    qint64 m_size = 0;
+    bool m_compressed = false;
+    QVector<Block> m_blocks;
+};
+
+template <typename Sink>
+void LogSegmentReader::forEachLine(Sink &&sink) const
+{
+    QByteArray block;
+    QByteArray carry;                // 上一块末尾未结束的行
+    qint64 carryOffset = 0;
+    for (int i = 0; i < m_blocks.size(); ++i) {
+        if (!readBlock(i, &block)) return;
+        const char *p = block.constData();
+        const char *end = p + block.size();
+        qint64 offset = m_blocks.at(i).offset;
+        while (p < end) {
+            const char *nl = static_cast<const char *>(std::memchr(p, '\n', size_t(end - p)));
+            if (!nl) {
+                if (carry.isEmpty()) carryOffset = offset;
+                carry.append(p, int(end - p));
+                break;
+            }
+            qsizetype n = nl - p;
+            bool more;
+            if (!carry.isEmpty()) {
+                carry.append(p, int(n));
+                n = carry.size();
+                if (n > 0 && carry.at(n - 1) == '\r') --n;
+                more = sink(carryOffset, carry.constData(), n);
+                carry.resize(0);
+            } else {
+                if (n > 0 && p[n - 1] == '\r') --n;
+                more = sink(offset, p, n);
+            }
+            if (!more) return;
+            offset += (nl + 1) - p;
+            p = nl + 1;
+        }
+    }
+    if (!carry.isEmpty()) sink(carryOffset, carry.constData(), qsizetype(carry.size()));
+}
+
+#endif // LOGARCHIVE_H
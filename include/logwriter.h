@@ -0,0 +1,89 @@
+#ifndef LOGWRITER_H
+#define LOGWRITER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "logarchive.h"
+
+// 异步日志写入器: 文件在整个会话期间保持打开, 由后台线程批量写盘
+// - append() 只把记录追加到内存队列, 任意线程调用都不会等待磁盘
+// - 队列达到 flushBytes 或距上次写盘超过 flushIntervalMs 时由后台线程写出
+// - 追加/覆盖只在 open() 时决定一次; close() 写出剩余数据并 fsync
+// - 队列超过 maxQueueBytes 时丢弃新记录并计数, 磁盘过慢也不会拖垮接收; append() 返回记录是否被接受
+// - 写盘失败(磁盘已满、短写)时计数并累计未写出的字节, 由调用方从统计中发现并提示
+// - 设置了分段策略时, 由后台线程在写盘间隙切换分段: 当前文件改名为带时间的分段后重新创建,
+//   关闭的分段交给 LogArchiver 压缩和执行保留上限, 写日志线程不做压缩
+class LogWriter
+{
+public:
+    LogWriter();
+    ~LogWriter();
+
+    LogWriter(const LogWriter &) = delete;
+    LogWriter &operator=(const LogWriter &) = delete;
+
+    bool open(const QString &path, bool append, QString *errorString = nullptr);
+    void close();
+    bool isOpen() const { return m_running; }
+    QString fileName() const { return m_path; }
+
+    bool append(const QByteArray &record);
+    bool append(const char *data, qsizetype len);
+    void setFlushThresholds(qint64 flushBytes, int flushIntervalMs);
+    void setMaxQueueBytes(qint64 maxQueueBytes) { m_maxQueueBytes = maxQueueBytes; }
+    // 队列满时 append() 等待后台线程写出而不是丢弃; 只用于本身就是后台线程的生产者
+    void setBlocking(bool blocking) { m_blocking = blocking; }
+    // 在 open() 之前设置, 对之后打开的文件生效
+    void setRotation(const LogRotation &rotation) { m_rotation = rotation; }
+    const LogRotation &rotation() const { return m_rotation; }
+
+    qint64 queueDepth() const { return m_queuedBytes.load(std::memory_order_relaxed); }
+    quint64 droppedRecords() const { return m_droppedRecords.load(std::memory_order_relaxed); }
+    quint64 bytesWritten() const { return m_bytesWritten.load(std::memory_order_relaxed); }
+    quint64 writeErrors() const { return m_writeErrors.load(std::memory_order_relaxed); }
+    quint64 lostBytes() const { return m_lostBytes.load(std::memory_order_relaxed); }
+    quint64 segmentsRotated() const { return m_segmentsRotated.load(std::memory_order_relaxed); }
+    quint64 rotationFailures() const { return m_rotationFailures.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+    qint64 writeOut(const QByteArray &data);
+    bool rotationDue() const;
+    void rotate();
+    void syncFile();
+
+    QFile m_file;
+    QString m_path;                 // 切换分段时 m_file 在后台线程中重新打开, 其他线程读这里
+    std::thread m_thread;
+    mutable QMutex m_mutex;
+    QWaitCondition m_wake;
+    QWaitCondition m_spaceAvailable;   // 阻塞模式下后台线程取走队列后唤醒生产者
+    QByteArray m_queue;             // 受 m_mutex 保护, 与后台线程的缓冲区交换
+    std::atomic<bool> m_running{false};
+    bool m_stopRequested = false;
+    qint64 m_flushBytes = 64 * 1024;
+    int m_flushIntervalMs = 1000;
+    qint64 m_maxQueueBytes = 64 * 1024 * 1024;
+    bool m_blocking = false;
+    std::atomic<qint64> m_queuedBytes{0};
+    std::atomic<quint64> m_droppedRecords{0};
+    std::atomic<quint64> m_bytesWritten{0};
+    std::atomic<quint64> m_writeErrors{0};
+    std::atomic<quint64> m_lostBytes{0};
+
+    // 以下只在后台线程中访问(open/close 时线程未运行)
+    LogRotation m_rotation;
+    qint64 m_segmentBytes = 0;
+    std::chrono::steady_clock::time_point m_segmentStart;
+    std::atomic<quint64> m_segmentsRotated{0};
+    std::atomic<quint64> m_rotationFailures{0};
+};
+
+#endif // LOGWRITER_H
@@ -7,8 +7,41 @@
 #include <QVBoxLayout>
 #include <QSerialPort>
 #include <QSerialPortInfo>
+#include <QPushButton>
+#include <QLineEdit>
+#include <QCheckBox>
+#include <QLabel>
+#include <QToolBar>
+#include <QStatusBar>
+#include <QMessageBox>
+#include <QFile>
+#include <QTextStream>
+#include <QDateTime>
+#include <QThread>
+#include <QTimer>
+#include <QDoubleSpinBox>
+#include <QHash>
 
+#include "alarmengine.h"
+#include "capturesearch.h"
+#include "frameparser.h"
+#include "receiveformatter.h"
+#include "sendscheduler.h"
+
+class PlotDock;
+class PortBridge;
+class PortDiscovery;
+class ReplayDock;
 class SettingsPanel; // 前向声明
+class ScrollbackView;
+class SearchBar;
+class SessionManager;
+class SerialSession;
+class StatsCollector;
+class StatsDock;
+class TransactionDock;
+struct PortInfo;
+struct StatsSnapshot;
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -32,15 +65,102 @@ private slots:
     // 槽函数: on_控件对象名_信号名
     void onOpenCloseClicked();    // 打开/关闭串口
     void onSendClicked();         // 发送数据
-    void onSerialDataReceived();  // 接收数据
+    void onSerialDataReceived();  // 接收数据(定时从I/O线程的环形缓冲区拉取)
     void refreshPorts();          // 刷新串口列表
+    void onPortsChanged(const QList<PortInfo> &added, const QStringList &removed);
+    void onSessionReconnecting(SerialSession *session, const QString &previousName);
+    void onLogFileChanged(const QString &path);
+    void onSessionOpened(SerialSession *session);
+    void onSessionFailed(SerialSession *session, const QString &errorString);
+    void onSessionClosed(SerialSession *session);
+    void onSessionError(SerialSession *session, const QString &errorString);
+    void updateOpenCloseButton();
+    void onLogEnabledToggled(bool enabled);
+    void onOpenCaptureClicked();  // 查看原始捕获文件
+    void onFrameSpecChanged(const QString &text);
+    void onSendScriptClicked();   // 按脚本定时发送
+    void onSendFileClicked();     // 以线路速率发送文件
+    void updateSendButton();
+    void onStatsSampled(const StatsSnapshot &snapshot);
+    void onFindRequested(bool forward);
+    void onSearchFilterChanged();
+    void onSearchCaptureRequested();
+    void onSearchLogRequested();
+    void loadPortSettings(const QString &portName);
+    void onBridgeToggled(bool enabled);   // 把当前串口共享给本地客户端
+    void onTriggerSpecChanged(const QString &text);
+    void onAlarmRulesChanged(const QString &path);
 
 private:
     Ui::MainWindow *ui;
-    QSerialPort *serial;
+    SessionManager *m_sessions;      // 所有已打开的串口会话, 共用一个I/O线程
+    PortDiscovery *m_discovery;      // 后台枚举和监视串口设备
+    QTimer *m_pollTimer;             // 周期性拉取接收数据
+    StatsCollector *m_stats;         // 吞吐/延迟/错误计数的周期采样
+    StatsDock *m_statsDock;
+    PlotDock *m_plotDock;            // 遥测曲线
+    ReplayDock *m_replayDock;        // 捕获回放
+    TransactionDock *m_transactionDock;  // 命令/响应往返延迟
+    PortBridge *m_bridge = nullptr;  // 串口桥接, 同一时刻只桥接一个串口
+    QString m_bridgePort;
+    QByteArray m_renderBuffer;       // 十六进制渲染缓冲, 复用
+    ReceiveFormatter m_rxFormatter;  // 接收行格式化, 缓冲复用
+    FrameSpec m_frameSpec;           // 各会话的分帧格式
+    bool m_framingEnabled = false;
+    AlarmEngine m_alarms;            // 在原始接收流上匹配报警规则
     SettingsPanel *m_settingsPanel;  // 替换原来的QWidget和动画(m_是C++中标识成员变量的命名约定)
     bool panelVisible = false;       // 面板是否可见
+
+    QComboBox *m_portBox;
+    QPushButton *m_openCloseButton;
+    QPushButton *m_refreshButton;
+    QPushButton *m_settingsButton;
+    ScrollbackView *m_sentHistory;
+    QLineEdit *m_sendEdit;
+    QCheckBox *m_hexSendCheck;
+    QComboBox *m_sendChecksumBox;    // 发送时自动追加的校验
+    QPushButton *m_sendButton;
+    QDoubleSpinBox *m_periodBox;     // 定时发送周期(ms), 0 为单次发送
+    QPushButton *m_scriptButton;
+    QPushButton *m_sendFileButton;
+    QLabel *m_sendStatsLabel;        // 定时发送的速率与抖动
+    ScrollbackView *m_receiveEdit;   // 按帧率批量刷新的虚拟化接收区
+    QLabel *m_batchLabel;            // 状态栏: 批量刷新统计
+    QLabel *m_statsLabel;            // 状态栏: 吞吐与延迟摘要
+    QLabel *m_alarmLabel;            // 状态栏: 最近一次报警, 清空接收区时隐藏
+    QPushButton *m_statsButton;
+    QPushButton *m_plotButton;
+    QPushButton *m_replayButton;
+    QPushButton *m_transactionButton;
+    QPushButton *m_bridgeButton;
+    QPushButton *m_triggerButton;    // 手动触发, 启用触发捕获后可用
+    QCheckBox *m_hexReceiveCheck;
+    QPushButton *m_clearReceiveButton;
+    QPushButton *m_openCaptureButton;
+    SearchBar *m_searchBar;
+    CaptureSearcher m_captureSearcher;   // 保留索引, 再次搜索同一捕获文件时只补建新增部分
+    QString m_countedQuery;              // 已统计过匹配数的查询, 连续查找时不重复统计
+    QHash<QString, quint64> m_reportedLogWriteErrors;   // 各串口已提示过的写日志失败次数
+    QHash<QString, quint64> m_reportedRotationFailures; // 各串口已提示过的分段改名失败次数
+    QCheckBox *m_logFileCheck;
+    QLabel *m_logFilePath;
+
     void initUI();                   // 初始化界面
     void initConnections();          // 连接信号槽
+    void startLogSession(SerialSession *session);
+    void startLogSessions();
+    void stopLogSessions();
+    void writeToLogFile(SerialSession *session, const QString &message);
+    // decoder 非空时文本经过该串口的流式UTF-8解码; 分帧时每帧独立解码
+    void displayReceived(SerialSession *session, qint64 timestampNs, const char *data, qsizetype size,
+                         Utf8StreamDecoder *decoder = nullptr);
+    DataRender::Mode displayMode() const;
+    QString portTag(SerialSession *session) const;
+    QString renderData(const QByteArray &data);
+    SerialSession *writableSession();
+    void dropMissingPort(const QString &portName);
+    void openLogFile(const QString &path);
+    void showSendStats(SerialSession *session, const SendStats &stats);
+    void onAlarm(SerialSession *session, const AlarmMatch &match);
 };
 #endif // MAINWINDOW_H
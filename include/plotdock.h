@@ -0,0 +1,51 @@
+#ifndef PLOTDOCK_H
+#define PLOTDOCK_H
+
+#include <QDockWidget>
+#include <QDoubleSpinBox>
+#include <QHash>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+
+#include "telemetryextractor.h"
+#include "telemetrystore.h"
+
+class SerialSession;
+class TelemetryPlot;
+
+// 遥测曲线面板: 可停靠/浮动
+// - 按提取格式从接收数据中取出数值, 每个 串口×字段 一个通道, 存入列式环形缓冲区
+// - 只有设置了提取格式时才处理数据, 未使用时接收路径没有额外开销
+class PlotDock : public QDockWidget
+{
+    Q_OBJECT
+public:
+    explicit PlotDock(QWidget *parent = nullptr);
+
+    bool isCollecting() const { return m_extractor.spec().isValid(); }
+    // 未分帧的接收数据, 以及分帧后的完整帧
+    void feed(SerialSession *session, qint64 timestampNs, const char *data, qsizetype size);
+    void feedFrame(SerialSession *session, qint64 timestampNs, const char *data, qsizetype size);
+
+private slots:
+    void onApplyClicked();
+    void onClearClicked();
+    void updateStatus();
+
+private:
+    int channelFor(SerialSession *session, int field);
+
+    TelemetryExtractor m_extractor;
+    TelemetryStore m_store;
+    QHash<quint32, int> m_channels;  // (端口号 << 16 | 字段序号) -> 通道
+    TelemetryPlot *m_plot;
+    QLineEdit *m_specEdit;
+    QPushButton *m_applyButton;
+    QDoubleSpinBox *m_windowBox;
+    QPushButton *m_pauseButton;
+    QPushButton *m_clearButton;
+    QLabel *m_statusLabel;
+};
+
+#endif // PLOTDOCK_H
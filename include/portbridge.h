@@ -0,0 +1,113 @@
+#ifndef PORTBRIDGE_H
+#define PORTBRIDGE_H
+
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+
+class QIODevice;
+class QLocalServer;
+class QTcpServer;
+class SerialSession;
+
+// 慢客户端(落后超过 maxLagBytes)的处理方式
+enum class BridgeDropPolicy {
+    DropOldest,      // 跳过积压的数据, 从最新的数据继续, 记入丢弃字节数
+    Disconnect,      // 断开该客户端
+};
+
+struct BridgeOptions
+{
+    BridgeDropPolicy policy = BridgeDropPolicy::DropOldest;
+    qint64 maxLagBytes = 1024 * 1024;    // 不超过共享缓冲区大小
+    qint64 clientTxLimit = 64 * 1024;    // 每个客户端待发往串口的上限, 满时暂停读取该客户端
+    int maxClients = 16;
+    bool readOnly = false;               // 丢弃客户端发来的数据
+
+    // "drop" / "disconnect"
+    static bool parsePolicy(const QString &name, BridgeDropPolicy *policy);
+};
+
+struct BridgeStats
+{
+    int clients = 0;
+    quint64 accepted = 0;        // 累计接受的连接数
+    quint64 rxBytes = 0;         // 从串口收到、进入共享缓冲区的字节数
+    quint64 rxDropped = 0;       // 所有客户端因落后而跳过的字节数之和
+    quint64 slowDisconnects = 0; // 因落后被断开的客户端数
+    quint64 txBytes = 0;         // 客户端发往串口的字节数
+    quint64 txDiscarded = 0;     // 只读时丢弃的客户端数据
+};
+
+// 串口桥接: 本程序独占串口, 通过本地 TCP 或 Unix 域套接字让多个客户端(测试脚本等)共用
+// - 接收: 串口数据写入一个共享环形缓冲区一次, 每个客户端只保存一个读位置;
+//   写入套接字时从共享缓冲区取数据, 套接字内部缓冲中另有每个客户端最多 kSocketWindow(64KB)
+//   的副本, 积压再多也留在共享缓冲区中, 客户端越多内存只按 64KB 增长
+// - 慢客户端: 落后超过 maxLagBytes 时按策略跳过积压或断开, 不会拖慢串口和其他客户端
+// - 发送: 每个客户端有自己的待发队列, 轮流每次取最多 kTxQuantum 字节交给串口;
+//   串口排队超过 kPortTxWindow 时暂停, 客户端队列满时不再读取其套接字, 由 TCP/本地套接字
+//   的窗口把背压传回对端
+// - 运行在界面线程(或无界面模式的主线程), 接收数据由 drain() 的回调经 onReceive() 送入
+// - 会话可以为空(如等待重连): 客户端保持连接, 发往串口的数据留在队列中, 重新设置会话后继续
+class PortBridge : public QObject
+{
+    Q_OBJECT
+public:
+    static constexpr qint64 kBufferSize = 4 * 1024 * 1024;   // 2的幂
+    static constexpr qint64 kSocketWindow = 64 * 1024;
+    static constexpr qint64 kTxQuantum = 4096;
+    static constexpr qint64 kPortTxWindow = 16 * 1024;
+
+    explicit PortBridge(const BridgeOptions &options = BridgeOptions(), QObject *parent = nullptr);
+    ~PortBridge();
+
+    // "tcp:端口" "tcp:地址:端口" 或 "unix:路径"; 只写端口时只监听 127.0.0.1
+    // 端口为0时由系统分配, 实际地址见 address()
+    bool listen(const QString &address, QString *errorString = nullptr);
+    void close();
+    bool isListening() const;
+    QString address() const;
+
+    void setSession(SerialSession *session);
+    SerialSession *session() const { return m_session; }
+
+    // 桥接会话收到的数据, 在 drain() 的回调中按顺序调用
+    void onReceive(const char *data, qsizetype size);
+
+    const BridgeOptions &options() const { return m_options; }
+    BridgeStats stats() const;
+
+signals:
+    void clientsChanged(int count);
+    void clientDropped(const QString &peer, const QString &reason);
+
+private:
+    struct Client
+    {
+        QIODevice *socket;
+        QString peer;
+        quint64 cursor;              // 在共享缓冲区中的绝对读位置
+        QByteArray txPending;        // 待发往串口
+    };
+
+    void onNewConnection(QIODevice *socket, const QString &peer);
+    void removeClient(Client *client, const QString &reason);
+    Client *findClient(QIODevice *socket) const;
+    void flushClient(Client *client);
+    void readClient(Client *client);
+    void pumpTransmit();
+
+    BridgeOptions m_options;
+    QTcpServer *m_tcpServer = nullptr;
+    QLocalServer *m_localServer = nullptr;
+    QPointer<SerialSession> m_session;
+    QByteArray m_buffer;             // 共享接收缓冲区, kBufferSize 字节
+    quint64 m_head = 0;              // 已写入的总字节数; 有效数据为 [m_head - kBufferSize, m_head)
+    QList<Client *> m_clients;
+    int m_nextTx = 0;                // 轮询发送的下一个客户端
+    BridgeStats m_stats;
+};
+
+#endif // PORTBRIDGE_H
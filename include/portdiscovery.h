@@ -0,0 +1,70 @@
+#ifndef PORTDISCOVERY_H
+#define PORTDISCOVERY_H
+
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+class QThread;
+
+// 一个串口设备的描述, 来自 QSerialPortInfo
+struct PortInfo
+{
+    QString portName;
+    QString systemLocation;
+    QString description;
+    QString manufacturer;
+    QString serialNumber;
+    quint16 vendorId = 0;
+    quint16 productId = 0;
+
+    // 是否为同一个USB适配器: 有序列号时按 VID/PID/序列号比较, 重新枚举后设备名变化也能识别
+    bool sameDevice(const PortInfo &other) const;
+    // 用作下拉框提示: 描述、厂商、VID:PID、序列号
+    QString summary() const;
+    bool operator==(const PortInfo &other) const;
+    bool operator!=(const PortInfo &other) const { return !(*this == other); }
+};
+
+// 后台串口发现服务
+// - 枚举(QSerialPortInfo::availablePorts)在独立线程中进行, 界面线程从不等待 udev/注册表查询
+// - Linux 上用 inotify 监视 /dev 中 tty* 设备节点的增删, 事件合并后重新枚举; 其他平台或监视失败时定时轮询
+// - 结果与上一次比较, 只通知新增和移除的串口; 同名但设备信息变化的串口按移除后新增处理
+class PortDiscovery : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PortDiscovery(QObject *parent = nullptr);
+    ~PortDiscovery();
+
+    // 开始监视并立即枚举一次
+    void start();
+    // 立即在后台重新枚举, 结果通过 portsChanged 通知
+    void rescan();
+
+    QList<PortInfo> ports() const { return m_ports; }
+    PortInfo port(const QString &portName) const;
+    bool hasScanned() const { return m_scanned; }
+    // true 表示由设备事件驱动, false 表示定时轮询
+    bool isEventDriven() const { return m_eventDriven; }
+
+    static constexpr int kPollIntervalMs = 2000;
+    static constexpr int kSettleMs = 250;       // 设备节点创建后等待 udev 设置权限和符号链接
+
+signals:
+    void portsChanged(const QList<PortInfo> &added, const QStringList &removed);
+
+private:
+    struct Watcher;
+    void apply(const QList<PortInfo> &ports);
+
+    QThread *m_thread;
+    QObject *m_context;              // 位于发现线程, 用于向该线程投递任务
+    Watcher *m_watcher = nullptr;    // 只在发现线程中访问
+    QList<PortInfo> m_ports;         // 界面线程中的缓存, 按端口名排序
+    bool m_scanned = false;
+    bool m_eventDriven = false;
+};
+
+#endif // PORTDISCOVERY_H
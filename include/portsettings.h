@@ -0,0 +1,34 @@
+#ifndef PORTSETTINGS_H
+#define PORTSETTINGS_H
+
+#include <QString>
+#include <QSerialPort>
+
+// 打开串口所需的全部参数, 由GUI线程组装后整体交给I/O线程
+// I/O线程在打开前一次性设置全部参数, 任何一项被驱动拒绝都视为打开失败, 不会留下半配置的串口
+struct PortSettings
+{
+    QString portName;
+    qint32 baudRate = 115200;        // 任意整数, Linux 下非标准值通过 BOTHER 设置
+    QSerialPort::DataBits dataBits = QSerialPort::Data8;
+    QSerialPort::Parity parity = QSerialPort::NoParity;
+    QSerialPort::StopBits stopBits = QSerialPort::OneStop;
+    QSerialPort::FlowControl flowControl = QSerialPort::NoFlowControl;
+    QIODevice::OpenMode openMode = QIODevice::ReadWrite;
+    qint64 readBufferSize = 0;       // QSerialPort 内部读缓冲上限(字节), 0 为不限
+    bool lowLatency = false;         // Linux: ASYNC_LOW_LATENCY, FTDI 适配器的 latency_timer 设为 1 ms
+
+    static constexpr qint32 kMinBaudRate = 50;
+    static constexpr qint32 kMaxBaudRate = 12000000;
+
+    bool validate(QString *errorString = nullptr) const;
+    // 每个字符在线路上占用的比特数: 起始位 + 数据位 + 校验位 + 停止位
+    double bitsPerCharacter() const;
+    qint64 lineRateBytesPerSec() const { return qint64(baudRate / bitsPerCharacter()); }
+
+    // 按串口名持久化, 下次选择同一串口时恢复; portName 和 openMode 不保存
+    void save() const;
+    static PortSettings load(const QString &portName, const PortSettings &defaults = PortSettings());
+};
+
+#endif // PORTSETTINGS_H
@@ -0,0 +1,45 @@
+#ifndef RECEIVEFORMATTER_H
+#define RECEIVEFORMATTER_H
+
+#include <QByteArray>
+
+#include "datarender.h"
+#include "timestampformatter.h"
+#include "utf8decoder.h"
+
+// 接收数据的行格式化, 界面和命令行模式共用
+// - 显示行: [hh:mm:ss.zzz] [端口] 接收: 文本      日志行: [yyyy-MM-dd hh:mm:ss] 接收: 文本\n
+// - 所有结果都写在内部复用的UTF-8缓冲中, 下一次 format() 前有效; 稳态下不分配内存
+// - 时间戳使用I/O线程读到数据的时刻, 而不是格式化时的当前时间
+// - 文本方式显示时经过串口自己的流式解码器, 跨块的多字节字符在后一块中完整输出
+class ReceiveFormatter
+{
+public:
+    ReceiveFormatter();
+
+    void setMode(DataRender::Mode mode) { m_mode = mode; }
+    void setTimestamps(bool enabled) { m_timestamps = enabled; }
+
+    // tag 为端口标记(如 "[COM3] "), 单串口时传空; decoder 为空时按整块独立处理(如完整的帧)
+    // 数据全部暂存在解码器中、没有可显示的内容时返回 false
+    bool format(qint64 timestampNs, const QByteArray &tag, const char *data, qsizetype n,
+                Utf8StreamDecoder *decoder = nullptr);
+
+    const QByteArray &displayLine() const { return m_display; }
+    const char *text() const { return m_display.constData() + m_textStart; }
+    qsizetype textSize() const { return m_display.size() - m_textStart; }
+    const QByteArray &logLine();
+
+private:
+    TimestampFormatter m_clock;
+    DataRender::Mode m_mode = DataRender::Mode::Filter;
+    bool m_timestamps = false;
+    qint64 m_timestampNs = 0;
+    QByteArray m_display;
+    QByteArray m_log;
+    QByteArray m_decoded;
+    int m_textStart = 0;
+    bool m_logValid = false;
+};
+
+#endif // RECEIVEFORMATTER_H
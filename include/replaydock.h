@@ -0,0 +1,46 @@
+#ifndef REPLAYDOCK_H
+#define REPLAYDOCK_H
+
+#include <QComboBox>
+#include <QDockWidget>
+#include <QLabel>
+#include <QPushButton>
+#include <QSlider>
+
+#include "capturereplayer.h"
+
+class SessionManager;
+
+// 捕获回放面板: 可停靠/浮动
+// 选择原始捕获文件后按原速、倍速或尽快回放, 数据与真实串口一样经过分帧、显示、曲线和日志
+// 尽快模式结束时显示的速率即整条接收路径的吞吐
+class ReplayDock : public QDockWidget
+{
+    Q_OBJECT
+public:
+    explicit ReplayDock(SessionManager *sessions, QWidget *parent = nullptr);
+
+private slots:
+    void onOpenClicked();
+    void onSpeedChanged();
+    void onSliderReleased();
+    void onProgress(const ReplayStats &stats);
+    void onFinished(const ReplayStats &stats);
+
+private:
+    double speed() const;
+    void updateControls();
+    QString formatStats(const ReplayStats &stats) const;
+
+    SessionManager *m_sessions;
+    QLabel *m_fileLabel;
+    QPushButton *m_openButton;
+    QPushButton *m_pauseButton;
+    QPushButton *m_stopButton;
+    QComboBox *m_speedBox;
+    QSlider *m_positionSlider;
+    QLabel *m_positionLabel;
+    QLabel *m_statusLabel;
+};
+
+#endif // REPLAYDOCK_H
@@ -0,0 +1,101 @@
+#ifndef SCROLLBACKMODEL_H
+#define SCROLLBACKMODEL_H
+
+#include <QAbstractListModel>
+#include <QSortFilterProxyModel>
+#include <QString>
+#include <QVector>
+#include <deque>
+#include <vector>
+
+#include "bigramfilter.h"
+#include "searchquery.h"
+
+// 有界回滚缓冲区模型: 行按固定大小的块存储, 超过行数或内存上限时整块丢弃最旧的数据
+// - 除最后一块外每块都是满的, 因此第 row 行位于 row / kBlockLines 块, 定位为 O(1)
+// - 块内各行以UTF-8连续存放在一个字节数组中, 另记每行的结束偏移; 只有绘制可见行时才转换为 QString
+// - 丢弃的块放入备用列表复用, 稳定运行后追加数据不再分配内存
+// - 内存占用不超过上限加一个块, 与会话时长无关
+// - 每块维护一个二元组位图, 随追加增量更新, 搜索时整块跳过不可能匹配的行
+class ScrollbackModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    static constexpr int kBlockLines = 1024;
+
+    explicit ScrollbackModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    // 追加以 '\n' 分隔的UTF-8文本, 末尾不带 '\n'; 每段(包括空段)是一行
+    void appendText(const char *utf8, qsizetype size);
+    void setLimits(int maxLines, qint64 maxBytes);
+    void clear();
+
+    QString lineAt(int row) const;
+    qint64 byteSize() const { return m_bytes; }
+    quint64 droppedLines() const { return m_droppedLines; }
+    // 自创建以来追加的总行数, 即下一行的绝对行号; 绝对行号 = 已丢弃行数 + 行号
+    quint64 appendedLines() const { return m_droppedLines + quint64(m_lineCount); }
+
+    // 把绝对行号 [first, last] 标记为报警行, 以背景色显示; 可以标记尚未追加的行
+    // 标记按行号递增, 最多保留 kMaxMarkedLines 条, 随旧行一起丢弃
+    void markLines(quint64 first, quint64 last);
+    bool isMarked(int row) const;
+    static constexpr int kMaxMarkedLines = 65536;
+
+    // 从 fromRow(含)开始向后/向前查找第一条匹配行, 不回绕, 没有时返回 -1
+    int findRow(const SearchQuery &query, int fromRow, bool forward) const;
+    // 统计匹配行数; scannedBlocks 返回实际逐行检查的块数
+    int countMatches(const SearchQuery &query, int *scannedBlocks = nullptr) const;
+    bool blockMayMatch(int row, const SearchQuery &query) const;
+    bool lineMatches(int row, const SearchQuery &query) const;
+
+private:
+    struct Block
+    {
+        QByteArray text;
+        QVector<int> ends;
+        qint64 bytes = 0;
+        BigramFilter filter;
+
+        int lineCount() const { return ends.size(); }
+        int lineStart(int i) const { return i == 0 ? 0 : ends.at(i - 1); }
+    };
+
+    static bool blockMayMatch(const Block &block, const SearchQuery &query);
+    static bool lineMatches(const Block &block, int i, const SearchQuery &query);
+
+    Block &writableBlock();
+    void trim();
+
+    std::deque<Block> m_blocks;
+    std::vector<Block> m_spare;
+    int m_lineCount = 0;
+    qint64 m_bytes = 0;
+    int m_maxLines = 100000;
+    qint64 m_maxBytes = 64 * 1024 * 1024;
+    quint64 m_droppedLines = 0;
+    std::deque<quint64> m_marked;    // 递增的绝对行号
+};
+
+// "仅显示匹配行"的过滤模型: 新追加的行由 QSortFilterProxyModel 增量过滤, 不会重新过滤全部历史
+class ScrollbackFilterModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+public:
+    explicit ScrollbackFilterModel(ScrollbackModel *source, QObject *parent = nullptr);
+
+    void setQuery(const SearchQuery &query);
+    const SearchQuery &query() const { return m_query; }
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private:
+    ScrollbackModel *m_source;
+    SearchQuery m_query;
+};
+
+#endif // SCROLLBACKMODEL_H
@@ -0,0 +1,77 @@
+#ifndef SCROLLBACKVIEW_H
+#define SCROLLBACKVIEW_H
+
+#include <QByteArray>
+#include <QListView>
+#include <QTimer>
+#include <QVector>
+
+#include "searchquery.h"
+
+class LatencyHistogram;
+class ScrollbackFilterModel;
+class ScrollbackModel;
+
+// 接收区/发送历史的显示控件: 基于 ScrollbackModel 的虚拟化列表, 只绘制可见行
+// - 先缓存收到的数据块, 按固定帧率(默认30Hz)一次性插入模型
+// - 每次刷新只做一次批量插入和一次滚动, 避免高速设备下每个数据块都触发一次重新排版
+// - 只有存在待显示数据时定时器才运行, 空闲时不占用CPU
+// - 待显示数据以UTF-8缓存在预留容量的缓冲区中, 刷新后清空但保留容量
+class ScrollbackView : public QListView
+{
+    Q_OBJECT
+public:
+    explicit ScrollbackView(QWidget *parent = nullptr);
+
+    // 追加一个数据块(可能包含多行); sourceNs 为数据在I/O线程读到的单调时间, 用于统计显示延迟
+    void appendChunk(const QString &text, qint64 sourceNs = 0);
+    // 同上, 数据已是UTF-8, 接收路径使用此重载以免转换
+    void appendUtf8(const char *text, qsizetype size, qint64 sourceNs = 0);
+    void setMaxFlushRate(int hz);            // 每秒最多刷新次数
+    void setLimits(int maxLines, qint64 maxBytes);
+    void clear();
+    // 每次刷新后记录各数据块从读取到显示的延迟
+    void setLatencyHistogram(LatencyHistogram *histogram) { m_latency = histogram; }
+
+    // 查找下一条/上一条匹配行并选中, 到末尾时回绕; 过滤开启时只在显示的行中查找
+    bool findNext(const SearchQuery &query, bool forward);
+    // 仅显示匹配行; 空查询恢复显示全部
+    void setFilter(const SearchQuery &query);
+    bool isFiltering() const { return model() != m_model; }
+
+    // 下一行(含待刷新的行)的绝对行号; 只统计上次调用之后新增的待刷新数据
+    quint64 nextLine();
+    // 以背景色标记绝对行号 [first, last], 可以是尚未刷新的行
+    void markLines(quint64 first, quint64 last);
+
+    ScrollbackModel *scrollbackModel() const { return m_model; }
+    quint64 chunkCount() const { return m_chunkCount; }
+    quint64 flushCount() const { return m_flushCount; }
+    // 被合并进其他数据块一起刷新的块数(已刷新块数 - 刷新次数), 用于确认批量刷新生效
+    quint64 coalescedChunks() const { return m_flushedChunks - m_flushCount; }
+
+signals:
+    void flushed(int chunks);
+
+protected:
+    void keyPressEvent(QKeyEvent *event) override;
+
+private slots:
+    void flush();
+
+private:
+    ScrollbackModel *m_model;
+    ScrollbackFilterModel *m_filter;
+    QTimer *m_flushTimer;
+    QByteArray m_pending;
+    int m_pendingChunks = 0;
+    int m_countedBytes = 0;           // m_pending 中已统计换行的字节数
+    int m_countedLines = 0;           // 其中的换行数
+    QVector<qint64> m_pendingSources;
+    LatencyHistogram *m_latency = nullptr;
+    quint64 m_chunkCount = 0;
+    quint64 m_flushCount = 0;
+    quint64 m_flushedChunks = 0;
+};
+
+#endif // SCROLLBACKVIEW_H
@@ -0,0 +1,51 @@
+#ifndef SEARCHBAR_H
+#define SEARCHBAR_H
+
+#include <QCheckBox>
+#include <QComboBox>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QTimer>
+#include <QWidget>
+
+#include "searchquery.h"
+
+// 接收区下方的搜索/过滤栏
+// - 回车或"下一个"查找, Shift+回车或"上一个"反向查找
+// - 勾选"仅显示匹配"后, 修改查询条件会在短暂停顿后重新过滤
+class SearchBar : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit SearchBar(QWidget *parent = nullptr);
+
+    // 当前查询; 输入无效时返回空查询并给出错误信息
+    SearchQuery query(QString *errorString = nullptr) const;
+    bool filterEnabled() const { return m_filterCheck->isChecked(); }
+    void setResultText(const QString &text) { m_resultLabel->setText(text); }
+    void focusSearch();
+
+signals:
+    void findRequested(bool forward);
+    void filterChanged();
+    void captureSearchRequested();
+    void logSearchRequested();
+
+protected:
+    void keyPressEvent(QKeyEvent *event) override;
+
+private:
+    QComboBox *m_kindBox;
+    QLineEdit *m_patternEdit;
+    QCheckBox *m_caseCheck;
+    QPushButton *m_prevButton;
+    QPushButton *m_nextButton;
+    QCheckBox *m_filterCheck;
+    QPushButton *m_captureButton;
+    QPushButton *m_logButton;
+    QLabel *m_resultLabel;
+    QTimer *m_filterDelay;   // 输入停顿后才重新过滤, 避免每个按键都过滤一遍历史
+};
+
+#endif // SEARCHBAR_H
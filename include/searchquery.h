@@ -0,0 +1,36 @@
+#ifndef SEARCHQUERY_H
+#define SEARCHQUERY_H
+
+#include <QByteArray>
+#include <QList>
+#include <QRegularExpression>
+#include <QString>
+
+// 搜索条件: 文本、十六进制字节或正则表达式
+// - 显示行以UTF-8存储, 在其中查找时使用 lineNeedles/regex: 十六进制查询同时匹配十六进制显示("AA 55")和原文
+// - 在捕获文件的原始字节中查找时使用 bytes/regex
+// - 文本查询可以用二元组位图预过滤, 正则查询只能逐行(逐条记录)检查
+// - 不区分大小写时只折叠ASCII字母
+struct SearchQuery
+{
+    enum class Kind { Text, Hex, Regex };
+
+    Kind kind = Kind::Text;
+    QString pattern;                 // 用户输入的原文
+    bool caseSensitive = false;
+    QByteArray bytes;                // 文本为UTF-8, 十六进制为解码后的字节
+    QList<QByteArray> lineNeedles;
+    QRegularExpression regex;
+
+    bool isEmpty() const { return pattern.isEmpty(); }
+    bool isLiteral() const { return kind != Kind::Regex; }
+
+    static SearchQuery parse(Kind kind, const QString &pattern, bool caseSensitive,
+                             QString *errorString = nullptr);
+
+    bool matchesLine(const char *line, qsizetype n) const;
+    // 在原始字节中查找, 返回匹配起始位置, 没有时返回 -1
+    qsizetype indexIn(const char *data, qsizetype n) const;
+};
+
+#endif // SEARCHQUERY_H
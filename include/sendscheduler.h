@@ -0,0 +1,115 @@
+#ifndef SENDSCHEDULER_H
+#define SENDSCHEDULER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QFile>
+#include <QMetaType>
+#include <QVector>
+
+class QSocketNotifier;
+class QTimer;
+class SerialWorker;
+
+// 一条定时发送条目: 发送 payload, 然后等待 intervalNs 再发送下一条
+struct SendEntry
+{
+    QByteArray payload;
+    qint64 intervalNs = 0;
+};
+
+// 发送计划: 按序列循环发送, 或以线路最大速率流式发送文件
+// 脚本格式(每行一条, # 开头为注释):
+//   <间隔ms> hex <十六进制字节>     例: 1.5 hex AA 55 01 02
+//   <间隔ms> text <文本>            例: 10 text STATUS?\r\n  (支持 \r \n \t \\ 转义)
+//   loop <次数>                     0 表示无限循环, 默认 1
+struct SendPlan
+{
+    QVector<SendEntry> entries;
+    int loops = 1;                  // 0 = 无限循环
+    QString filePath;               // 非空时为文件流模式, 忽略 entries
+    int fileChunkSize = 4096;
+    qint64 lineRateBytesPerSec = 0; // 文件流模式下的期望速率(波特率/10), 用于统计
+
+    bool isFileStream() const { return !filePath.isEmpty(); }
+    static SendPlan periodic(const QByteArray &payload, qint64 intervalNs, int loops = 0);
+    static SendPlan parseScript(const QString &script, QString *errorString = nullptr);
+};
+
+// 发送统计: 期望/实际速率与相对计划时刻的抖动
+struct SendStats
+{
+    quint64 sent = 0;               // 已发送条目(文件模式为数据块)
+    quint64 bytes = 0;
+    double elapsedSec = 0;
+    double requestedRate = 0;       // 条目/秒; 文件模式为 字节/秒
+    double achievedRate = 0;
+    double jitterMeanUs = 0;        // |实际 - 计划| 的平均值
+    double jitterMaxUs = 0;
+    quint64 backpressureStalls = 0; // 到点时写队列已满而推迟发送的次数
+    bool fileStream = false;        // 速率单位为字节/秒
+    bool finished = false;
+};
+Q_DECLARE_METATYPE(SendStats)
+
+// 定时发送调度器, 运行在串口I/O线程中, 属于 SerialWorker
+// - Linux 上使用 timerfd(CLOCK_MONOTONIC, 绝对时刻)挂在I/O线程的事件循环上, 精度为微秒级;
+//   其他平台退回 Qt::PreciseTimer(毫秒级)
+// - 计划时刻按绝对时间累加, 单次延迟不会累积成漂移
+// - 写队列积压超过阈值时暂停, 等 bytesWritten 后继续, 不会无限堆积
+class SendScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SendScheduler(SerialWorker *worker);
+    ~SendScheduler();
+
+    bool isRunning() const { return m_running; }
+
+public slots:
+    void start(const SendPlan &plan);
+    void stop();
+
+signals:
+    void statsUpdated(const SendStats &stats);
+    void finished(const SendStats &stats);
+
+private slots:
+    void onTimer();
+    void onDrained();
+
+private:
+    void armTimer(qint64 deadlineNs);
+    void disarmTimer();
+    void sendDue();
+    void pumpFile();
+    void halt();
+    void finish();
+    SendStats currentStats() const;
+
+    static constexpr qint64 kMaxOutstanding = 16 * 1024;   // 写队列积压上限
+
+    SerialWorker *m_worker;
+    SendPlan m_plan;
+    bool m_running = false;
+    bool m_waitingForDrain = false;
+    int m_index = 0;
+    int m_loop = 0;
+    qint64 m_startNs = 0;
+    qint64 m_deadlineNs = 0;
+    QFile m_file;
+    QByteArray m_fileChunk;
+
+    quint64 m_sent = 0;
+    quint64 m_bytes = 0;
+    quint64 m_stalls = 0;
+    double m_jitterSumUs = 0;
+    double m_jitterMaxUs = 0;
+
+    int m_timerFd = -1;
+    QSocketNotifier *m_notifier = nullptr;
+    QTimer *m_timer = nullptr;
+    QTimer *m_statsTimer;
+};
+
+#endif // SENDSCHEDULER_H
@@ -0,0 +1,96 @@
+#ifndef SERIALSESSION_H
+#define SERIALSESSION_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QVector>
+
+#include "frameparser.h"
+#include "logwriter.h"
+#include "portsettings.h"
+#include "sendscheduler.h"
+#include "transactiontracker.h"
+#include "utf8decoder.h"
+
+class SerialWorker;
+
+// 一个已打开(或正在打开)的串口会话, 在GUI线程中使用
+// - SerialWorker 运行在 SessionManager 的共享I/O线程中, 本对象只是它的句柄
+// - 每个会话有自己的接收环形缓冲区(在工作对象中)、分帧状态、UTF-8解码状态和日志
+class SerialSession : public QObject
+{
+    Q_OBJECT
+public:
+    SerialSession(quint8 portId, const PortSettings &settings, QObject *parent = nullptr);
+    ~SerialSession();
+
+    quint8 portId() const { return m_portId; }
+    QString portName() const { return m_settings.portName; }
+    // 多串口时显示在每行前的端口标记 "[COM3] ", UTF-8, 创建时生成一次
+    const QByteArray &portTag() const { return m_portTag; }
+    const PortSettings &settings() const { return m_settings; }
+    bool isOpen() const { return m_open; }
+    bool canWrite() const { return m_open && m_settings.openMode != QIODevice::ReadOnly; }
+    // 是否由 close() 主动关闭; 否则是设备拔出等错误导致的关闭
+    bool closeRequested() const { return m_closeRequested; }
+    // 捕获回放会话: 没有真实串口, 只读
+    bool isReplay() const { return m_replay; }
+
+    SerialWorker *worker() const { return m_worker; }
+    FrameParser &frameParser() { return m_frameParser; }
+    Utf8StreamDecoder &textDecoder() { return m_textDecoder; }
+    LogWriter &logWriter() { return m_logWriter; }
+    // 命令/响应跟踪: 发送记录在 stage() 中取出, 接收的帧由显示端交给 onReceive()
+    TransactionTracker &transactions() { return m_transactions; }
+    void setTransactionRule(const TransactionRule &rule);
+
+    void write(const QByteArray &data);
+    // write() 之后尚未交给驱动的字节数
+    qint64 queuedBytes() const;
+    void close();
+    // 定时/脚本/文件发送在I/O线程中调度, 同一时刻只有一个计划在运行
+    void startSchedule(const SendPlan &plan);
+    void stopSchedule();
+    bool isScheduleRunning() const { return m_scheduleRunning; }
+
+signals:
+    void opened(bool ok, const QString &errorString);
+    void closed();
+    void errorOccurred(const QString &errorString);
+    void scheduleStats(const SendStats &stats);
+    void scheduleFinished(const SendStats &stats);
+
+private:
+    friend class SessionManager;
+
+    struct StagedChunk
+    {
+        qint64 timestampNs;
+        int offset;                  // 在 m_arena 中的位置
+        int length;
+    };
+    // 取出环形缓冲区中的全部记录, 负载连续复制到复用的 m_arena 中, 稳态下不分配内存
+    // 供 SessionManager 按时间合并; 数据在下一次 stage() 前有效
+    // 启用事务跟踪时, 先取出发送记录并处理上一批之前的超时
+    void stage();
+    void stageTransmits();
+
+    quint8 m_portId;
+    PortSettings m_settings;
+    QByteArray m_portTag;
+    SerialWorker *m_worker;
+    bool m_open = false;
+    bool m_closeRequested = false;
+    bool m_replay = false;
+    bool m_scheduleRunning = false;
+    FrameParser m_frameParser;
+    Utf8StreamDecoder m_textDecoder;
+    LogWriter m_logWriter;
+    TransactionTracker m_transactions;
+    qint64 m_lastStageNs = 0;
+    QVector<StagedChunk> m_staged;
+    QByteArray m_arena;
+    int m_stagedPos = 0;
+};
+
+#endif // SERIALSESSION_H
@@ -0,0 +1,136 @@
+#ifndef SERIALWORKER_H
+#define SERIALWORKER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QQueue>
+#include <QSerialPort>
+#include <QTimer>
+#include <atomic>
+
+#include "capturefile.h"
+#include "portsettings.h"
+#include "sendscheduler.h"
+#include "spscringbuffer.h"
+
+class TriggerCapture;
+
+// 环形缓冲区中每条接收记录的头部, 紧跟 length 字节的原始数据
+struct ChunkHeader
+{
+    qint64 timestampNs;  // 单调时钟, I/O线程读到数据的时刻
+    quint32 length;
+};
+
+// 线路错误计数(自打开串口起)
+// 溢出/校验/帧错误/break 来自驱动的中断计数(Linux TIOCGICOUNT, 驱动不支持时为0)
+struct LineErrorCounts
+{
+    quint64 overrun = 0;         // UART 硬件FIFO溢出
+    quint64 bufferOverrun = 0;   // 驱动 tty 缓冲区溢出
+    quint64 parity = 0;
+    quint64 framing = 0;
+    quint64 breaks = 0;
+    quint64 portErrors = 0;      // QSerialPort::errorOccurred 报告的错误次数
+
+    quint64 total() const { return overrun + bufferOverrun + parity + framing + breaks + portErrors; }
+};
+
+// 串口读写工作对象: 运行在独立的 QThread 中, 拥有 QSerialPort
+// - 读: readyRead 时直接读入无锁环形缓冲区, GUI线程用定时器拉取
+// - 写: GUI线程投递的数据在这里排队串行写出, 慢速串口不会阻塞界面
+// - 捕获: 收发的原始字节在这里带单调时钟时间戳写入二进制捕获文件
+// 除 ring()/ringStalls() 外, 所有方法都只能在I/O线程中调用(通过 QMetaObject::invokeMethod 投递)
+class SerialWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SerialWorker(quint8 portId = 0, size_t ringCapacity = 4 * 1024 * 1024, QObject *parent = nullptr);
+    ~SerialWorker();
+
+    SpscRingBuffer &ring() { return m_ring; }
+    // 发送记录: 启用后每次交给驱动的数据以 [ChunkHeader][前 kMaxTxTapBytes 字节] 写入 txRing(),
+    // 供事务跟踪取得与接收同一时钟的发送时间; 可在任意线程开关
+    SpscRingBuffer &txRing() { return m_txRing; }
+    void setTransmitTap(bool enabled) { m_txTap.store(enabled, std::memory_order_relaxed); }
+    quint64 txTapDrops() const { return m_txTapDrops.load(std::memory_order_relaxed); }
+    static constexpr qint64 kMaxTxTapBytes = 256;
+    quint8 portId() const { return m_portId; }
+    // 多个工作对象共享同一个I/O线程时也共享同一个捕获文件, 只能在I/O线程中设置
+    void setCapture(CaptureWriter *capture) { m_capture = capture; }
+    // 触发捕获同样由所有工作对象共享; 串口错误和线路错误计数增加时在这里触发
+    void setTriggerCapture(TriggerCapture *trigger) { m_trigger = trigger; }
+    quint64 ringStalls() const { return m_ringStalls.load(std::memory_order_relaxed); }
+    // 以下计数可在任意线程读取
+    quint64 rxBytes() const { return m_rxBytes.load(std::memory_order_relaxed); }
+    quint64 txBytes() const { return m_txBytes.load(std::memory_order_relaxed); }
+    LineErrorCounts lineErrors() const;
+    // 已排队和已交给驱动但尚未写完的字节数, 只能在I/O线程中调用
+    qint64 outstandingBytes() const;
+    // 从其他线程投递写入, 数据在I/O线程中排队写出
+    void post(const QByteArray &data);
+    // 已投递或排队、尚未交给驱动的字节数, 可在任意线程读取, 供发送方做流量控制
+    qint64 queuedBytes() const { return m_queuedBytes.load(std::memory_order_relaxed); }
+    SendScheduler *scheduler() const { return m_scheduler; }
+    // 回放模式下由 CaptureReplayer 写入一条接收记录, 超过单条上限时拆分
+    // 返回写入的字节数, 环形缓冲区满时小于 size; 只能在I/O线程中调用
+    qint64 injectReceived(qint64 timestampNs, const char *data, qint64 size);
+
+    static qint64 monotonicNs();
+
+public slots:
+    void openPort(const PortSettings &settings);
+    // 不打开串口, 作为捕获回放的接收端; 之后的关闭和通知与真实串口相同
+    void openReplay();
+    void closePort();
+    void writeData(const QByteArray &data);
+
+signals:
+    void portOpened(bool ok, const QString &errorString);
+    void portClosed();
+    void dataWritten(qint64 bytes);
+    void errorOccurred(const QString &errorString);
+
+private slots:
+    void onReadyRead();
+    void onBytesWritten(qint64 bytes);
+    void onError(QSerialPort::SerialPortError error);
+    void pollLineCounters();
+
+private:
+    void flushPending();
+    void clearPending();
+    bool applyLowLatency(QString *errorString);
+    void tapTransmit(qint64 timestampNs, const QByteArray &data);
+
+    static constexpr qint64 kMaxChunkSize = 64 * 1024;       // 单条记录最大负载
+    static constexpr qint64 kMaxBytesInFlight = 64 * 1024;   // 交给驱动但尚未写完的上限
+
+    QSerialPort *m_serial = nullptr;
+    QTimer *m_retryTimer = nullptr;   // 环形缓冲区满时稍后重试读取
+    SpscRingBuffer m_ring;
+    SpscRingBuffer m_txRing;
+    std::atomic<bool> m_txTap{false};
+    std::atomic<quint64> m_txTapDrops{0};  // 发送记录缓冲区满而丢弃的记录数
+    QByteArray m_scratch;             // [ChunkHeader][payload], 避免每次读取都分配内存
+    QQueue<QByteArray> m_pendingWrites;
+    qint64 m_pendingBytes = 0;        // m_pendingWrites 中的字节总数
+    std::atomic<qint64> m_queuedBytes{0};  // 投递途中的字节 + m_pendingBytes
+    SendScheduler *m_scheduler;
+    CaptureWriter *m_capture = nullptr;
+    TriggerCapture *m_trigger = nullptr;
+    quint8 m_portId;
+    bool m_replaying = false;
+    std::atomic<quint64> m_ringStalls{0};  // 因环形缓冲区满而推迟读取的次数
+    std::atomic<quint64> m_rxBytes{0};
+    std::atomic<quint64> m_txBytes{0};     // 已交给驱动的字节数
+
+    // 驱动计数是累计值, 打开时记下基准; 各计数由I/O线程写入, 其他线程读取
+    enum LineCounter { Overrun, BufferOverrun, Parity, Framing, Break, PortError, LineCounterCount };
+    QTimer *m_counterTimer = nullptr;
+    quint64 m_counterBase[LineCounterCount] = {};
+    bool m_counterBaseReady = false;   // 打开时的第一次读取只作为基准, 不算作计数增加
+    std::atomic<quint64> m_lineCounters[LineCounterCount] = {};
+};
+
+#endif // SERIALWORKER_H
@@ -0,0 +1,143 @@
+#ifndef SESSIONMANAGER_H
+#define SESSIONMANAGER_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QThread>
+#include <functional>
+
+#include "capturereplayer.h"
+#include "portdiscovery.h"
+#include "portsettings.h"
+#include "triggercapture.h"
+
+class CaptureWriter;
+class SerialSession;
+
+// 多串口会话管理
+// - 所有串口的工作对象共用一个I/O线程: Qt事件循环在Linux上基于epoll, 没有数据的串口不消耗CPU
+// - drain() 取出所有会话已接收的数据, 按I/O线程的单调时间戳合并成一条时间有序的流
+// - 原始捕获由所有会话共享, 记录中带端口号, 捕获对象只在I/O线程中使用
+// - 自动重连: 不是由 closeSession() 关闭的会话(如USB适配器拔出)会被记住, 串口发现服务报告
+//   同一适配器重新出现后按原设置重新打开; 重新枚举后设备名变化时按序列号匹配
+// - 捕获回放: 捕获中每个有接收数据的端口对应一个只读的回放会话, 数据经由与真实串口相同的
+//   环形缓冲区和 drain() 进入接收路径; 同一时刻只有一个回放
+// - 触发捕获: 与原始捕获一样由所有串口共享, 平时只写内存环, 触发时才写盘; 回放数据不进入内存环
+class SessionManager : public QObject
+{
+    Q_OBJECT
+public:
+    // data 指向会话的暂存区, 只在回调期间有效, 需要保留时由调用方复制
+    using ChunkHandler = std::function<void(SerialSession *session, qint64 timestampNs, const char *data, qsizetype size)>;
+
+    explicit SessionManager(QObject *parent = nullptr);
+    ~SessionManager();
+
+    // 异步打开, 结果通过 sessionOpened/sessionFailed 通知; 同名串口已打开时返回已有会话
+    SerialSession *openSession(const PortSettings &settings);
+    void closeSession(SerialSession *session);
+    void closeAll();
+
+    SerialSession *session(const QString &portName) const;
+    SerialSession *session(quint8 portId) const;
+    QList<SerialSession *> sessions() const { return m_sessions; }
+    int openCount() const;
+
+    void drain(const ChunkHandler &handler);
+
+    void setCapturePath(const QString &path) { m_capturePath = path; }
+    // 写盘队列满时未写入捕获文件的记录数, 任意线程可读
+    quint64 captureDroppedRecords() const;
+
+    // 在I/O线程中一次分配内存环并开始记录, 再次调用时按新配置重新分配, 已缓冲的数据丢弃
+    void enableTriggerCapture(const TriggerSpec &spec, const QString &directory);
+    void disableTriggerCapture();
+    bool isTriggerCaptureEnabled() const { return m_triggerEnabled; }
+    // 可在GUI线程中调用, 例如帧校验失败或手动触发; timestampNs 为事件时刻, 0 表示现在
+    void fireTrigger(TriggerReason reason, quint8 portId = 0, qint64 timestampNs = 0);
+    // 只用于读取统计计数
+    const TriggerCapture *triggerCapture() const { return m_trigger; }
+
+    // discovery 为空时关闭自动重连
+    void setAutoReconnect(PortDiscovery *discovery);
+    bool isAwaitingReconnect(const QString &portName) const { return m_lost.contains(portName); }
+    void cancelReconnect(const QString &portName);
+
+    static constexpr int kReconnectAttempts = 5;
+    static constexpr int kReconnectDelayMs = 500;   // 节点出现后 udev 可能尚未设置权限, 失败时稍后重试
+
+    // 回放原始捕获, speed 为倍速, 0 表示尽快; 回放会话照常通过 sessionOpened 通知,
+    // 全部打开后才开始送数据. 回放结束或 stopReplay() 后会话关闭, 然后发出 replayFinished
+    bool openReplay(const QString &path, double speed, QString *errorString = nullptr);
+    bool isReplaying() const { return m_replayer != nullptr; }
+    void setReplaySpeed(double speed);
+    void setReplayPaused(bool paused);
+    // timestampNs 为捕获中的时刻, 在 replayFirstNs() 与 replayLastNs() 之间
+    void seekReplay(qint64 timestampNs);
+    void stopReplay();
+    qint64 replayFirstNs() const { return m_replayFirstNs; }
+    qint64 replayLastNs() const { return m_replayLastNs; }
+
+    // 同一个文件路径按端口名区分: log.txt -> log_COM3.txt
+    static QString perPortPath(const QString &path, const QString &portName);
+
+signals:
+    void sessionOpened(SerialSession *session);
+    void sessionFailed(SerialSession *session, const QString &errorString);
+    void sessionClosed(SerialSession *session);
+    void sessionError(SerialSession *session, const QString &errorString);
+    void captureFailed(const QString &errorString);
+    // 触发捕获开始写出一个窗口; 窗口内的再次触发不通知
+    void triggerFired(TriggerReason reason, quint8 portId, const QString &path);
+    void triggerSaved(const QString &path, qint64 bytes);
+    // 正在按原设置重新打开已断开的串口, 结果仍通过 sessionOpened 通知; previousName 为断开前的端口名
+    void reconnecting(SerialSession *session, const QString &previousName);
+    void replayProgress(const ReplayStats &stats);
+    // elapsedNs 包含最后一批数据被取走并处理的时间, 尽快模式下即整条接收路径的吞吐
+    void replayFinished(const ReplayStats &stats);
+
+private:
+    void onSessionOpened(SerialSession *session, bool ok, const QString &errorString);
+    void onSessionClosed(SerialSession *session);
+    void addSession(SerialSession *session);
+    void removeSession(SerialSession *session);
+    int liveOpenCount() const;
+    void onReplayStopped(const ReplayStats &stats);
+    void finishReplayIfDone();
+    void startCapture();
+    void stopCapture();
+    quint8 nextPortId() const;
+
+    struct LostPort
+    {
+        PortSettings settings;
+        PortInfo device;             // 断开前的设备信息, 未知时 portName 为空
+        int attempts = 0;
+    };
+    static bool matchesLost(const LostPort &lost, const PortInfo &port);
+    void onPortsChanged(const QList<PortInfo> &added);
+    void reconnect(const QString &lostName, const QString &portName);
+    void retryReconnect(const QString &lostName);
+
+    QThread *m_ioThread;
+    QObject *m_ioContext;            // 位于I/O线程, 用于向该线程投递任务
+    CaptureWriter *m_capture;        // 只在I/O线程中访问
+    QString m_capturePath;
+    TriggerCapture *m_trigger;       // 位于I/O线程
+    bool m_triggerEnabled = false;
+    QList<SerialSession *> m_sessions;
+    PortDiscovery *m_discovery = nullptr;
+    QHash<QString, LostPort> m_lost;                // 按断开前的端口名
+    QHash<SerialSession *, LostPort> m_reconnects;  // 正在重新打开的会话
+
+    CaptureReplayer *m_replayer = nullptr;          // 位于I/O线程
+    QList<SerialSession *> m_replaySessions;
+    double m_replaySpeed = 1.0;
+    bool m_replayStarted = false;
+    ReplayStats m_replayStats;
+    qint64 m_replayFirstNs = 0;
+    qint64 m_replayLastNs = 0;
+};
+
+#endif // SESSIONMANAGER_H
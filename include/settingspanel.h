@@ -12,10 +12,14 @@
 #include <QLabel>
 #include <QCheckbox>
 #include <QLineEdit>
+#include <QSpinBox>
 #include <QPushButton>
 #include <QFileDialog>
 #include <QStandardPaths>
 
+#include "logarchive.h"
+#include "portsettings.h"
+
 class SettingsPanel : public QWidget
 {
     Q_OBJECT
@@ -29,25 +33,47 @@ public:
     QSerialPort::DataBits getdataBits() const;
     QSerialPort::Parity getparity() const;
     QSerialPort::StopBits getstopBits() const;
+    QSerialPort::FlowControl getflowControl() const;
+    PortSettings portSettings(const QString &portName) const;
+    void setPortSettings(const PortSettings &settings);
     bool showControlCharacters() const;
     bool showTimeStamps() const;
     QString logFilePath() const;
+    QString captureFilePath() const;
+    QString frameSpec() const;
+    QString triggerSpec() const;
+    QString alarmRulesPath() const;
+    // 触发捕获文件与原始捕获放在同一目录, 未设置捕获文件时放在文档目录
+    QString triggerDirectory() const;
     bool isAppendMode() const;
+    LogRotation logRotation() const;
+    int scrollbackMaxLines() const;
+    qint64 scrollbackMaxBytes() const;
 
 protected:
     void resizeEvent(QResizeEvent *event) override;
 
 signals:
     void logFileChanged(const QString &path);
+    void scrollbackLimitsChanged(int maxLines, qint64 maxBytes);
+    void frameSpecChanged(const QString &spec);
+    void triggerSpecChanged(const QString &spec);
+    void alarmRulesChanged(const QString &path);   // 路径改变时发出; 用按钮选择文件时总是发出, 同一文件也重新加载
 
 private slots:
     void browseLogFile();
+    void browseCaptureFile();
+    void browseAlarmRules();
 
 private:
     void initAnimation();
     void initUI();
     void initConnections();
     void addLabelAndCombo(QHBoxLayout* layout, const QString& labelText, QComboBox*& comboBox, int width);
+    // 文本框内容确认后发出的信号; applied 记录最近一次发出的内容
+    using TextSignal = void (SettingsPanel::*)(const QString &);
+    void connectAppliedEdit(QLineEdit *edit, QString *applied, TextSignal signal);
+    void applyEdit(QLineEdit *edit, QString *applied, TextSignal signal, bool force);
     QPropertyAnimation *m_animMin;
     QPropertyAnimation *m_animMax;
     QParallelAnimationGroup *m_animationGroup;
@@ -58,12 +84,30 @@ private:
     QComboBox *m_dataBitsBox;
     QComboBox *m_parityBox;
     QComboBox *m_stopBitsBox;
+    QComboBox *m_flowControlBox;
+    QSpinBox *m_readBufferBox;        // QSerialPort 读缓冲上限(KB), 0 为不限
+    QCheckBox *m_lowLatencyCheckbox;
     QCheckBox *m_showCtrlCharsCheckbox;
     QCheckBox *m_showTimeStampsCheckbox;
     QPushButton *m_togglePanelButton;
     QLineEdit *m_logFilePathEdit;
     QPushButton *m_browseLogFileBtn;
     QCheckBox *m_appendLogCheckbox;
+    QLineEdit *m_captureFilePathEdit;  // 原始二进制捕获文件, 打开串口时开始捕获
+    QPushButton *m_browseCaptureFileBtn;
+    QLineEdit *m_frameSpecEdit;        // 帧格式描述, 为空时按原始数据块显示
+    QString m_appliedFrameSpec;        // 最近一次发出的帧格式
+    QLineEdit *m_triggerSpecEdit;      // 触发捕获条件, 为空时关闭触发捕获
+    QString m_appliedTriggerSpec;      // 最近一次发出的触发条件
+    QLineEdit *m_alarmRulesEdit;       // 报警规则文件, 为空时关闭报警
+    QPushButton *m_browseAlarmRulesBtn;
+    QString m_appliedAlarmRules;       // 最近一次发出的规则文件路径
+    QSpinBox *m_maxLinesBox;      // 显示区最大行数
+    QSpinBox *m_maxMemoryBox;     // 显示区最大内存(MB)
+    QSpinBox *m_segmentSizeBox;       // 日志分段大小(MB), 0 为不按大小分段
+    QSpinBox *m_segmentMinutesBox;    // 日志分段时长(分钟), 0 为不按时间分段
+    QCheckBox *m_compressLogCheckbox;
+    QSpinBox *m_retentionBox;         // 日志总大小上限(MB), 0 为不限
 };
 
 #endif // SETTINGSPANEL_H
@@ -0,0 +1,113 @@
+#ifndef SPSCRINGBUFFER_H
+#define SPSCRINGBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+// 单生产者/单消费者(SPSC)无锁字节环形缓冲区
+// - 生产者(串口I/O线程)只推进 m_head, 消费者(GUI线程)只推进 m_tail
+// - 容量向上取整为2的幂, 下标用掩码回绕; head/tail 单调递增, 差值即为已用字节数
+// - 一次 write() 的数据要么全部可见要么全部不可见, 因此可以把"记录头+负载"作为一条记录写入
+class SpscRingBuffer
+{
+public:
+    explicit SpscRingBuffer(size_t capacity)
+    {
+        size_t cap = 1;
+        while (cap < capacity) cap <<= 1;
+        m_capacity = cap;
+        m_mask = cap - 1;
+        m_buffer.reset(new char[cap]);
+    }
+
+    SpscRingBuffer(const SpscRingBuffer &) = delete;
+    SpscRingBuffer &operator=(const SpscRingBuffer &) = delete;
+
+    size_t capacity() const { return m_capacity; }
+
+    // 消费者侧: 可读字节数
+    size_t readAvailable() const
+    {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_relaxed);
+    }
+
+    // 生产者侧: 可写字节数
+    size_t writeAvailable() const
+    {
+        return m_capacity - (m_head.load(std::memory_order_relaxed) - m_tail.load(std::memory_order_acquire));
+    }
+
+    // 生产者: 空间不足时不写入任何数据并返回 false
+    bool write(const char *data, size_t len)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        if (m_capacity - (head - tail) < len) return false;
+
+        copyIn(head, data, len);
+        m_head.store(head + len, std::memory_order_release);
+
+        const size_t used = head + len - tail;
+        if (used > m_highWater.load(std::memory_order_relaxed))
+            m_highWater.store(used, std::memory_order_relaxed);
+        return true;
+    }
+
+    // 消费者: 复制但不移除
+    size_t peek(char *data, size_t len) const
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t avail = m_head.load(std::memory_order_acquire) - tail;
+        if (len > avail) len = avail;
+        copyOut(tail, data, len);
+        return len;
+    }
+
+    // 消费者: 复制并移除
+    size_t read(char *data, size_t len)
+    {
+        len = peek(data, len);
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + len, std::memory_order_release);
+        return len;
+    }
+
+    // 消费者: 丢弃数据
+    void skip(size_t len)
+    {
+        const size_t avail = readAvailable();
+        if (len > avail) len = avail;
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + len, std::memory_order_release);
+    }
+
+    // 历史最大占用(字节), 用于观察消费者是否跟得上
+    size_t highWaterMark() const { return m_highWater.load(std::memory_order_relaxed); }
+
+private:
+    void copyIn(size_t pos, const char *data, size_t len)
+    {
+        const size_t offset = pos & m_mask;
+        const size_t first = len < m_capacity - offset ? len : m_capacity - offset;
+        std::memcpy(m_buffer.get() + offset, data, first);
+        std::memcpy(m_buffer.get(), data + first, len - first);
+    }
+
+    void copyOut(size_t pos, char *data, size_t len) const
+    {
+        const size_t offset = pos & m_mask;
+        const size_t first = len < m_capacity - offset ? len : m_capacity - offset;
+        std::memcpy(data, m_buffer.get() + offset, first);
+        std::memcpy(data + first, m_buffer.get(), len - first);
+    }
+
+    std::unique_ptr<char[]> m_buffer;
+    size_t m_capacity = 0;
+    size_t m_mask = 0;
+    // head/tail 放在不同缓存行, 避免生产者和消费者互相伪共享
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) std::atomic<size_t> m_tail{0};
+    std::atomic<size_t> m_highWater{0};
+};
+
+#endif // SPSCRINGBUFFER_H
@@ -0,0 +1,105 @@
+#ifndef STATSCOLLECTOR_H
+#define STATSCOLLECTOR_H
+
+#include <QObject>
+#include <QHash>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+#include "latencyhistogram.h"
+#include "logwriter.h"
+#include "serialworker.h"
+
+class SerialSession;
+class SessionManager;
+
+// 单个串口在一个采样周期内的统计
+struct PortStatsSample
+{
+    QString portName;
+    double rxBytesPerSec = 0;
+    double txBytesPerSec = 0;
+    double rxFramesPerSec = 0;
+    quint64 rxBytes = 0;             // 自打开串口起的累计值
+    quint64 txBytes = 0;
+    quint64 frames = 0;
+    quint64 checksumErrors = 0;
+    size_t ringHighWater = 0;
+    size_t ringCapacity = 0;
+    quint64 ringStalls = 0;
+    LineErrorCounts errors;
+    qint64 logQueueBytes = 0;
+    quint64 logDropped = 0;
+    quint64 logWriteErrors = 0;      // 写盘失败次数, 对应的数据已丢失
+    quint64 logRotationFailures = 0; // 分段改名失败次数, 只用于提示
+};
+
+// 一次采样: 各串口的计数与本周期的"读取到显示"延迟
+struct StatsSnapshot
+{
+    qint64 timestampMs = 0;          // 墙上时间, 便于和其他日志对齐
+    double intervalSec = 0;
+    QVector<PortStatsSample> ports;
+    quint64 latencySamples = 0;
+    double latencyP50Us = 0;
+    double latencyP99Us = 0;
+    double latencyMaxUs = 0;
+
+    double totalRxBytesPerSec() const;
+    double totalTxBytesPerSec() const;
+};
+
+// 周期性采集各会话的吞吐、延迟和丢弃计数, 在GUI线程(或无界面模式的主线程)中使用
+// - 计数来自各处已有的原子计数器, 采样只读取不加锁
+// - 延迟由显示端调用 displayLatency().record() 记录, 每个周期汇总后清零
+// - 可把每次采样追加到 CSV 或 JSON Lines 文件, 通过 LogWriter 异步写出
+class StatsCollector : public QObject
+{
+    Q_OBJECT
+public:
+    enum class ExportFormat { Csv, JsonLines };
+
+    explicit StatsCollector(SessionManager *sessions, QObject *parent = nullptr);
+
+    void setInterval(int ms) { m_timer->setInterval(ms); }
+    void start();
+    void stop();
+
+    LatencyHistogram &displayLatency() { return m_latency; }
+    const StatsSnapshot &lastSnapshot() const { return m_last; }
+
+    // 路径为空时停止导出; 格式按扩展名(.json/.jsonl)推断时用 formatForPath()
+    bool setExportPath(const QString &path, ExportFormat format, QString *errorString = nullptr);
+    QString exportPath() const { return m_export.isOpen() ? m_export.fileName() : QString(); }
+    static ExportFormat formatForPath(const QString &path);
+
+    static QByteArray csvHeader();
+    static QByteArray toCsv(const StatsSnapshot &snapshot);
+    static QByteArray toJsonLine(const StatsSnapshot &snapshot);
+
+signals:
+    void sampled(const StatsSnapshot &snapshot);
+
+private slots:
+    void sample();
+
+private:
+    struct Previous
+    {
+        quint64 rxBytes = 0;
+        quint64 txBytes = 0;
+        quint64 frames = 0;
+    };
+
+    SessionManager *m_sessions;
+    QTimer *m_timer;
+    qint64 m_lastSampleNs = 0;
+    QHash<SerialSession *, Previous> m_previous;
+    LatencyHistogram m_latency;
+    StatsSnapshot m_last;
+    LogWriter m_export;
+    ExportFormat m_exportFormat = ExportFormat::Csv;
+};
+
+#endif // STATSCOLLECTOR_H
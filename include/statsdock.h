@@ -0,0 +1,32 @@
+#ifndef STATSDOCK_H
+#define STATSDOCK_H
+
+#include <QDockWidget>
+#include <QLabel>
+#include <QPushButton>
+#include <QTableWidget>
+
+#include "statscollector.h"
+
+// 统计面板: 可停靠/浮动, 每列一个串口, 每行一项指标
+// 数据来自 StatsCollector 的周期采样, 导出按钮把采样追加到 CSV/JSON Lines 文件
+class StatsDock : public QDockWidget
+{
+    Q_OBJECT
+public:
+    explicit StatsDock(StatsCollector *collector, QWidget *parent = nullptr);
+
+private slots:
+    void onSampled(const StatsSnapshot &snapshot);
+    void onExportClicked();
+
+private:
+    void setCell(int row, int column, const QString &text);
+
+    StatsCollector *m_collector;
+    QTableWidget *m_table;
+    QLabel *m_latencyLabel;
+    QPushButton *m_exportButton;
+};
+
+#endif // STATSDOCK_H
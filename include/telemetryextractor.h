@@ -0,0 +1,127 @@
+#ifndef TELEMETRYEXTRACTOR_H
+#define TELEMETRYEXTRACTOR_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <cstring>
+
+// 帧内一个数值字段: 偏移处按类型解码后乘以 scale
+struct TelemetryField
+{
+    enum class Type { U8, I8, U16, I16, U32, I32, F32 };
+
+    QString name;
+    int offset = 0;
+    Type type = Type::U8;
+    bool bigEndian = false;
+    double scale = 1.0;
+
+    int size() const;
+};
+
+// 遥测提取格式, 可由文本解析:
+//   "re:P=(?<pressure>[-\d.]+) F=(?<flow>[-\d.]+)"   正则, 每个捕获组一个通道, 命名组的名字即通道名
+//   "pressure=3:i16be:0.01;flow=5:u16"              帧字段, 名字=偏移:类型[:系数], 需要启用分帧
+// 类型: u8 i8 u16 i16 u32 i32 f32, 加 be 后缀为大端, 默认小端
+struct TelemetrySpec
+{
+    enum class Kind { None, Regex, Fields };
+
+    Kind kind = Kind::None;
+    QRegularExpression regex;
+    QVector<TelemetryField> fields;
+    QStringList channelNames;        // 按捕获组/字段顺序
+
+    bool isValid() const { return kind != Kind::None; }
+    static TelemetrySpec parse(const QString &text, QString *errorString = nullptr);
+};
+
+// 从接收数据中提取数值样本
+// - 未分帧的文本按行匹配, 行尾之前的不完整部分按串口暂存, 与下一块拼接
+// - 分帧时每帧独立处理: 字段格式按偏移解码, 正则格式把整帧当作一行
+// - 结果通过回调 sink(通道序号, 数值) 输出, 一行/一帧中没有匹配的通道不输出
+class TelemetryExtractor
+{
+public:
+    static constexpr int kMaxLine = 4096;    // 超长的行截断, 防止没有换行的二进制数据无限暂存
+
+    void setSpec(const TelemetrySpec &spec);
+    const TelemetrySpec &spec() const { return m_spec; }
+    void reset();
+
+    template <typename Sink>
+    void feedText(quint8 portId, const char *data, qsizetype n, Sink &&sink);
+    template <typename Sink>
+    void feedFrame(const char *data, qsizetype n, Sink &&sink);
+
+    quint64 matchedRecords() const { return m_matched; }
+    quint64 unmatchedRecords() const { return m_unmatched; }
+
+private:
+    // 解析一行/一帧, 结果放在 m_values/m_present 中, 返回找到的通道数
+    int extractLine(const char *line, qsizetype n);
+    int extractFrame(const char *data, qsizetype n);
+
+    template <typename Sink>
+    void emitValues(int found, Sink &sink);
+
+    TelemetrySpec m_spec;
+    QHash<quint8, QByteArray> m_carry;
+    QVector<double> m_values;
+    QVector<bool> m_present;
+    quint64 m_matched = 0;
+    quint64 m_unmatched = 0;
+};
+
+template <typename Sink>
+void TelemetryExtractor::emitValues(int found, Sink &sink)
+{
+    if (found == 0) {
+        ++m_unmatched;
+        return;
+    }
+    ++m_matched;
+    for (int i = 0; i < m_values.size(); ++i) {
+        if (m_present.at(i)) sink(i, m_values.at(i));
+    }
+}
+
+template <typename Sink>
+void TelemetryExtractor::feedText(quint8 portId, const char *data, qsizetype n, Sink &&sink)
+{
+    if (m_spec.kind != TelemetrySpec::Kind::Regex) return;
+
+    QByteArray &carry = m_carry[portId];
+    const char *end = data + n;
+    while (data < end) {
+        const char *newline = static_cast<const char *>(std::memchr(data, '\n', size_t(end - data)));
+        if (!newline) {
+            carry.append(data, int(qMin<qsizetype>(end - data, kMaxLine - carry.size())));
+            return;
+        }
+        if (carry.isEmpty()) {
+            emitValues(extractLine(data, newline - data), sink);
+        } else {
+            carry.append(data, int(qMin<qsizetype>(newline - data, kMaxLine - carry.size())));
+            emitValues(extractLine(carry.constData(), carry.size()), sink);
+            carry.resize(0);
+        }
+        data = newline + 1;
+    }
+}
+
+template <typename Sink>
+void TelemetryExtractor::feedFrame(const char *data, qsizetype n, Sink &&sink)
+{
+    if (m_spec.kind == TelemetrySpec::Kind::Fields) {
+        emitValues(extractFrame(data, n), sink);
+    } else if (m_spec.kind == TelemetrySpec::Kind::Regex) {
+        emitValues(extractLine(data, n), sink);
+    }
+}
+
+#endif // TELEMETRYEXTRACTOR_H
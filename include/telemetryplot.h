@@ -0,0 +1,53 @@
+#ifndef TELEMETRYPLOT_H
+#define TELEMETRYPLOT_H
+
+#include <QPointF>
+#include <QTimer>
+#include <QVector>
+#include <QWidget>
+
+#include "telemetrystore.h"
+
+// 遥测曲线: 横轴为最近 windowSeconds 秒, 纵轴自动缩放, 所有通道共用一个坐标系
+// - 每个通道按像素列做最小/最大值抽取, 每列最多画两个点, 绘制量只与控件宽度有关
+// - 最小/最大值抽取保留了每列内的尖峰, 不会像隔点抽样那样丢失短脉冲
+// - 可见时以固定帧率(默认30Hz)重绘, 隐藏或暂停且没有新数据时不重绘
+class TelemetryPlot : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit TelemetryPlot(TelemetryStore *store, QWidget *parent = nullptr);
+
+    void setWindowSeconds(double seconds);
+    void setPaused(bool paused);
+    bool isPaused() const { return m_paused; }
+    void setFrameRate(int hz);
+
+    // 最近一次绘制的耗时和点数, 用于确认抽取生效
+    double lastPaintMs() const { return m_lastPaintMs; }
+    int lastPointCount() const { return m_lastPointCount; }
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private slots:
+    void onFrameTimer();
+
+private:
+    static QColor channelColor(int channel);
+
+    TelemetryStore *m_store;
+    QTimer *m_frameTimer;
+    double m_windowSeconds = 10.0;
+    bool m_paused = false;
+    qint64 m_pausedAtNs = 0;
+    quint64 m_paintedGeneration = 0;
+    QVector<QVector<TelemetryStore::Bucket>> m_buckets;   // 每通道一组, 复用
+    QVector<QPointF> m_points;
+    double m_lastPaintMs = 0;
+    int m_lastPointCount = 0;
+};
+
+#endif // TELEMETRYPLOT_H
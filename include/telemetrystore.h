@@ -0,0 +1,65 @@
+#ifndef TELEMETRYSTORE_H
+#define TELEMETRYSTORE_H
+
+#include <QString>
+#include <QVector>
+#include <vector>
+
+// 遥测数据的列式存储: 每个通道一个定长环形缓冲区, 时间戳和数值分列存放
+// - 每 kBlockSize 个样本预先记录一组最小/最大值, 抽取时整块跳过, 百万级样本也只需扫描少量数据
+// - 同一通道的时间戳单调不减(来自I/O线程的单调时钟), 按时间定位用二分查找
+// - 写满后覆盖最旧的样本, 内存占用固定为 通道数 × 容量 × 16 字节
+class TelemetryStore
+{
+public:
+    static constexpr int kBlockSize = 256;
+
+    // 一个像素列内样本的范围; count 为 0 表示该列没有样本
+    struct Bucket
+    {
+        double min;
+        double max;
+        int count;
+    };
+
+    explicit TelemetryStore(int capacity = 1 << 20);
+
+    int addChannel(const QString &name);
+    int channelCount() const { return int(m_channels.size()); }
+    QString channelName(int channel) const { return m_channels[size_t(channel)].name; }
+    void clear();
+
+    void append(int channel, qint64 timestampNs, double value);
+
+    int capacity() const { return m_capacity; }
+    qsizetype size(int channel) const { return m_channels[size_t(channel)].count; }
+    qint64 lastTimestampNs(int channel) const;
+    double lastValue(int channel) const;
+    // 每次追加或清空都会递增, 绘图据此判断是否需要重绘
+    quint64 generation() const { return m_generation; }
+
+    // 把 [t0Ns, t1Ns) 均分为 buckets 列, 输出每列样本的最小/最大值
+    void decimate(int channel, qint64 t0Ns, qint64 t1Ns, int buckets, QVector<Bucket> *out) const;
+
+private:
+    struct Channel
+    {
+        QString name;
+        std::vector<qint64> timestamps;
+        std::vector<double> values;
+        std::vector<double> blockMin;
+        std::vector<double> blockMax;
+        qsizetype head = 0;          // 下一个写入位置
+        qsizetype count = 0;
+    };
+
+    static qsizetype physical(const Channel &ch, qsizetype logical);
+    static qsizetype lowerBound(const Channel &ch, qsizetype from, qint64 timestampNs);
+    static void scanRange(const Channel &ch, qsizetype from, qsizetype to, double *min, double *max);
+
+    int m_capacity;
+    std::vector<Channel> m_channels;
+    quint64 m_generation = 0;
+};
+
+#endif // TELEMETRYSTORE_H
@@ -0,0 +1,32 @@
+#ifndef TIMESTAMPFORMATTER_H
+#define TIMESTAMPFORMATTER_H
+
+#include <QByteArray>
+#include <QtGlobal>
+
+// 定长时间戳格式化: 把I/O线程的单调时钟时间戳转换为本地时间并追加到缓冲区
+// - 只做整数运算, 不创建 QDateTime/QString, 缓冲区容量足够时不分配内存
+// - 单调时钟到本地时间的偏移每分钟用 QDateTime 重新校准一次(跟随夏令时和系统时间调整)
+// - 日期部分按天缓存
+class TimestampFormatter
+{
+public:
+    static constexpr int kTimeSize = 15;       // "[hh:mm:ss.zzz] "
+    static constexpr int kDateTimeSize = 22;   // "[yyyy-MM-dd hh:mm:ss] "
+
+    void appendTime(QByteArray *out, qint64 monotonicNs);
+    void appendDateTime(QByteArray *out, qint64 monotonicNs);
+
+private:
+    qint64 localMs(qint64 monotonicNs);
+    void resync(qint64 monotonicNs);
+    void updateDate(qint64 day);
+
+    qint64 m_offsetMs = 0;           // 本地时间(毫秒) - 单调时钟(毫秒)
+    qint64 m_nextResyncNs = 0;
+    bool m_synced = false;
+    qint64 m_day = -1;               // 已缓存日期对应的天数(自1970-01-01起, 本地时间)
+    char m_date[10] = {};            // "yyyy-MM-dd"
+};
+
+#endif // TIMESTAMPFORMATTER_H
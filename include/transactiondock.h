@@ -0,0 +1,45 @@
+#ifndef TRANSACTIONDOCK_H
+#define TRANSACTIONDOCK_H
+
+#include <QDockWidget>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QTableWidget>
+
+#include "transactiontracker.h"
+
+class SerialSession;
+class SessionManager;
+
+// 事务面板: 可停靠/浮动
+// - 设置命令/响应匹配规则后, 每个 串口×命令类型 一行, 显示往返延迟分布和超时
+// - 规则作用于所有会话, 之后打开的会话由 attach() 应用; 留空停止跟踪
+class TransactionDock : public QDockWidget
+{
+    Q_OBJECT
+public:
+    explicit TransactionDock(SessionManager *sessions, QWidget *parent = nullptr);
+
+    void attach(SerialSession *session);
+
+private slots:
+    void onApplyClicked();
+    void onResetClicked();
+    void onExportClicked();
+    void refresh();
+
+private:
+    void setCell(int row, int column, const QString &text, bool highlight = false);
+
+    SessionManager *m_sessions;
+    TransactionRule m_rule;
+    QLineEdit *m_ruleEdit;
+    QPushButton *m_applyButton;
+    QPushButton *m_resetButton;
+    QPushButton *m_exportButton;
+    QTableWidget *m_table;
+    QLabel *m_statusLabel;
+};
+
+#endif // TRANSACTIONDOCK_H
@@ -0,0 +1,115 @@
+#ifndef TRANSACTIONTRACKER_H
+#define TRANSACTIONTRACKER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+#include "latencyhistogram.h"
+
+// 命令/响应的匹配规则, 可由文本解析, 例如:
+//   "match=seq;op=2:1;seq=3:1;timeout=200"   按第3字节的序号匹配, 第2字节为命令类型
+//   "match=echo;op=2:1"                       响应回显命令字节, 匹配同类型中最早未应答的命令
+//   "match=first;op=0:1"                      命令之后收到的第一帧即为响应(省略 match 时的默认值)
+// 键: match(seq/echo/first) op(类型字段 偏移:字节数) seq(序号字段 偏移:字节数)
+//     rxop/rxseq(响应中的位置, 省略时与命令相同) timeout(毫秒, 默认1000)
+// 字段最多4字节; 启用分帧时偏移相对帧首, 否则相对接收数据块的开头
+struct TransactionRule
+{
+    enum class Match { None, SequenceId, OpcodeEcho, FirstFrame };
+
+    struct Field
+    {
+        int offset = -1;             // <0 表示未设置
+        int size = 1;
+        bool isSet() const { return offset >= 0; }
+    };
+
+    Match match = Match::None;       // 默认构造的规则无效, 表示不跟踪
+    Field opcode;
+    Field sequence;
+    Field rxOpcode;
+    Field rxSequence;
+    qint64 timeoutNs = 1000000000;
+
+    bool isValid() const;
+    static TransactionRule parse(const QString &text, QString *errorString = nullptr);
+};
+
+// 一类命令(按类型字段区分)的统计; 延迟从命令交给驱动到响应帧最后一块数据被读到
+struct TransactionTypeStats
+{
+    quint32 type = 0;
+    int typeSize = 0;                // 0 表示规则中没有类型字段, 所有命令归为一类
+    bool overflow = false;           // 类型数超过上限后的其余类型
+    quint64 sent = 0;
+    quint64 matched = 0;
+    quint64 timeouts = 0;
+    LatencyHistogram latency;
+
+    QString label() const;
+};
+
+// 命令/响应事务跟踪: 把发送的命令与之后收到的响应配对, 按命令类型统计往返延迟
+// - 两端的时间戳都来自I/O线程的单调时钟: 命令是交给驱动的时刻, 响应是读到数据的时刻
+// - 未应答的命令保存在固定容量的表中, 满时最早的一条按超时处理; 类型数有上限,
+//   每类一个固定大小的直方图, 长时间运行内存不增长
+// - 不是线程安全的, 只在GUI线程(或无界面模式的主线程)中使用
+class TransactionTracker
+{
+public:
+    struct Timeout
+    {
+        qint64 sentNs;
+        quint32 type;
+        quint32 sequence;
+    };
+
+    static constexpr int kMaxPending = 256;
+    static constexpr int kMaxTypes = 32;
+    static constexpr int kRecentTimeouts = 64;
+
+    void setRule(const TransactionRule &rule);
+    const TransactionRule &rule() const { return m_rule; }
+    bool isEnabled() const { return m_enabled; }
+    void reset();
+
+    void onTransmit(qint64 timestampNs, const char *data, qsizetype size);
+    void onReceive(qint64 timestampNs, const char *data, qsizetype size);
+    // 把在 cutoffNs 之前已超时的命令标记为超时; cutoffNs 之前的接收数据必须都已交给 onReceive()
+    void expire(qint64 cutoffNs);
+
+    const QVector<TransactionTypeStats> &types() const { return m_types; }
+    quint64 pendingCount() const { return quint64(m_pending.size()); }
+    quint64 unmatchedResponses() const { return m_unmatched; }
+    // 最近的超时, 从旧到新
+    QVector<Timeout> recentTimeouts() const;
+
+    static QByteArray csvHeader();
+    QByteArray toCsv(const QString &portName) const;
+    QByteArray toJson(const QString &portName) const;
+
+private:
+    struct Pending
+    {
+        qint64 sentNs;
+        quint32 type;
+        quint32 sequence;
+        int typeIndex;
+    };
+
+    static bool readField(const TransactionRule::Field &field, const char *data, qsizetype size, quint32 *value);
+    int typeIndex(quint32 type);
+    void complete(int pendingIndex, qint64 latencyNs);
+    void timeOut(int pendingIndex);
+
+    TransactionRule m_rule;
+    bool m_enabled = false;
+    QVector<Pending> m_pending;      // 按发送时间排序, 预留 kMaxPending 容量
+    QVector<TransactionTypeStats> m_types;
+    QVector<Timeout> m_timeouts;     // 环形, 最多 kRecentTimeouts 条
+    int m_timeoutHead = 0;
+    quint64 m_unmatched = 0;
+};
+
+#endif // TRANSACTIONTRACKER_H
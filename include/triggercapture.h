@@ -0,0 +1,142 @@
+#ifndef TRIGGERCAPTURE_H
+#define TRIGGERCAPTURE_H
+
+#include <QByteArray>
+#include <QByteArrayMatcher>
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <thread>
+
+#include "capturefile.h"
+
+class QTimer;
+
+// 触发捕获的配置, 文本格式与分帧格式相同: 分号分隔, 例如
+//   buffer=64;pre=30;post=10;pattern=55AA;error;checksum
+// - buffer: 内存环大小(MB), 启用时一次分配, 之后不再变化
+// - pre/post: 触发前/后保存的秒数; 触发前的窗口同时受内存环大小限制
+// - pattern: 接收数据中出现该字节序列(十六进制)时触发, 跨读取边界也能匹配
+// - error: 串口报告错误或线路错误计数(溢出/校验/帧错误/break)增加时触发
+// - checksum: 帧校验失败时触发, 需要设置带校验的分帧格式
+// 手动触发总是可用
+struct TriggerSpec
+{
+    qint64 bufferBytes = 64 * 1024 * 1024;
+    qint64 preNs = 30000000000LL;
+    qint64 postNs = 10000000000LL;
+    QByteArray pattern;
+    bool onError = false;
+    bool onChecksum = false;
+
+    static constexpr qint64 kMinBufferBytes = 1024 * 1024;
+    static constexpr qint64 kMaxBufferBytes = 1024 * 1024 * 1024;
+
+    static bool parse(const QString &text, TriggerSpec *spec, QString *errorString = nullptr);
+};
+
+enum class TriggerReason : quint8 { Manual, Pattern, PortError, LineError, Checksum };
+
+// 触发捕获: 最近的收发原始数据保存在预先分配的内存环中, 平时不写盘
+// - 内存环按 [记录头][负载] 连续存放, 写满后从最旧的记录开始覆盖
+// - 触发时新建一个 .pyrocap 文件, 由后台线程直接从内存环按片读出触发前 pre 秒和之后 post 秒的记录写盘;
+//   I/O线程只记下窗口的起止, 不复制数据, 触发不会卡住接收, 也不占用内存环之外的内存
+// - 写盘期间尚未写出的记录不会被覆盖; 磁盘跟不上导致内存环写满时丢弃新记录并计数
+// - 窗口内(直到文件写完)的再次触发只计数, 不延长窗口, 持续出现的模式不会让文件无限增长
+// - 与原始捕获一样运行在I/O线程中, 由各工作对象调用 record(); 只能在I/O线程中调用,
+//   统计计数除外
+class TriggerCapture : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TriggerCapture(QObject *parent = nullptr);
+    ~TriggerCapture();
+
+    // 分配内存环并开始记录, 原有数据被丢弃; directory 为保存窗口文件的目录
+    void configure(const TriggerSpec &spec, const QString &directory);
+    // 结束正在写出的窗口并释放内存环
+    void disable();
+    bool isEnabled() const { return m_capacity > 0; }
+
+    void record(qint64 timestampNs, CaptureDirection direction, quint8 portId, const char *data, qsizetype len);
+    // timestampNs 为事件发生的时刻(单调时钟); 对应条件未启用时忽略
+    void trigger(TriggerReason reason, quint8 portId, qint64 timestampNs);
+
+    // 以下可在任意线程读取
+    qint64 capacity() const { return m_capacityBytes.load(std::memory_order_relaxed); }
+    qint64 bufferedBytes() const { return m_bufferedBytes.load(std::memory_order_relaxed); }
+    quint64 triggerCount() const { return m_triggers.load(std::memory_order_relaxed); }
+    quint64 savedCount() const { return m_saved.load(std::memory_order_relaxed); }
+    // 窗口写盘期间因内存环已满而丢弃的字节数, 每个窗口重新计数
+    qint64 windowDroppedBytes() const { return m_windowDropped.load(std::memory_order_relaxed); }
+
+    static QString reasonName(TriggerReason reason);
+
+    static constexpr int kRecordHeaderSize = 16;
+    static constexpr qint64 kMaxRecordPayload = 64 * 1024;   // 更长的数据拆成多条记录
+    static constexpr qint64 kDumpSliceBytes = 1024 * 1024;    // 写盘线程每次从内存环读出的数据量
+    static constexpr qint64 kDumpQueueBytes = 8 * 1024 * 1024;
+    static constexpr int kDumpIdleMs = 10;
+
+signals:
+    void triggered(TriggerReason reason, quint8 portId, const QString &path);
+    void saved(const QString &path, qint64 bytes);
+    void failed(const QString &errorString);
+
+private:
+    struct RecordHeader
+    {
+        qint64 timestampNs;
+        quint32 length;
+        quint8 direction;
+        quint8 portId;
+        quint16 reserved;
+    };
+    static_assert(sizeof(RecordHeader) == kRecordHeaderSize, "记录头必须为16字节");
+
+    bool append(const RecordHeader &header, const char *payload);
+    void evictOldest();
+    RecordHeader headerAt(qint64 position) const;
+    void copyOut(qint64 position, char *dest, qint64 len) const;
+    void copyIn(qint64 position, const char *src, qint64 len);
+    bool matchPattern(quint8 portId, const char *data, qsizetype len);
+    bool enabledFor(TriggerReason reason) const;
+    bool isWindowOpen() const;
+    // 窗口在当前写入位置结束, 写盘线程写完之前的记录后关闭文件
+    void finishWindow();
+    void waitForWindow();
+    void dumpWindow();               // 写盘线程
+
+    TriggerSpec m_spec;
+    QString m_directory;
+    QByteArray m_buffer;             // 预先分配并触碰过的内存环
+    qint64 m_capacity = 0;
+    qint64 m_head = 0;               // 下一条记录的绝对位置, 对 m_capacity 取模得到偏移
+    qint64 m_tail = 0;               // 最旧一条记录的绝对位置
+    QByteArray m_payload;            // 回绕记录的暂存区, 大小为 kMaxRecordPayload, 只由写盘线程使用
+
+    QByteArrayMatcher m_matcher;
+    QByteArray m_carry[256];         // 各端口上一次接收的末尾 pattern.size()-1 字节
+    QByteArray m_seam;               // 上次末尾 + 本次开头, 用于跨边界匹配
+
+    // 窗口: I/O线程在触发时设置, 之后 m_writer 只由写盘线程使用
+    CaptureWriter m_writer;
+    QString m_windowPath;
+    qint64 m_startNs = 0;            // 触发前窗口的开始时刻
+    qint64 m_deadlineNs = 0;         // 触发后窗口的结束时刻
+    QTimer *m_windowTimer;           // 窗口结束后没有新数据时也按时结束
+    std::thread m_dumper;
+    std::atomic<qint64> m_publishedHead{0};    // 写盘线程可以读到的位置
+    std::atomic<qint64> m_dumpCursor{0};       // 写盘线程已读完的位置, I/O线程不能覆盖它之后的数据
+    std::atomic<qint64> m_windowEnd{-1};       // 窗口结束的位置, -1 为尚未结束
+    std::atomic<bool> m_dumpDone{true};
+    std::atomic<qint64> m_windowDropped{0};
+
+    std::atomic<qint64> m_capacityBytes{0};
+    std::atomic<qint64> m_bufferedBytes{0};
+    std::atomic<quint64> m_triggers{0};
+    std::atomic<quint64> m_saved{0};
+};
+Q_DECLARE_METATYPE(TriggerReason)
+
+#endif // TRIGGERCAPTURE_H
@@ -0,0 +1,33 @@
+#ifndef UTF8DECODER_H
+#define UTF8DECODER_H
+
+#include <QByteArray>
+#include <QtGlobal>
+
+// 流式UTF-8校验/解码器, 每个串口一个, 显示和文本日志共用
+// - 数据块末尾不完整的多字节序列暂存(最多3字节), 与下一块拼接后再输出, 跨块的汉字不会变成替换字符
+// - 输出始终是合法的UTF-8: 非法序列按最大有效前缀替换为 U+FFFD, 与 QString::fromUtf8 的结果一致
+// - ASCII 每次检查8字节, 合法的数据整段拷贝; 状态只有暂存的几个字节, 不需要每块重新初始化
+class Utf8StreamDecoder
+{
+public:
+    // 把 data 中的完整序列追加到 out, 末尾不完整的序列留到下一次
+    void decode(QByteArray *out, const char *data, qsizetype n);
+    // 把暂存的不完整序列作为替换字符输出并清空, 用于数据流结束或切换显示方式
+    void flush(QByteArray *out);
+    // 把暂存的原始字节追加到 out 并清空, 用于切换到十六进制显示
+    void takePending(QByteArray *out);
+    void reset() { m_partialSize = 0; }
+
+    int pendingBytes() const { return m_partialSize; }
+    quint64 invalidSequences() const { return m_invalid; }
+
+private:
+    void appendReplacement(QByteArray *out);
+
+    char m_partial[4] = {};
+    int m_partialSize = 0;
+    quint64 m_invalid = 0;
+};
+
+#endif // UTF8DECODER_H
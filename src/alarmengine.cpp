@@ -0,0 +1,263 @@
+#include "alarmengine.h"
+#include "serialworker.h"
+
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QStringList>
+#include <algorithm>
+
+namespace {
+
+// \r \n \t \\ \xNN, 其余字符按UTF-8原样保留
+bool unescape(const QString &text, QByteArray *out)
+{
+    const QByteArray utf8 = text.toUtf8();
+    out->clear();
+    for (int i = 0; i < utf8.size(); ++i) {
+        const char c = utf8.at(i);
+        if (c != '\\') {
+            out->append(c);
+            continue;
+        }
+        if (++i >= utf8.size()) return false;
+        switch (utf8.at(i)) {
+        case 'r':  out->append('\r'); break;
+        case 'n':  out->append('\n'); break;
+        case 't':  out->append('\t'); break;
+        case '\\': out->append('\\'); break;
+        case 'x': {
+            bool ok = false;
+            const int value = utf8.mid(i + 1, 2).toInt(&ok, 16);
+            if (!ok || i + 2 >= utf8.size()) return false;
+            out->append(char(value));
+            i += 2;
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool AlarmRule::parse(const QString &line, AlarmRule *rule, QString *errorString)
+{
+    AlarmRule result;
+    auto fail = [&](const QString &message) {
+        if (errorString) *errorString = message;
+        return false;
+    };
+
+    const QStringList items = line.split(';', Qt::SkipEmptyParts);
+    for (const QString &item : items) {
+        const int eq = item.indexOf('=');
+        if (eq <= 0) return fail("缺少'=': " + item);
+        const QString key = item.left(eq).trimmed().toLower();
+        // 文本模式的值不去除空白, 首尾空格也是模式的一部分
+        const QString raw = item.mid(eq + 1);
+        const QString value = raw.trimmed();
+        bool ok = true;
+
+        if (key == "name") {
+            result.name = value;
+        } else if (key == "text") {
+            ok = unescape(raw, &result.pattern) && !result.pattern.isEmpty();
+        } else if (key == "hex") {
+            result.pattern = QByteArray::fromHex(value.toLatin1());
+            ok = !result.pattern.isEmpty();
+        } else if (key == "action") {
+            result.actions = 0;
+            for (const QString &name : value.split(',', Qt::SkipEmptyParts)) {
+                const QString n = name.trimmed().toLower();
+                if (n == "status")         result.actions |= Status;
+                else if (n == "highlight") result.actions |= Highlight;
+                else if (n == "sound")     result.actions |= Sound;
+                else if (n == "command")   result.actions |= Command;
+                else return fail("未知的动作: " + n);
+            }
+        } else if (key == "cmd") {
+            result.command = value;
+        } else if (key == "holdoff") {
+            const int ms = value.toInt(&ok);
+            result.holdoffNs = qint64(ms) * 1000000;
+            ok = ok && ms >= 0;
+        } else {
+            return fail("未知的键: " + key);
+        }
+        if (!ok) return fail("无效的值: " + item);
+    }
+
+    if (result.pattern.isEmpty()) return fail("必须用 text 或 hex 指定模式");
+    if ((result.actions & Command) && result.command.isEmpty()) return fail("command 动作需要用 cmd 指定命令");
+    if (!result.command.isEmpty()) result.actions |= Command;
+    if ((result.actions & Command) && result.holdoffNs < kMinCommandHoldoffNs)
+        return fail(QString("command 动作的 holdoff 不能小于 %1 ms").arg(kMinCommandHoldoffNs / 1000000));
+    if (result.name.isEmpty()) result.name = QString::fromUtf8(result.pattern);
+    *rule = result;
+    return true;
+}
+
+bool AlarmRule::parseList(const QString &text, QVector<AlarmRule> *rules, QString *errorString)
+{
+    QVector<AlarmRule> result;
+    const QStringList lines = text.split('\n');
+    for (int i = 0; i < lines.size(); ++i) {
+        QString line = lines.at(i);
+        if (line.endsWith('\r')) line.chop(1);
+        if (line.trimmed().isEmpty() || line.trimmed().startsWith('#')) continue;
+        AlarmRule rule;
+        QString error;
+        if (!parse(line, &rule, &error)) {
+            if (errorString) *errorString = QString("第 %1 行: %2").arg(i + 1).arg(error);
+            return false;
+        }
+        result.append(rule);
+    }
+    *rules = result;
+    return true;
+}
+
+// ---------------------------------------------------------------- AlarmAutomaton
+
+void AlarmAutomaton::compile(const QVector<QByteArray> &patterns)
+{
+    m_classOf.fill(0);
+    m_classCount = 0;
+    m_next.clear();
+    m_outputStart = {0};
+    m_outputs.clear();
+
+    // 等价类 0 留给模式中没有出现的字节
+    int classes = 1;
+    for (const QByteArray &pattern : patterns) {
+        for (char c : pattern) {
+            if (m_classOf[uchar(c)] == 0) m_classOf[uchar(c)] = quint16(classes++);
+        }
+    }
+    if (classes == 1) return;
+
+    // 字典树, -1 表示没有这条边
+    QVector<qint32> delta(classes, -1);
+    QVector<QVector<qint32>> outputs(1);
+    for (int p = 0; p < patterns.size(); ++p) {
+        int state = 0;
+        for (char c : patterns.at(p)) {
+            const int index = state * classes + m_classOf[uchar(c)];
+            if (delta.at(index) < 0) {
+                delta[index] = outputs.size();
+                outputs.append(QVector<qint32>());
+                delta.insert(delta.size(), classes, -1);
+            }
+            state = delta.at(index);
+        }
+        if (state != 0) outputs[state].append(p);
+    }
+    const int states = outputs.size();
+    Q_ASSERT(qint64(states) * classes <= kStateMask);
+
+    // 广度优先: 失败状态的深度更小, 它的转移和输出在处理当前状态时已经补全
+    QVector<qint32> fail(states, 0);
+    QVector<qint32> queue;
+    queue.reserve(states);
+    for (int c = 0; c < classes; ++c) {
+        if (delta.at(c) < 0) delta[c] = 0;
+        else queue.append(delta.at(c));
+    }
+    for (int head = 0; head < queue.size(); ++head) {
+        const int u = queue.at(head);
+        outputs[u] += outputs.at(fail.at(u));
+        for (int c = 0; c < classes; ++c) {
+            const qint32 v = delta.at(u * classes + c);
+            const qint32 f = delta.at(fail.at(u) * classes + c);
+            if (v < 0) {
+                delta[u * classes + c] = f;
+            } else {
+                fail[v] = f;
+                queue.append(v);
+            }
+        }
+    }
+
+    m_outputStart.resize(states + 1);
+    for (int s = 0; s < states; ++s) {
+        std::sort(outputs[s].begin(), outputs[s].end());
+        m_outputStart[s] = m_outputs.size();
+        m_outputs += outputs.at(s);
+    }
+    m_outputStart[states] = m_outputs.size();
+
+    m_classCount = classes;
+    m_next.resize(delta.size());
+    for (int i = 0; i < delta.size(); ++i) {
+        const qint32 target = delta.at(i);
+        const quint32 row = quint32(target * classes);
+        m_next[i] = qint32(outputs.at(target).isEmpty() ? row : row | 0x80000000u);
+    }
+}
+
+// ---------------------------------------------------------------- AlarmEngine
+
+void AlarmEngine::setRules(const QVector<AlarmRule> &rules)
+{
+    m_rules = rules;
+    QVector<QByteArray> patterns;
+    patterns.reserve(rules.size());
+    for (const AlarmRule &rule : rules) patterns.append(rule.pattern);
+    m_automaton.compile(patterns);
+    m_states.fill(0);
+    m_counts.fill(0, rules.size());
+    m_holdoffs.clear();
+    m_latency.reset();
+    m_totalMatches = 0;
+    m_notifications = 0;
+}
+
+int AlarmEngine::feed(quint8 stream, qint64 timestampNs, const char *data, qsizetype size, const Handler &handler)
+{
+    if (m_rules.isEmpty()) return 0;
+    int actions = 0;
+    m_states[stream] = m_automaton.scan(m_states[stream], data, size, [&](int rule, qsizetype) {
+        const AlarmRule &r = m_rules.at(rule);
+        const quint64 count = ++m_counts[rule];
+        ++m_totalMatches;
+        actions |= r.actions;
+
+        const quint32 key = quint32(rule) << 8 | stream;
+        auto it = m_holdoffs.find(key);
+        if (it != m_holdoffs.end() && timestampNs - it->lastNs < r.holdoffNs) {
+            ++it->suppressed;
+            return;
+        }
+        if (it == m_holdoffs.end()) it = m_holdoffs.insert(key, Holdoff());
+        const quint64 suppressed = it->suppressed;
+        it->lastNs = timestampNs;
+        it->suppressed = 0;
+        ++m_notifications;
+        m_latency.record(SerialWorker::monotonicNs() - timestampNs);
+        if (handler) handler(AlarmMatch{rule, stream, timestampNs, count, suppressed});
+    });
+    return actions;
+}
+
+bool AlarmEngine::runCommand(const AlarmRule &rule, const QString &portName, QString *errorString)
+{
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert("PYROCOM_ALARM", rule.name);
+    environment.insert("PYROCOM_PORT", portName);
+    QProcess process;
+    process.setProcessEnvironment(environment);
+#ifdef Q_OS_WIN
+    process.setProgram("cmd.exe");
+    process.setArguments({"/c", rule.command});
+#else
+    process.setProgram("/bin/sh");
+    process.setArguments({"-c", rule.command});
+#endif
+    if (!process.startDetached()) {
+        if (errorString) *errorString = process.errorString();
+        return false;
+    }
+    return true;
+}
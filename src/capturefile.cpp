@@ -0,0 +1,275 @@
+#include "capturefile.h"
+
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+using namespace CaptureFormat;
+
+namespace {
+
+void putRecordHeader(char *out, quint8 type, CaptureDirection direction, quint8 portId,
+                     quint32 length, qint64 timestampNs)
+{
+    out[0] = char(type);
+    out[1] = char(direction);
+    out[2] = char(portId);
+    out[3] = 0;
+    qToLittleEndian<quint32>(length, out + 4);
+    qToLittleEndian<qint64>(timestampNs, out + 8);
+}
+
+} // namespace
+
+// ---------------------------------------------------------------- 写入
+
+bool CaptureWriter::open(const QString &path, QString *errorString)
+{
+    close();
+    // 捕获文件总是新建: 追加到旧文件会破坏索引链
+    if (!m_writer.open(path, false, errorString)) return false;
+
+    char header[kFileHeaderSize] = {};
+    std::memcpy(header, kMagic, sizeof(kMagic));
+    qToLittleEndian<quint16>(kVersion, header + 8);
+    qToLittleEndian<quint16>(quint16(kFileHeaderSize), header + 10);
+    m_writer.append(header, kFileHeaderSize);
+
+    m_pending.clear();
+    m_droppedRecords.store(0, std::memory_order_relaxed);
+    m_offset = kFileHeaderSize;
+    m_lastIndexOffset = 0;
+    m_lastEntryOffset = -kIndexStride;
+    m_lastBlockOffset = m_offset;
+    m_lastTimestampNs = 0;
+    return true;
+}
+
+void CaptureWriter::close()
+{
+    if (!m_writer.isOpen()) return;
+    writeIndexBlock();
+
+    char trailer[kTrailerSize];
+    qToLittleEndian<quint64>(quint64(m_lastIndexOffset), trailer);
+    std::memcpy(trailer + 8, kEndMagic, sizeof(kEndMagic));
+    m_writer.append(trailer, kTrailerSize);
+    m_writer.close();
+}
+
+void CaptureWriter::record(qint64 timestampNs, CaptureDirection direction, quint8 portId,
+                           const char *data, qsizetype len)
+{
+    if (!m_writer.isOpen() || len <= 0) return;
+
+    m_staging.resize(int(kRecordHeaderSize + len));
+    putRecordHeader(m_staging.data(), kDataRecord, direction, portId, quint32(len), timestampNs);
+    std::memcpy(m_staging.data() + kRecordHeaderSize, data, size_t(len));
+    // 偏移和索引只按写盘队列实际接受的字节推进, 被丢弃的记录在文件中不留空洞, 之后的索引仍然有效
+    if (!m_writer.append(m_staging)) {
+        m_droppedRecords.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (m_offset - m_lastEntryOffset >= kIndexStride) {
+        m_pending.append({timestampNs, m_offset});
+        m_lastEntryOffset = m_offset;
+    }
+    m_offset += kRecordHeaderSize + len;
+    m_lastTimestampNs = timestampNs;
+    if (m_offset - m_lastBlockOffset >= kIndexBlockBytes) writeIndexBlock();
+}
+
+void CaptureWriter::writeIndexBlock()
+{
+    if (m_pending.isEmpty()) return;
+
+    const quint32 payload = quint32(8 + 4 + m_pending.size() * 16);
+    QByteArray block(int(kRecordHeaderSize + payload), Qt::Uninitialized);
+    char *p = block.data();
+    putRecordHeader(p, kIndexRecord, CaptureDirection::Rx, 0, payload, m_lastTimestampNs);
+    p += kRecordHeaderSize;
+    qToLittleEndian<quint64>(quint64(m_lastIndexOffset), p);
+    qToLittleEndian<quint32>(quint32(m_pending.size()), p + 8);
+    p += 12;
+    for (const CaptureIndexEntry &entry : m_pending) {
+        qToLittleEndian<qint64>(entry.timestampNs, p);
+        qToLittleEndian<quint64>(quint64(entry.offset), p + 8);
+        p += 16;
+    }
+    // 索引块被丢弃时保留条目, 下次再写
+    if (!m_writer.append(block)) return;
+
+    m_lastIndexOffset = m_offset;
+    m_offset += block.size();
+    m_lastBlockOffset = m_offset;
+    m_pending.clear();
+}
+
+// ---------------------------------------------------------------- 读取
+
+CaptureReader::~CaptureReader()
+{
+    close();
+}
+
+bool CaptureReader::open(const QString &path, QString *errorString)
+{
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        if (errorString) *errorString = m_file.errorString();
+        return false;
+    }
+    m_size = m_file.size();
+    if (m_size < kFileHeaderSize) {
+        if (errorString) *errorString = "文件过短, 不是捕获文件";
+        m_file.close();
+        return false;
+    }
+    m_base = m_file.map(0, m_size);
+    if (!m_base) {
+        if (errorString) *errorString = m_file.errorString();
+        m_file.close();
+        return false;
+    }
+    if (std::memcmp(m_base, kMagic, sizeof(kMagic)) != 0
+        || qFromLittleEndian<quint16>(m_base + 8) != kVersion) {
+        if (errorString) *errorString = "不支持的捕获文件格式";
+        close();
+        return false;
+    }
+
+    m_dataEnd = m_size;
+    if (!loadIndexChain()) rebuildIndex();
+    return true;
+}
+
+void CaptureReader::close()
+{
+    if (m_base) m_file.unmap(const_cast<uchar *>(m_base));
+    m_base = nullptr;
+    m_size = 0;
+    m_dataEnd = 0;
+    m_index.clear();
+    if (m_file.isOpen()) m_file.close();
+}
+
+bool CaptureReader::readNext(qint64 offset, Record *record, qint64 *next) const
+{
+    while (offset >= kFileHeaderSize && offset + kRecordHeaderSize <= m_dataEnd) {
+        const uchar *p = m_base + offset;
+        const quint8 type = p[0];
+        const quint32 length = qFromLittleEndian<quint32>(p + 4);
+        const qint64 end = offset + kRecordHeaderSize + length;
+        if (end > m_dataEnd) return false;   // 记录被截断(写入时崩溃)
+
+        if (type == kDataRecord) {
+            record->offset = offset;
+            record->direction = CaptureDirection(p[1]);
+            record->portId = p[2];
+            record->length = length;
+            record->timestampNs = qFromLittleEndian<qint64>(p + 8);
+            record->data = reinterpret_cast<const char *>(p + kRecordHeaderSize);
+            if (next) *next = end;
+            return true;
+        }
+        offset = end;
+    }
+    return false;
+}
+
+qint64 CaptureReader::seekToTime(qint64 timestampNs) const
+{
+    // 先用稀疏索引定位到附近, 再顺序扫描最多 kIndexStride 字节
+    // 多条记录可以有相同的时间戳(如一次读取拆成的多条记录), 从第一个不早于目标的索引项的前一项开始,
+    // 其前面的同一时刻的记录才不会被跳过
+    auto it = std::lower_bound(m_index.cbegin(), m_index.cend(), timestampNs,
+                               [](const CaptureIndexEntry &e, qint64 ts) { return e.timestampNs < ts; });
+    qint64 offset = it == m_index.cbegin() ? firstOffset() : (it - 1)->offset;
+
+    Record record;
+    qint64 next = 0;
+    while (readNext(offset, &record, &next)) {
+        if (record.timestampNs >= timestampNs) return record.offset;
+        offset = next;
+    }
+    return m_dataEnd;
+}
+
+qint64 CaptureReader::firstTimestampNs() const
+{
+    Record record;
+    return readNext(firstOffset(), &record, nullptr) ? record.timestampNs : 0;
+}
+
+qint64 CaptureReader::lastTimestampNs() const
+{
+    qint64 offset = m_index.isEmpty() ? firstOffset() : m_index.last().offset;
+    qint64 last = 0;
+    Record record;
+    qint64 next = 0;
+    while (readNext(offset, &record, &next)) {
+        last = record.timestampNs;
+        offset = next;
+    }
+    return last;
+}
+
+QString CaptureReader::renderHex(const Record &record)
+{
+    return QString::fromLatin1(QByteArray::fromRawData(record.data, int(record.length)).toHex(' ').toUpper());
+}
+
+bool CaptureReader::loadIndexChain()
+{
+    if (m_size < kFileHeaderSize + kTrailerSize) return false;
+    const uchar *trailer = m_base + m_size - kTrailerSize;
+    if (std::memcmp(trailer + 8, kEndMagic, sizeof(kEndMagic)) != 0) return false;
+
+    m_dataEnd = m_size - kTrailerSize;
+    QVector<QVector<CaptureIndexEntry>> blocks;
+    qint64 offset = qint64(qFromLittleEndian<quint64>(trailer));
+    while (offset >= kFileHeaderSize) {
+        if (offset + kRecordHeaderSize + 12 > m_dataEnd) return false;
+        const uchar *p = m_base + offset;
+        const quint32 length = qFromLittleEndian<quint32>(p + 4);
+        if (p[0] != kIndexRecord || offset + kRecordHeaderSize + length > m_dataEnd) return false;
+
+        p += kRecordHeaderSize;
+        const qint64 prev = qint64(qFromLittleEndian<quint64>(p));
+        const quint32 count = qFromLittleEndian<quint32>(p + 8);
+        if (12 + qint64(count) * 16 > length || (prev != 0 && prev >= offset)) return false;
+        p += 12;
+
+        QVector<CaptureIndexEntry> entries(int(count));
+        for (quint32 i = 0; i < count; ++i, p += 16) {
+            entries[int(i)].timestampNs = qFromLittleEndian<qint64>(p);
+            entries[int(i)].offset = qint64(qFromLittleEndian<quint64>(p + 8));
+        }
+        blocks.append(entries);
+        offset = prev;
+    }
+
+    // 索引链是从后往前走的
+    m_index.clear();
+    for (int i = blocks.size() - 1; i >= 0; --i) m_index += blocks[i];
+    return true;
+}
+
+void CaptureReader::rebuildIndex()
+{
+    m_dataEnd = m_size;
+    m_index.clear();
+    qint64 lastEntry = -kIndexStride;
+    Record record;
+    qint64 offset = firstOffset();
+    qint64 next = 0;
+    while (readNext(offset, &record, &next)) {
+        if (record.offset - lastEntry >= kIndexStride) {
+            m_index.append({record.timestampNs, record.offset});
+            lastEntry = record.offset;
+        }
+        offset = next;
+    }
+}
@@ -0,0 +1,203 @@
+#include "capturereplayer.h"
+#include "serialworker.h"
+
+#include <QTimer>
+
+CaptureReplayer::CaptureReplayer(QObject *parent)
+    : QObject(parent)
+    , m_timer(new QTimer(this))   // 作为子对象, moveToThread 时一起迁移到I/O线程
+{
+    qRegisterMetaType<ReplayStats>();
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &CaptureReplayer::pump);
+}
+
+CaptureReplayer::~CaptureReplayer() = default;
+
+bool CaptureReplayer::open(const QString &path, QString *errorString)
+{
+    return m_reader.open(path, errorString);
+}
+
+QVector<quint8> CaptureReplayer::receivePortIds() const
+{
+    bool seen[256] = {};
+    CaptureReader::Record record;
+    qint64 offset = m_reader.firstOffset();
+    qint64 next = 0;
+    while (m_reader.readNext(offset, &record, &next)) {
+        if (record.direction == CaptureDirection::Rx) seen[record.portId] = true;
+        offset = next;
+    }
+    QVector<quint8> ids;
+    for (int id = 0; id < 256; ++id) {
+        if (seen[id]) ids.append(quint8(id));
+    }
+    return ids;
+}
+
+void CaptureReplayer::addTarget(quint8 capturePortId, SerialWorker *worker)
+{
+    m_targets.insert(capturePortId, worker);
+}
+
+void CaptureReplayer::start(double speed)
+{
+    if (m_stopped) return;
+    const qint64 now = SerialWorker::monotonicNs();
+    m_speed = qMax(0.0, speed);
+    m_running = true;
+    m_paused = false;
+    m_offset = m_reader.firstOffset();
+    m_haveRecord = false;
+    m_recordPos = 0;
+    m_stats = ReplayStats();
+    m_stats.positionNs = m_reader.firstTimestampNs();
+    m_runStartNs = now;
+    m_lastProgressNs = now;
+    rebase(m_stats.positionNs, now);
+    pump();
+}
+
+// 当前回放到的捕获时刻; 尽快模式下就是最后写入的记录
+qint64 CaptureReplayer::captureTimeNow(qint64 nowNs) const
+{
+    if (m_speed <= 0) return m_stats.positionNs;
+    return m_anchorCaptureNs + qint64((nowNs - m_anchorWallNs) * m_speed);
+}
+
+void CaptureReplayer::rebase(qint64 captureNs, qint64 nowNs)
+{
+    m_anchorCaptureNs = captureNs;
+    m_anchorWallNs = nowNs;
+}
+
+void CaptureReplayer::setSpeed(double speed)
+{
+    const qint64 now = SerialWorker::monotonicNs();
+    const qint64 captureNs = m_paused ? m_anchorCaptureNs : captureTimeNow(now);
+    m_speed = qMax(0.0, speed);
+    rebase(captureNs, now);
+    if (m_running && !m_paused) schedule(0);
+}
+
+void CaptureReplayer::setPaused(bool paused)
+{
+    if (!m_running || paused == m_paused) return;
+    const qint64 now = SerialWorker::monotonicNs();
+    if (paused) {
+        m_anchorCaptureNs = captureTimeNow(now);
+        m_stats.elapsedNs += now - m_runStartNs;
+        m_paused = true;
+        m_timer->stop();
+        return;
+    }
+    m_paused = false;
+    m_runStartNs = now;
+    rebase(m_anchorCaptureNs, now);
+    schedule(0);
+}
+
+// 跳转时丢弃当前记录未写完的部分; 暂停状态下只移动位置
+void CaptureReplayer::seek(qint64 timestampNs)
+{
+    if (!m_running) return;
+    const qint64 now = SerialWorker::monotonicNs();
+    m_offset = m_reader.seekToTime(timestampNs);
+    m_haveRecord = false;
+    m_recordPos = 0;
+    m_stats.positionNs = timestampNs;
+    rebase(timestampNs, now);
+    emit seeked(timestampNs);
+    if (!m_paused) schedule(0);
+}
+
+// 开始之前也可以停止, 之后 start() 不再生效; 两种情况都只通知一次 finished
+void CaptureReplayer::stop()
+{
+    finish(false);
+}
+
+void CaptureReplayer::schedule(qint64 delayNs)
+{
+    m_timer->start(int(qMin<qint64>((delayNs + 999999) / 1000000, 60 * 1000)));
+}
+
+void CaptureReplayer::finish(bool completed)
+{
+    if (m_stopped) return;
+    const qint64 now = SerialWorker::monotonicNs();
+    m_timer->stop();
+    if (m_running && !m_paused) m_stats.elapsedNs += now - m_runStartNs;
+    m_stats.finished = completed;
+    m_stats.finishedAtNs = now;
+    m_running = false;
+    m_paused = false;
+    m_stopped = true;
+    emit finished(m_stats);
+}
+
+// 写入所有已到时刻的记录, 然后定时到下一条记录的时刻
+// 每批最多 kBatchBytes, 同一线程中的真实串口不会因回放而推迟读取
+void CaptureReplayer::pump()
+{
+    if (!m_running || m_paused) return;
+    qint64 batchBytes = 0;
+    for (;;) {
+        if (!m_haveRecord) {
+            if (!m_reader.readNext(m_offset, &m_record, &m_next)) {
+                finish(true);
+                return;
+            }
+            m_haveRecord = true;
+            m_recordPos = 0;
+        }
+
+        SerialWorker *worker = m_record.direction == CaptureDirection::Rx ? m_targets.value(m_record.portId) : nullptr;
+        if (!worker || m_record.length == 0) {
+            m_offset = m_next;
+            m_haveRecord = false;
+            continue;
+        }
+
+        const qint64 now = SerialWorker::monotonicNs();
+        qint64 timestampNs = now;
+        if (m_speed > 0) {
+            // 时间戳取计划时刻而不是写入时刻, 定时器的毫秒级误差不会反映到显示和曲线上
+            timestampNs = m_anchorWallNs + qint64((m_record.timestampNs - m_anchorCaptureNs) / m_speed);
+            if (timestampNs > now) {
+                schedule(timestampNs - now);
+                break;
+            }
+        }
+        if (batchBytes >= kBatchBytes) {
+            schedule(0);
+            break;
+        }
+
+        const qint64 written = worker->injectReceived(timestampNs, m_record.data + m_recordPos,
+                                                      qint64(m_record.length - m_recordPos));
+        m_recordPos += quint32(written);
+        m_stats.bytes += quint64(written);
+        batchBytes += written;
+        if (m_recordPos < m_record.length) {
+            // 接收方来不及处理: 稍后从未写完的位置继续
+            ++m_stats.ringStalls;
+            schedule(1000000);
+            break;
+        }
+        ++m_stats.records;
+        m_stats.positionNs = m_record.timestampNs;
+        m_offset = m_next;
+        m_haveRecord = false;
+    }
+
+    const qint64 now = SerialWorker::monotonicNs();
+    if (now - m_lastProgressNs >= kProgressIntervalNs) {
+        m_lastProgressNs = now;
+        ReplayStats stats = m_stats;
+        stats.elapsedNs += now - m_runStartNs;
+        emit progress(stats);
+    }
+}
@@ -0,0 +1,108 @@
+#include "capturesearch.h"
+
+static inline int streamKey(quint8 portId, CaptureDirection direction)
+{
+    return portId * 2 + int(direction);
+}
+
+bool CaptureSearcher::open(const QString &path, QString *errorString)
+{
+    // 换了文件才丢弃索引; 同一文件只重新映射, 已有区域仍然有效(捕获文件只追加)
+    if (path != m_path) {
+        m_regions.clear();
+        m_lastByte.clear();
+        m_indexedEnd = 0;
+    }
+    m_reader.close();
+    if (!m_reader.open(path, errorString)) {
+        m_path.clear();
+        return false;
+    }
+    m_path = path;
+    extendIndex();
+    return true;
+}
+
+void CaptureSearcher::extendIndex()
+{
+    qint64 offset = m_indexedEnd ? m_indexedEnd : m_reader.firstOffset();
+    CaptureReader::Record record;
+    qint64 next = 0;
+    while (m_reader.readNext(offset, &record, &next)) {
+        if (m_regions.isEmpty() || m_regions.last().payloadBytes >= kRegionBytes) {
+            Region region;
+            region.firstOffset = record.offset;
+            m_regions.append(region);
+        }
+        Region &region = m_regions.last();
+        region.filter.add(record.data, record.length);
+
+        const int key = streamKey(record.portId, record.direction);
+        if (record.length > 0) {
+            auto last = m_lastByte.find(key);
+            if (last != m_lastByte.end()) region.filter.addPair(*last, record.data[0]);
+            m_lastByte[key] = record.data[record.length - 1];
+        }
+        region.payloadBytes += record.length;
+        region.endOffset = next;
+        offset = next;
+    }
+    m_indexedEnd = offset;
+}
+
+// 匹配最多跨越相邻两个区域(查询串远小于区域大小), 因此也检查与前后区域的并集
+bool CaptureSearcher::regionMayMatch(int i, const SearchQuery &query) const
+{
+    if (!query.isLiteral()) return true;
+    const BigramFilter &filter = m_regions.at(i).filter;
+    if (filter.mayContain(query.bytes)) return true;
+    if (i > 0 && filter.mayContain(query.bytes, &m_regions.at(i - 1).filter)) return true;
+    if (i + 1 < m_regions.size() && filter.mayContain(query.bytes, &m_regions.at(i + 1).filter)) return true;
+    return false;
+}
+
+QVector<CaptureSearcher::Hit> CaptureSearcher::search(const SearchQuery &query, int maxHits) const
+{
+    QVector<Hit> hits;
+    m_lastScanned = 0;
+    if (query.isEmpty() || !m_reader.isOpen()) return hits;
+
+    // 每个串口+方向保留上一条记录末尾 (查询长度-1) 个字节, 与下一条记录拼接后匹配
+    const qsizetype carryBytes = query.isLiteral() ? query.bytes.size() - 1 : 0;
+    QHash<int, QByteArray> carry;
+    QByteArray joined;
+    bool previousScanned = false;
+
+    for (int i = 0; i < m_regions.size() && hits.size() < maxHits; ++i) {
+        if (!regionMayMatch(i, query)) {
+            previousScanned = false;
+            continue;
+        }
+        // 上一个区域被跳过时拼接缓冲已失效; 跨越该交界的匹配会让上一个区域也被扫描
+        if (!previousScanned) carry.clear();
+        previousScanned = true;
+        ++m_lastScanned;
+
+        const Region &region = m_regions.at(i);
+        qint64 offset = region.firstOffset;
+        CaptureReader::Record record;
+        qint64 next = 0;
+        while (offset < region.endOffset && m_reader.readNext(offset, &record, &next)) {
+            offset = next;
+            if (carryBytes == 0) {
+                if (query.indexIn(record.data, record.length) >= 0)
+                    hits.append({record.offset, record.timestampNs, record.portId, record.direction});
+            } else {
+                QByteArray &tail = carry[streamKey(record.portId, record.direction)];
+                joined = tail;
+                joined.append(record.data, int(record.length));
+                if (query.indexIn(joined.constData(), joined.size()) >= 0)
+                    hits.append({record.offset, record.timestampNs, record.portId, record.direction});
+                // 保留的字节比查询串短, 不会单独构成匹配, 同一处匹配不会被重复报告
+                tail = joined.right(int(carryBytes));
+            }
+            if (hits.size() >= maxHits) break;
+        }
+    }
+    return hits;
+}
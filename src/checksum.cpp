@@ -0,0 +1,142 @@
+#include "checksum.h"
+
+#include <atomic>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define CHECKSUM_X86_64 1
+#include <immintrin.h>
+#include <cstring>
+#endif
+
+namespace Checksum {
+
+uint32_t sum8(const uint8_t *data, size_t n)
+{
+    // 累加到32位再截断, 循环可以向量化
+    uint32_t sum = 0;
+    for (size_t i = 0; i < n; ++i) sum += data[i];
+    return sum & 0xFF;
+}
+
+uint32_t xor8(const uint8_t *data, size_t n)
+{
+    uint8_t x = 0;
+    for (size_t i = 0; i < n; ++i) x ^= data[i];
+    return x;
+}
+
+namespace {
+
+uint32_t none(const uint8_t *, size_t)
+{
+    return 0;
+}
+
+#ifdef CHECKSUM_X86_64
+// SSE4.2 的 crc32 指令就是反射的 CRC-32C, 每条处理8字节
+__attribute__((target("sse4.2"))) uint32_t crc32cHardware(const uint8_t *data, size_t n)
+{
+    uint64_t crc = 0xFFFFFFFFu;
+    while (n >= 8) {
+        uint64_t word;
+        std::memcpy(&word, data, 8);
+        crc = _mm_crc32_u64(crc, word);
+        data += 8;
+        n -= 8;
+    }
+    uint32_t crc32 = uint32_t(crc);
+    for (; n > 0; --n, ++data) crc32 = _mm_crc32_u8(crc32, *data);
+    return crc32 ^ 0xFFFFFFFFu;
+}
+#endif
+
+std::atomic<bool> g_forceTable{false};
+
+uint32_t crc32cDispatch(const uint8_t *data, size_t n)
+{
+#ifdef CHECKSUM_X86_64
+    static const bool hardware = (__builtin_cpu_init(), __builtin_cpu_supports("sse4.2"));
+    if (hardware && !g_forceTable.load(std::memory_order_relaxed)) return crc32cHardware(data, n);
+#endif
+    return Crc32C::compute(data, n);
+}
+
+const Algorithm kAlgorithms[int(Kind::Count)] = {
+    {Kind::None,        "none",        0, false, 0,          none},
+    {Kind::Sum8,        "sum8",        1, false, 0xDD,       sum8},
+    {Kind::Xor8,        "xor8",        1, false, 0x31,       xor8},
+    {Kind::Crc8,        "crc8",        1, true,  0xF4,       Crc8::compute},
+    {Kind::Crc8Maxim,   "crc8maxim",   1, false, 0xA1,       Crc8Maxim::compute},
+    {Kind::Crc16Modbus, "crc16modbus", 2, false, 0x4B37,     Crc16Modbus::compute},
+    {Kind::Crc16Ccitt,  "crc16ccitt",  2, true,  0x29B1,     Crc16Ccitt::compute},
+    {Kind::Crc16Xmodem, "crc16xmodem", 2, true,  0x31C3,     Crc16Xmodem::compute},
+    {Kind::Crc16Kermit, "crc16kermit", 2, false, 0x2189,     Crc16Kermit::compute},
+    {Kind::Crc16X25,    "crc16x25",    2, false, 0x906E,     Crc16X25::compute},
+    {Kind::Crc16Arc,    "crc16arc",    2, false, 0xBB3D,     Crc16Arc::compute},
+    {Kind::Crc32,       "crc32",       4, false, 0xCBF43926, Crc32::compute},
+    {Kind::Crc32C,      "crc32c",      4, false, 0xE3069283, crc32cDispatch},
+    {Kind::Crc32Mpeg2,  "crc32mpeg2",  4, true,  0x0376E6E7, Crc32Mpeg2::compute},
+};
+
+} // namespace
+
+const Algorithm &algorithm(Kind kind)
+{
+    return kAlgorithms[int(kind)];
+}
+
+bool kindForName(const QString &name, Kind *kind)
+{
+    const QString lower = name.trimmed().toLower();
+    for (const Algorithm &a : kAlgorithms) {
+        if (lower == QLatin1String(a.name)) {
+            *kind = a.kind;
+            return true;
+        }
+    }
+    return false;
+}
+
+QStringList names()
+{
+    QStringList result;
+    for (const Algorithm &a : kAlgorithms) result.append(a.name);
+    return result;
+}
+
+bool verify(Kind kind, const uint8_t *data, size_t n, const uint8_t *check)
+{
+    const Algorithm &a = algorithm(kind);
+    const uint32_t value = a.compute(data, n);
+    for (int i = 0; i < a.size; ++i) {
+        const int shift = a.bigEndian ? (a.size - 1 - i) * 8 : i * 8;
+        if (check[i] != uint8_t(value >> shift)) return false;
+    }
+    return true;
+}
+
+void append(Kind kind, QByteArray *data)
+{
+    const Algorithm &a = algorithm(kind);
+    const uint32_t value = a.compute(reinterpret_cast<const uint8_t *>(data->constData()), size_t(data->size()));
+    for (int i = 0; i < a.size; ++i) {
+        const int shift = a.bigEndian ? (a.size - 1 - i) * 8 : i * 8;
+        data->append(char(value >> shift));
+    }
+}
+
+const char *activeIsa()
+{
+#ifdef CHECKSUM_X86_64
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2") && !g_forceTable.load(std::memory_order_relaxed)) return "sse4.2";
+#endif
+    return "slice-by-8";
+}
+
+void forceTable(bool table)
+{
+    g_forceTable.store(table, std::memory_order_relaxed);
+}
+
+} // namespace Checksum
@@ -0,0 +1,92 @@
+#include "datarender.h"
+#include "hexkernels.h"
+
+namespace DataRender {
+
+QString render(const QByteArray &data, Mode mode, QByteArray *scratch)
+{
+    switch (mode) {
+    case Mode::Hex:    return hexSpaced(data, scratch);
+    case Mode::Escape: return escapeControlChars(data);
+    case Mode::Filter: return filterControlChars(data);
+    }
+    return QString();
+}
+
+void appendRendered(QByteArray *out, const char *data, qsizetype n, Mode mode)
+{
+    switch (mode) {
+    case Mode::Hex:    appendHexSpaced(out, data, n); break;
+    case Mode::Escape: appendEscaped(out, data, n); break;
+    case Mode::Filter: appendFiltered(out, data, n); break;
+    }
+}
+
+// 一次编码直接生成大写带空格的结果
+void appendHexSpaced(QByteArray *out, const char *data, qsizetype n)
+{
+    const int start = out->size();
+    out->resize(start + int(HexKernels::encodedSpacedSize(size_t(n))));
+    HexKernels::encodeSpacedUpper(reinterpret_cast<const uint8_t *>(data), size_t(n), out->data() + start);
+}
+
+// 转义控制字符
+// 在UTF-8解码前按字节处理: 向量化扫描找到控制字节, 其间的普通字节整段拷贝
+void appendEscaped(QByteArray *out, const char *data, qsizetype n)
+{
+    static const char digits[] = "0123456789abcdef";
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(data);
+    size_t pos = 0;
+    while (pos < size_t(n)) {
+        // 转义ASCII控制字符(0x00-0x1F)，但保留换行、回车和制表符
+        const size_t hit = pos + HexKernels::findControl(p + pos, size_t(n) - pos);
+        out->append(data + pos, int(hit - pos));
+        if (hit == size_t(n)) break;
+        const char escaped[4] = {'\\', 'x', digits[p[hit] >> 4], digits[p[hit] & 0x0F]};
+        out->append(escaped, 4);
+        pos = hit + 1;
+    }
+}
+
+// 过滤控制字符: 保留可见字符和必要的空白字符
+void appendFiltered(QByteArray *out, const char *data, qsizetype n)
+{
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(data);
+    size_t pos = 0;
+    while (pos < size_t(n)) {
+        const size_t hit = pos + HexKernels::findControl(p + pos, size_t(n) - pos);
+        out->append(data + pos, int(hit - pos));
+        pos = hit + 1;
+    }
+}
+
+QString hexSpaced(const QByteArray &data, QByteArray *scratch)
+{
+    QByteArray local;
+    QByteArray &buffer = scratch ? *scratch : local;
+    buffer.resize(0);
+    appendHexSpaced(&buffer, data.constData(), data.size());
+    return QString::fromLatin1(buffer);
+}
+
+QString escapeControlChars(const QByteArray &input)
+{
+    QByteArray result;
+    result.reserve(input.size() + 16);
+    appendEscaped(&result, input.constData(), input.size());
+    return QString::fromUtf8(result);
+}
+
+QString filterControlChars(const QByteArray &input)
+{
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(input.constData());
+    if (HexKernels::findControl(p, size_t(input.size())) == size_t(input.size()))
+        return QString::fromUtf8(input);   // 常见情况: 没有控制字符, 直接解码
+
+    QByteArray result;
+    result.reserve(input.size());
+    appendFiltered(&result, input.constData(), input.size());
+    return QString::fromUtf8(result);
+}
+
+} // namespace DataRender
@@ -0,0 +1,253 @@
+#include "frameparser.h"
+
+#include <QStringList>
+#include <cstring>
+
+namespace {
+
+// 在 [data, data+len) 中从 from 开始查找 needle, 不分配内存
+qsizetype findBytes(const char *data, qsizetype len, const QByteArray &needle, qsizetype from)
+{
+    const qsizetype nsize = needle.size();
+    const char first = needle.at(0);
+    const char *p = data + from;
+    const char *last = data + len - nsize;
+    while (p <= last) {
+        p = static_cast<const char *>(std::memchr(p, first, size_t(last - p + 1)));
+        if (!p) return -1;
+        if (std::memcmp(p + 1, needle.constData() + 1, size_t(nsize - 1)) == 0) return p - data;
+        ++p;
+    }
+    return -1;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------- FrameSpec
+
+int FrameSpec::checksumSize() const
+{
+    return Checksum::algorithm(checksum).size;
+}
+
+bool FrameSpec::isValid() const
+{
+    const int modes = (fixedLength > 0) + (lengthOffset >= 0) + (!delimiter.isEmpty());
+    if (modes != 1 || maxFrameLength <= 0) return false;
+    if (fixedLength > 0 && fixedLength < header.size() + checksumSize()) return false;
+    if (lengthOffset >= 0 && lengthSize != 1 && lengthSize != 2 && lengthSize != 4) return false;
+    return true;
+}
+
+FrameSpec FrameSpec::parse(const QString &text, QString *errorString)
+{
+    FrameSpec spec;
+    auto fail = [&](const QString &message) {
+        if (errorString) *errorString = message;
+        return FrameSpec();
+    };
+
+    const QStringList items = text.split(';', Qt::SkipEmptyParts);
+    for (const QString &item : items) {
+        const int eq = item.indexOf('=');
+        if (eq <= 0) return fail("缺少'=': " + item);
+        const QString key = item.left(eq).trimmed().toLower();
+        const QString value = item.mid(eq + 1).trimmed();
+        bool ok = true;
+
+        if (key == "head") {
+            spec.header = QByteArray::fromHex(value.toLatin1());
+            ok = !spec.header.isEmpty();
+        } else if (key == "fixed") {
+            spec.fixedLength = value.toInt(&ok);
+        } else if (key == "len") {
+            const QStringList parts = value.split(':');
+            if (parts.size() < 2) return fail("len 格式为 偏移:字节数[:be]");
+            bool ok2 = false;
+            spec.lengthOffset = parts[0].toInt(&ok);
+            spec.lengthSize = parts[1].toInt(&ok2);
+            ok = ok && ok2;
+            spec.lengthBigEndian = parts.size() > 2 && parts[2].compare("be", Qt::CaseInsensitive) == 0;
+        } else if (key == "adj") {
+            spec.lengthAdjust = value.toInt(&ok);
+        } else if (key == "delim") {
+            spec.delimiter = QByteArray::fromHex(value.toLatin1());
+            ok = !spec.delimiter.isEmpty();
+        } else if (key == "check") {
+            ok = Checksum::kindForName(value, &spec.checksum);
+        } else if (key == "max") {
+            spec.maxFrameLength = value.toInt(&ok);
+        } else {
+            return fail("未知的键: " + key);
+        }
+        if (!ok) return fail("无效的值: " + item);
+    }
+
+    if (!spec.isValid()) return fail("必须且只能指定 fixed/len/delim 中的一种");
+    return spec;
+}
+
+// ---------------------------------------------------------------- FrameParser
+
+void FrameParser::setSpec(const FrameSpec &spec)
+{
+    m_spec = spec;
+    reset();
+}
+
+void FrameParser::reset()
+{
+    m_pending.clear();
+    m_frames = 0;
+    m_checksumErrors = 0;
+    m_discardedBytes = 0;
+}
+
+// 第一个可能是帧头的位置; 末尾不完整但前缀匹配的也算, 等待更多数据再判断
+qsizetype FrameParser::findHeader(const char *data, qsizetype len) const
+{
+    const QByteArray &header = m_spec.header;
+    const qsizetype hsize = header.size();
+    const char first = header.at(0);
+    const char *p = data;
+    const char *end = data + len;
+    while (p < end) {
+        p = static_cast<const char *>(std::memchr(p, first, size_t(end - p)));
+        if (!p) return -1;
+        const qsizetype cmp = qMin(hsize, qsizetype(end - p));
+        if (std::memcmp(p + 1, header.constData() + 1, size_t(cmp - 1)) == 0) return p - data;
+        ++p;
+    }
+    return -1;
+}
+
+// 返回帧总长; 数据不足以判断时置 *needMore, 长度非法时返回 -1
+qsizetype FrameParser::frameLengthAt(const char *frame, qsizetype avail, bool *needMore) const
+{
+    *needMore = false;
+    if (m_spec.fixedLength > 0) return m_spec.fixedLength;
+
+    const qsizetype fieldEnd = m_spec.lengthOffset + m_spec.lengthSize;
+    if (avail < fieldEnd) {
+        *needMore = true;
+        return 0;
+    }
+    const uchar *p = reinterpret_cast<const uchar *>(frame + m_spec.lengthOffset);
+    quint32 value = 0;
+    for (int i = 0; i < m_spec.lengthSize; ++i) {
+        const int shift = m_spec.lengthBigEndian ? (m_spec.lengthSize - 1 - i) * 8 : i * 8;
+        value |= quint32(p[i]) << shift;
+    }
+    const qint64 total = qint64(value) + m_spec.lengthAdjust;
+    const qint64 minimum = qMax<qint64>(fieldEnd, m_spec.header.size()) + m_spec.checksumSize();
+    if (total < minimum || total > m_spec.maxFrameLength) return -1;
+    return qsizetype(total);
+}
+
+bool FrameParser::verify(const char *frame, qsizetype size) const
+{
+    const int csize = m_spec.checksumSize();
+    if (csize == 0) return true;
+
+    const qsizetype covered = size - m_spec.delimiter.size() - csize;
+    if (covered < 0) return false;
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(frame);
+    return Checksum::verify(m_spec.checksum, p, size_t(covered), p + covered);
+}
+
+// 残余帧的起点已经确定(drain 停在可能的帧首), 按分帧方式估算缺少的字节;
+// 结束符分帧时无法预知帧长, 取到输入中第一个结束符为止, 最多补到最大帧长
+qsizetype FrameParser::pendingNeed(const char *data, qsizetype len) const
+{
+    const qsizetype have = m_pending.size();
+    const qsizetype hsize = m_spec.header.size();
+    if (have < hsize) return hsize - have;
+
+    if (!m_spec.delimiter.isEmpty()) {
+        const qsizetype limit = qMin<qsizetype>(len, qMax<qsizetype>(1, m_spec.maxFrameLength - have));
+        // 跨接缝的结束符在输入前 delim.size()-1 字节内结束, 取到输入中的第一个结束符也能覆盖
+        const qsizetype idx = findBytes(data, limit, m_spec.delimiter, 0);
+        return idx < 0 ? limit : idx + m_spec.delimiter.size();
+    }
+
+    qsizetype size = m_spec.fixedLength;
+    if (size <= 0) {
+        const qsizetype fieldEnd = m_spec.lengthOffset + m_spec.lengthSize;
+        if (have < fieldEnd) return fieldEnd - have;
+        bool needMore = false;
+        size = frameLengthAt(m_pending.constData(), have, &needMore);
+    }
+    return qMax<qsizetype>(1, size - have);
+}
+
+FrameParser::Result FrameParser::scan(const char *data, qsizetype len, qsizetype *frameStart,
+                                      qsizetype *frameSize, qsizetype *consumed)
+{
+    const qsizetype hsize = m_spec.header.size();
+    qsizetype pos = 0;
+
+    for (;;) {
+        if (hsize > 0) {
+            const qsizetype h = findHeader(data + pos, len - pos);
+            if (h < 0) {
+                m_discardedBytes += quint64(len - pos);
+                *consumed = len;
+                return Result::NeedMore;
+            }
+            m_discardedBytes += quint64(h);
+            pos += h;
+        }
+
+        const char *frame = data + pos;
+        const qsizetype avail = len - pos;
+        if (avail < qMax<qsizetype>(hsize, 1)) {
+            *consumed = pos;
+            return Result::NeedMore;
+        }
+
+        qsizetype size = 0;
+        if (!m_spec.delimiter.isEmpty()) {
+            const QByteArray &delim = m_spec.delimiter;
+            const qsizetype limit = qMin<qsizetype>(avail, m_spec.maxFrameLength);
+            const qsizetype idx = findBytes(frame, limit, delim, hsize);
+            if (idx < 0) {
+                if (avail < m_spec.maxFrameLength) {
+                    *consumed = pos;
+                    return Result::NeedMore;
+                }
+                // 超过最大帧长仍未找到结束符
+                const qsizetype skip = hsize > 0 ? 1 : limit;
+                m_discardedBytes += quint64(skip);
+                pos += skip;
+                continue;
+            }
+            size = idx + delim.size();
+        } else {
+            bool needMore = false;
+            size = frameLengthAt(frame, avail, &needMore);
+            if (needMore || (size > 0 && size > avail)) {
+                *consumed = pos;
+                return Result::NeedMore;
+            }
+            if (size < 0) {
+                ++m_discardedBytes;
+                ++pos;
+                continue;
+            }
+        }
+
+        if (!verify(frame, size)) {
+            ++m_checksumErrors;
+            // 有帧头时只跳过一个字节重新同步, 否则整帧丢弃
+            const qsizetype skip = hsize > 0 ? 1 : size;
+            m_discardedBytes += quint64(skip);
+            pos += skip;
+            continue;
+        }
+
+        *frameStart = pos;
+        *frameSize = size;
+        *consumed = pos + size;
+        return Result::Frame;
+    }
+}
@@ -0,0 +1,532 @@
+#include "headless.h"
+#include "alarmengine.h"
+#include "datarender.h"
+#include "frameparser.h"
+#include "portbridge.h"
+#include "portdiscovery.h"
+#include "receiveformatter.h"
+#include "serialsession.h"
+#include "serialworker.h"
+#include "sessionmanager.h"
+#include "statscollector.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QHash>
+#include <QSet>
+#include <QTextStream>
+#include <QTimer>
+#include <csignal>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+volatile std::sig_atomic_t g_stopRequested = 0;
+volatile std::sig_atomic_t g_triggerRequested = 0;
+
+void onStopSignal(int)
+{
+    g_stopRequested = 1;
+}
+
+void onTriggerSignal(int)
+{
+    g_triggerRequested = 1;
+}
+
+// 未知的名称返回 false, 不按默认值打开串口
+bool parseParity(const QString &name, QSerialPort::Parity *parity)
+{
+    const QString n = name.toLower();
+    if (n == "none")       *parity = QSerialPort::NoParity;
+    else if (n == "even")  *parity = QSerialPort::EvenParity;
+    else if (n == "odd")   *parity = QSerialPort::OddParity;
+    else if (n == "mark")  *parity = QSerialPort::MarkParity;
+    else if (n == "space") *parity = QSerialPort::SpaceParity;
+    else return false;
+    return true;
+}
+
+bool parseStopBits(const QString &name, QSerialPort::StopBits *stopBits)
+{
+    if (name == "1")        *stopBits = QSerialPort::OneStop;
+    else if (name == "1.5") *stopBits = QSerialPort::OneAndHalfStop;
+    else if (name == "2")   *stopBits = QSerialPort::TwoStop;
+    else return false;
+    return true;
+}
+
+bool parseFlowControl(const QString &name, QSerialPort::FlowControl *flowControl)
+{
+    const QString n = name.toLower();
+    if (n == "none")         *flowControl = QSerialPort::NoFlowControl;
+    else if (n == "rtscts")  *flowControl = QSerialPort::HardwareControl;
+    else if (n == "xonxoff") *flowControl = QSerialPort::SoftwareControl;
+    else return false;
+    return true;
+}
+
+} // namespace
+
+bool isHeadlessInvocation(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--headless") == 0) return true;
+    }
+    return false;
+}
+
+int runHeadless(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("app0");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("PyroCom 无界面串口采集");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"headless", "无界面模式"},
+        {"port", "串口名, 可重复指定以同时打开多个串口", "name"},
+        {"baud", "波特率(默认115200)", "rate", "115200"},
+        {"databits", "数据位 5-8(默认8)", "bits", "8"},
+        {"parity", "校验位 none/even/odd/mark/space", "parity", "none"},
+        {"stopbits", "停止位 1/1.5/2", "bits", "1"},
+        {"flow", "流控 none/rtscts/xonxoff", "mode", "none"},
+        {"read-buffer", "QSerialPort 读缓冲上限(KB), 0 为不限", "kb", "0"},
+        {"low-latency", "Linux: 设置 ASYNC_LOW_LATENCY, FTDI 适配器 latency_timer 改为 1 ms"},
+        {"capture", "原始二进制捕获文件", "file"},
+        {"log", "文本日志文件, 多个串口时文件名后加端口名", "file"},
+        {"append", "日志追加而不是覆盖"},
+        {"log-max-mb", "日志达到指定大小(MB)时切换分段", "mb"},
+        {"log-max-minutes", "日志每隔指定分钟切换分段", "minutes"},
+        {"log-gzip", "在后台把关闭的日志分段压缩为 .gz"},
+        {"log-keep-mb", "日志分段总大小上限(MB), 超出时删除最旧的分段", "mb"},
+        {"frame", "帧格式, 如 head=AA55;len=2:1;adj=4;check=sum8", "spec"},
+        {"hex", "以十六进制输出"},
+        {"escape", "文本输出时转义控制字符"},
+        {"quiet", "不输出到标准输出"},
+        {"duration", "运行指定秒数后退出", "seconds"},
+        {"stats", "每秒追加一行统计, .json/.jsonl 为 JSON Lines, 其他为 CSV", "file"},
+        {"reconnect", "USB适配器拔出后等待重新插入并自动重连"},
+        {"replay", "回放原始捕获文件, 经过与串口相同的分帧/输出/日志路径, 结束后退出", "file"},
+        {"speed", "回放倍速(默认1), 0 为尽快, 结束时输出整条接收路径的吞吐", "factor", "1"},
+        {"bridge", "把串口共享给本地客户端: tcp:端口 / tcp:地址:端口 / unix:路径, 第n个对应第n个 --port",
+         "address"},
+        {"bridge-policy", "慢客户端处理: drop(跳过积压) / disconnect(断开)", "policy", "drop"},
+        {"bridge-max-lag", "客户端落后超过指定大小(KB)时按策略处理", "kb", "1024"},
+        {"bridge-readonly", "丢弃客户端发来的数据, 只转发接收"},
+        {"trigger", "触发捕获: 收发数据只保存在内存环中, 触发时写出前后窗口, "
+                    "如 buffer=64;pre=30;post=10;pattern=55AA;error;checksum; SIGUSR1 为手动触发", "spec"},
+        {"trigger-dir", "触发捕获文件的保存目录(默认当前目录)", "dir"},
+        {"alarms", "报警规则文件, 每行一条, 如 name=超压;text=E201;action=status,command;cmd=...", "file"},
+    });
+    parser.process(app);
+
+    QTextStream err(stderr);
+    const QStringList ports = parser.values("port");
+    const QString replayPath = parser.value("replay");
+    if (ports.isEmpty() && replayPath.isEmpty()) {
+        err << "必须用 --port 指定至少一个串口, 或用 --replay 指定捕获文件\n";
+        return 1;
+    }
+
+    FrameSpec frameSpec;
+    if (parser.isSet("frame")) {
+        QString error;
+        frameSpec = FrameSpec::parse(parser.value("frame"), &error);
+        if (!frameSpec.isValid()) {
+            err << "无效的帧格式: " << error << "\n";
+            return 1;
+        }
+    }
+
+    TriggerSpec triggerSpec;
+    if (parser.isSet("trigger")) {
+        QString error;
+        if (!TriggerSpec::parse(parser.value("trigger"), &triggerSpec, &error)) {
+            err << "无效的触发格式: " << error << "\n";
+            return 1;
+        }
+        if (triggerSpec.onChecksum && !frameSpec.isValid()) {
+            err << "checksum 触发需要用 --frame 指定带校验的帧格式\n";
+            return 1;
+        }
+    }
+
+    // 无界面时 status 输出到标准错误, sound 为终端响铃, highlight 不适用
+    AlarmEngine alarms;
+    if (parser.isSet("alarms")) {
+        QFile file(parser.value("alarms"));
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            err << "无法打开报警规则文件: " << file.errorString() << "\n";
+            return 1;
+        }
+        QVector<AlarmRule> rules;
+        QString error;
+        if (!AlarmRule::parseList(QString::fromUtf8(file.readAll()), &rules, &error)) {
+            err << "无效的报警规则: " << error << "\n";
+            return 1;
+        }
+        alarms.setRules(rules);
+    }
+
+    // 数值参数必须能解析且在范围内, 否则 toInt 返回的 0 会被当成"不限"等默认含义
+    const qint64 kIntMax = std::numeric_limits<int>::max();
+    qint64 baud = 0, dataBits = 0, readBufferKb = 0, bridgeMaxLagKb = 0;
+    double logMaxMb = 0, logMaxMinutes = 0, logKeepMb = 0, speed = 1, duration = 0;
+    auto integerOption = [&](const char *name, qint64 minimum, qint64 maximum, qint64 *value) {
+        bool ok = false;
+        *value = parser.value(name).toLongLong(&ok);
+        if (ok && *value >= minimum && *value <= maximum) return true;
+        err << "无效的 --" << name << ": " << parser.value(name) << "\n";
+        return false;
+    };
+    auto numberOption = [&](const char *name, double maximum, double *value) {
+        if (!parser.isSet(name)) return true;
+        bool ok = false;
+        *value = parser.value(name).toDouble(&ok);
+        if (ok && *value >= 0 && *value <= maximum) return true;
+        err << "无效的 --" << name << ": " << parser.value(name) << "\n";
+        return false;
+    };
+    const double unbounded = std::numeric_limits<double>::max();
+    if (!integerOption("baud", 1, std::numeric_limits<qint32>::max(), &baud)
+        || !integerOption("databits", 5, 8, &dataBits)
+        || !integerOption("read-buffer", 0, kIntMax, &readBufferKb)
+        || !integerOption("bridge-max-lag", 0, kIntMax, &bridgeMaxLagKb)
+        || !numberOption("log-max-mb", unbounded, &logMaxMb)
+        || !numberOption("log-max-minutes", unbounded, &logMaxMinutes)
+        || !numberOption("log-keep-mb", unbounded, &logKeepMb)
+        || !numberOption("speed", unbounded, &speed)
+        || !numberOption("duration", double(kIntMax / 1000), &duration)) {   // 定时器以 int 毫秒计
+        return 1;
+    }
+
+    PortSettings portSettings;
+    portSettings.baudRate = qint32(baud);
+    portSettings.dataBits = static_cast<QSerialPort::DataBits>(dataBits);
+    if (!parseParity(parser.value("parity"), &portSettings.parity)) {
+        err << "无效的 --parity: " << parser.value("parity") << "\n";
+        return 1;
+    }
+    if (!parseStopBits(parser.value("stopbits"), &portSettings.stopBits)) {
+        err << "无效的 --stopbits: " << parser.value("stopbits") << "\n";
+        return 1;
+    }
+    if (!parseFlowControl(parser.value("flow"), &portSettings.flowControl)) {
+        err << "无效的 --flow: " << parser.value("flow") << "\n";
+        return 1;
+    }
+    portSettings.readBufferSize = readBufferKb * 1024;
+    portSettings.lowLatency = parser.isSet("low-latency");
+    if (!ports.isEmpty()) {
+        QString error;
+        if (!portSettings.validate(&error)) {
+            err << "串口参数无效: " << error << "\n";
+            return 1;
+        }
+    }
+
+    BridgeOptions bridgeOptions;
+    bridgeOptions.maxLagBytes = bridgeMaxLagKb * 1024;
+    bridgeOptions.readOnly = parser.isSet("bridge-readonly");
+    const QStringList bridgeAddresses = parser.values("bridge");
+    if (bridgeAddresses.size() > ports.size()) {
+        err << "--bridge 的个数不能多于 --port\n";
+        return 1;
+    }
+    if (!BridgeOptions::parsePolicy(parser.value("bridge-policy"), &bridgeOptions.policy)) {
+        err << "未知的桥接策略: " << parser.value("bridge-policy") << "\n";
+        return 1;
+    }
+
+    const DataRender::Mode mode = parser.isSet("hex") ? DataRender::Mode::Hex
+                                : parser.isSet("escape") ? DataRender::Mode::Escape
+                                                         : DataRender::Mode::Filter;
+    const bool quiet = parser.isSet("quiet");
+    const QString logPath = parser.value("log");
+    const bool append = parser.isSet("append");
+    LogRotation rotation;
+    rotation.maxSegmentBytes = qint64(logMaxMb * 1048576);
+    rotation.maxSegmentSeconds = qint64(logMaxMinutes * 60);
+    rotation.compress = parser.isSet("log-gzip");
+    rotation.retentionBytes = qint64(logKeepMb * 1048576);
+
+    SessionManager sessions;
+    sessions.setCapturePath(parser.value("capture"));
+    if (parser.isSet("trigger")) sessions.enableTriggerCapture(triggerSpec, parser.value("trigger-dir"));
+    StatsCollector stats(&sessions);
+    if (parser.isSet("stats")) {
+        const QString statsPath = parser.value("stats");
+        QString error;
+        if (!stats.setExportPath(statsPath, StatsCollector::formatForPath(statsPath), &error)) {
+            err << "无法打开统计文件: " << error << "\n";
+            return 1;
+        }
+        stats.start();
+    }
+    PortDiscovery discovery;
+    if (parser.isSet("reconnect")) {
+        sessions.setAutoReconnect(&discovery);
+        discovery.start();
+    }
+    // 按端口名找到桥接; 重连后设备名可能变化, 随会话更新
+    QHash<QString, PortBridge *> bridges;
+    QHash<SerialSession *, PortBridge *> sessionBridges;
+    for (int i = 0; i < bridgeAddresses.size(); ++i) {
+        PortBridge *bridge = new PortBridge(bridgeOptions, &sessions);
+        QString error;
+        if (!bridge->listen(bridgeAddresses.at(i), &error)) {
+            err << "无法监听 " << bridgeAddresses.at(i) << ": " << error << "\n";
+            return 1;
+        }
+        const QString portName = ports.at(i);
+        QObject::connect(bridge, &PortBridge::clientsChanged, [&err, portName](int count) {
+            err << "桥接 " << portName << ": " << count << " 个客户端\n";
+            err.flush();
+        });
+        QObject::connect(bridge, &PortBridge::clientDropped, [&err, portName](const QString &peer, const QString &reason) {
+            err << "桥接 " << portName << ": " << peer << " " << reason << "\n";
+            err.flush();
+        });
+        err << "桥接 " << portName << " 监听 " << bridge->address() << "\n";
+        bridges.insert(portName, bridge);
+    }
+    auto attachBridge = [&](SerialSession *session, const QString &portName) {
+        PortBridge *bridge = bridges.take(portName);
+        if (!bridge) return;
+        bridges.insert(session->portName(), bridge);
+        sessionBridges.insert(session, bridge);
+        bridge->setSession(session);
+    };
+
+    int pending = ports.size();
+    int failures = 0;
+    QSet<SerialSession *> reconnecting;
+
+    QObject::connect(&sessions, &SessionManager::reconnecting, [&](SerialSession *session, const QString &previousName) {
+        err << "重新连接 " << previousName << "\n";
+        err.flush();
+        reconnecting.insert(session);
+        attachBridge(session, previousName);
+        QObject::connect(session, &QObject::destroyed, [&reconnecting, session]() { reconnecting.remove(session); });
+        if (frameSpec.isValid()) session->frameParser().setSpec(frameSpec);
+        // 重连后日志总是追加
+        if (!logPath.isEmpty()) {
+            const QString path = ports.size() > 1 ? SessionManager::perPortPath(logPath, previousName) : logPath;
+            session->logWriter().setRotation(rotation);
+            session->logWriter().open(path, true);
+        }
+    });
+    QObject::connect(&sessions, &SessionManager::sessionClosed, [&](SerialSession *session) {
+        reconnecting.remove(session);
+        sessionBridges.remove(session);
+        if (sessions.isAwaitingReconnect(session->portName())) {
+            err << "已断开 " << session->portName() << ", 等待重新插入\n";
+            err.flush();
+        }
+    });
+    QObject::connect(&sessions, &SessionManager::sessionOpened, [&](SerialSession *session) {
+        err << "已打开 " << session->portName() << "\n";
+        err.flush();
+        // 断线前未完成的部分匹配不能与重连后的数据拼接
+        alarms.resetStream(session->portId());
+        if (reconnecting.remove(session)) return;
+        if (!session->isReplay()) attachBridge(session, session->portName());
+        if (!logPath.isEmpty()) {
+            // 回放会话在 openReplay() 中一次创建, 此时会话数即总数
+            const bool perPort = sessions.sessions().size() > 1;
+            const QString path = perPort ? SessionManager::perPortPath(logPath, session->portName()) : logPath;
+            QString error;
+            session->logWriter().setRotation(rotation);
+            if (!session->logWriter().open(path, append, &error)) err << "无法打开日志文件: " << error << "\n";
+        }
+        if (!session->isReplay()) --pending;
+    });
+    QObject::connect(&sessions, &SessionManager::sessionFailed, [&](SerialSession *session, const QString &error) {
+        err << "无法打开 " << session->portName() << ": " << error << "\n";
+        err.flush();
+        ++failures;
+        if (--pending == 0 && sessions.openCount() == 0) QCoreApplication::exit(2);
+    });
+    QObject::connect(&sessions, &SessionManager::sessionError, [&](SerialSession *session, const QString &error) {
+        err << "串口错误 " << session->portName() << ": " << error << "\n";
+        err.flush();
+    });
+    QObject::connect(&sessions, &SessionManager::captureFailed, [&](const QString &error) {
+        err << "无法打开捕获文件: " << error << "\n";
+        err.flush();
+    });
+    QObject::connect(&sessions, &SessionManager::triggerFired, [&](TriggerReason reason, quint8 portId, const QString &path) {
+        SerialSession *session = sessions.session(portId);
+        err << "触发(" << TriggerCapture::reasonName(reason) << (session ? " " + session->portName() : QString())
+            << "): 写出到 " << path << "\n";
+        err.flush();
+    });
+    QObject::connect(&sessions, &SessionManager::triggerSaved, [&](const QString &path, qint64 bytes) {
+        err << "触发捕获已保存: " << path << ", " << bytes << " 字节\n";
+        err.flush();
+    });
+
+    for (const QString &port : ports) {
+        PortSettings settings = portSettings;
+        settings.portName = port;
+        SerialSession *session = sessions.openSession(settings);
+        if (frameSpec.isValid()) session->frameParser().setSpec(frameSpec);
+    }
+
+    if (!replayPath.isEmpty()) {
+        QString error;
+        if (!sessions.openReplay(replayPath, speed, &error)) {
+            err << "无法回放捕获文件: " << error << "\n";
+            return 1;
+        }
+        // 吞吐按最后一批数据被取走并输出为止计算
+        QObject::connect(&sessions, &SessionManager::replayFinished, [&](const ReplayStats &replay) {
+            err << QString("回放%1: %2 条记录, %3 字节, 用时 %4 s, %5 MB/s, %6 条/s, 缓冲区满 %7 次\n")
+                       .arg(replay.finished ? "结束" : "已停止").arg(replay.records).arg(replay.bytes)
+                       .arg(replay.elapsedNs / 1e9, 0, 'f', 3).arg(replay.bytesPerSec() / 1048576.0, 0, 'f', 1)
+                       .arg(replay.recordsPerSec(), 0, 'f', 0).arg(replay.ringStalls);
+            err.flush();
+            if (ports.isEmpty()) QCoreApplication::quit();
+        });
+    }
+
+    // 输出与日志: 与界面一样定时拉取, 按时间顺序合并
+    // 每行由 ReceiveFormatter 直接生成UTF-8字节, 标准输出按字节缓冲写出, 不经过 QString
+    QFile out;
+    out.open(stdout, QIODevice::WriteOnly);
+    ReceiveFormatter formatter;
+    formatter.setMode(mode);
+    const QByteArray noTag;
+    auto emitLine = [&](SerialSession *session, qint64 timestampNs, const char *data, qsizetype size,
+                        Utf8StreamDecoder *decoder) {
+        const bool tagPorts = sessions.sessions().size() > 1;
+        if (!formatter.format(timestampNs, tagPorts ? session->portTag() : noTag, data, size, decoder)) return;
+        if (session->logWriter().isOpen()) session->logWriter().append(formatter.logLine());
+        if (!quiet) {
+            // 标准输出不带 "接收: " 前缀, 与原来的输出格式一致
+            if (tagPorts) out.write(session->portTag());
+            out.write(formatter.text(), formatter.textSize());
+            out.putChar('\n');
+        }
+    };
+
+    auto onAlarm = [&](const AlarmMatch &match) {
+        const AlarmRule &rule = alarms.rules().at(match.rule);
+        SerialSession *session = sessions.session(match.stream);
+        const QString portName = session ? session->portName() : QString::number(match.stream);
+        if (rule.actions & AlarmRule::Status) {
+            err << "报警: " << rule.name << " [" << portName << "] 第 " << match.count << " 次";
+            if (match.suppressed) err << ", 期间另有 " << match.suppressed << " 次";
+            err << "\n";
+        }
+        if (rule.actions & AlarmRule::Sound) err << '\a';
+        if (rule.actions & AlarmRule::Command) {
+            QString error;
+            if (!AlarmEngine::runCommand(rule, portName, &error)) err << "无法执行报警命令 " << rule.command << ": " << error << "\n";
+        }
+        err.flush();
+    };
+
+    auto drainAll = [&]() {
+        const qint64 now = SerialWorker::monotonicNs();
+        sessions.drain([&](SerialSession *session, qint64 timestampNs, const char *data, qsizetype size) {
+            // 无界面时延迟统计到取出数据为止
+            stats.displayLatency().record(now - timestampNs);
+            if (PortBridge *bridge = sessionBridges.value(session)) bridge->onReceive(data, size);
+            if (alarms.isEnabled()) alarms.feed(session->portId(), timestampNs, data, size, onAlarm);
+            if (frameSpec.isValid()) {
+                const quint64 checksumErrors = session->frameParser().checksumErrors();
+                session->frameParser().feed(data, size, [&](const FrameView &frame) {
+                    emitLine(session, timestampNs, frame.data, frame.size, nullptr);
+                });
+                if (session->frameParser().checksumErrors() != checksumErrors && !session->isReplay())
+                    sessions.fireTrigger(TriggerReason::Checksum, session->portId(), timestampNs);
+            } else {
+                emitLine(session, timestampNs, data, size, &session->textDecoder());
+            }
+        });
+        out.flush();
+    };
+    // 与界面一样, 会话关闭(回放结束、设备拔出)时先取走环形缓冲区中剩余的数据
+    QObject::connect(&sessions, &SessionManager::sessionClosed, [&](SerialSession *) { drainAll(); });
+
+    // 写日志失败(磁盘已满等)时日志已缺少数据, 失败次数增加时提示一次
+    // 分段改名失败时继续写原文件, 同样只提示一次
+    QHash<SerialSession *, quint64> reportedLogErrors, reportedRotationFailures;
+    auto reportLogErrors = [&]() {
+        for (SerialSession *session : sessions.sessions()) {
+            const LogWriter &log = session->logWriter();
+            quint64 &reported = reportedLogErrors[session];
+            if (log.writeErrors() > reported) {
+                err << QString("写日志失败 %1: 共 %2 次, 丢失 %3 字节\n")
+                           .arg(session->portName()).arg(log.writeErrors()).arg(log.lostBytes());
+                reported = log.writeErrors();
+            }
+            quint64 &reportedRotation = reportedRotationFailures[session];
+            if (log.rotationFailures() > reportedRotation) {
+                err << QString("日志分段失败 %1: 无法改名, 继续写入原文件\n").arg(session->portName());
+                reportedRotation = log.rotationFailures();
+            }
+        }
+        err.flush();
+    };
+    QObject::connect(&sessions, &SessionManager::sessionClosed, [&](SerialSession *session) {
+        reportLogErrors();
+        reportedLogErrors.remove(session);
+        reportedRotationFailures.remove(session);
+    });
+
+    QTimer pollTimer;
+    quint64 polls = 0;
+    QObject::connect(&pollTimer, &QTimer::timeout, [&]() {
+        drainAll();
+        if (++polls % 100 == 0) reportLogErrors();
+        if (g_triggerRequested) {
+            g_triggerRequested = 0;
+            sessions.fireTrigger(TriggerReason::Manual);
+        }
+        if (g_stopRequested) QCoreApplication::quit();
+    });
+    pollTimer.start(10);
+
+    if (parser.isSet("duration")) {
+        QTimer::singleShot(int(duration * 1000), &app, &QCoreApplication::quit);
+    }
+
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+#ifdef SIGUSR1
+    std::signal(SIGUSR1, onTriggerSignal);
+#endif
+
+    const int rc = app.exec();
+    // 最后一次拉取, 然后由 SessionManager 析构关闭串口和捕获, 日志写出并落盘
+    pollTimer.stop();
+    drainAll();
+    // 先写完日志再统计, 最后一批写盘的失败也要报告
+    for (SerialSession *session : sessions.sessions()) session->logWriter().close();
+    reportLogErrors();
+    for (auto it = bridges.cbegin(); it != bridges.cend(); ++it) {
+        const BridgeStats bridgeStats = it.value()->stats();
+        err << QString("桥接 %1: 连接 %2 次, 转发接收 %3 字节, 丢弃 %4 字节, 断开慢客户端 %5 个, 发送 %6 字节\n")
+                   .arg(it.key()).arg(bridgeStats.accepted).arg(bridgeStats.rxBytes).arg(bridgeStats.rxDropped)
+                   .arg(bridgeStats.slowDisconnects).arg(bridgeStats.txBytes);
+    }
+    if (const quint64 dropped = sessions.captureDroppedRecords()) {
+        err << QString("捕获: 写盘过慢, 文件中缺少 %1 条记录\n").arg(dropped);
+    }
+    if (const TriggerCapture *trigger = sessions.isTriggerCaptureEnabled() ? sessions.triggerCapture() : nullptr) {
+        err << QString("触发捕获: 触发 %1 次, 保存 %2 个文件\n").arg(trigger->triggerCount()).arg(trigger->savedCount());
+    }
+    if (alarms.isEnabled()) {
+        err << QString("报警: 规则 %1 条, 匹配 %2 次, 通知 %3 次, 通知延迟 p99 %4 us\n")
+                   .arg(alarms.rules().size()).arg(alarms.totalMatches()).arg(alarms.notifications())
+                   .arg(alarms.latency().percentileNs(99) / 1000.0, 0, 'f', 1);
+    }
+    if (rc != 0) return rc;
+    return !ports.isEmpty() && failures == ports.size() ? 2 : 0;
+}
@@ -0,0 +1,7 @@
+#include "headless.h"
+
+// 不链接 QtWidgets 的命令行版本, 用于没有图形环境的现场网关
+int main(int argc, char *argv[])
+{
+    return runHeadless(argc, argv);
+}
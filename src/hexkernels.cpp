@@ -0,0 +1,311 @@
+#include "hexkernels.h"
+
+#include <atomic>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define HEXKERNELS_X86 1
+#include <immintrin.h>
+#define HEXKERNELS_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+namespace HexKernels {
+
+// ---------------------------------------------------------------- 标量实现
+
+namespace {
+
+const char kUpperDigits[] = "0123456789ABCDEF";
+
+inline int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    c = char(c | 0x20);
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+inline bool isControl(uint8_t b)
+{
+    return b < 0x20 && b != '\t' && b != '\n' && b != '\r';
+}
+
+} // namespace
+
+namespace Scalar {
+
+size_t encodeSpacedUpper(const uint8_t *in, size_t n, char *out)
+{
+    if (n == 0) return 0;
+    char *p = out;
+    for (size_t i = 0; i < n; ++i) {
+        *p++ = kUpperDigits[in[i] >> 4];
+        *p++ = kUpperDigits[in[i] & 0x0F];
+        *p++ = ' ';
+    }
+    return size_t(p - out) - 1;
+}
+
+bool decodeHex(const char *in, size_t n, uint8_t *out, size_t *outLen)
+{
+    size_t count = 0;
+    int high = -1;
+    for (size_t i = 0; i < n; ++i) {
+        if (in[i] == ' ') continue;
+        const int v = hexValue(in[i]);
+        if (v < 0) return false;
+        if (high < 0) {
+            high = v;
+        } else {
+            out[count++] = uint8_t(high << 4 | v);
+            high = -1;
+        }
+    }
+    *outLen = count;
+    return high < 0;
+}
+
+size_t findControl(const uint8_t *in, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        if (isControl(in[i])) return i;
+    }
+    return n;
+}
+
+} // namespace Scalar
+
+// ---------------------------------------------------------------- SIMD实现
+
+#ifdef HEXKERNELS_X86
+namespace {
+
+// 16个字节 -> 32个大写十六进制字符, lo/hi 分别为前8字节和后8字节的"高低"字符对
+HEXKERNELS_TARGET("ssse3")
+inline void nibblesToAscii(__m128i v, __m128i *lo, __m128i *hi)
+{
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    const __m128i table = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                        '8', '9', 'A', 'B', 'C', 'D', 'E', 'F');
+    const __m128i h = _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+    const __m128i l = _mm_shuffle_epi8(table, _mm_and_si128(v, mask));
+    *lo = _mm_unpacklo_epi8(h, l);
+    *hi = _mm_unpackhi_epi8(h, l);
+}
+
+// 输出第 j 个字符取自字符对序列的下标 (j/3)*2 + j%3, j%3 == 2 时为空格
+struct SpacingTables
+{
+    __m128i fromLo[3];
+    __m128i fromHi[3];
+    __m128i spaces[3];
+};
+
+SpacingTables makeSpacingTables()
+{
+    alignas(16) int8_t lo[3][16], hi[3][16], sp[3][16];
+    for (int k = 0; k < 3; ++k) {
+        for (int j = 0; j < 16; ++j) {
+            const int o = k * 16 + j;
+            const int src = (o / 3) * 2 + o % 3;
+            lo[k][j] = hi[k][j] = int8_t(0x80);
+            sp[k][j] = 0;
+            if (o % 3 == 2) sp[k][j] = ' ';
+            else if (src < 16) lo[k][j] = int8_t(src);
+            else hi[k][j] = int8_t(src - 16);
+        }
+    }
+    SpacingTables t;
+    for (int k = 0; k < 3; ++k) {
+        t.fromLo[k] = _mm_load_si128(reinterpret_cast<const __m128i *>(lo[k]));
+        t.fromHi[k] = _mm_load_si128(reinterpret_cast<const __m128i *>(hi[k]));
+        t.spaces[k] = _mm_load_si128(reinterpret_cast<const __m128i *>(sp[k]));
+    }
+    return t;
+}
+
+HEXKERNELS_TARGET("ssse3")
+size_t encodeSpacedUpperSsse3(const uint8_t *in, size_t n, char *out)
+{
+    static const SpacingTables t = makeSpacingTables();
+    size_t i = 0;
+    char *p = out;
+    // 最后不足或恰好16字节交给标量, 避免写出末尾多余的空格
+    for (; i + 16 < n; i += 16, p += 48) {
+        __m128i lo, hi;
+        nibblesToAscii(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i)), &lo, &hi);
+        for (int k = 0; k < 3; ++k) {
+            const __m128i r = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(lo, t.fromLo[k]),
+                                                        _mm_shuffle_epi8(hi, t.fromHi[k])),
+                                           t.spaces[k]);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(p + k * 16), r);
+        }
+    }
+    return size_t(p - out) + Scalar::encodeSpacedUpper(in + i, n - i, p);
+}
+
+// 32个十六进制字符 -> 16字节; 含非十六进制字符时返回 false 且不写出
+HEXKERNELS_TARGET("ssse3")
+inline bool decodeBlockSsse3(const char *in, uint8_t *out)
+{
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 16));
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i five = _mm_set1_epi8(5);
+    const __m128i lowerA = _mm_set1_epi8('a');
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    const __m128i ten = _mm_set1_epi8(10);
+
+    __m128i values[2];
+    const __m128i chars[2] = {a, b};
+    for (int k = 0; k < 2; ++k) {
+        const __m128i d = _mm_sub_epi8(chars[k], zero);
+        const __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(d, nine), d);
+        const __m128i l = _mm_sub_epi8(_mm_or_si128(chars[k], caseBit), lowerA);
+        const __m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(l, five), l);
+        if (_mm_movemask_epi8(_mm_or_si128(isDigit, isLetter)) != 0xFFFF) return false;
+        values[k] = _mm_or_si128(_mm_and_si128(isDigit, d),
+                                 _mm_and_si128(isLetter, _mm_add_epi8(l, ten)));
+    }
+    // 相邻两个半字节合并: 高位*16 + 低位
+    const __m128i weights = _mm_set1_epi16(0x0110);
+    const __m128i w0 = _mm_maddubs_epi16(values[0], weights);
+    const __m128i w1 = _mm_maddubs_epi16(values[1], weights);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_packus_epi16(w0, w1));
+    return true;
+}
+
+HEXKERNELS_TARGET("ssse3")
+bool decodeHexSsse3(const char *in, size_t n, uint8_t *out, size_t *outLen)
+{
+    size_t i = 0, count = 0;
+    int high = -1;
+    while (i < n) {
+        // 没有待配对的半字节时尝试整块解码, 块内有空格或非法字符则退回标量处理
+        if (high < 0 && i + 32 <= n && decodeBlockSsse3(in + i, out + count)) {
+            i += 32;
+            count += 16;
+            continue;
+        }
+        const size_t end = i + 32 < n ? i + 32 : n;
+        for (; i < end; ++i) {
+            if (in[i] == ' ') continue;
+            const int v = hexValue(in[i]);
+            if (v < 0) return false;
+            if (high < 0) {
+                high = v;
+            } else {
+                out[count++] = uint8_t(high << 4 | v);
+                high = -1;
+            }
+        }
+    }
+    *outLen = count;
+    return high < 0;
+}
+
+HEXKERNELS_TARGET("sse2")
+size_t findControlSse2(const uint8_t *in, size_t n)
+{
+    const __m128i limit = _mm_set1_epi8(0x1F);
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        const __m128i low = _mm_cmpeq_epi8(_mm_max_epu8(v, limit), limit);   // v <= 0x1F
+        const __m128i allowed = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, tab), _mm_cmpeq_epi8(v, lf)),
+                                             _mm_cmpeq_epi8(v, cr));
+        const int mask = _mm_movemask_epi8(_mm_andnot_si128(allowed, low));
+        if (mask) return i + size_t(__builtin_ctz(unsigned(mask)));
+    }
+    return i + Scalar::findControl(in + i, n - i);
+}
+
+HEXKERNELS_TARGET("avx2")
+size_t findControlAvx2(const uint8_t *in, size_t n)
+{
+    const __m256i limit = _mm256_set1_epi8(0x1F);
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i lf = _mm256_set1_epi8('\n');
+    const __m256i cr = _mm256_set1_epi8('\r');
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+        const __m256i low = _mm256_cmpeq_epi8(_mm256_max_epu8(v, limit), limit);
+        const __m256i allowed = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, tab),
+                                                                 _mm256_cmpeq_epi8(v, lf)),
+                                                _mm256_cmpeq_epi8(v, cr));
+        const unsigned mask = unsigned(_mm256_movemask_epi8(_mm256_andnot_si256(allowed, low)));
+        if (mask) return i + size_t(__builtin_ctz(mask));
+    }
+    return i + findControlSse2(in + i, n - i);
+}
+
+} // namespace
+#endif // HEXKERNELS_X86
+
+// ---------------------------------------------------------------- 运行时分派
+
+namespace {
+
+struct Dispatch
+{
+    size_t (*encode)(const uint8_t *, size_t, char *);
+    bool (*decode)(const char *, size_t, uint8_t *, size_t *);
+    size_t (*control)(const uint8_t *, size_t);
+    const char *isa;
+};
+
+Dispatch detect()
+{
+#ifdef HEXKERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return {encodeSpacedUpperSsse3, decodeHexSsse3, findControlAvx2, "avx2"};
+    if (__builtin_cpu_supports("ssse3"))
+        return {encodeSpacedUpperSsse3, decodeHexSsse3, findControlSse2, "ssse3"};
+    if (__builtin_cpu_supports("sse2"))
+        return {Scalar::encodeSpacedUpper, Scalar::decodeHex, findControlSse2, "sse2"};
+#endif
+    return {Scalar::encodeSpacedUpper, Scalar::decodeHex, Scalar::findControl, "scalar"};
+}
+
+const Dispatch kScalar = {Scalar::encodeSpacedUpper, Scalar::decodeHex, Scalar::findControl, "scalar"};
+std::atomic<bool> g_forceScalar{false};
+
+const Dispatch &dispatch()
+{
+    static const Dispatch best = detect();
+    return g_forceScalar.load(std::memory_order_relaxed) ? kScalar : best;
+}
+
+} // namespace
+
+size_t encodeSpacedUpper(const uint8_t *in, size_t n, char *out)
+{
+    return dispatch().encode(in, n, out);
+}
+
+bool decodeHex(const char *in, size_t n, uint8_t *out, size_t *outLen)
+{
+    return dispatch().decode(in, n, out, outLen);
+}
+
+size_t findControl(const uint8_t *in, size_t n)
+{
+    return dispatch().control(in, n);
+}
+
+const char *activeIsa()
+{
+    return dispatch().isa;
+}
+
+void forceScalar(bool scalar)
+{
+    g_forceScalar.store(scalar, std::memory_order_relaxed);
+}
+
+} // namespace HexKernels
@@ -0,0 +1,64 @@
+#include "latencyhistogram.h"
+
+#include <cmath>
+
+// 小于 kSubBuckets 的值直接落在第0组; 其余按最高位所在的2的幂分组, 组内取紧随最高位的 kSubBucketBits 位
+int LatencyHistogram::bucketIndex(quint64 value)
+{
+    if (value < quint64(kSubBuckets)) return int(value);
+    const int msb = 63 - __builtin_clzll(value);
+    const int shift = msb - kSubBucketBits;
+    const int sub = int((value >> shift) & (kSubBuckets - 1));
+    return (shift + 1) * kSubBuckets + sub;
+}
+
+qint64 LatencyHistogram::bucketUpperBound(int index)
+{
+    if (index < kSubBuckets) return index;
+    const int shift = index / kSubBuckets - 1;
+    const quint64 sub = quint64(index % kSubBuckets);
+    const quint64 lower = (quint64(kSubBuckets) | sub) << shift;
+    return qint64(lower + (quint64(1) << shift) - 1);
+}
+
+void LatencyHistogram::record(qint64 valueNs)
+{
+    if (valueNs < 0) valueNs = 0;
+    ++m_buckets[size_t(bucketIndex(quint64(valueNs)))];
+    if (m_count == 0 || valueNs < m_min) m_min = valueNs;
+    if (valueNs > m_max) m_max = valueNs;
+    m_sum += valueNs;
+    ++m_count;
+}
+
+void LatencyHistogram::reset()
+{
+    m_buckets.fill(0);
+    m_count = 0;
+    m_min = 0;
+    m_max = 0;
+    m_sum = 0;
+}
+
+qint64 LatencyHistogram::percentileNs(double percentile) const
+{
+    if (m_count == 0) return 0;
+    const double clamped = qBound(0.0, percentile, 100.0);
+    const quint64 target = qMax<quint64>(1, quint64(std::ceil(clamped / 100.0 * double(m_count))));
+    quint64 seen = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        seen += m_buckets[size_t(i)];
+        if (seen >= target) return qMin(bucketUpperBound(i), m_max);
+    }
+    return m_max;
+}
+
+void LatencyHistogram::add(const LatencyHistogram &other)
+{
+    if (other.m_count == 0) return;
+    for (int i = 0; i < kBucketCount; ++i) m_buckets[size_t(i)] += other.m_buckets[size_t(i)];
+    if (m_count == 0 || other.m_min < m_min) m_min = other.m_min;
+    if (other.m_max > m_max) m_max = other.m_max;
+    m_sum += other.m_sum;
+    m_count += other.m_count;
+}
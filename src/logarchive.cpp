@@ -0,0 +1,388 @@
+#include "logarchive.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QRegularExpression>
+#include <algorithm>
+#include <vector>
+#include <zlib.h>
+
+namespace {
+
+constexpr quint8 kSubfieldId1 = 'P';
+constexpr quint8 kSubfieldId2 = 'L';
+
+void putLe16(uchar *p, quint32 v)
+{
+    p[0] = uchar(v);
+    p[1] = uchar(v >> 8);
+}
+
+void putLe32(uchar *p, quint32 v)
+{
+    p[0] = uchar(v);
+    p[1] = uchar(v >> 8);
+    p[2] = uchar(v >> 16);
+    p[3] = uchar(v >> 24);
+}
+
+quint32 getLe16(const uchar *p)
+{
+    return quint32(p[0]) | quint32(p[1]) << 8;
+}
+
+quint32 getLe32(const uchar *p)
+{
+    return quint32(p[0]) | quint32(p[1]) << 8 | quint32(p[2]) << 16 | quint32(p[3]) << 24;
+}
+
+// 分块gzip成员头: 固定的24字节, 扩展字段中带本成员的压缩长度和原文长度
+bool isBlockHeader(const uchar *p, qint64 available)
+{
+    return available >= BlockGzip::kHeaderSize + BlockGzip::kTrailerSize
+        && p[0] == 0x1f && p[1] == 0x8b && p[2] == 8 && (p[3] & 4) != 0
+        && getLe16(p + 10) == 12 && p[12] == kSubfieldId1 && p[13] == kSubfieldId2 && getLe16(p + 14) == 8;
+}
+
+// 其他工具生成的gzip(可能有多个成员): 依次解压所有成员
+bool inflateGzip(const uchar *data, qint64 size, QByteArray *out)
+{
+    out->resize(0);
+    z_stream stream = {};
+    if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) return false;
+    stream.next_in = const_cast<Bytef *>(data);
+    stream.avail_in = uInt(size);
+    int rc = Z_OK;
+    char buffer[64 * 1024];
+    while (stream.avail_in > 0) {
+        stream.next_out = reinterpret_cast<Bytef *>(buffer);
+        stream.avail_out = sizeof(buffer);
+        rc = inflate(&stream, Z_NO_FLUSH);
+        if (rc != Z_OK && rc != Z_STREAM_END) break;
+        out->append(buffer, int(sizeof(buffer) - stream.avail_out));
+        if (rc == Z_STREAM_END) inflateReset(&stream);
+    }
+    inflateEnd(&stream);
+    return rc == Z_OK || rc == Z_STREAM_END;
+}
+
+} // namespace
+
+bool BlockGzip::appendBlock(QByteArray *out, const char *data, qsizetype size)
+{
+    const int start = out->size();
+    const uLong bound = compressBound(uLong(size)) + 64;
+    out->resize(start + kHeaderSize + int(bound) + kTrailerSize);
+    uchar *header = reinterpret_cast<uchar *>(out->data()) + start;
+
+    z_stream stream = {};
+    // 原始deflate流(无zlib头), gzip头和尾自己写
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        out->resize(start);
+        return false;
+    }
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+    stream.avail_in = uInt(size);
+    stream.next_out = header + kHeaderSize;
+    stream.avail_out = uInt(bound);
+    const int rc = deflate(&stream, Z_FINISH);
+    const qint64 deflated = qint64(stream.total_out);
+    deflateEnd(&stream);
+    if (rc != Z_STREAM_END) {
+        out->resize(start);
+        return false;
+    }
+
+    const qint64 memberSize = kHeaderSize + deflated + kTrailerSize;
+    header[0] = 0x1f;
+    header[1] = 0x8b;
+    header[2] = 8;          // deflate
+    header[3] = 4;          // FEXTRA
+    putLe32(header + 4, 0); // 不记录修改时间
+    header[8] = 0;
+    header[9] = 255;        // 未知操作系统
+    putLe16(header + 10, 12);
+    header[12] = kSubfieldId1;
+    header[13] = kSubfieldId2;
+    putLe16(header + 14, 8);
+    putLe32(header + 16, quint32(memberSize));
+    putLe32(header + 20, quint32(size));
+    uchar *trailer = header + kHeaderSize + deflated;
+    putLe32(trailer, quint32(crc32(0, reinterpret_cast<const Bytef *>(data), uInt(size))));
+    putLe32(trailer + 4, quint32(size));
+    out->resize(start + int(memberSize));
+    return true;
+}
+
+bool BlockGzip::compressFile(const QString &source, const QString &target, QString *errorString)
+{
+    QFile in(source);
+    if (!in.open(QIODevice::ReadOnly)) {
+        if (errorString) *errorString = in.errorString();
+        return false;
+    }
+    const QString partPath = target + ".part";
+    QFile out(partPath);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (errorString) *errorString = out.errorString();
+        return false;
+    }
+
+    QByteArray block(kBlockBytes, Qt::Uninitialized);
+    QByteArray member;
+    member.reserve(kBlockBytes + kBlockBytes / 8);
+    for (;;) {
+        const qint64 n = in.read(block.data(), kBlockBytes);
+        if (n < 0) {
+            if (errorString) *errorString = in.errorString();
+            out.remove();
+            return false;
+        }
+        if (n == 0) break;
+        member.resize(0);
+        if (!appendBlock(&member, block.constData(), n) || out.write(member) != member.size()) {
+            if (errorString) *errorString = out.errorString();
+            out.remove();
+            return false;
+        }
+    }
+    out.close();
+    QFile::remove(target);
+    if (!QFile::rename(partPath, target)) {
+        if (errorString) *errorString = QString("无法重命名 %1").arg(partPath);
+        QFile::remove(partPath);
+        return false;
+    }
+    return true;
+}
+
+QString LogArchive::segmentPath(const QString &activePath, const QString &stamp)
+{
+    const QFileInfo info(activePath);
+    const QString suffix = info.suffix().isEmpty() ? QString() : "." + info.suffix();
+    return info.path() + "/" + info.completeBaseName() + "." + stamp + suffix;
+}
+
+QStringList LogArchive::segments(const QString &activePath)
+{
+    const QFileInfo info(activePath);
+    const QString base = info.completeBaseName();
+    const QString suffix = info.suffix().isEmpty() ? QString() : "." + info.suffix();
+    const QRegularExpression pattern("^" + QRegularExpression::escape(base) + "\\.(\\d{8}-\\d{6})(?:_(\\d+))?"
+                                     + QRegularExpression::escape(suffix) + "(\\.gz)?$");
+    // 按 (时间, 序号) 排序: 序号按数值比较, _10 排在 _2 之后
+    struct Entry
+    {
+        QString stamp;
+        int index;
+        QString name;
+    };
+    QDir dir(info.path());
+    std::vector<Entry> entries;
+    for (const QString &name : dir.entryList(QStringList(base + ".*"), QDir::Files)) {
+        const QRegularExpressionMatch match = pattern.match(name);
+        if (match.hasMatch()) entries.push_back({match.captured(1), match.captured(2).toInt(), name});
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return a.stamp != b.stamp ? a.stamp < b.stamp : a.index < b.index;
+    });
+    QStringList paths;
+    for (const Entry &entry : entries) paths.append(dir.filePath(entry.name));
+    return paths;
+}
+
+int LogArchive::enforceRetention(const QString &activePath, qint64 retentionBytes)
+{
+    if (retentionBytes <= 0) return 0;
+    const QStringList paths = segments(activePath);
+    qint64 total = QFileInfo(activePath).size();
+    for (const QString &path : paths) total += QFileInfo(path).size();
+
+    int removed = 0;
+    for (const QString &path : paths) {
+        if (total <= retentionBytes) break;
+        const qint64 size = QFileInfo(path).size();
+        if (QFile::remove(path)) {
+            total -= size;
+            ++removed;
+        }
+    }
+    return removed;
+}
+
+LogArchiver &LogArchiver::instance()
+{
+    static LogArchiver archiver;
+    return archiver;
+}
+
+// 进程退出时完成已提交的压缩再结束线程
+LogArchiver::~LogArchiver()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopRequested = true;
+        m_wake.wakeOne();
+    }
+    if (m_thread.joinable()) m_thread.join();
+}
+
+void LogArchiver::submit(const QString &activePath, const QString &segment, const LogRotation &rotation)
+{
+    QMutexLocker locker(&m_mutex);
+    m_jobs.append({activePath, segment, rotation});
+    if (!m_thread.joinable()) m_thread = std::thread(&LogArchiver::run, this);
+    m_wake.wakeOne();
+}
+
+void LogArchiver::waitForIdle()
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_busy || !m_jobs.isEmpty()) m_idle.wait(&m_mutex);
+}
+
+void LogArchiver::run()
+{
+    QMutexLocker locker(&m_mutex);
+    for (;;) {
+        while (m_jobs.isEmpty() && !m_stopRequested) m_wake.wait(&m_mutex);
+        if (m_jobs.isEmpty()) return;
+        const Job job = m_jobs.takeFirst();
+        m_busy = true;
+        locker.unlock();
+
+        // 分段可能已被之前的保留上限删除
+        if (!job.segment.isEmpty() && job.rotation.compress && QFile::exists(job.segment)) {
+            if (BlockGzip::compressFile(job.segment, job.segment + ".gz")) {
+                QFile::remove(job.segment);
+                m_compressed.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        const int removed = LogArchive::enforceRetention(job.activePath, job.rotation.retentionBytes);
+        m_removed.fetch_add(quint64(removed), std::memory_order_relaxed);
+
+        locker.relock();
+        m_busy = false;
+        if (m_jobs.isEmpty()) m_idle.wakeAll();
+    }
+}
+
+LogSegmentReader::~LogSegmentReader()
+{
+    close();
+}
+
+bool LogSegmentReader::open(const QString &path, QString *errorString)
+{
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        if (errorString) *errorString = m_file.errorString();
+        return false;
+    }
+    m_fileSize = m_file.size();
+    if (m_fileSize > 0) {
+        m_base = m_file.map(0, m_fileSize);
+        if (!m_base) {
+            if (errorString) *errorString = m_file.errorString();
+            m_file.close();
+            return false;
+        }
+    }
+
+    if (m_fileSize >= 2 && m_base[0] == 0x1f && m_base[1] == 0x8b) {
+        m_compressed = true;
+        if (!indexBlockGzip()) {
+            // 不是分块格式: 整个文件作为一个块, 长度取最后一个成员的 ISIZE(单成员时即原文长度)
+            m_blocks.clear();
+            const qint64 isize = m_fileSize >= 8 ? qint64(getLe32(m_base + m_fileSize - 4)) : 0;
+            m_blocks.append({0, isize, 0, m_fileSize});
+            m_size = isize;
+        }
+        return true;
+    }
+
+    // 文本: 按固定大小划分虚拟块
+    for (qint64 offset = 0; offset < m_fileSize; offset += BlockGzip::kBlockBytes) {
+        const qint64 length = qMin<qint64>(BlockGzip::kBlockBytes, m_fileSize - offset);
+        m_blocks.append({offset, length, offset, length});
+    }
+    m_size = m_fileSize;
+    return true;
+}
+
+void LogSegmentReader::close()
+{
+    if (m_base) m_file.unmap(const_cast<uchar *>(m_base));
+    m_base = nullptr;
+    if (m_file.isOpen()) m_file.close();
+    m_fileSize = 0;
+    m_size = 0;
+    m_compressed = false;
+    m_blocks.clear();
+}
+
+// 沿成员头跳跃, 每个成员只读24字节; 遇到格式不符(含末尾被截断的成员)时停止
+bool LogSegmentReader::indexBlockGzip()
+{
+    qint64 fileOffset = 0;
+    qint64 offset = 0;
+    while (fileOffset < m_fileSize) {
+        const uchar *p = m_base + fileOffset;
+        if (!isBlockHeader(p, m_fileSize - fileOffset)) break;
+        const qint64 memberSize = getLe32(p + 16);
+        const qint64 length = getLe32(p + 20);
+        if (memberSize < BlockGzip::kHeaderSize + BlockGzip::kTrailerSize || fileOffset + memberSize > m_fileSize) break;
+        m_blocks.append({offset, length, fileOffset, memberSize});
+        offset += length;
+        fileOffset += memberSize;
+    }
+    m_size = offset;
+    return !m_blocks.isEmpty();
+}
+
+bool LogSegmentReader::readBlock(int i, QByteArray *out) const
+{
+    if (i < 0 || i >= m_blocks.size()) return false;
+    const Block &block = m_blocks.at(i);
+    const uchar *p = m_base + block.fileOffset;
+    if (!m_compressed) {
+        out->resize(int(block.length));
+        std::memcpy(out->data(), p, size_t(block.length));
+        return true;
+    }
+    if (!isBlockHeader(p, block.fileLength)) return inflateGzip(p, block.fileLength, out);
+
+    out->resize(int(block.length));
+    z_stream stream = {};
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) return false;
+    stream.next_in = const_cast<Bytef *>(p + BlockGzip::kHeaderSize);
+    stream.avail_in = uInt(block.fileLength - BlockGzip::kHeaderSize - BlockGzip::kTrailerSize);
+    stream.next_out = reinterpret_cast<Bytef *>(out->data());
+    stream.avail_out = uInt(block.length);
+    const int rc = inflate(&stream, Z_FINISH);
+    inflateEnd(&stream);
+    if (rc != Z_STREAM_END || qint64(stream.total_out) != block.length) return false;
+    const uchar *trailer = p + block.fileLength - BlockGzip::kTrailerSize;
+    return getLe32(trailer) == quint32(crc32(0, reinterpret_cast<const Bytef *>(out->constData()), uInt(block.length)));
+}
+
+QByteArray LogSegmentReader::tail(qint64 maxBytes) const
+{
+    QByteArray result;
+    QByteArray block;
+    int i = m_blocks.size() - 1;
+    for (; i >= 0 && result.size() < maxBytes; --i) {
+        if (!readBlock(i, &block)) break;
+        result.prepend(block);
+    }
+    // 没有从文件开头读起时, 去掉不完整的第一行
+    if (i >= 0 || result.size() > maxBytes) {
+        if (result.size() > maxBytes) result.remove(0, int(result.size() - maxBytes));
+        const int nl = result.indexOf('\n');
+        result.remove(0, nl < 0 ? result.size() : nl + 1);
+    }
+    return result;
+}
@@ -0,0 +1,185 @@
+#include "logwriter.h"
+
+#include <QDateTime>
+#include <QMutexLocker>
+
+#if defined(Q_OS_WIN)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+LogWriter::LogWriter() = default;
+
+LogWriter::~LogWriter()
+{
+    close();
+}
+
+bool LogWriter::open(const QString &path, bool append, QString *errorString)
+{
+    close();
+
+    m_path = path;
+    m_file.setFileName(path);
+    // 由本类自行批量写出, 关闭 QFile 自带的缓冲以免重复拷贝
+    QIODevice::OpenMode mode = QIODevice::WriteOnly | QIODevice::Unbuffered;
+    mode |= append ? QIODevice::Append : QIODevice::Truncate;
+    if (!m_file.open(mode)) {
+        if (errorString) *errorString = m_file.errorString();
+        return false;
+    }
+
+    m_segmentBytes = m_file.size();
+    m_segmentStart = std::chrono::steady_clock::now();
+    // 上次运行留下的分段也受保留上限约束
+    if (m_rotation.retentionBytes > 0) LogArchiver::instance().submit(path, QString(), m_rotation);
+
+    m_stopRequested = false;
+    m_running = true;
+    m_thread = std::thread(&LogWriter::run, this);
+    return true;
+}
+
+void LogWriter::close()
+{
+    if (!m_running) return;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopRequested = true;
+        m_wake.wakeOne();
+    }
+    m_thread.join();
+    m_running = false;
+
+    // 确保数据真正落盘后再关闭
+    syncFile();
+    m_file.close();
+}
+
+void LogWriter::syncFile()
+{
+#if defined(Q_OS_WIN)
+    _commit(m_file.handle());
+#else
+    ::fsync(m_file.handle());
+#endif
+}
+
+void LogWriter::setFlushThresholds(qint64 flushBytes, int flushIntervalMs)
+{
+    QMutexLocker locker(&m_mutex);
+    m_flushBytes = flushBytes;
+    m_flushIntervalMs = flushIntervalMs;
+}
+
+bool LogWriter::append(const QByteArray &record)
+{
+    return append(record.constData(), record.size());
+}
+
+bool LogWriter::append(const char *data, qsizetype len)
+{
+    if (!m_running || len <= 0) return false;
+
+    QMutexLocker locker(&m_mutex);
+    // 队列为空时总是接受, 单条超过上限的记录也不会永远等待
+    while (m_blocking && !m_queue.isEmpty() && m_queue.size() + len > m_maxQueueBytes) {
+        m_wake.wakeOne();
+        m_spaceAvailable.wait(&m_mutex);
+    }
+    if (m_queue.size() + len > m_maxQueueBytes) {
+        m_droppedRecords.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    m_queue.append(data, len);
+    m_queuedBytes.store(m_queue.size(), std::memory_order_relaxed);
+    if (m_queue.size() >= m_flushBytes) m_wake.wakeOne();
+    return true;
+}
+
+// 两个缓冲区来回交换并保留容量: 稳定运行后 append() 不再分配内存
+// 某次突发把缓冲区撑得远大于写盘阈值时, 写完后释放, 以免长期占用
+void LogWriter::run()
+{
+    QMutexLocker locker(&m_mutex);
+    const qsizetype keepCapacity = qsizetype(m_flushBytes) * 2;
+    QByteArray batch;
+    batch.reserve(int(keepCapacity));
+    m_queue.reserve(int(keepCapacity));
+    for (;;) {
+        if (!m_stopRequested && m_queue.size() < m_flushBytes)
+            m_wake.wait(&m_mutex, m_flushIntervalMs);
+
+        // 交换缓冲区后立即释放锁, 写盘期间生产者可以继续追加
+        batch.swap(m_queue);
+        m_queuedBytes.store(0, std::memory_order_relaxed);
+        m_spaceAvailable.wakeAll();
+        const bool stop = m_stopRequested;
+        locker.unlock();
+
+        if (!batch.isEmpty()) {
+            m_segmentBytes += writeOut(batch);
+            if (batch.capacity() > 4 * keepCapacity) {
+                batch = QByteArray();
+                batch.reserve(int(keepCapacity));
+            } else {
+                batch.resize(0);
+            }
+        }
+        if (stop) return;
+        // 按时间切换时, 没有新数据也会在唤醒周期内检查
+        if (rotationDue()) rotate();
+        locker.relock();
+    }
+}
+
+bool LogWriter::rotationDue() const
+{
+    if (!m_rotation.isEnabled() || m_segmentBytes == 0) return false;
+    if (m_rotation.maxSegmentBytes > 0 && m_segmentBytes >= m_rotation.maxSegmentBytes) return true;
+    return m_rotation.maxSegmentSeconds > 0
+        && std::chrono::steady_clock::now() - m_segmentStart >= std::chrono::seconds(m_rotation.maxSegmentSeconds);
+}
+
+// 关闭当前文件并改名为分段, 然后以同名重新创建
+// 改名失败(文件被其他程序占用等)时继续追加到原文件并计数, 分段计数同样清零,
+// 下一次尝试在再写满一个分段之后, 不会每次唤醒都重试
+void LogWriter::rotate()
+{
+    const QString path = m_path;
+    syncFile();
+    m_file.close();
+
+    const QString stamp = QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss");
+    QString segment = LogArchive::segmentPath(path, stamp);
+    for (int n = 1; QFile::exists(segment) || QFile::exists(segment + ".gz"); ++n)
+        segment = LogArchive::segmentPath(path, stamp + "_" + QString::number(n));
+
+    const bool renamed = QFile::rename(path, segment);
+    m_file.setFileName(path);
+    const QIODevice::OpenMode mode = QIODevice::WriteOnly | QIODevice::Unbuffered
+                                   | (renamed ? QIODevice::Truncate : QIODevice::Append);
+    m_segmentStart = std::chrono::steady_clock::now();
+    m_segmentBytes = 0;
+    if (!m_file.open(mode)) return;   // 之后的写出失败, 与磁盘错误相同处理
+    if (!renamed) {
+        m_rotationFailures.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    m_segmentsRotated.fetch_add(1, std::memory_order_relaxed);
+    LogArchiver::instance().submit(path, segment, m_rotation);
+}
+
+// 返回实际写出的字节数; 无缓冲的 QFile 会写到全部写完或出错为止, 写不完即为失败
+qint64 LogWriter::writeOut(const QByteArray &data)
+{
+    const qint64 n = qMax<qint64>(0, m_file.write(data));
+    m_bytesWritten.fetch_add(quint64(n), std::memory_order_relaxed);
+    if (n < data.size()) {
+        m_writeErrors.fetch_add(1, std::memory_order_relaxed);
+        m_lostBytes.fetch_add(quint64(data.size() - n), std::memory_order_relaxed);
+    }
+    return n;
+}
@@ -1,11 +1,16 @@
 #include "mainwindow.h"
+#include "headless.h"
 
 #include <QApplication>
 #include <QDebug>
 
 int main(int argc, char *argv[])
 {
+    // 无界面模式不创建 QApplication, 也不初始化任何窗口部件
+    if (isHeadlessInvocation(argc, argv)) return runHeadless(argc, argv);
+
     QApplication a(argc, argv);
+    QApplication::setOrganizationName("PyroCom");   // QSettings 中按串口保存的参数
     MainWindow w;
     w.show();
     return a.exec();
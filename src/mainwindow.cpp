@@ -1,5 +1,33 @@
 #include "mainwindow.h"
 #include "./ui_mainwindow.h"
+#include "settingspanel.h"
+#include "serialsession.h"
+#include "sessionmanager.h"
+#include "scrollbackview.h"
+#include "scrollbackmodel.h"
+#include "searchbar.h"
+#include "capturefile.h"
+#include "checksum.h"
+#include "datarender.h"
+#include "hexkernels.h"
+#include "logarchive.h"
+#include "plotdock.h"
+#include "portbridge.h"
+#include "portdiscovery.h"
+#include "replaydock.h"
+#include "statscollector.h"
+#include "statsdock.h"
+#include "transactiondock.h"
+
+#include <QApplication>
+#include <QDialog>
+#include <QElapsedTimer>
+#include <QFileDialog>
+#include <QInputDialog>
+#include <QListWidget>
+#include <QSettings>
+#include <QShortcut>
+#include <QFileInfo>
 
 
 // 主窗口类MainWindow的构造函数实现
@@ -18,18 +46,33 @@
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)              // 调用基类QMainWindow的构造函数
     , ui(new Ui::MainWindow)
-    , serial(new QSerialPort(this))    // 初始化serial成员（创建串口对象，设置this为父对象）
+    , m_sessions(new SessionManager(this))  // 串口读写放到独立线程, 界面卡顿不会影响收数据
+    , m_discovery(new PortDiscovery(this))
+    , m_pollTimer(new QTimer(this))
+    , m_stats(new StatsCollector(m_sessions, this))
+    , m_statsDock(nullptr)
+    , m_plotDock(nullptr)
+    , m_replayDock(nullptr)
+    , m_transactionDock(nullptr)
     , m_settingsPanel(new SettingsPanel(this))
 {
+    m_pollTimer->setInterval(10);
+
     ui->setupUi(this);
     initUI();
     initConnections();
-    refreshPorts();
+    // 串口列表在后台枚举, 结果到达后增量更新下拉框; 适配器重新插入时自动重连
+    m_sessions->setAutoReconnect(m_discovery);
+    m_discovery->start();
 }
 
 MainWindow::~MainWindow()
 {
-    if (serial->isOpen()) serial->close();
+    // 桥接先于界面删除, 断开客户端时不再更新状态栏
+    if (m_bridge) m_bridge->disconnect(this);
+    delete m_bridge;
+    // SessionManager 析构时在I/O线程中关闭所有串口, 各会话的日志写出并落盘
+    delete m_sessions;
     delete ui;
 }
 
@@ -37,38 +80,92 @@ MainWindow::~MainWindow()
 void MainWindow::initUI() {
 
     m_portBox = new QComboBox(this);
-    m_portBox->clear();
-    foreach (const QSerialPortInfo &info, QSerialPortInfo::availablePorts()) {
-        m_portBox->addItem(info.portName());
-    }
+    m_portBox->setSizeAdjustPolicy(QComboBox::AdjustToContents);
 
     m_openCloseButton = new QPushButton("打开串口", this);
     m_refreshButton   = new QPushButton("刷新", this);
     m_settingsButton  = new QPushButton("设置", this);
+    m_statsButton     = new QPushButton("统计", this);
+    m_statsButton->setCheckable(true);
+    m_plotButton      = new QPushButton("曲线", this);
+    m_plotButton->setCheckable(true);
+    m_replayButton    = new QPushButton("回放", this);
+    m_replayButton->setCheckable(true);
+    m_transactionButton = new QPushButton("事务", this);
+    m_transactionButton->setCheckable(true);
+    m_bridgeButton    = new QPushButton("桥接", this);
+    m_bridgeButton->setCheckable(true);
+    m_bridgeButton->setToolTip("通过本地 TCP 或 Unix 套接字把当前串口共享给其他程序");
+    m_triggerButton   = new QPushButton("触发", this);
+    m_triggerButton->setEnabled(false);
+    m_triggerButton->setToolTip("保存触发捕获内存环中的数据及之后的窗口, 需先在设置中填写触发条件");
 
     // 创建发送历史显示区域
-    m_sentHistory = new QTextEdit(this);
-    m_sentHistory->setReadOnly(true);
-    m_sentHistory->setPlaceholderText("发送历史将显示在这里...");
+    m_sentHistory = new ScrollbackView(this);
     m_sentHistory->setMinimumHeight(120);
 
     // 创建发送toolbar
     m_sendEdit = new QLineEdit(this);
     m_sendEdit->setPlaceholderText("输入要发送的内容，按回车或点击发送按钮");
     m_hexSendCheck = new QCheckBox("Hex发送", this);
+    // 发送时在末尾追加校验值, 与接收分帧的 check= 使用同一套算法
+    m_sendChecksumBox = new QComboBox(this);
+    for (int i = 0; i < int(Checksum::Kind::Count); ++i) {
+        const Checksum::Algorithm &algorithm = Checksum::algorithm(Checksum::Kind(i));
+        m_sendChecksumBox->addItem(i == 0 ? QString("无校验") : QString(algorithm.name), i);
+    }
+    m_sendChecksumBox->setToolTip("发送时对整条数据计算校验并追加到末尾");
 
     // 创建接收数据显示区域
-    m_receiveEdit = new QTextEdit(this);
-    m_receiveEdit->setReadOnly(true);
-    m_receiveEdit->setPlaceholderText("接收数据将显示在这里...");
+    m_receiveEdit = new ScrollbackView(this);
     m_receiveEdit->setMinimumHeight(120);
     m_sendButton = new QPushButton("发送", this);
+    m_periodBox = new QDoubleSpinBox(this);
+    m_periodBox->setRange(0, 3600000);
+    m_periodBox->setDecimals(3);
+    m_periodBox->setSuffix(" ms");
+    m_periodBox->setSpecialValueText("单次");
+    m_periodBox->setToolTip("定时发送周期, 单次表示只发送一次");
+    m_scriptButton   = new QPushButton("脚本...", this);
+    m_sendFileButton = new QPushButton("发送文件...", this);
+    m_sendStatsLabel = new QLabel(this);
 
     m_hexReceiveCheck    = new QCheckBox("Hex 接收", this);
     m_clearReceiveButton = new QPushButton("清空", this);
+    m_openCaptureButton  = new QPushButton("打开捕获", this);
+    m_searchBar          = new SearchBar(this);
     m_logFileCheck       = new QCheckBox("启用日志:", this);
     m_logFilePath        = new QLabel("", this);
     m_logFilePath->setMinimumWidth(100);
+    m_batchLabel         = new QLabel(this);
+    m_statsLabel         = new QLabel(this);
+    m_alarmLabel         = new QLabel(this);
+    m_alarmLabel->setStyleSheet("QLabel { color: white; background: #c0392b; padding: 0 6px; }");
+    m_alarmLabel->hide();
+    statusBar()->addPermanentWidget(m_alarmLabel);
+    statusBar()->addPermanentWidget(m_statsLabel);
+    statusBar()->addPermanentWidget(m_batchLabel);
+
+    // 统计面板: 默认隐藏, 可拖出为独立窗口
+    m_statsDock = new StatsDock(m_stats, this);
+    addDockWidget(Qt::RightDockWidgetArea, m_statsDock);
+    m_statsDock->hide();
+    m_receiveEdit->setLatencyHistogram(&m_stats->displayLatency());
+
+    // 遥测曲线面板: 默认隐藏, 设置提取格式后开始采集
+    m_plotDock = new PlotDock(this);
+    addDockWidget(Qt::BottomDockWidgetArea, m_plotDock);
+    m_plotDock->hide();
+
+    // 捕获回放面板: 默认隐藏, 回放会话与真实串口共用接收路径
+    m_replayDock = new ReplayDock(m_sessions, this);
+    addDockWidget(Qt::BottomDockWidgetArea, m_replayDock);
+    m_replayDock->hide();
+
+    // 事务面板: 默认隐藏, 设置匹配规则后开始跟踪命令与响应
+    m_transactionDock = new TransactionDock(m_sessions, this);
+    addDockWidget(Qt::RightDockWidgetArea, m_transactionDock);
+    m_transactionDock->hide();
 
     // toptoolbar
     QToolBar *mainToolBar = new QToolBar("Top Toolbar", this);
@@ -84,6 +181,12 @@ void MainWindow::initUI() {
     QWidget *spacer = new QWidget();
     spacer->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
     mainToolBar->addWidget(spacer);
+    mainToolBar->addWidget(m_triggerButton);
+    mainToolBar->addWidget(m_bridgeButton);
+    mainToolBar->addWidget(m_replayButton);
+    mainToolBar->addWidget(m_transactionButton);
+    mainToolBar->addWidget(m_plotButton);
+    mainToolBar->addWidget(m_statsButton);
     // 添加 Settings 按钮（最左侧）
     mainToolBar->addWidget(m_settingsButton);
     // 将工具栏添加到 MainWindow 顶部
@@ -96,19 +199,20 @@ void MainWindow::initUI() {
     sendToolBar->addWidget(new QLabel("发送:", this));
     sendToolBar->addWidget(m_sendEdit);
     sendToolBar->addWidget(m_hexSendCheck);
+    sendToolBar->addWidget(m_sendChecksumBox);
+    sendToolBar->addWidget(new QLabel("周期:", this));
+    sendToolBar->addWidget(m_periodBox);
     sendToolBar->addWidget(m_sendButton);
-    // 可以在这里添加其他控件到右边
-    // 例如:
-    // QWidget *rightSpacer = new QWidget();
-    // rightSpacer->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
-    // sendToolBar->addWidget(rightSpacer);
-    // sendToolBar->addWidget(new QPushButton("其他按钮", this));
+    sendToolBar->addWidget(m_scriptButton);
+    sendToolBar->addWidget(m_sendFileButton);
+    sendToolBar->addWidget(m_sendStatsLabel);
 
     // receiveToolBar
     QToolBar *receiveToolBar = new QToolBar("Receive Toolbar", this);
     receiveToolBar->setMovable(false);
     receiveToolBar->addWidget(m_hexReceiveCheck);
     receiveToolBar->addWidget(m_clearReceiveButton);
+    receiveToolBar->addWidget(m_openCaptureButton);
     receiveToolBar->addWidget(m_logFileCheck);
     receiveToolBar->addWidget(m_logFilePath);
 
@@ -122,10 +226,15 @@ void MainWindow::initUI() {
     mainLayout->addWidget(sendToolBar);
     mainLayout->addWidget(m_receiveEdit);
     mainLayout->addWidget(receiveToolBar);
+    mainLayout->addWidget(m_searchBar);
 
     // 设置主窗口的中心部件
     this->setCentralWidget(centralWidget);
 
+    // 显示区按设置面板中的上限回滚
+    m_sentHistory->setLimits(m_settingsPanel->scrollbackMaxLines(), m_settingsPanel->scrollbackMaxBytes());
+    m_receiveEdit->setLimits(m_settingsPanel->scrollbackMaxLines(), m_settingsPanel->scrollbackMaxBytes());
+
     m_settingsPanel->setFixedWidth(width());
 }
 
@@ -142,11 +251,87 @@ void MainWindow::initConnections() {
     connect(m_openCloseButton, &QPushButton::clicked, this, &MainWindow::onOpenCloseClicked);
     connect(m_sendButton, &QPushButton::clicked, this, &MainWindow::onSendClicked);
     connect(m_refreshButton, &QPushButton::clicked, this, &MainWindow::refreshPorts);
-    connect(serial, &QSerialPort::readyRead, this, &MainWindow::onSerialDataReceived);
+    connect(m_pollTimer, &QTimer::timeout, this, &MainWindow::onSerialDataReceived);
+    connect(m_sessions, &SessionManager::sessionOpened, this, &MainWindow::onSessionOpened);
+    connect(m_sessions, &SessionManager::sessionFailed, this, &MainWindow::onSessionFailed);
+    connect(m_sessions, &SessionManager::sessionClosed, this, &MainWindow::onSessionClosed);
+    connect(m_sessions, &SessionManager::sessionError, this, &MainWindow::onSessionError);
+    connect(m_sessions, &SessionManager::reconnecting, this, &MainWindow::onSessionReconnecting);
+    connect(m_discovery, &PortDiscovery::portsChanged, this, &MainWindow::onPortsChanged);
+    connect(m_portBox, &QComboBox::currentTextChanged, this, &MainWindow::updateOpenCloseButton);
+    connect(m_portBox, &QComboBox::currentTextChanged, this, &MainWindow::loadPortSettings);
     connect(m_settingsButton, &QPushButton::clicked, this, [this]() { m_settingsPanel->togglePanel(); });
     connect(m_settingsPanel, &SettingsPanel::logFileChanged, this, &MainWindow::onLogFileChanged);
+    connect(m_settingsPanel, &SettingsPanel::frameSpecChanged, this, &MainWindow::onFrameSpecChanged);
+    connect(m_settingsPanel, &SettingsPanel::triggerSpecChanged, this, &MainWindow::onTriggerSpecChanged);
+    connect(m_settingsPanel, &SettingsPanel::alarmRulesChanged, this, &MainWindow::onAlarmRulesChanged);
+    connect(m_triggerButton, &QPushButton::clicked, this, [this]() { m_sessions->fireTrigger(TriggerReason::Manual); });
+    connect(m_sessions, &SessionManager::triggerFired, this, [this](TriggerReason reason, quint8 portId, const QString &path) {
+        SerialSession *session = m_sessions->session(portId);
+        statusBar()->showMessage(QString("触发(%1%2), 正在保存: %3")
+                                     .arg(TriggerCapture::reasonName(reason),
+                                          session && reason != TriggerReason::Manual ? " " + session->portName() : QString(),
+                                          path));
+    });
+    connect(m_sessions, &SessionManager::triggerSaved, this, [this](const QString &path, qint64 bytes) {
+        statusBar()->showMessage(QString("触发捕获已保存: %1 (%2 KB)").arg(path).arg(bytes / 1024), 10000);
+    });
+    connect(m_openCaptureButton, &QPushButton::clicked, this, &MainWindow::onOpenCaptureClicked);
+    connect(m_sessions, &SessionManager::captureFailed, this, [this](const QString &error) {
+        statusBar()->showMessage("无法打开捕获文件: " + error, 5000);
+    });
+    connect(m_logFileCheck, &QCheckBox::toggled, this, &MainWindow::onLogEnabledToggled);
     connect(m_sendEdit, &QLineEdit::returnPressed, this, &MainWindow::onSendClicked);
-    connect(m_clearReceiveButton, &QPushButton::clicked, this, [this](){ m_receiveEdit->clear();});
+    connect(m_stats, &StatsCollector::sampled, this, &MainWindow::onStatsSampled);
+    connect(m_statsButton, &QPushButton::toggled, m_statsDock, &QDockWidget::setVisible);
+    connect(m_statsDock, &QDockWidget::visibilityChanged, this, [this](bool visible) {
+        // 浮动窗口被关闭时同步按钮状态; 停靠区被其他标签页遮住时不算关闭
+        if (!visible && !m_statsDock->isHidden()) return;
+        m_statsButton->setChecked(visible);
+    });
+    connect(m_plotButton, &QPushButton::toggled, m_plotDock, &QDockWidget::setVisible);
+    connect(m_plotDock, &QDockWidget::visibilityChanged, this, [this](bool visible) {
+        if (!visible && !m_plotDock->isHidden()) return;
+        m_plotButton->setChecked(visible);
+    });
+    connect(m_replayButton, &QPushButton::toggled, m_replayDock, &QDockWidget::setVisible);
+    connect(m_replayDock, &QDockWidget::visibilityChanged, this, [this](bool visible) {
+        if (!visible && !m_replayDock->isHidden()) return;
+        m_replayButton->setChecked(visible);
+    });
+    connect(m_transactionButton, &QPushButton::toggled, m_transactionDock, &QDockWidget::setVisible);
+    connect(m_transactionDock, &QDockWidget::visibilityChanged, this, [this](bool visible) {
+        if (!visible && !m_transactionDock->isHidden()) return;
+        m_transactionButton->setChecked(visible);
+    });
+    connect(m_bridgeButton, &QPushButton::toggled, this, &MainWindow::onBridgeToggled);
+    connect(m_sessions, &SessionManager::replayFinished, this, [this](const ReplayStats &stats) {
+        statusBar()->showMessage(QString("回放%1: %2 MB, %3 MB/s")
+                                     .arg(stats.finished ? "结束" : "已停止")
+                                     .arg(stats.bytes / 1048576.0, 0, 'f', 2)
+                                     .arg(stats.bytesPerSec() / 1048576.0, 0, 'f', 1), 5000);
+    });
+    connect(m_searchBar, &SearchBar::findRequested, this, &MainWindow::onFindRequested);
+    connect(m_searchBar, &SearchBar::filterChanged, this, &MainWindow::onSearchFilterChanged);
+    connect(m_searchBar, &SearchBar::captureSearchRequested, this, &MainWindow::onSearchCaptureRequested);
+    connect(m_searchBar, &SearchBar::logSearchRequested, this, &MainWindow::onSearchLogRequested);
+    connect(new QShortcut(QKeySequence::Find, this), &QShortcut::activated, m_searchBar, &SearchBar::focusSearch);
+    connect(m_scriptButton, &QPushButton::clicked, this, &MainWindow::onSendScriptClicked);
+    connect(m_sendFileButton, &QPushButton::clicked, this, &MainWindow::onSendFileClicked);
+    connect(m_portBox, &QComboBox::currentTextChanged, this, &MainWindow::updateSendButton);
+    connect(m_clearReceiveButton, &QPushButton::clicked, this, [this](){
+        m_receiveEdit->clear();
+        m_alarmLabel->hide();
+    });
+    connect(m_settingsPanel, &SettingsPanel::scrollbackLimitsChanged, this, [this](int maxLines, qint64 maxBytes) {
+        m_sentHistory->setLimits(maxLines, maxBytes);
+        m_receiveEdit->setLimits(maxLines, maxBytes);
+    });
+    connect(m_receiveEdit, &ScrollbackView::flushed, this, [this]() {
+        m_batchLabel->setText(QString("刷新: %1  合并: %2")
+                                  .arg(m_receiveEdit->flushCount())
+                                  .arg(m_receiveEdit->coalescedChunks()));
+    });
 }
 
 void MainWindow::onLogFileChanged(const QString &path) {
@@ -154,45 +339,121 @@ void MainWindow::onLogFileChanged(const QString &path) {
     m_logFilePath->setText(displayText);
     statusBar()->showMessage("日志文件设置为: " + displayText, 3000);
 
-    // 自动勾选复选框（如果路径有效）
-    m_logFileCheck->setChecked(!path.isEmpty());
+    // 切换文件时结束旧的日志会话
+    stopLogSessions();
+    // 自动勾选复选框（如果路径有效）, 勾选时开始新的日志会话
+    if (m_logFileCheck->isChecked() == !path.isEmpty()) {
+        onLogEnabledToggled(!path.isEmpty());
+    } else {
+        m_logFileCheck->setChecked(!path.isEmpty());
+    }
+}
 
-    // 可以在这里初始化日志文件
-    if (!path.isEmpty()) {
-        QFile file(path);
-        if (!m_settingsPanel->isAppendMode() && file.exists()) {
-            file.remove();
-        }
+void MainWindow::onLogEnabledToggled(bool enabled) {
+    if (enabled) {
+        startLogSessions();
+    } else {
+        stopLogSessions();
     }
 }
 
-void MainWindow::writeToLogFile(const QString &message) {
-    // 只有复选框选中时才写入日志
-    if (!m_logFileCheck->isChecked() || m_settingsPanel->logFilePath().isEmpty()) {
-        return;
+// 开始日志会话: 每个串口一个日志文件(文件名后加端口名)
+// 追加/覆盖设置只在这里生效一次, 之后文件一直保持打开
+void MainWindow::startLogSession(SerialSession *session) {
+    const QString path = m_settingsPanel->logFilePath();
+    if (!m_logFileCheck->isChecked() || path.isEmpty() || session->logWriter().isOpen()) return;
+
+    QString error;
+    const QString portPath = SessionManager::perPortPath(path, session->portName());
+    session->logWriter().setRotation(m_settingsPanel->logRotation());
+    if (!session->logWriter().open(portPath, m_settingsPanel->isAppendMode(), &error)) {
+        statusBar()->showMessage("无法打开日志文件: " + error, 5000);
+    }
+}
+
+void MainWindow::startLogSessions() {
+    for (SerialSession *session : m_sessions->sessions()) {
+        if (session->isOpen()) startLogSession(session);
     }
+}
 
-    QFile file(m_settingsPanel->logFilePath());
-    QIODevice::OpenMode mode = m_settingsPanel->isAppendMode()
-                                   ? QIODevice::Append | QIODevice::Text
-                                   : QIODevice::WriteOnly | QIODevice::Text;
+void MainWindow::stopLogSessions() {
+    for (SerialSession *session : m_sessions->sessions()) session->logWriter().close();
+}
 
-    if (file.open(mode)) {
-        QTextStream stream(&file);
-        stream << QDateTime::currentDateTime().toString("[yyyy-MM-dd hh:mm:ss] ") << message << "\n";
-        file.close();
+void MainWindow::writeToLogFile(SerialSession *session, const QString &message) {
+    // 只有日志会话打开时才写入
+    if (!session->logWriter().isOpen()) {
+        return;
     }
+
+    QByteArray line = QDateTime::currentDateTime().toString("[yyyy-MM-dd hh:mm:ss] ").toUtf8();
+    line += message.toUtf8();
+    line += '\n';
+    session->logWriter().append(line);
 }
 
-// 刷新串口列表
+// 刷新串口列表: 只请求后台重新枚举, 有变化时由 onPortsChanged 更新
 void MainWindow::refreshPorts() {
-    statusBar()->showMessage("刷新串口列表");
-    m_portBox->clear();
-    foreach (const QSerialPortInfo &info, QSerialPortInfo::availablePorts()) {
-        m_portBox->addItem(info.portName());
+    statusBar()->showMessage("刷新串口列表", 2000);
+    m_discovery->rescan();
+}
+
+// 增量更新下拉框: 只增删变化的项, 按名称排序插入, 当前选中项不受其他串口变化影响
+// 已打开或等待重连的串口拔出后仍保留在列表中, 以便查看状态或取消重连
+void MainWindow::onPortsChanged(const QList<PortInfo> &added, const QStringList &removed) {
+    for (const QString &name : removed) {
+        const int index = m_portBox->findText(name);
+        if (index < 0) continue;
+        if (m_sessions->session(name) || m_sessions->isAwaitingReconnect(name)) {
+            m_portBox->setItemData(index, "已断开, 等待设备重新插入", Qt::ToolTipRole);
+        } else {
+            m_portBox->removeItem(index);
+        }
+    }
+    for (const PortInfo &port : added) {
+        int index = m_portBox->findText(port.portName);
+        if (index < 0) {
+            index = 0;
+            while (index < m_portBox->count() && m_portBox->itemText(index) < port.portName) ++index;
+            m_portBox->insertItem(index, port.portName);
+        }
+        m_portBox->setItemData(index, port.summary(), Qt::ToolTipRole);
+    }
+    updateOpenCloseButton();
+}
+
+void MainWindow::onSessionReconnecting(SerialSession *session, const QString &previousName) {
+    if (m_framingEnabled) session->frameParser().setSpec(m_frameSpec);
+    // 桥接的客户端在断开期间保持连接, 重连后继续
+    if (m_bridge && m_bridgePort == previousName) {
+        m_bridge->setSession(session);
+        m_bridgePort = session->portName();
+    }
+    // 重连后的日志接在断开前的内容之后, 不受覆盖设置影响
+    const QString path = m_settingsPanel->logFilePath();
+    if (m_logFileCheck->isChecked() && !path.isEmpty()) {
+        QString error;
+        session->logWriter().setRotation(m_settingsPanel->logRotation());
+        session->logWriter().open(SessionManager::perPortPath(path, session->portName()), true, &error);
+    }
+    statusBar()->showMessage(previousName == session->portName()
+                                 ? QString("正在重新连接 %1").arg(previousName)
+                                 : QString("正在重新连接 %1 (现为 %2)").arg(previousName).arg(session->portName()));
+    if (m_portBox->currentText() == previousName) {
+        if (previousName != session->portName()) dropMissingPort(previousName);
+        m_portBox->setCurrentText(session->portName());
     }
 }
 
+// 不再存在且没有会话使用的串口从列表中移除
+void MainWindow::dropMissingPort(const QString &portName) {
+    if (m_sessions->session(portName) || m_sessions->isAwaitingReconnect(portName)) return;
+    if (!m_discovery->port(portName).portName.isEmpty()) return;
+    const int index = m_portBox->findText(portName);
+    if (index >= 0) m_portBox->removeItem(index);
+}
+
 /*
  * 异步通信: 采用固定的数据格式(数据以相同的帧格式传送 - 起始位/数据位/奇偶校验位/停止位)
  * 同步通信: 双方共享一个时钟, 数据开始前传送一两个同步符号
@@ -204,49 +465,203 @@ void MainWindow::refreshPorts() {
  */
 
 // 打开/关闭串口
+// 每个串口是一个独立的会话, 可以同时打开多个; 按钮作用于当前选中的串口
+// 实际的打开/关闭在I/O线程中完成, 结果通过 SessionManager 的信号返回
 void MainWindow::onOpenCloseClicked() {
-    if (serial->isOpen()) {
-        serial->close();
-        m_openCloseButton->setText("打开串口");
-        statusBar()->showMessage("串口已关闭");
-        // 串口关闭后允许配置
-        m_settingsButton->setEnabled(true);
+    const QString portName = m_portBox->currentText();
+    if (portName.isEmpty()) return;
+
+    if (m_sessions->isAwaitingReconnect(portName)) {
+        m_sessions->cancelReconnect(portName);
+        statusBar()->showMessage(QString("已取消自动重连: %1").arg(portName), 3000);
+        dropMissingPort(portName);
+        updateOpenCloseButton();
+        return;
+    }
+
+    if (SerialSession *session = m_sessions->session(portName)) {
+        m_openCloseButton->setEnabled(false);
+        m_sessions->closeSession(session);
+        return;
+    }
+
+    // 设置只在打开时读取, 因此其他串口打开期间也可以为下一个串口修改配置
+    // 波特率: 表示每秒传输的符号数, 通信双方必须使用相同的波特率
+    // 比特率: 波特率 × 每个符号包含的比特数
+    const PortSettings settings = m_settingsPanel->portSettings(portName);
+    QString error;
+    if (!settings.validate(&error)) {
+        QMessageBox::warning(this, "警告", "串口参数无效: " + error);
+        return;
+    }
+
+    m_openCloseButton->setEnabled(false);
+    m_sessions->setCapturePath(m_settingsPanel->captureFilePath());
+    SerialSession *session = m_sessions->openSession(settings);
+    if (m_framingEnabled) session->frameParser().setSpec(m_frameSpec);
+}
+
+// 已打开的串口显示正在使用的参数, 否则恢复该串口上次成功打开时的参数(没有时保持面板当前值)
+void MainWindow::loadPortSettings(const QString &portName) {
+    if (portName.isEmpty()) return;
+    if (SerialSession *session = m_sessions->session(portName)) {
+        m_settingsPanel->setPortSettings(session->settings());
+        return;
+    }
+    m_settingsPanel->setPortSettings(PortSettings::load(portName, m_settingsPanel->portSettings(portName)));
+}
+
+// 桥接当前选中的串口; 监听地址记在 QSettings 中, 下次作为默认值
+void MainWindow::onBridgeToggled(bool enabled) {
+    if (!enabled) {
+        if (!m_bridge) return;
+        m_bridge->disconnect(this);
+        delete m_bridge;   // 断开所有客户端并停止监听
+        m_bridge = nullptr;
+        statusBar()->showMessage(QString("已停止桥接: %1").arg(m_bridgePort), 3000);
+        m_bridgePort.clear();
+        return;
+    }
+
+    SerialSession *session = m_sessions->session(m_portBox->currentText());
+    if (!session || !session->isOpen() || session->isReplay()) {
+        QMessageBox::warning(this, "警告", "请先打开要桥接的串口！");
+        m_bridgeButton->setChecked(false);
+        return;
+    }
+    QSettings settings;
+    bool ok = false;
+    const QString address = QInputDialog::getText(this, "串口桥接",
+                                                  "监听地址 (tcp:端口 / tcp:地址:端口 / unix:路径):", QLineEdit::Normal,
+                                                  settings.value("bridge/address", "tcp:127.0.0.1:5555").toString(), &ok);
+    if (!ok || address.trimmed().isEmpty()) {
+        m_bridgeButton->setChecked(false);
+        return;
+    }
+
+    PortBridge *bridge = new PortBridge(BridgeOptions(), this);
+    QString error;
+    if (!bridge->listen(address.trimmed(), &error)) {
+        delete bridge;
+        QMessageBox::critical(this, "错误", "无法监听 " + address + ": " + error);
+        m_bridgeButton->setChecked(false);
+        return;
+    }
+    settings.setValue("bridge/address", address.trimmed());
+    m_bridge = bridge;
+    m_bridgePort = session->portName();
+    m_bridge->setSession(session);
+    connect(m_bridge, &PortBridge::clientsChanged, this, [this](int count) {
+        statusBar()->showMessage(QString("桥接 %1 (%2): %3 个客户端").arg(m_bridgePort, m_bridge->address()).arg(count));
+    });
+    connect(m_bridge, &PortBridge::clientDropped, this, [this](const QString &peer, const QString &reason) {
+        statusBar()->showMessage(QString("桥接客户端 %1: %2").arg(peer, reason), 5000);
+    });
+    statusBar()->showMessage(QString("正在桥接 %1, 监听 %2").arg(m_bridgePort, m_bridge->address()));
+}
+
+static QString openModeString(QIODevice::OpenMode mode) {
+    if (mode == QIODevice::ReadOnly)  return "只读";
+    if (mode == QIODevice::WriteOnly) return "只写";
+    return "读写";
+}
+
+// 按钮文字反映当前选中串口的状态
+void MainWindow::updateOpenCloseButton() {
+    const QString portName = m_portBox->currentText();
+    SerialSession *session = m_sessions->session(portName);
+    if (!session && m_sessions->isAwaitingReconnect(portName)) {
+        m_openCloseButton->setEnabled(true);
+        m_openCloseButton->setText("取消重连");
+        return;
+    }
+    m_openCloseButton->setEnabled(!session || session->isOpen());
+    m_openCloseButton->setText(session ? "关闭串口" : "打开串口");
+}
+
+void MainWindow::onSessionOpened(SerialSession *session) {
+    if (session->isReplay()) {
+        // 回放会话不经过打开按钮, 在这里设置分帧; 所有回放会话打开后才开始送数据
+        if (m_framingEnabled) session->frameParser().setSpec(m_frameSpec);
+        statusBar()->showMessage(QString("开始回放: %1").arg(session->portName()));
     } else {
-        // 串口打开时禁止配置
-        m_settingsButton->setEnabled(false);
-
-        QIODevice::OpenMode mode =  m_settingsPanel->getopenMode();
-        QString modeStr;
-        switch (mode) {
-        case QIODevice::ReadOnly:  modeStr = "只读"; break;
-        case QIODevice::WriteOnly: modeStr = "只写"; break;
-        case QIODevice::ReadWrite: modeStr = "读写"; break;
-        }
+        // 只保存实际打开成功的参数
+        session->settings().save();
+        const QString modeStr = openModeString(session->settings().openMode);
+        statusBar()->showMessage(QString("串口已连接: %1 (%2), 共 %3 个串口")
+                                     .arg(session->portName()).arg(modeStr).arg(m_sessions->openCount()));
+    }
+    m_alarms.resetStream(session->portId());   // 端口号会被之后打开的串口复用
+    m_transactionDock->attach(session);
+    startLogSession(session);
+    if (!m_pollTimer->isActive()) m_pollTimer->start();
+    m_stats->start();
+    updateOpenCloseButton();
 
-        serial->setPortName(m_portBox->currentText());
-        // 波特率: 表示每秒传输的符号数, 通信双方必须使用相同的波特率
-        // 比特率: 波特率 × 每个符号包含的比特数
-        serial->setBaudRate(m_settingsPanel->getbaudRate());
-        serial->setDataBits(m_settingsPanel->getdataBits());
-        serial->setStopBits(m_settingsPanel->getstopBits());
-        serial->setParity(m_settingsPanel->getparity());
-        if (serial->open(mode)) { // 使用动态模式
-            m_openCloseButton->setText("关闭串口");
-            statusBar()->showMessage(QString("串口已连接: %1 (%2)").arg(serial->portName()).arg(modeStr));
-        } else {
-            QMessageBox::critical(this, "错误", QString("无法以%1模式打开串口: %2").arg(modeStr).arg(serial->errorString()));
-        }
+    connect(session, &SerialSession::scheduleStats, this, [this, session](const SendStats &stats) {
+        showSendStats(session, stats);
+    });
+    connect(session, &SerialSession::scheduleFinished, this, [this, session](const SendStats &stats) {
+        showSendStats(session, stats);
+        updateSendButton();
+    });
+}
+
+void MainWindow::onSessionFailed(SerialSession *session, const QString &errorString) {
+    const QString modeStr = openModeString(session->settings().openMode);
+    QMessageBox::critical(this, "错误", QString("无法以%1模式打开串口 %2: %3")
+                                          .arg(modeStr).arg(session->portName()).arg(errorString));
+    QTimer::singleShot(0, this, &MainWindow::updateOpenCloseButton);   // 会话随后被移除
+}
+
+void MainWindow::onSessionClosed(SerialSession *session) {
+    onSerialDataReceived();   // 取出关闭前已读到的数据
+    session->logWriter().close();
+    if (m_sessions->isAwaitingReconnect(session->portName())) {
+        statusBar()->showMessage(QString("串口已断开: %1, 设备重新插入后自动重连").arg(session->portName()));
+    } else {
+        statusBar()->showMessage(QString("串口已关闭: %1").arg(session->portName()));
+        if (m_bridge && m_bridgePort == session->portName()) m_bridgeButton->setChecked(false);
+    }
+    if (m_sessions->openCount() == 0) {
+        m_pollTimer->stop();
+        m_stats->stop();
+        m_statsLabel->clear();
     }
+    // 会话随后被移除; 拔出后手动关闭的串口此时才从列表中去掉
+    const QString portName = session->portName();
+    QTimer::singleShot(0, this, [this, portName]() {
+        dropMissingPort(portName);
+        updateOpenCloseButton();
+    });
 }
 
-void MainWindow::onSendClicked() {
-    if (!serial->isOpen()) {
+void MainWindow::onSessionError(SerialSession *session, const QString &errorString) {
+    statusBar()->showMessage(QString("串口错误 %1: %2").arg(session->portName()).arg(errorString), 5000);
+}
+
+// 取得当前选中且可写的会话, 不可用时提示并返回 nullptr
+SerialSession *MainWindow::writableSession() {
+    SerialSession *session = m_sessions->session(m_portBox->currentText());
+    if (!session || !session->isOpen()) {
         QMessageBox::warning(this, "警告", "请先打开串口！");
-        return;
+        return nullptr;
     }
 
-    if (serial->openMode() == QIODevice::ReadOnly) {
+    if (!session->canWrite()) {
         QMessageBox::warning(this, "警告", "当前串口为只读模式，无法发送数据！");
+        return nullptr;
+    }
+    return session;
+}
+
+void MainWindow::onSendClicked() {
+    SerialSession *session = writableSession();
+    if (!session) return;
+
+    // 定时发送进行中时, 按钮用于停止
+    if (session->isScheduleRunning()) {
+        session->stopSchedule();
         return;
     }
 
@@ -258,98 +673,518 @@ void MainWindow::onSendClicked() {
         timestamp = QDateTime::currentDateTime().toString("[hh:mm:ss.zzz] ");
     }
 
+    QByteArray payload;
     if (m_hexSendCheck->isChecked()) {
-        QByteArray hexData;
-        // 移除所有空格，确保格式正确
-        QString cleanData = data.replace(" ", "");
-        // 检查是否为有效的十六进制字符串
-        bool ok;
-        cleanData.toULongLong(&ok, 16);
-        if (!ok || cleanData.isEmpty()) {
+        // 解码时忽略空格并检查每个字符, 不限制长度
+        const QByteArray text = data.toLatin1();
+        payload.resize(text.size() / 2 + 1);
+        size_t len = 0;
+        const bool ok = HexKernels::decodeHex(text.constData(), size_t(text.size()),
+                                              reinterpret_cast<uint8_t *>(payload.data()), &len);
+        if (!ok || len == 0) {
             QMessageBox::warning(this, "警告", "无效的十六进制数据！");
-            m_sentHistory->append(timestamp + "未发送: " + data);
+            m_sentHistory->appendChunk(timestamp + portTag(session) + "未发送: " + data);
             return;
         }
-        hexData = QByteArray::fromHex(data.toLatin1());
-        serial->write(hexData);
-        m_sentHistory->append(timestamp + "发送: " + data);
+        payload.resize(int(len));
     } else {
-        serial->write(data.toUtf8());
-        m_sentHistory->append(timestamp + "发送: " + data);
+        payload = data.toUtf8();
+    }
+    const Checksum::Kind checksum = Checksum::Kind(m_sendChecksumBox->currentData().toInt());
+    if (checksum != Checksum::Kind::None) {
+        Checksum::append(checksum, &payload);
+        const int size = Checksum::algorithm(checksum).size;
+        data += QString(" [%1: %2]").arg(Checksum::algorithm(checksum).name)
+                    .arg(QString::fromLatin1(payload.right(size).toHex(' ').toUpper()));
+    }
+    const double periodMs = m_periodBox->value();
+    if (periodMs > 0) {
+        // 周期发送由I/O线程中的调度器按绝对时刻驱动, 保留输入框内容便于调整后重发
+        session->startSchedule(SendPlan::periodic(payload, qint64(periodMs * 1e6)));
+        m_sentHistory->appendChunk(timestamp + portTag(session) + QString("周期发送(%1 ms): ").arg(periodMs) + data);
+        updateSendButton();
+        writeToLogFile(session, QString("周期发送(%1 ms): ").arg(periodMs) + data);
+        return;
     }
 
+    // 交给I/O线程排队写出, 不在界面线程等待串口
+    session->write(payload);
+    m_sentHistory->appendChunk(timestamp + portTag(session) + "发送: " + data);
+
     m_sendEdit->clear();
 
-    if(!m_settingsPanel->logFilePath().isEmpty()) {
-        writeToLogFile("发送: " + data);
+    writeToLogFile(session, "发送: " + data);
+}
+
+void MainWindow::onSendScriptClicked() {
+    SerialSession *session = writableSession();
+    if (!session) return;
+
+    const QString path = QFileDialog::getOpenFileName(this, "打开发送脚本", QString(),
+                                                      "发送脚本 (*.txt *.send);;所有文件 (*.*)");
+    if (path.isEmpty()) return;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        QMessageBox::warning(this, "警告", "无法打开脚本: " + file.errorString());
+        return;
+    }
+    QString error;
+    const SendPlan plan = SendPlan::parseScript(QString::fromUtf8(file.readAll()), &error);
+    if (plan.entries.isEmpty()) {
+        QMessageBox::warning(this, "警告", "无效的发送脚本: " + error);
+        return;
+    }
+
+    session->startSchedule(plan);
+    m_sentHistory->appendChunk(portTag(session) + QString("脚本发送: %1 (%2 条, 循环 %3)")
+                                   .arg(path).arg(plan.entries.size())
+                                   .arg(plan.loops == 0 ? QString("无限") : QString::number(plan.loops)));
+    updateSendButton();
+}
+
+void MainWindow::onSendFileClicked() {
+    SerialSession *session = writableSession();
+    if (!session) return;
+
+    const QString path = QFileDialog::getOpenFileName(this, "选择要发送的文件");
+    if (path.isEmpty()) return;
+
+    SendPlan plan;
+    plan.filePath = path;
+    plan.lineRateBytesPerSec = session->settings().lineRateBytesPerSec();
+    session->startSchedule(plan);
+    m_sentHistory->appendChunk(portTag(session) + QString("发送文件: %1 (%2 字节)")
+                                   .arg(path).arg(QFileInfo(path).size()));
+    updateSendButton();
+}
+
+// 发送按钮文字反映当前选中串口是否正在定时发送
+void MainWindow::updateSendButton() {
+    SerialSession *session = m_sessions->session(m_portBox->currentText());
+    const bool running = session && session->isScheduleRunning();
+    m_sendButton->setText(running ? "停止" : "发送");
+    m_scriptButton->setEnabled(!running);
+    m_sendFileButton->setEnabled(!running);
+}
+
+void MainWindow::showSendStats(SerialSession *session, const SendStats &stats) {
+    QString text = portTag(session);
+    if (stats.fileStream) {
+        text += QString("%1/%2 KB/s")
+                    .arg(stats.achievedRate / 1024, 0, 'f', 1).arg(stats.requestedRate / 1024, 0, 'f', 1);
+    } else {
+        text += QString("%1/%2 条/s  抖动 平均 %3 us 最大 %4 us")
+                    .arg(stats.achievedRate, 0, 'f', 1).arg(stats.requestedRate, 0, 'f', 1)
+                    .arg(stats.jitterMeanUs, 0, 'f', 0).arg(stats.jitterMaxUs, 0, 'f', 0);
     }
+    if (stats.backpressureStalls) text += QString("  背压 %1 次").arg(stats.backpressureStalls);
+    if (stats.finished) text += QString("  已结束: %1 条 %2 字节").arg(stats.sent).arg(stats.bytes);
+    m_sendStatsLabel->setText(text);
 }
 
-// 转义控制字符
-QString MainWindow::escapeControlChars(const QString &input) {
-    qDebug() << "escapeControlChars.";
-    QString result;
-    for(QChar ch : input) {
-        ushort unicode = ch.unicode();
-        // 转义ASCII控制字符(0x00-0x1F)，但保留换行、回车和制表符
-        if(unicode < 32 && unicode != '\n' && unicode != '\r' && unicode != '\t') {
-            result += QString("\\x%1").arg(unicode, 2, 16, QChar('0'));
-        } else {
-            result += ch;
+// 状态栏摘要: 总吞吐、显示延迟和错误总数, 详细数据在统计面板中
+void MainWindow::onStatsSampled(const StatsSnapshot &snapshot) {
+    quint64 errors = 0;
+    qint64 logQueue = 0;
+    for (const PortStatsSample &port : snapshot.ports) {
+        errors += port.errors.total() + port.ringStalls + port.logDropped + port.logWriteErrors;
+        logQueue += port.logQueueBytes;
+        // 写盘失败意味着日志已经缺失数据, 每次新增时提示一次
+        quint64 &reported = m_reportedLogWriteErrors[port.portName];
+        if (port.logWriteErrors > reported) {
+            statusBar()->showMessage(QString("日志写入失败 %1: 共 %2 次, 请检查磁盘空间")
+                                         .arg(port.portName).arg(port.logWriteErrors), 10000);
+            reported = port.logWriteErrors;
+        }
+        quint64 &reportedRotation = m_reportedRotationFailures[port.portName];
+        if (port.logRotationFailures > reportedRotation) {
+            statusBar()->showMessage(QString("日志分段失败 %1: 无法改名, 继续写入原文件").arg(port.portName), 10000);
+            reportedRotation = port.logRotationFailures;
         }
     }
-    return result;
+    QString text = QString("RX %1 KB/s  TX %2 KB/s")
+                       .arg(snapshot.totalRxBytesPerSec() / 1024.0, 0, 'f', 1)
+                       .arg(snapshot.totalTxBytesPerSec() / 1024.0, 0, 'f', 1);
+    if (snapshot.latencySamples) {
+        text += QString("  延迟 p50 %1 ms p99 %2 ms")
+                    .arg(snapshot.latencyP50Us / 1000.0, 0, 'f', 1)
+                    .arg(snapshot.latencyP99Us / 1000.0, 0, 'f', 1);
+    }
+    if (logQueue) text += QString("  日志队列 %1 KB").arg(logQueue / 1024);
+    if (errors) text += QString("  错误/丢弃 %1").arg(errors);
+    if (m_sessions->isTriggerCaptureEnabled()) {
+        const TriggerCapture *trigger = m_sessions->triggerCapture();
+        text += QString("  触发环 %1/%2 MB, 已保存 %3")
+                    .arg(trigger->bufferedBytes() / 1048576.0, 0, 'f', 1)
+                    .arg(trigger->capacity() / 1048576).arg(trigger->savedCount());
+    }
+    m_statsLabel->setText(text);
 }
 
-// 过滤控制字符
-QString MainWindow::filterControlChars(const QString &input) {
-    qDebug() << "filterControlChars.";
-    QString result;
-    for(QChar ch : input) {
-        ushort unicode = ch.unicode();
-        // 保留可见字符和必要的空白字符
-        if(unicode >= 32 || unicode == '\n' || unicode == '\r' || unicode == '\t') {
-            result += ch;
-        }
+// 查找接收区: 同一查询第一次查找时统计总匹配数, 显示索引跳过的块数和耗时
+void MainWindow::onFindRequested(bool forward) {
+    QString error;
+    const SearchQuery query = m_searchBar->query(&error);
+    if (query.isEmpty()) {
+        m_searchBar->setResultText(error);
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const bool found = m_receiveEdit->findNext(query, forward);
+    const QString key = QString("%1|%2|%3").arg(int(query.kind)).arg(query.caseSensitive).arg(query.pattern);
+    if (key != m_countedQuery) {
+        m_countedQuery = key;
+        int scanned = 0;
+        const ScrollbackModel *model = m_receiveEdit->scrollbackModel();
+        const int matches = model->countMatches(query, &scanned);
+        const int blocks = (model->rowCount() + ScrollbackModel::kBlockLines - 1) / ScrollbackModel::kBlockLines;
+        m_searchBar->setResultText(QString("%1 条匹配 (检查 %2/%3 块, %4 ms)")
+                                       .arg(matches).arg(scanned).arg(blocks).arg(timer.elapsed()));
+    } else if (!found) {
+        m_searchBar->setResultText("没有匹配");
     }
-    return result;
+}
+
+void MainWindow::onSearchFilterChanged() {
+    m_countedQuery.clear();
+    if (!m_searchBar->filterEnabled()) {
+        m_receiveEdit->setFilter(SearchQuery());
+        return;
+    }
+    QString error;
+    const SearchQuery query = m_searchBar->query(&error);
+    if (!error.isEmpty()) {
+        m_searchBar->setResultText(error);
+        return;
+    }
+    m_receiveEdit->setFilter(query);
+}
+
+// 在原始捕获文件中搜索完整会话(不受接收区回滚上限影响), 结果在单独的窗口中列出
+void MainWindow::onSearchCaptureRequested() {
+    QString error;
+    const SearchQuery query = m_searchBar->query(&error);
+    if (query.isEmpty()) {
+        m_searchBar->setResultText(error.isEmpty() ? "请输入搜索内容" : error);
+        return;
+    }
+
+    QString path = m_settingsPanel->captureFilePath();
+    if (path.isEmpty() || !QFileInfo::exists(path)) {
+        path = QFileDialog::getOpenFileName(this, "选择捕获文件", QString(),
+                                            "捕获文件 (*.pyrocap);;所有文件 (*.*)");
+        if (path.isEmpty()) return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    if (!m_captureSearcher.open(path, &error)) {
+        QMessageBox::warning(this, "警告", "无法打开捕获文件: " + error);
+        return;
+    }
+    const qint64 indexMs = timer.restart();
+    const int maxHits = 10000;
+    const QVector<CaptureSearcher::Hit> hits = m_captureSearcher.search(query, maxHits);
+    const qint64 searchMs = timer.elapsed();
+
+    const CaptureReader &reader = m_captureSearcher.reader();
+    const qint64 startNs = reader.firstTimestampNs();
+    QDialog dialog(this);
+    dialog.setWindowTitle(QString("捕获搜索: %1").arg(query.pattern));
+    QVBoxLayout *layout = new QVBoxLayout(&dialog);
+    layout->addWidget(new QLabel(QString("%1 条记录匹配%2  (索引 %3 ms, 搜索 %4 ms, 检查 %5/%6 个区域)")
+                                     .arg(hits.size()).arg(hits.size() >= maxHits ? "(已达上限)" : "")
+                                     .arg(indexMs).arg(searchMs)
+                                     .arg(m_captureSearcher.lastScannedRegions())
+                                     .arg(m_captureSearcher.regionCount()), &dialog));
+    QListWidget *list = new QListWidget(&dialog);
+    list->setUniformItemSizes(true);
+    layout->addWidget(list);
+
+    CaptureReader::Record record;
+    for (const CaptureSearcher::Hit &hit : hits) {
+        if (!reader.readNext(hit.offset, &record, nullptr)) continue;
+        const SerialSession *session = m_sessions->session(hit.portId);
+        const QString port = session ? session->portName() : QString("端口%1").arg(hit.portId);
+        const QString dir = hit.direction == CaptureDirection::Tx ? "发送: " : "接收: ";
+        const QByteArray data = QByteArray::fromRawData(record.data, int(qMin<quint32>(record.length, 256)));
+        list->addItem(QString("[+%1 ms] [%2] ").arg((hit.timestampNs - startNs) / 1e6, 0, 'f', 3).arg(port)
+                      + dir + renderData(data));
+    }
+    dialog.resize(800, 500);
+    dialog.exec();
 }
 
 // 接收数据
+// 由 m_pollTimer 驱动, 取出所有会话的接收记录, 按时间顺序合并显示
 void MainWindow::onSerialDataReceived() {
-    QByteArray data = serial->readAll();
-    QString displayData;
-
-    if (m_hexReceiveCheck->isChecked()) {
-        // 十六进制显示（格式：A1 B2 C3）
-        displayData = data.toHex(' ').toUpper();
-    } else {
-        // 文本模式
-        if(m_settingsPanel->showControlCharacters()) {
-            // 显示控制字符（转义形式）
-            displayData = escapeControlChars(QString::fromUtf8(data));
+    // 每次拉取只读取一次显示设置
+    m_rxFormatter.setMode(displayMode());
+    m_rxFormatter.setTimestamps(m_settingsPanel->showTimeStamps());
+    const bool plotting = m_plotDock->isCollecting();
+    m_sessions->drain([this, plotting](SerialSession *session, qint64 timestampNs, const char *data, qsizetype size) {
+        // 桥接转发原始数据, 与显示的分帧设置无关
+        if (m_bridge && session == m_bridge->session()) m_bridge->onReceive(data, size);
+        // 报警同样在原始流上匹配; 需要高亮时标记本块数据显示成的行
+        int alarmActions = 0;
+        quint64 firstLine = 0;
+        if (m_alarms.isEnabled()) {
+            alarmActions = m_alarms.feed(session->portId(), timestampNs, data, size,
+                                         [this, session](const AlarmMatch &match) { onAlarm(session, match); });
+            if (alarmActions & AlarmRule::Highlight) firstLine = m_receiveEdit->nextLine();
+        }
+        if (m_framingEnabled) {
+            // 每个完整帧显示为一行; 帧视图直接指向接收缓冲, 不做拷贝
+            const quint64 checksumErrors = session->frameParser().checksumErrors();
+            session->frameParser().feed(data, size, [this, session, timestampNs, plotting](const FrameView &frame) {
+                displayReceived(session, timestampNs, frame.data, frame.size);
+                if (plotting) m_plotDock->feedFrame(session, timestampNs, frame.data, frame.size);
+                session->transactions().onReceive(timestampNs, frame.data, frame.size);
+            });
+            if (session->frameParser().checksumErrors() != checksumErrors && !session->isReplay())
+                m_sessions->fireTrigger(TriggerReason::Checksum, session->portId(), timestampNs);
         } else {
-            // 默认处理（过滤控制字符）
-            displayData = filterControlChars(QString::fromUtf8(data));
+            displayReceived(session, timestampNs, data, size, &session->textDecoder());
+            if (plotting) m_plotDock->feed(session, timestampNs, data, size);
+            session->transactions().onReceive(timestampNs, data, size);
+        }
+        if (alarmActions & AlarmRule::Highlight) {
+            const quint64 nextLine = m_receiveEdit->nextLine();
+            if (nextLine > firstLine) m_receiveEdit->markLines(firstLine, nextLine - 1);
+        }
+    });
+}
+
+void MainWindow::onFrameSpecChanged(const QString &text) {
+    if (text.isEmpty()) {
+        m_framingEnabled = false;
+        for (SerialSession *session : m_sessions->sessions()) session->frameParser().reset();
+        statusBar()->showMessage("已关闭分帧, 按原始数据块显示", 3000);
+        return;
+    }
+    QString error;
+    const FrameSpec spec = FrameSpec::parse(text, &error);
+    if (!spec.isValid()) {
+        QMessageBox::warning(this, "警告", "无效的帧格式: " + error);
+        return;
+    }
+    m_frameSpec = spec;
+    m_framingEnabled = true;
+    for (SerialSession *session : m_sessions->sessions()) session->frameParser().setSpec(spec);
+    statusBar()->showMessage("已启用分帧: " + text, 3000);
+}
+
+// 触发捕获与分帧无关, 在设置面板中修改后立即生效, 修改条件会重新分配内存环
+void MainWindow::onTriggerSpecChanged(const QString &text) {
+    if (text.isEmpty()) {
+        if (!m_sessions->isTriggerCaptureEnabled()) return;
+        m_sessions->disableTriggerCapture();
+        m_triggerButton->setEnabled(false);
+        statusBar()->showMessage("已关闭触发捕获", 3000);
+        return;
+    }
+    TriggerSpec spec;
+    QString error;
+    if (!TriggerSpec::parse(text, &spec, &error)) {
+        QMessageBox::warning(this, "警告", "无效的触发格式: " + error);
+        return;
+    }
+    if (spec.onChecksum && !m_framingEnabled) {
+        statusBar()->showMessage("checksum 触发需要先设置带校验的帧格式", 5000);
+    }
+    const QString directory = m_settingsPanel->triggerDirectory();
+    m_sessions->enableTriggerCapture(spec, directory);
+    m_triggerButton->setEnabled(true);
+    statusBar()->showMessage(QString("已启用触发捕获: 内存环 %1 MB, 保存到 %2")
+                                 .arg(spec.bufferBytes / 1048576).arg(directory), 5000);
+}
+
+// 规则文件为UTF-8文本; 加载失败时保留原来的规则
+void MainWindow::onAlarmRulesChanged(const QString &path) {
+    if (path.isEmpty()) {
+        if (!m_alarms.isEnabled()) return;
+        m_alarms.setRules({});
+        m_alarmLabel->hide();
+        statusBar()->showMessage("已关闭报警", 3000);
+        return;
+    }
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        QMessageBox::warning(this, "警告", "无法打开报警规则文件: " + file.errorString());
+        return;
+    }
+    QVector<AlarmRule> rules;
+    QString error;
+    if (!AlarmRule::parseList(QString::fromUtf8(file.readAll()), &rules, &error)) {
+        QMessageBox::warning(this, "警告", "无效的报警规则: " + error);
+        return;
+    }
+    m_alarms.setRules(rules);
+    statusBar()->showMessage(QString("已加载 %1 条报警规则, 自动机 %2 个状态")
+                                 .arg(rules.size()).arg(m_alarms.automaton().stateCount()), 5000);
+}
+
+// 状态栏常驻显示最近一次报警, 其余动作按规则执行; 抑制间隔由引擎处理
+void MainWindow::onAlarm(SerialSession *session, const AlarmMatch &match) {
+    const AlarmRule &rule = m_alarms.rules().at(match.rule);
+    if (rule.actions & AlarmRule::Status) {
+        QString text = QString("报警: %1 [%2] 第 %3 次").arg(rule.name, session->portName()).arg(match.count);
+        if (match.suppressed) text += QString(", 期间另有 %1 次").arg(match.suppressed);
+        m_alarmLabel->setText(text);
+        m_alarmLabel->show();
+        statusBar()->showMessage(text, 10000);
+    }
+    if (rule.actions & AlarmRule::Sound) QApplication::beep();
+    if (rule.actions & AlarmRule::Command) {
+        QString error;
+        if (!AlarmEngine::runCommand(rule, session->portName(), &error)) {
+            statusBar()->showMessage(QString("无法执行报警命令 %1: %2").arg(rule.command, error), 5000);
         }
     }
+}
 
-    // 添加时间戳（如果需要）
-    QString timestamp;
-    if(m_settingsPanel->showTimeStamps()) {
-        timestamp = QDateTime::currentDateTime().toString("[hh:mm:ss.zzz] ");
+// 同时打开多个串口时, 每行前标注来源端口
+QString MainWindow::portTag(SerialSession *session) const {
+    return m_sessions->sessions().size() > 1 ? "[" + session->portName() + "] " : QString();
+}
+
+// 当前的接收显示方式
+DataRender::Mode MainWindow::displayMode() const {
+    if (m_hexReceiveCheck->isChecked()) return DataRender::Mode::Hex;
+    if (m_settingsPanel->showControlCharacters()) return DataRender::Mode::Escape;   // 显示控制字符（转义形式）
+    return DataRender::Mode::Filter;                                                // 默认处理（过滤控制字符）
+}
+
+// 按当前的显示设置把原始字节渲染为文本
+QString MainWindow::renderData(const QByteArray &data) {
+    return DataRender::render(data, displayMode(), &m_renderBuffer);
+}
+
+// 接收热路径: 时间戳、端口标记和渲染结果都写入格式化器复用的UTF-8缓冲, 不经过 QString
+void MainWindow::displayReceived(SerialSession *session, qint64 timestampNs, const char *data, qsizetype size,
+                                 Utf8StreamDecoder *decoder) {
+    static const QByteArray noTag;
+    if (!m_rxFormatter.format(timestampNs, m_sessions->sessions().size() > 1 ? session->portTag() : noTag,
+                              data, size, decoder)) {
+        return;
+    }
+
+    // 由接收区按帧率批量插入并自动滚动
+    const QByteArray &line = m_rxFormatter.displayLine();
+    m_receiveEdit->appendUtf8(line.constData(), line.size(), timestampNs);
+
+    if (session->logWriter().isOpen()) session->logWriter().append(m_rxFormatter.logLine());
+}
+
+// 查看原始捕获文件: 文件只做内存映射, 按当前显示设置渲染前若干条记录
+// 也可以打开文本日志及其分段(含压缩的 .gz), 显示末尾部分
+void MainWindow::onOpenCaptureClicked() {
+    const QString path = QFileDialog::getOpenFileName(this, "打开捕获或日志文件", QString(),
+                                                      "捕获文件 (*.pyrocap);;日志文件 (*.txt *.log *.gz);;所有文件 (*.*)");
+    if (path.isEmpty()) return;
+    if (!path.endsWith(".pyrocap", Qt::CaseInsensitive)) {
+        openLogFile(path);
+        return;
+    }
+
+    CaptureReader reader;
+    QString error;
+    if (!reader.open(path, &error)) {
+        QMessageBox::warning(this, "警告", "无法打开捕获文件: " + error);
+        return;
+    }
+
+    m_receiveEdit->clear();
+    const qint64 startNs = reader.firstTimestampNs();
+    const int maxRecords = m_settingsPanel->scrollbackMaxLines();
+    CaptureReader::Record record;
+    qint64 offset = reader.firstOffset();
+    qint64 next = 0;
+    int count = 0;
+    while (count < maxRecords && reader.readNext(offset, &record, &next)) {
+        const QByteArray data = QByteArray::fromRawData(record.data, int(record.length));
+        const QString stamp = QString("[+%1 ms] ").arg((record.timestampNs - startNs) / 1e6, 0, 'f', 3);
+        const QString dir = record.direction == CaptureDirection::Tx ? "发送: " : "接收: ";
+        m_receiveEdit->appendChunk(stamp + dir + renderData(data));
+        offset = next;
+        ++count;
+    }
+    const double seconds = (reader.lastTimestampNs() - startNs) / 1e9;
+    statusBar()->showMessage(QString("捕获文件 %1: %2 MB, 时长 %3 s, 显示前 %4 条记录")
+                                 .arg(path).arg(reader.size() / 1048576.0, 0, 'f', 1)
+                                 .arg(seconds, 0, 'f', 1).arg(count));
+}
+
+// 只解压末尾的若干块, 按接收区的回滚上限截取, 多GB的压缩日志也能立即打开
+void MainWindow::openLogFile(const QString &path) {
+    LogSegmentReader reader;
+    QString error;
+    if (!reader.open(path, &error)) {
+        QMessageBox::warning(this, "警告", "无法打开日志文件: " + error);
+        return;
     }
+    QByteArray text = reader.tail(m_settingsPanel->scrollbackMaxBytes() / 2);
+    if (text.endsWith('\n')) text.chop(1);
+    m_receiveEdit->clear();
+    if (!text.isEmpty()) m_receiveEdit->appendUtf8(text.constData(), text.size());
+    statusBar()->showMessage(QString("日志文件 %1: %2 MB%3, 显示末尾 %4 KB")
+                                 .arg(path).arg(reader.size() / 1048576.0, 0, 'f', 1)
+                                 .arg(reader.isCompressed()
+                                          ? QString(" (压缩后 %1 MB)").arg(reader.compressedSize() / 1048576.0, 0, 'f', 1)
+                                          : QString())
+                                 .arg(text.size() / 1024));
+}
 
-    m_receiveEdit->append(timestamp + "接收: " + displayData);
+// 在日志的所有分段中搜索(从旧到新, 最后是当前文件), 逐块解压, 结果在单独的窗口中列出
+void MainWindow::onSearchLogRequested() {
+    QString error;
+    const SearchQuery query = m_searchBar->query(&error);
+    if (query.isEmpty()) {
+        m_searchBar->setResultText(error.isEmpty() ? "请输入搜索内容" : error);
+        return;
+    }
+    const QString path = QFileDialog::getOpenFileName(this, "选择日志文件", m_settingsPanel->logFilePath(),
+                                                      "日志文件 (*.txt *.log *.gz);;所有文件 (*.*)");
+    if (path.isEmpty()) return;
 
-    // 自动滚动到底部
-    QTextCursor cursor = m_receiveEdit->textCursor();
-    cursor.movePosition(QTextCursor::End);
-    m_receiveEdit->setTextCursor(cursor);
+    // 选中的是当前文件时连同它的分段一起搜索; 选中某个分段时只搜索该分段
+    QStringList files = LogArchive::segments(path);
+    files.append(path);
 
-    if(!m_settingsPanel->logFilePath().isEmpty()) {
-        writeToLogFile("接收: " + displayData);
+    QElapsedTimer timer;
+    timer.start();
+    const int maxHits = 10000;
+    qint64 totalBytes = 0;
+    QStringList hits;
+    LogSegmentReader reader;
+    for (const QString &file : files) {
+        if (!reader.open(file, &error)) continue;
+        totalBytes += reader.size();
+        const QString name = QFileInfo(file).fileName();
+        reader.forEachLine([&](qint64, const char *line, qsizetype n) {
+            if (query.matchesLine(line, n)) hits.append(name + ": " + QString::fromUtf8(line, int(qMin<qsizetype>(n, 512))));
+            return hits.size() < maxHits;
+        });
+        if (hits.size() >= maxHits) break;
     }
+    reader.close();
+    const qint64 searchMs = timer.elapsed();
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(QString("日志搜索: %1").arg(query.pattern));
+    QVBoxLayout *layout = new QVBoxLayout(&dialog);
+    layout->addWidget(new QLabel(QString("%1 行匹配%2  (%3 个文件, 原文 %4 MB, %5 ms)")
+                                     .arg(hits.size()).arg(hits.size() >= maxHits ? "(已达上限)" : "")
+                                     .arg(files.size()).arg(totalBytes / 1048576.0, 0, 'f', 1).arg(searchMs), &dialog));
+    QListWidget *list = new QListWidget(&dialog);
+    list->setUniformItemSizes(true);
+    list->addItems(hits);
+    layout->addWidget(list);
+    dialog.resize(800, 500);
+    dialog.exec();
 }
 
 void MainWindow::resizeEvent(QResizeEvent *event) {
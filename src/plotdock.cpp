@@ -0,0 +1,118 @@
+#include "plotdock.h"
+#include "serialsession.h"
+#include "telemetryplot.h"
+
+#include <QHBoxLayout>
+#include <QMessageBox>
+#include <QTimer>
+#include <QVBoxLayout>
+
+PlotDock::PlotDock(QWidget *parent)
+    : QDockWidget("曲线", parent)
+    , m_plot(new TelemetryPlot(&m_store, this))
+    , m_specEdit(new QLineEdit(this))
+    , m_applyButton(new QPushButton("应用", this))
+    , m_windowBox(new QDoubleSpinBox(this))
+    , m_pauseButton(new QPushButton("暂停", this))
+    , m_clearButton(new QPushButton("清空", this))
+    , m_statusLabel(new QLabel(this))
+{
+    setObjectName("plotDock");
+    setFeatures(QDockWidget::DockWidgetClosable | QDockWidget::DockWidgetMovable | QDockWidget::DockWidgetFloatable);
+
+    m_specEdit->setPlaceholderText("re:P=(?<pressure>[-\\d.]+)  或  pressure=3:i16be:0.01;flow=5:u16");
+    m_specEdit->setToolTip("正则: re:开头, 每个捕获组一个通道, 按行匹配\n"
+                           "帧字段: 名字=偏移:类型[:系数], 类型 u8/i8/u16/i16/u32/i32/f32, 加 be 为大端, 需启用分帧\n"
+                           "留空停止提取");
+    m_windowBox->setRange(0.1, 3600);
+    m_windowBox->setDecimals(1);
+    m_windowBox->setValue(10);
+    m_windowBox->setSuffix(" s");
+    m_windowBox->setToolTip("显示最近的时间范围");
+    m_pauseButton->setCheckable(true);
+
+    QWidget *content = new QWidget(this);
+    QVBoxLayout *layout = new QVBoxLayout(content);
+    layout->setContentsMargins(5, 5, 5, 5);
+    QHBoxLayout *specRow = new QHBoxLayout;
+    specRow->addWidget(m_specEdit, 1);
+    specRow->addWidget(m_applyButton);
+    layout->addLayout(specRow);
+    QHBoxLayout *controlRow = new QHBoxLayout;
+    controlRow->addWidget(new QLabel("时间窗:", this));
+    controlRow->addWidget(m_windowBox);
+    controlRow->addWidget(m_pauseButton);
+    controlRow->addWidget(m_clearButton);
+    controlRow->addWidget(m_statusLabel, 1);
+    layout->addLayout(controlRow);
+    layout->addWidget(m_plot, 1);
+    setWidget(content);
+
+    connect(m_applyButton, &QPushButton::clicked, this, &PlotDock::onApplyClicked);
+    connect(m_specEdit, &QLineEdit::returnPressed, this, &PlotDock::onApplyClicked);
+    connect(m_clearButton, &QPushButton::clicked, this, &PlotDock::onClearClicked);
+    connect(m_pauseButton, &QPushButton::toggled, m_plot, &TelemetryPlot::setPaused);
+    connect(m_windowBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), m_plot, &TelemetryPlot::setWindowSeconds);
+
+    QTimer *statusTimer = new QTimer(this);
+    connect(statusTimer, &QTimer::timeout, this, &PlotDock::updateStatus);
+    statusTimer->start(500);
+}
+
+void PlotDock::onApplyClicked()
+{
+    QString error;
+    const TelemetrySpec spec = TelemetrySpec::parse(m_specEdit->text(), &error);
+    if (!error.isEmpty()) {
+        QMessageBox::warning(this, "警告", "无效的提取格式: " + error);
+        return;
+    }
+    m_extractor.setSpec(spec);
+    onClearClicked();
+}
+
+// 通道随格式一起重建, 第一次收到某串口的某字段时再创建
+void PlotDock::onClearClicked()
+{
+    m_store.clear();
+    m_channels.clear();
+    m_extractor.reset();
+    updateStatus();
+}
+
+int PlotDock::channelFor(SerialSession *session, int field)
+{
+    const quint32 key = quint32(session->portId()) << 16 | quint32(field);
+    auto it = m_channels.constFind(key);
+    if (it != m_channels.constEnd()) return it.value();
+    const int channel = m_store.addChannel(session->portName() + " " + m_extractor.spec().channelNames.at(field));
+    m_channels.insert(key, channel);
+    return channel;
+}
+
+void PlotDock::feed(SerialSession *session, qint64 timestampNs, const char *data, qsizetype size)
+{
+    m_extractor.feedText(session->portId(), data, size, [&](int field, double value) {
+        m_store.append(channelFor(session, field), timestampNs, value);
+    });
+}
+
+void PlotDock::feedFrame(SerialSession *session, qint64 timestampNs, const char *data, qsizetype size)
+{
+    m_extractor.feedFrame(data, size, [&](int field, double value) {
+        m_store.append(channelFor(session, field), timestampNs, value);
+    });
+}
+
+void PlotDock::updateStatus()
+{
+    if (!isCollecting()) {
+        m_statusLabel->setText("未设置提取格式");
+        return;
+    }
+    qint64 samples = 0;
+    for (int ch = 0; ch < m_store.channelCount(); ++ch) samples += m_store.size(ch);
+    m_statusLabel->setText(QString("%1 个通道, %2 个样本, 未匹配 %3 行; 绘制 %4 点 %5 ms")
+                               .arg(m_store.channelCount()).arg(samples).arg(m_extractor.unmatchedRecords())
+                               .arg(m_plot->lastPointCount()).arg(m_plot->lastPaintMs(), 0, 'f', 2));
+}
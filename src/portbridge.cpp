@@ -0,0 +1,303 @@
+#include "portbridge.h"
+#include "serialsession.h"
+#include "serialworker.h"
+
+#include <QDir>
+#include <QFile>
+#include <QHostAddress>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+bool BridgeOptions::parsePolicy(const QString &name, BridgeDropPolicy *policy)
+{
+    const QString n = name.toLower();
+    if (n == "drop") {
+        *policy = BridgeDropPolicy::DropOldest;
+    } else if (n == "disconnect") {
+        *policy = BridgeDropPolicy::Disconnect;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+PortBridge::PortBridge(const BridgeOptions &options, QObject *parent)
+    : QObject(parent)
+    , m_options(options)
+    , m_buffer(int(kBufferSize), Qt::Uninitialized)
+{
+    m_options.maxLagBytes = qBound<qint64>(1, m_options.maxLagBytes, kBufferSize);
+    m_options.clientTxLimit = qMax<qint64>(kTxQuantum, m_options.clientTxLimit);
+}
+
+PortBridge::~PortBridge()
+{
+    close();
+}
+
+bool PortBridge::listen(const QString &address, QString *errorString)
+{
+    close();
+    auto fail = [&](const QString &message) {
+        if (errorString) *errorString = message;
+        close();
+        return false;
+    };
+
+    if (address.startsWith("unix:")) {
+        const QString path = address.mid(5);
+        if (path.isEmpty()) return fail("缺少套接字路径");
+        // 上次异常退出留下的套接字文件会让 listen 失败, 但只删除确实无人监听的套接字:
+        // 仍能连上说明另一个程序在用; 路径上是普通文件等时也不删除
+        {
+            QLocalSocket probe;
+            probe.connectToServer(path);
+            if (probe.waitForConnected(200)) {
+                probe.abort();
+                return fail("套接字正在被其他程序使用: " + path);
+            }
+        }
+#ifdef Q_OS_UNIX
+        // 不含路径的名称由 QLocalServer 放在临时目录下
+        const QString file = path.contains('/') ? path : QDir::tempPath() + "/" + path;
+        struct stat st;
+        if (::stat(QFile::encodeName(file).constData(), &st) == 0) {
+            if (!S_ISSOCK(st.st_mode)) return fail("路径已存在且不是套接字: " + file);
+            QLocalServer::removeServer(path);
+        }
+#endif
+        m_localServer = new QLocalServer(this);
+        m_localServer->setSocketOptions(QLocalServer::UserAccessOption);
+        connect(m_localServer, &QLocalServer::newConnection, this, [this]() {
+            while (QLocalSocket *socket = m_localServer->nextPendingConnection()) {
+                socket->setReadBufferSize(m_options.clientTxLimit);
+                connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+                    if (Client *client = findClient(socket)) removeClient(client, "连接已关闭");
+                });
+                onNewConnection(socket, "unix#" + QString::number(m_stats.accepted + 1));
+            }
+        });
+        if (!m_localServer->listen(path)) return fail(m_localServer->errorString());
+        return true;
+    }
+
+    // tcp:端口 / tcp:地址:端口, IPv6 地址写在方括号中
+    const QString spec = address.startsWith("tcp:") ? address.mid(4) : address;
+    const int colon = spec.lastIndexOf(':');
+    QHostAddress host(QHostAddress::LocalHost);
+    if (colon >= 0) {
+        QString hostName = spec.left(colon);
+        if (hostName.startsWith('[') && hostName.endsWith(']')) hostName = hostName.mid(1, hostName.size() - 2);
+        if (!host.setAddress(hostName)) return fail("无效的地址: " + hostName);
+    }
+    bool ok = false;
+    const int port = spec.mid(colon + 1).toInt(&ok);
+    if (!ok || port < 0 || port > 65535) return fail("无效的端口: " + spec.mid(colon + 1));
+
+    m_tcpServer = new QTcpServer(this);
+    connect(m_tcpServer, &QTcpServer::newConnection, this, [this]() {
+        while (QTcpSocket *socket = m_tcpServer->nextPendingConnection()) {
+            socket->setReadBufferSize(m_options.clientTxLimit);
+            socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+            connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+                if (Client *client = findClient(socket)) removeClient(client, "连接已关闭");
+            });
+            onNewConnection(socket, QString("%1:%2").arg(socket->peerAddress().toString()).arg(socket->peerPort()));
+        }
+    });
+    if (!m_tcpServer->listen(host, quint16(port))) return fail(m_tcpServer->errorString());
+    return true;
+}
+
+void PortBridge::close()
+{
+    while (!m_clients.isEmpty()) removeClient(m_clients.last(), "桥接已关闭");
+    if (m_tcpServer) {
+        m_tcpServer->close();
+        m_tcpServer->deleteLater();
+        m_tcpServer = nullptr;
+    }
+    if (m_localServer) {
+        m_localServer->close();
+        m_localServer->deleteLater();
+        m_localServer = nullptr;
+    }
+}
+
+bool PortBridge::isListening() const
+{
+    return (m_tcpServer && m_tcpServer->isListening()) || (m_localServer && m_localServer->isListening());
+}
+
+QString PortBridge::address() const
+{
+    if (m_localServer) return "unix:" + m_localServer->fullServerName();
+    if (!m_tcpServer) return QString();
+    const QHostAddress host = m_tcpServer->serverAddress();
+    const QString name = host.protocol() == QAbstractSocket::IPv6Protocol ? "[" + host.toString() + "]" : host.toString();
+    return QString("tcp:%1:%2").arg(name).arg(m_tcpServer->serverPort());
+}
+
+void PortBridge::setSession(SerialSession *session)
+{
+    if (m_session) disconnect(m_session->worker(), nullptr, this, nullptr);
+    m_session = session;
+    if (!session) return;
+    // 串口每写完一批, 就从客户端队列中补充
+    connect(session->worker(), &SerialWorker::dataWritten, this, &PortBridge::pumpTransmit);
+    pumpTransmit();
+}
+
+BridgeStats PortBridge::stats() const
+{
+    BridgeStats stats = m_stats;
+    stats.clients = m_clients.size();
+    return stats;
+}
+
+// 新客户端从当前位置开始接收, 不补发连接之前的数据
+void PortBridge::onNewConnection(QIODevice *socket, const QString &peer)
+{
+    ++m_stats.accepted;
+    if (m_clients.size() >= m_options.maxClients) {
+        socket->close();
+        socket->deleteLater();
+        emit clientDropped(peer, "客户端数已达上限");
+        return;
+    }
+    Client *client = new Client{socket, peer, m_head, QByteArray()};
+    m_clients.append(client);
+    connect(socket, &QIODevice::readyRead, this, [this, client]() {
+        readClient(client);
+        pumpTransmit();
+    });
+    connect(socket, &QIODevice::bytesWritten, this, [this, client]() { flushClient(client); });
+    emit clientsChanged(m_clients.size());
+    if (socket->bytesAvailable() > 0) readClient(client);
+}
+
+// 先断开信号再关闭: 关闭时发出的 disconnected 不会再次进入这里
+void PortBridge::removeClient(Client *client, const QString &reason)
+{
+    const int index = m_clients.indexOf(client);
+    if (index < 0) return;
+    m_clients.removeAt(index);
+    if (m_nextTx > index) --m_nextTx;
+    disconnect(client->socket, nullptr, this, nullptr);
+    if (QAbstractSocket *tcp = qobject_cast<QAbstractSocket *>(client->socket)) tcp->abort();
+    else if (QLocalSocket *local = qobject_cast<QLocalSocket *>(client->socket)) local->abort();
+    client->socket->deleteLater();
+    const QString peer = client->peer;
+    delete client;
+    emit clientDropped(peer, reason);
+    emit clientsChanged(m_clients.size());
+}
+
+PortBridge::Client *PortBridge::findClient(QIODevice *socket) const
+{
+    for (Client *client : m_clients) {
+        if (client->socket == socket) return client;
+    }
+    return nullptr;
+}
+
+// 数据先复制一次到共享缓冲区; 没有客户端时只推进位置
+void PortBridge::onReceive(const char *data, qsizetype size)
+{
+    m_stats.rxBytes += quint64(size);
+    if (m_clients.isEmpty()) {
+        m_head += quint64(size);
+        return;
+    }
+    if (size > kBufferSize) {
+        m_head += quint64(size - kBufferSize);
+        data += size - kBufferSize;
+        size = kBufferSize;
+    }
+    const qint64 offset = qint64(m_head & quint64(kBufferSize - 1));
+    const qint64 first = qMin<qint64>(size, kBufferSize - offset);
+    std::memcpy(m_buffer.data() + offset, data, size_t(first));
+    std::memcpy(m_buffer.data(), data + first, size_t(size - first));
+    m_head += quint64(size);
+
+    for (int i = 0; i < m_clients.size();) {
+        Client *client = m_clients.at(i);
+        const qint64 lag = qint64(m_head - client->cursor);
+        if (lag > m_options.maxLagBytes) {
+            if (m_options.policy == BridgeDropPolicy::Disconnect) {
+                ++m_stats.slowDisconnects;
+                removeClient(client, QString("落后 %1 KB, 已断开").arg(lag / 1024));
+                continue;
+            }
+            // 跳过全部积压: 客户端恢复后看到的是最新数据, 而不是一直追赶旧数据
+            m_stats.rxDropped += quint64(lag);
+            client->cursor = m_head;
+        }
+        flushClient(client);
+        ++i;
+    }
+}
+
+// write() 会把数据复制进套接字的内部缓冲, 每个客户端最多复制 kSocketWindow 字节,
+// 其余留在共享缓冲区中, 由 bytesWritten 继续
+void PortBridge::flushClient(Client *client)
+{
+    QIODevice *socket = client->socket;
+    while (client->cursor < m_head) {
+        const qint64 room = kSocketWindow - socket->bytesToWrite();
+        if (room <= 0) return;
+        const qint64 offset = qint64(client->cursor & quint64(kBufferSize - 1));
+        const qint64 span = qMin(qMin(qint64(m_head - client->cursor), kBufferSize - offset), room);
+        const qint64 n = socket->write(m_buffer.constData() + offset, span);
+        if (n <= 0) return;
+        client->cursor += quint64(n);
+    }
+}
+
+// 队列满时不读取, 数据留在套接字中; 套接字的读缓冲也有上限, 对端因此被阻塞
+void PortBridge::readClient(Client *client)
+{
+    if (m_options.readOnly) {
+        m_stats.txDiscarded += quint64(client->socket->readAll().size());
+        return;
+    }
+    const qint64 room = m_options.clientTxLimit - client->txPending.size();
+    if (room <= 0 || client->socket->bytesAvailable() <= 0) return;
+    client->txPending += client->socket->read(room);
+}
+
+// 轮询各客户端, 每次取一个份额写入串口, 一个客户端持续发送不会挡住其他客户端
+// 单次发送不超过 kTxQuantum 的命令不会被拆开; 更长的数据可能与其他客户端的数据交错
+void PortBridge::pumpTransmit()
+{
+    SerialSession *session = m_session;
+    if (!session || !session->isOpen() || m_clients.isEmpty()) return;
+    const bool writable = session->canWrite();
+    int idle = 0;
+    while (idle < m_clients.size()) {
+        if (writable && session->queuedBytes() >= kPortTxWindow) return;
+        if (m_nextTx >= m_clients.size()) m_nextTx = 0;
+        Client *client = m_clients.at(m_nextTx++);
+        if (client->txPending.isEmpty()) {
+            ++idle;
+            continue;
+        }
+        idle = 0;
+        const QByteArray chunk = client->txPending.left(int(kTxQuantum));
+        client->txPending.remove(0, chunk.size());
+        if (writable) {
+            session->write(chunk);
+            m_stats.txBytes += quint64(chunk.size());
+        } else {
+            m_stats.txDiscarded += quint64(chunk.size());   // 只读打开的串口
+        }
+        readClient(client);
+    }
+}
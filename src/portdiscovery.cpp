@@ -0,0 +1,243 @@
+#include "portdiscovery.h"
+
+#include <QSerialPortInfo>
+#include <QSocketNotifier>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+bool PortInfo::sameDevice(const PortInfo &other) const
+{
+    if (!serialNumber.isEmpty() || !other.serialNumber.isEmpty()) {
+        return serialNumber == other.serialNumber && vendorId == other.vendorId && productId == other.productId;
+    }
+    return portName == other.portName;
+}
+
+QString PortInfo::summary() const
+{
+    QStringList parts;
+    if (!description.isEmpty()) parts << description;
+    if (!manufacturer.isEmpty()) parts << manufacturer;
+    if (vendorId || productId) {
+        parts << QString("%1:%2").arg(vendorId, 4, 16, QChar('0')).arg(productId, 4, 16, QChar('0'));
+    }
+    if (!serialNumber.isEmpty()) parts << "S/N " + serialNumber;
+    parts << systemLocation;
+    return parts.join("\n");
+}
+
+bool PortInfo::operator==(const PortInfo &other) const
+{
+    return portName == other.portName && systemLocation == other.systemLocation
+        && description == other.description && manufacturer == other.manufacturer
+        && serialNumber == other.serialNumber && vendorId == other.vendorId && productId == other.productId;
+}
+
+namespace {
+
+QList<PortInfo> enumeratePorts()
+{
+    QList<PortInfo> ports;
+    const QList<QSerialPortInfo> infos = QSerialPortInfo::availablePorts();
+    for (const QSerialPortInfo &info : infos) {
+        PortInfo port;
+        port.portName = info.portName();
+        port.systemLocation = info.systemLocation();
+        port.description = info.description();
+        port.manufacturer = info.manufacturer();
+        port.serialNumber = info.serialNumber();
+        port.vendorId = info.hasVendorIdentifier() ? info.vendorIdentifier() : 0;
+        port.productId = info.hasProductIdentifier() ? info.productIdentifier() : 0;
+        ports.append(port);
+    }
+    std::sort(ports.begin(), ports.end(), [](const PortInfo &a, const PortInfo &b) { return a.portName < b.portName; });
+    return ports;
+}
+
+const PortInfo *findPort(const QList<PortInfo> &ports, const QString &portName)
+{
+    for (const PortInfo &port : ports) {
+        if (port.portName == portName) return &port;
+    }
+    return nullptr;
+}
+
+#ifdef Q_OS_LINUX
+// 只关心串口设备节点: ttyS/ttyUSB/ttyACM/ttyAMA 等以及蓝牙 rfcomm
+bool isSerialNode(const char *name)
+{
+    return std::strncmp(name, "tty", 3) == 0 || std::strncmp(name, "rfcomm", 6) == 0;
+}
+#endif
+
+} // namespace
+
+// 发现线程中的状态, 由 m_context 所在线程创建和销毁
+struct PortDiscovery::Watcher
+{
+    PortDiscovery *owner;
+    QObject *context;
+    QTimer *settleTimer = nullptr;
+    QTimer *pollTimer = nullptr;
+    QSocketNotifier *notifier = nullptr;
+    int fd = -1;
+    QList<PortInfo> last;
+    bool scanned = false;
+
+    Watcher(PortDiscovery *owner, QObject *context) : owner(owner), context(context) {}
+    ~Watcher();
+
+    void start();
+    void scan();
+    bool watchDevices();
+    void readEvents();
+};
+
+PortDiscovery::Watcher::~Watcher()
+{
+    delete notifier;
+    delete settleTimer;
+    delete pollTimer;
+#ifdef Q_OS_LINUX
+    if (fd >= 0) ::close(fd);
+#endif
+}
+
+void PortDiscovery::Watcher::start()
+{
+    settleTimer = new QTimer(context);
+    settleTimer->setSingleShot(true);
+    settleTimer->setInterval(kSettleMs);
+    QObject::connect(settleTimer, &QTimer::timeout, context, [this]() { scan(); });
+
+    const bool eventDriven = watchDevices();
+    if (!eventDriven) {
+        pollTimer = new QTimer(context);
+        pollTimer->setInterval(kPollIntervalMs);
+        QObject::connect(pollTimer, &QTimer::timeout, context, [this]() { scan(); });
+        pollTimer->start();
+    }
+    PortDiscovery *target = owner;
+    QMetaObject::invokeMethod(owner, [target, eventDriven]() { target->m_eventDriven = eventDriven; }, Qt::QueuedConnection);
+    scan();
+}
+
+// 只在结果变化时通知界面线程
+void PortDiscovery::Watcher::scan()
+{
+    const QList<PortInfo> ports = enumeratePorts();
+    if (scanned && ports == last) return;
+    last = ports;
+    scanned = true;
+    PortDiscovery *target = owner;
+    QMetaObject::invokeMethod(owner, [target, ports]() { target->apply(ports); }, Qt::QueuedConnection);
+}
+
+bool PortDiscovery::Watcher::watchDevices()
+{
+#ifdef Q_OS_LINUX
+    fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) return false;
+    // IN_ATTRIB: udev 在创建节点之后才修改权限, 此时重新枚举才能打开
+    if (::inotify_add_watch(fd, "/dev", IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB) < 0) {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    notifier = new QSocketNotifier(fd, QSocketNotifier::Read);
+    QObject::connect(notifier, &QSocketNotifier::activated, context, [this]() { readEvents(); });
+    return true;
+#else
+    return false;
+#endif
+}
+
+// 一次插拔会产生一串事件, 重新计时等待事件平息后只枚举一次
+void PortDiscovery::Watcher::readEvents()
+{
+#ifdef Q_OS_LINUX
+    alignas(struct inotify_event) char buffer[4096];
+    bool relevant = false;
+    for (;;) {
+        const ssize_t n = ::read(fd, buffer, sizeof(buffer));
+        if (n <= 0) break;
+        for (ssize_t pos = 0; pos < n;) {
+            const struct inotify_event *event = reinterpret_cast<const struct inotify_event *>(buffer + pos);
+            if ((event->mask & IN_Q_OVERFLOW) || (event->len > 0 && isSerialNode(event->name))) relevant = true;
+            pos += ssize_t(sizeof(struct inotify_event) + event->len);
+        }
+    }
+    if (relevant) settleTimer->start();
+#endif
+}
+
+PortDiscovery::PortDiscovery(QObject *parent)
+    : QObject(parent)
+    , m_thread(new QThread(this))
+    , m_context(new QObject)
+{
+    m_context->moveToThread(m_thread);
+}
+
+PortDiscovery::~PortDiscovery()
+{
+    if (m_thread->isRunning()) {
+        Watcher *watcher = m_watcher;
+        QMetaObject::invokeMethod(m_context, [watcher]() { delete watcher; }, Qt::BlockingQueuedConnection);
+        m_context->deleteLater();
+        m_thread->quit();
+        m_thread->wait();
+    } else {
+        delete m_context;
+    }
+}
+
+void PortDiscovery::start()
+{
+    if (m_thread->isRunning()) return;
+    m_thread->start();
+    m_watcher = new Watcher(this, m_context);
+    Watcher *watcher = m_watcher;
+    QMetaObject::invokeMethod(m_context, [watcher]() { watcher->start(); }, Qt::QueuedConnection);
+}
+
+void PortDiscovery::rescan()
+{
+    if (!m_thread->isRunning()) {
+        start();
+        return;
+    }
+    Watcher *watcher = m_watcher;
+    QMetaObject::invokeMethod(m_context, [watcher]() { watcher->scan(); }, Qt::QueuedConnection);
+}
+
+PortInfo PortDiscovery::port(const QString &portName) const
+{
+    const PortInfo *found = findPort(m_ports, portName);
+    return found ? *found : PortInfo();
+}
+
+void PortDiscovery::apply(const QList<PortInfo> &ports)
+{
+    QList<PortInfo> added;
+    QStringList removed;
+    for (const PortInfo &old : m_ports) {
+        const PortInfo *now = findPort(ports, old.portName);
+        if (!now || *now != old) removed.append(old.portName);
+    }
+    for (const PortInfo &port : ports) {
+        const PortInfo *old = findPort(m_ports, port.portName);
+        if (!old || *old != port) added.append(port);
+    }
+    m_ports = ports;
+    m_scanned = true;
+    if (!added.isEmpty() || !removed.isEmpty()) emit portsChanged(added, removed);
+}
@@ -0,0 +1,89 @@
+#include "portsettings.h"
+
+#include <QSettings>
+
+namespace {
+
+// 串口名可能带路径(/dev/ttyUSB0), QSettings 会把 '/' 当作分组
+QString settingsGroup(const QString &portName)
+{
+    QString key = portName;
+    key.replace('/', '_').replace('\\', '_');
+    return "ports/" + key;
+}
+
+} // namespace
+
+bool PortSettings::validate(QString *errorString) const
+{
+    auto fail = [errorString](const QString &message) {
+        if (errorString) *errorString = message;
+        return false;
+    };
+    if (baudRate < kMinBaudRate || baudRate > kMaxBaudRate)
+        return fail(QString("波特率 %1 超出范围 %2-%3").arg(baudRate).arg(kMinBaudRate).arg(kMaxBaudRate));
+    if (dataBits < QSerialPort::Data5 || dataBits > QSerialPort::Data8)
+        return fail(QString("无效的数据位: %1").arg(int(dataBits)));
+    // 枚举值不连续(没有 1; OneAndHalfStop 是 3), 保存的设置可能来自手工编辑
+    switch (parity) {
+    case QSerialPort::NoParity: case QSerialPort::EvenParity: case QSerialPort::OddParity:
+    case QSerialPort::SpaceParity: case QSerialPort::MarkParity: break;
+    default: return fail(QString("无效的校验位: %1").arg(int(parity)));
+    }
+    if (stopBits != QSerialPort::OneStop && stopBits != QSerialPort::OneAndHalfStop && stopBits != QSerialPort::TwoStop)
+        return fail(QString("无效的停止位: %1").arg(int(stopBits)));
+    if (flowControl != QSerialPort::NoFlowControl && flowControl != QSerialPort::HardwareControl
+        && flowControl != QSerialPort::SoftwareControl)
+        return fail(QString("无效的流控方式: %1").arg(int(flowControl)));
+    // 1.5 停止位只为 5 数据位定义, 其他组合多数 UART 不支持
+    if (stopBits == QSerialPort::OneAndHalfStop && dataBits != QSerialPort::Data5)
+        return fail("1.5 停止位只能与 5 数据位一起使用");
+    if (readBufferSize < 0)
+        return fail("读缓冲区大小不能为负数");
+    if (flowControl == QSerialPort::SoftwareControl && !(openMode & QIODevice::ReadOnly))
+        return fail("XON/XOFF 流控需要读取串口");
+    return true;
+}
+
+double PortSettings::bitsPerCharacter() const
+{
+    const double stop = stopBits == QSerialPort::OneAndHalfStop ? 1.5 : stopBits == QSerialPort::TwoStop ? 2 : 1;
+    return 1 + int(dataBits) + (parity == QSerialPort::NoParity ? 0 : 1) + stop;
+}
+
+void PortSettings::save() const
+{
+    QSettings settings;
+    settings.beginGroup(settingsGroup(portName));
+    settings.setValue("baudRate", baudRate);
+    settings.setValue("dataBits", int(dataBits));
+    settings.setValue("parity", int(parity));
+    settings.setValue("stopBits", int(stopBits));
+    settings.setValue("flowControl", int(flowControl));
+    settings.setValue("readBufferSize", readBufferSize);
+    settings.setValue("lowLatency", lowLatency);
+    settings.endGroup();
+}
+
+// 保存的值无效(手工编辑或旧版本)时整体回退到 defaults
+PortSettings PortSettings::load(const QString &portName, const PortSettings &defaults)
+{
+    PortSettings result = defaults;
+    result.portName = portName;
+    QSettings settings;
+    settings.beginGroup(settingsGroup(portName));
+    result.baudRate = settings.value("baudRate", defaults.baudRate).toInt();
+    result.dataBits = QSerialPort::DataBits(settings.value("dataBits", int(defaults.dataBits)).toInt());
+    result.parity = QSerialPort::Parity(settings.value("parity", int(defaults.parity)).toInt());
+    result.stopBits = QSerialPort::StopBits(settings.value("stopBits", int(defaults.stopBits)).toInt());
+    result.flowControl = QSerialPort::FlowControl(settings.value("flowControl", int(defaults.flowControl)).toInt());
+    result.readBufferSize = settings.value("readBufferSize", defaults.readBufferSize).toLongLong();
+    result.lowLatency = settings.value("lowLatency", defaults.lowLatency).toBool();
+    settings.endGroup();
+
+    if (!result.validate()) {
+        result = defaults;
+        result.portName = portName;
+    }
+    return result;
+}
@@ -0,0 +1,57 @@
+#include "receiveformatter.h"
+
+static const char kReceivePrefix[] = "接收: ";
+
+// reserve 之后 resize(0) 保留容量(Qt5 中没有 reserve 过的缓冲 resize(0) 会释放内存)
+ReceiveFormatter::ReceiveFormatter()
+{
+    m_display.reserve(4096);
+    m_log.reserve(4096);
+    m_decoded.reserve(4096);
+}
+
+bool ReceiveFormatter::format(qint64 timestampNs, const QByteArray &tag, const char *data, qsizetype n,
+                              Utf8StreamDecoder *decoder)
+{
+    if (decoder) {
+        if (m_mode == DataRender::Mode::Hex) {
+            // 十六进制显示逐字节输出; 从文本切换过来时解码器还暂存着半个字符,
+            // 这些字节已经收到, 放在本块之前一起显示, 不能丢掉
+            if (decoder->pendingBytes() > 0) {
+                m_decoded.resize(0);
+                decoder->takePending(&m_decoded);
+                m_decoded.append(data, int(n));
+                data = m_decoded.constData();
+                n = m_decoded.size();
+            }
+        } else {
+            m_decoded.resize(0);
+            decoder->decode(&m_decoded, data, n);
+            if (m_decoded.isEmpty() && n > 0) return false;
+            data = m_decoded.constData();
+            n = m_decoded.size();
+        }
+    }
+    m_timestampNs = timestampNs;
+    m_logValid = false;
+    m_display.resize(0);
+    if (m_timestamps) m_clock.appendTime(&m_display, timestampNs);
+    m_display.append(tag);
+    m_display.append(kReceivePrefix, int(sizeof(kReceivePrefix) - 1));
+    m_textStart = m_display.size();
+    DataRender::appendRendered(&m_display, data, n, m_mode);
+    return true;
+}
+
+const QByteArray &ReceiveFormatter::logLine()
+{
+    if (!m_logValid) {
+        m_log.resize(0);
+        m_clock.appendDateTime(&m_log, m_timestampNs);
+        m_log.append(kReceivePrefix, int(sizeof(kReceivePrefix) - 1));
+        m_log.append(text(), int(textSize()));
+        m_log.append('\n');
+        m_logValid = true;
+    }
+    return m_log;
+}
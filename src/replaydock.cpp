@@ -0,0 +1,142 @@
+#include "replaydock.h"
+#include "sessionmanager.h"
+
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QMessageBox>
+#include <QVBoxLayout>
+
+namespace {
+
+constexpr int kSliderSteps = 1000;
+
+} // namespace
+
+ReplayDock::ReplayDock(SessionManager *sessions, QWidget *parent)
+    : QDockWidget("回放", parent)
+    , m_sessions(sessions)
+    , m_fileLabel(new QLabel("未选择捕获文件", this))
+    , m_openButton(new QPushButton("回放捕获...", this))
+    , m_pauseButton(new QPushButton("暂停", this))
+    , m_stopButton(new QPushButton("停止", this))
+    , m_speedBox(new QComboBox(this))
+    , m_positionSlider(new QSlider(Qt::Horizontal, this))
+    , m_positionLabel(new QLabel(this))
+    , m_statusLabel(new QLabel(this))
+{
+    setObjectName("replayDock");
+    setFeatures(QDockWidget::DockWidgetClosable | QDockWidget::DockWidgetMovable | QDockWidget::DockWidgetFloatable);
+
+    // 倍速保存在条目数据中, 0 表示尽快
+    for (double factor : {0.1, 0.5, 1.0, 2.0, 5.0, 10.0, 100.0})
+        m_speedBox->addItem(QString("%1×").arg(factor), factor);
+    m_speedBox->addItem("尽快", 0.0);
+    m_speedBox->setCurrentIndex(m_speedBox->findData(1.0));
+    m_speedBox->setToolTip("尽快: 不等待原来的时间间隔, 结束时的速率即接收路径的吞吐");
+    m_pauseButton->setCheckable(true);
+    m_positionSlider->setRange(0, kSliderSteps);
+    m_positionSlider->setToolTip("拖动跳转");
+    m_statusLabel->setWordWrap(true);
+
+    QWidget *content = new QWidget(this);
+    QVBoxLayout *layout = new QVBoxLayout(content);
+    layout->setContentsMargins(5, 5, 5, 5);
+    QHBoxLayout *fileRow = new QHBoxLayout;
+    fileRow->addWidget(m_openButton);
+    fileRow->addWidget(m_fileLabel, 1);
+    layout->addLayout(fileRow);
+    QHBoxLayout *controlRow = new QHBoxLayout;
+    controlRow->addWidget(new QLabel("速度:", this));
+    controlRow->addWidget(m_speedBox);
+    controlRow->addWidget(m_pauseButton);
+    controlRow->addWidget(m_stopButton);
+    controlRow->addWidget(m_positionSlider, 1);
+    controlRow->addWidget(m_positionLabel);
+    layout->addLayout(controlRow);
+    layout->addWidget(m_statusLabel);
+    layout->addStretch(1);
+    setWidget(content);
+
+    connect(m_openButton, &QPushButton::clicked, this, &ReplayDock::onOpenClicked);
+    connect(m_stopButton, &QPushButton::clicked, m_sessions, &SessionManager::stopReplay);
+    connect(m_pauseButton, &QPushButton::toggled, m_sessions, &SessionManager::setReplayPaused);
+    connect(m_speedBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &ReplayDock::onSpeedChanged);
+    connect(m_positionSlider, &QSlider::sliderReleased, this, &ReplayDock::onSliderReleased);
+    connect(m_sessions, &SessionManager::replayProgress, this, &ReplayDock::onProgress);
+    connect(m_sessions, &SessionManager::replayFinished, this, &ReplayDock::onFinished);
+    updateControls();
+}
+
+double ReplayDock::speed() const
+{
+    return m_speedBox->currentData().toDouble();
+}
+
+void ReplayDock::updateControls()
+{
+    const bool replaying = m_sessions->isReplaying();
+    m_openButton->setEnabled(!replaying);
+    m_pauseButton->setEnabled(replaying);
+    m_stopButton->setEnabled(replaying);
+    m_positionSlider->setEnabled(replaying);
+}
+
+void ReplayDock::onOpenClicked()
+{
+    const QString path = QFileDialog::getOpenFileName(this, "回放捕获文件", QString(),
+                                                      "捕获文件 (*.pyrocap);;所有文件 (*.*)");
+    if (path.isEmpty()) return;
+
+    QString error;
+    if (!m_sessions->openReplay(path, speed(), &error)) {
+        QMessageBox::warning(this, "警告", "无法回放捕获文件: " + error);
+        return;
+    }
+    m_fileLabel->setText(QFileInfo(path).fileName());
+    m_fileLabel->setToolTip(path);
+    m_pauseButton->setChecked(false);
+    m_positionSlider->setValue(0);
+    m_statusLabel->setText(QString("时长 %1 s")
+                               .arg((m_sessions->replayLastNs() - m_sessions->replayFirstNs()) / 1e9, 0, 'f', 1));
+    updateControls();
+}
+
+void ReplayDock::onSpeedChanged()
+{
+    m_sessions->setReplaySpeed(speed());
+}
+
+void ReplayDock::onSliderReleased()
+{
+    const qint64 first = m_sessions->replayFirstNs();
+    const qint64 span = m_sessions->replayLastNs() - first;
+    m_sessions->seekReplay(first + qint64(double(span) * m_positionSlider->value() / kSliderSteps));
+}
+
+QString ReplayDock::formatStats(const ReplayStats &stats) const
+{
+    return QString("%1 条记录, %2 MB, 用时 %3 s, %4 MB/s, %5 条/s, 缓冲区满 %6 次")
+        .arg(stats.records).arg(stats.bytes / 1048576.0, 0, 'f', 2).arg(stats.elapsedNs / 1e9, 0, 'f', 2)
+        .arg(stats.bytesPerSec() / 1048576.0, 0, 'f', 1).arg(stats.recordsPerSec(), 0, 'f', 0)
+        .arg(stats.ringStalls);
+}
+
+void ReplayDock::onProgress(const ReplayStats &stats)
+{
+    const qint64 first = m_sessions->replayFirstNs();
+    const qint64 span = qMax<qint64>(1, m_sessions->replayLastNs() - first);
+    if (!m_positionSlider->isSliderDown())
+        m_positionSlider->setValue(int(double(stats.positionNs - first) * kSliderSteps / span));
+    m_positionLabel->setText(QString("%1 / %2 s").arg((stats.positionNs - first) / 1e9, 0, 'f', 1)
+                                 .arg(span / 1e9, 0, 'f', 1));
+    m_statusLabel->setText(formatStats(stats));
+}
+
+void ReplayDock::onFinished(const ReplayStats &stats)
+{
+    if (stats.finished) m_positionSlider->setValue(kSliderSteps);
+    m_statusLabel->setText((stats.finished ? "回放结束: " : "回放已停止: ") + formatStats(stats));
+    m_pauseButton->setChecked(false);
+    updateControls();
+}
@@ -0,0 +1,220 @@
+#include "scrollbackmodel.h"
+
+#include <QBrush>
+#include <QColor>
+#include <algorithm>
+#include <cstring>
+
+ScrollbackModel::ScrollbackModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int ScrollbackModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_lineCount;
+}
+
+QVariant ScrollbackModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_lineCount) return QVariant();
+    if (role == Qt::DisplayRole || role == Qt::ToolTipRole) return lineAt(index.row());
+    if (role == Qt::BackgroundRole && isMarked(index.row())) return QBrush(QColor(255, 205, 205));
+    return QVariant();
+}
+
+QString ScrollbackModel::lineAt(int row) const
+{
+    const Block &block = m_blocks[size_t(row / kBlockLines)];
+    const int i = row % kBlockLines;
+    const int start = block.lineStart(i);
+    return QString::fromUtf8(block.text.constData() + start, block.ends.at(i) - start);
+}
+
+// 最后一块写满时换新块, 优先复用丢弃的旧块, 保留其容量
+ScrollbackModel::Block &ScrollbackModel::writableBlock()
+{
+    if (m_blocks.empty() || m_blocks.back().lineCount() == kBlockLines) {
+        if (m_spare.empty()) {
+            m_blocks.emplace_back();
+            m_blocks.back().ends.reserve(kBlockLines);
+        } else {
+            m_blocks.push_back(std::move(m_spare.back()));
+            m_spare.pop_back();
+        }
+        m_blocks.back().bytes = BigramFilter::kBytes;
+        m_bytes += BigramFilter::kBytes;
+    }
+    return m_blocks.back();
+}
+
+void ScrollbackModel::appendText(const char *utf8, qsizetype size)
+{
+    int lines = 1;
+    for (const char *p = utf8, *end = utf8 + size;
+         (p = static_cast<const char *>(std::memchr(p, '\n', size_t(end - p)))) != nullptr; ++p) {
+        ++lines;
+    }
+
+    beginInsertRows(QModelIndex(), m_lineCount, m_lineCount + lines - 1);
+    const char *line = utf8;
+    const char *end = utf8 + size;
+    for (int i = 0; i < lines; ++i) {
+        const char *next = static_cast<const char *>(std::memchr(line, '\n', size_t(end - line)));
+        const qsizetype n = (next ? next : end) - line;
+        Block &block = writableBlock();
+        block.text.append(line, int(n));
+        block.ends.append(block.text.size());
+        block.filter.add(line, n);
+        // 字节数按UTF-8数据加每行4字节的偏移表计算
+        block.bytes += n + 4;
+        m_bytes += n + 4;
+        line += n + 1;
+    }
+    m_lineCount += lines;
+    endInsertRows();
+
+    trim();
+}
+
+void ScrollbackModel::setLimits(int maxLines, qint64 maxBytes)
+{
+    m_maxLines = qMax(kBlockLines, maxLines);
+    m_maxBytes = qMax<qint64>(1024 * 1024, maxBytes);
+    trim();
+}
+
+void ScrollbackModel::clear()
+{
+    beginResetModel();
+    m_blocks.clear();
+    m_spare.clear();
+    m_marked.clear();
+    m_lineCount = 0;
+    m_bytes = 0;
+    endResetModel();
+}
+
+void ScrollbackModel::markLines(quint64 first, quint64 last)
+{
+    if (!m_marked.empty()) first = qMax(first, m_marked.back() + 1);
+    if (last >= quint64(kMaxMarkedLines)) first = qMax(first, last - kMaxMarkedLines + 1);
+    for (quint64 line = first; line <= last; ++line) m_marked.push_back(line);
+    while (m_marked.size() > size_t(kMaxMarkedLines)) m_marked.pop_front();
+    // 通常标记的是尚未刷新到模型的行; 已显示的行需要重绘
+    const quint64 appended = appendedLines();
+    if (first < appended && first <= last) {
+        const int top = int(qMax(first, m_droppedLines) - m_droppedLines);
+        const int bottom = int(qMin(last, appended - 1) - m_droppedLines);
+        if (top <= bottom) emit dataChanged(index(top), index(bottom), {Qt::BackgroundRole});
+    }
+}
+
+bool ScrollbackModel::isMarked(int row) const
+{
+    return !m_marked.empty() && std::binary_search(m_marked.cbegin(), m_marked.cend(), m_droppedLines + quint64(row));
+}
+
+// 整块丢弃最旧的行, 保留正在写入的最后一块
+void ScrollbackModel::trim()
+{
+    while (m_blocks.size() > 1 && (m_lineCount > m_maxLines || m_bytes > m_maxBytes)) {
+        Block &front = m_blocks.front();
+        const int n = front.lineCount();
+        beginRemoveRows(QModelIndex(), 0, n - 1);
+        m_bytes -= front.bytes;
+        m_lineCount -= n;
+        m_droppedLines += quint64(n);
+        // 只保留一个备用块; 其余的释放, 以免上限调小后内存不回落
+        if (m_spare.empty()) {
+            front.text.resize(0);
+            front.ends.resize(0);
+            front.filter.clear();
+            m_spare.push_back(std::move(front));
+        }
+        m_blocks.pop_front();
+        endRemoveRows();
+    }
+    while (!m_marked.empty() && m_marked.front() < m_droppedLines) m_marked.pop_front();
+}
+
+bool ScrollbackModel::blockMayMatch(const Block &block, const SearchQuery &query)
+{
+    if (!query.isLiteral()) return true;
+    for (const QByteArray &needle : query.lineNeedles) {
+        if (block.filter.mayContain(needle)) return true;
+    }
+    return false;
+}
+
+bool ScrollbackModel::lineMatches(const Block &block, int i, const SearchQuery &query)
+{
+    const int start = block.lineStart(i);
+    return query.matchesLine(block.text.constData() + start, block.ends.at(i) - start);
+}
+
+bool ScrollbackModel::blockMayMatch(int row, const SearchQuery &query) const
+{
+    return blockMayMatch(m_blocks[size_t(row / kBlockLines)], query);
+}
+
+bool ScrollbackModel::lineMatches(int row, const SearchQuery &query) const
+{
+    return lineMatches(m_blocks[size_t(row / kBlockLines)], row % kBlockLines, query);
+}
+
+int ScrollbackModel::findRow(const SearchQuery &query, int fromRow, bool forward) const
+{
+    if (query.isEmpty() || fromRow < 0 || fromRow >= m_lineCount) return -1;
+    int row = fromRow;
+    while (row >= 0 && row < m_lineCount) {
+        const int blockIndex = row / kBlockLines;
+        const Block &block = m_blocks[size_t(blockIndex)];
+        if (blockMayMatch(block, query)) {
+            const int first = blockIndex * kBlockLines;
+            const int last = first + block.lineCount() - 1;
+            for (; row >= first && row <= last; row += forward ? 1 : -1) {
+                if (lineMatches(block, row - first, query)) return row;
+            }
+        } else {
+            row = forward ? (blockIndex + 1) * kBlockLines : blockIndex * kBlockLines - 1;
+        }
+    }
+    return -1;
+}
+
+int ScrollbackModel::countMatches(const SearchQuery &query, int *scannedBlocks) const
+{
+    int count = 0;
+    int scanned = 0;
+    if (!query.isEmpty()) {
+        for (const Block &block : m_blocks) {
+            if (!blockMayMatch(block, query)) continue;
+            ++scanned;
+            for (int i = 0; i < block.lineCount(); ++i) {
+                if (lineMatches(block, i, query)) ++count;
+            }
+        }
+    }
+    if (scannedBlocks) *scannedBlocks = scanned;
+    return count;
+}
+
+ScrollbackFilterModel::ScrollbackFilterModel(ScrollbackModel *source, QObject *parent)
+    : QSortFilterProxyModel(parent)
+    , m_source(source)
+{
+    setSourceModel(source);
+}
+
+void ScrollbackFilterModel::setQuery(const SearchQuery &query)
+{
+    m_query = query;
+    invalidateFilter();
+}
+
+bool ScrollbackFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex &) const
+{
+    if (m_query.isEmpty()) return true;
+    return m_source->blockMayMatch(sourceRow, m_query) && m_source->lineMatches(sourceRow, m_query);
+}
@@ -0,0 +1,161 @@
+#include "scrollbackview.h"
+#include "scrollbackmodel.h"
+#include "latencyhistogram.h"
+#include "serialworker.h"
+
+#include <QApplication>
+#include <QClipboard>
+#include <QKeyEvent>
+#include <QScrollBar>
+#include <algorithm>
+
+ScrollbackView::ScrollbackView(QWidget *parent)
+    : QListView(parent)
+    , m_model(new ScrollbackModel(this))
+    , m_filter(new ScrollbackFilterModel(m_model, this))
+    , m_flushTimer(new QTimer(this))
+{
+    setModel(m_model);
+    setUniformItemSizes(true);   // 所有行等高, 视图无需逐行测量
+    setEditTriggers(QAbstractItemView::NoEditTriggers);
+    setSelectionMode(QAbstractItemView::ExtendedSelection);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    m_pending.reserve(256 * 1024);
+    m_pendingSources.reserve(1024);
+    m_flushTimer->setSingleShot(true);
+    setMaxFlushRate(30);
+    connect(m_flushTimer, &QTimer::timeout, this, &ScrollbackView::flush);
+}
+
+void ScrollbackView::setMaxFlushRate(int hz)
+{
+    m_flushTimer->setInterval(1000 / qMax(1, hz));
+}
+
+void ScrollbackView::setLimits(int maxLines, qint64 maxBytes)
+{
+    m_model->setLimits(maxLines, maxBytes);
+}
+
+void ScrollbackView::appendChunk(const QString &text, qint64 sourceNs)
+{
+    const QByteArray utf8 = text.toUtf8();
+    appendUtf8(utf8.constData(), utf8.size(), sourceNs);
+}
+
+void ScrollbackView::appendUtf8(const char *text, qsizetype size, qint64 sourceNs)
+{
+    // 各数据块之间以 '\n' 分隔, 与原来逐块拆行的结果相同
+    if (m_pendingChunks > 0) m_pending.append('\n');
+    m_pending.append(text, int(size));
+    if (sourceNs > 0 && m_latency) m_pendingSources.append(sourceNs);
+    ++m_pendingChunks;
+    ++m_chunkCount;
+    // 定时器已在运行时不重启, 保证刷新间隔不会被持续到来的数据无限推迟
+    if (!m_flushTimer->isActive()) m_flushTimer->start();
+}
+
+quint64 ScrollbackView::nextLine()
+{
+    if (m_pendingChunks == 0) return m_model->appendedLines();
+    m_countedLines += int(std::count(m_pending.constData() + m_countedBytes, m_pending.constData() + m_pending.size(), '\n'));
+    m_countedBytes = m_pending.size();
+    // 待刷新的数据作为一个整体追加, 行数为换行数 + 1, 下一块之前还会补一个换行
+    return m_model->appendedLines() + quint64(m_countedLines) + 1;
+}
+
+void ScrollbackView::markLines(quint64 first, quint64 last)
+{
+    m_model->markLines(first, last);
+}
+
+void ScrollbackView::clear()
+{
+    m_flushTimer->stop();
+    m_pending.resize(0);
+    m_pendingChunks = 0;
+    m_countedBytes = 0;
+    m_countedLines = 0;
+    m_pendingSources.resize(0);
+    m_model->clear();
+}
+
+void ScrollbackView::flush()
+{
+    if (m_pendingChunks == 0) return;
+
+    // 只有用户停留在底部时才自动滚动, 方便向上翻看历史
+    QScrollBar *bar = verticalScrollBar();
+    const bool atBottom = bar->value() == bar->maximum();
+
+    m_model->appendText(m_pending.constData(), m_pending.size());
+    if (atBottom) scrollToBottom();
+
+    const int chunks = m_pendingChunks;
+    m_flushedChunks += quint64(chunks);
+    ++m_flushCount;
+    // resize(0) 保留容量, 下一批数据不必重新分配
+    m_pending.resize(0);
+    m_pendingChunks = 0;
+    m_countedBytes = 0;
+    m_countedLines = 0;
+
+    if (m_latency && !m_pendingSources.isEmpty()) {
+        const qint64 now = SerialWorker::monotonicNs();
+        for (qint64 sourceNs : m_pendingSources) m_latency->record(now - sourceNs);
+        m_pendingSources.resize(0);
+    }
+    emit flushed(chunks);
+}
+
+void ScrollbackView::setFilter(const SearchQuery &query)
+{
+    if (query.isEmpty()) {
+        if (isFiltering()) setModel(m_model);
+    } else {
+        m_filter->setQuery(query);
+        if (!isFiltering()) setModel(m_filter);
+    }
+    scrollToBottom();
+}
+
+bool ScrollbackView::findNext(const SearchQuery &query, bool forward)
+{
+    const int count = m_model->rowCount();
+    if (query.isEmpty() || count == 0) return false;
+
+    // 过滤开启时跳过被过滤掉的匹配行
+    const int step = forward ? 1 : -1;
+    auto findVisible = [&](int from) {
+        for (int row = m_model->findRow(query, from, forward); row >= 0; row = m_model->findRow(query, row + step, forward)) {
+            if (!isFiltering() || m_filter->mapFromSource(m_model->index(row)).isValid()) return row;
+        }
+        return -1;
+    };
+
+    // 从当前行的下一行开始, 找不到时从另一端回绕一次
+    const QModelIndex current = isFiltering() ? m_filter->mapToSource(currentIndex()) : currentIndex();
+    int row = findVisible(current.isValid() ? current.row() + step : (forward ? 0 : count - 1));
+    if (row < 0) row = findVisible(forward ? 0 : count - 1);
+    if (row < 0) return false;
+
+    QModelIndex index = m_model->index(row);
+    if (isFiltering()) index = m_filter->mapFromSource(index);
+    setCurrentIndex(index);
+    scrollTo(index, QAbstractItemView::PositionAtCenter);
+    return true;
+}
+
+// 复制选中的行
+void ScrollbackView::keyPressEvent(QKeyEvent *event)
+{
+    if (event->matches(QKeySequence::Copy)) {
+        QModelIndexList rows = selectionModel()->selectedRows();
+        std::sort(rows.begin(), rows.end());
+        QStringList lines;
+        for (const QModelIndex &index : rows) lines.append(index.data().toString());
+        QApplication::clipboard()->setText(lines.join('\n'));
+        return;
+    }
+    QListView::keyPressEvent(event);
+}
@@ -0,0 +1,75 @@
+#include "searchbar.h"
+
+#include <QHBoxLayout>
+#include <QKeyEvent>
+
+SearchBar::SearchBar(QWidget *parent)
+    : QWidget(parent)
+    , m_kindBox(new QComboBox(this))
+    , m_patternEdit(new QLineEdit(this))
+    , m_caseCheck(new QCheckBox("区分大小写", this))
+    , m_prevButton(new QPushButton("上一个", this))
+    , m_nextButton(new QPushButton("下一个", this))
+    , m_filterCheck(new QCheckBox("仅显示匹配", this))
+    , m_captureButton(new QPushButton("搜索捕获...", this))
+    , m_logButton(new QPushButton("搜索日志...", this))
+    , m_resultLabel(new QLabel(this))
+    , m_filterDelay(new QTimer(this))
+{
+    m_kindBox->addItem("文本", int(SearchQuery::Kind::Text));
+    m_kindBox->addItem("Hex", int(SearchQuery::Kind::Hex));
+    m_kindBox->addItem("正则", int(SearchQuery::Kind::Regex));
+    m_patternEdit->setPlaceholderText("搜索接收区, 例如 ERROR / AA 55 / ^T=\\d+");
+    m_patternEdit->setClearButtonEnabled(true);
+    m_resultLabel->setMinimumWidth(120);
+    m_filterDelay->setSingleShot(true);
+    m_filterDelay->setInterval(250);
+
+    QHBoxLayout *layout = new QHBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(new QLabel("搜索:", this));
+    layout->addWidget(m_kindBox);
+    layout->addWidget(m_patternEdit, 1);
+    layout->addWidget(m_caseCheck);
+    layout->addWidget(m_prevButton);
+    layout->addWidget(m_nextButton);
+    layout->addWidget(m_filterCheck);
+    layout->addWidget(m_captureButton);
+    layout->addWidget(m_logButton);
+    layout->addWidget(m_resultLabel);
+
+    connect(m_nextButton, &QPushButton::clicked, this, [this]() { emit findRequested(true); });
+    connect(m_prevButton, &QPushButton::clicked, this, [this]() { emit findRequested(false); });
+    connect(m_captureButton, &QPushButton::clicked, this, &SearchBar::captureSearchRequested);
+    connect(m_logButton, &QPushButton::clicked, this, &SearchBar::logSearchRequested);
+    connect(m_filterCheck, &QCheckBox::toggled, this, &SearchBar::filterChanged);
+    connect(m_filterDelay, &QTimer::timeout, this, &SearchBar::filterChanged);
+    auto queryEdited = [this]() {
+        m_resultLabel->clear();
+        if (filterEnabled()) m_filterDelay->start();
+    };
+    connect(m_patternEdit, &QLineEdit::textChanged, this, queryEdited);
+    connect(m_kindBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, queryEdited);
+    connect(m_caseCheck, &QCheckBox::toggled, this, queryEdited);
+}
+
+SearchQuery SearchBar::query(QString *errorString) const
+{
+    const auto kind = SearchQuery::Kind(m_kindBox->currentData().toInt());
+    return SearchQuery::parse(kind, m_patternEdit->text(), m_caseCheck->isChecked(), errorString);
+}
+
+void SearchBar::focusSearch()
+{
+    m_patternEdit->setFocus();
+    m_patternEdit->selectAll();
+}
+
+void SearchBar::keyPressEvent(QKeyEvent *event)
+{
+    if (event->key() == Qt::Key_Return || event->key() == Qt::Key_Enter) {
+        emit findRequested(!(event->modifiers() & Qt::ShiftModifier));
+        return;
+    }
+    QWidget::keyPressEvent(event);
+}
@@ -0,0 +1,96 @@
+#include "searchquery.h"
+#include "datarender.h"
+#include "hexkernels.h"
+
+#include <cstring>
+
+SearchQuery SearchQuery::parse(Kind kind, const QString &pattern, bool caseSensitive, QString *errorString)
+{
+    SearchQuery query;
+    query.kind = kind;
+    query.caseSensitive = caseSensitive;
+    if (pattern.isEmpty()) return query;
+
+    switch (kind) {
+    case Kind::Text:
+        query.bytes = pattern.toUtf8();
+        query.lineNeedles.append(query.bytes);
+        break;
+    case Kind::Hex: {
+        const QByteArray text = pattern.toLatin1();
+        QByteArray decoded(text.size() / 2 + 1, Qt::Uninitialized);
+        size_t len = 0;
+        if (!HexKernels::decodeHex(text.constData(), size_t(text.size()),
+                                   reinterpret_cast<uint8_t *>(decoded.data()), &len) || len == 0) {
+            if (errorString) *errorString = "无效的十六进制数据";
+            return SearchQuery();
+        }
+        decoded.resize(int(len));
+        query.bytes = decoded;
+        // 十六进制显示时每行是 "AA 55 ..", 文本显示时是原文
+        query.lineNeedles.append(DataRender::hexSpaced(decoded).toLatin1());
+        query.lineNeedles.append(decoded);
+        break;
+    }
+    case Kind::Regex:
+        query.regex.setPattern(pattern);
+        if (!caseSensitive) query.regex.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
+        if (!query.regex.isValid()) {
+            if (errorString) *errorString = "无效的正则表达式: " + query.regex.errorString();
+            return SearchQuery();
+        }
+        query.regex.optimize();
+        break;
+    }
+    query.pattern = pattern;
+    return query;
+}
+
+static inline uchar foldAscii(uchar c)
+{
+    return (c >= 'A' && c <= 'Z') ? uchar(c | 0x20) : c;
+}
+
+static qsizetype findNeedle(const char *data, qsizetype n, const QByteArray &needle, bool foldCase)
+{
+    const qsizetype m = needle.size();
+    if (m == 0 || m > n) return -1;
+    const char *p = needle.constData();
+    if (!foldCase) {
+        const char *end = data + n - m + 1;
+        for (const char *q = data; q < end; ++q) {
+            q = static_cast<const char *>(std::memchr(q, p[0], size_t(end - q)));
+            if (!q) return -1;
+            if (std::memcmp(q, p, size_t(m)) == 0) return q - data;
+        }
+        return -1;
+    }
+    const uchar first = foldAscii(uchar(p[0]));
+    for (qsizetype i = 0; i + m <= n; ++i) {
+        if (foldAscii(uchar(data[i])) != first) continue;
+        qsizetype j = 1;
+        while (j < m && foldAscii(uchar(data[i + j])) == foldAscii(uchar(p[j]))) ++j;
+        if (j == m) return i;
+    }
+    return -1;
+}
+
+bool SearchQuery::matchesLine(const char *line, qsizetype n) const
+{
+    if (kind == Kind::Regex) return regex.match(QString::fromUtf8(line, int(n))).hasMatch();
+    for (const QByteArray &needle : lineNeedles) {
+        if (findNeedle(line, n, needle, !caseSensitive) >= 0) return true;
+    }
+    return false;
+}
+
+qsizetype SearchQuery::indexIn(const char *data, qsizetype n) const
+{
+    if (kind == Kind::Regex) {
+        // 正则按 Latin-1 解释原始字节, 每个字节对应一个字符, 匹配位置即字节偏移
+        const QRegularExpressionMatch match = regex.match(QString::fromLatin1(data, int(n)));
+        return match.hasMatch() ? match.capturedStart() : -1;
+    }
+    // 十六进制查询总是精确匹配字节
+    return findNeedle(data, n, bytes, !caseSensitive && kind == Kind::Text);
+}
@@ -0,0 +1,318 @@
+#include "sendscheduler.h"
+#include "hexkernels.h"
+#include "serialworker.h"
+
+#include <QSocketNotifier>
+#include <QStringList>
+#include <QTimer>
+#include <cmath>
+
+#ifdef Q_OS_LINUX
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+// ---------------------------------------------------------------- SendPlan
+
+SendPlan SendPlan::periodic(const QByteArray &payload, qint64 intervalNs, int loops)
+{
+    SendPlan plan;
+    plan.entries.append({payload, intervalNs});
+    plan.loops = loops;
+    return plan;
+}
+
+static QByteArray unescapeText(const QString &text)
+{
+    QByteArray out;
+    const QByteArray utf8 = text.toUtf8();
+    for (int i = 0; i < utf8.size(); ++i) {
+        const char c = utf8.at(i);
+        if (c != '\\' || i + 1 >= utf8.size()) {
+            out.append(c);
+            continue;
+        }
+        const char e = utf8.at(++i);
+        switch (e) {
+        case 'r':  out.append('\r'); break;
+        case 'n':  out.append('\n'); break;
+        case 't':  out.append('\t'); break;
+        case '\\': out.append('\\'); break;
+        default:   out.append('\\').append(e); break;
+        }
+    }
+    return out;
+}
+
+SendPlan SendPlan::parseScript(const QString &script, QString *errorString)
+{
+    SendPlan plan;
+    auto fail = [&](int line, const QString &message) {
+        if (errorString) *errorString = QString("第%1行: %2").arg(line).arg(message);
+        return SendPlan();
+    };
+
+    const QStringList lines = script.split('\n');
+    for (int i = 0; i < lines.size(); ++i) {
+        const QString line = lines.at(i).trimmed();
+        if (line.isEmpty() || line.startsWith('#')) continue;
+
+        const QStringList parts = line.split(' ', Qt::SkipEmptyParts);
+        if (parts.at(0) == "loop") {
+            bool ok = false;
+            plan.loops = parts.value(1).toInt(&ok);
+            if (!ok || plan.loops < 0) return fail(i + 1, "loop 次数无效");
+            continue;
+        }
+        if (parts.size() < 3) return fail(i + 1, "格式为 <间隔ms> hex|text <数据>");
+
+        bool ok = false;
+        const double intervalMs = parts.at(0).toDouble(&ok);
+        if (!ok || intervalMs < 0) return fail(i + 1, "间隔无效");
+
+        // 数据部分保留原始空白
+        const int dataStart = line.indexOf(parts.at(1), parts.at(0).size()) + parts.at(1).size() + 1;
+        const QString data = line.mid(dataStart);
+        SendEntry entry;
+        entry.intervalNs = qint64(intervalMs * 1e6);
+        if (parts.at(1) == "hex") {
+            const QByteArray text = data.toLatin1();
+            entry.payload.resize(text.size() / 2 + 1);
+            size_t len = 0;
+            if (!HexKernels::decodeHex(text.constData(), size_t(text.size()),
+                                       reinterpret_cast<uint8_t *>(entry.payload.data()), &len) || len == 0)
+                return fail(i + 1, "无效的十六进制数据");
+            entry.payload.resize(int(len));
+        } else if (parts.at(1) == "text") {
+            entry.payload = unescapeText(data);
+        } else {
+            return fail(i + 1, "未知类型: " + parts.at(1));
+        }
+        plan.entries.append(entry);
+    }
+
+    if (plan.entries.isEmpty()) return fail(lines.size(), "脚本中没有发送条目");
+    return plan;
+}
+
+// ---------------------------------------------------------------- SendScheduler
+
+SendScheduler::SendScheduler(SerialWorker *worker)
+    : QObject(worker)
+    , m_worker(worker)
+    , m_statsTimer(new QTimer(this))
+{
+    qRegisterMetaType<SendStats>();
+
+#ifdef Q_OS_LINUX
+    m_timerFd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+#endif
+    if (m_timerFd >= 0) {
+        m_notifier = new QSocketNotifier(m_timerFd, QSocketNotifier::Read, this);
+        m_notifier->setEnabled(false);
+        connect(m_notifier, &QSocketNotifier::activated, this, &SendScheduler::onTimer);
+    } else {
+        m_timer = new QTimer(this);
+        m_timer->setTimerType(Qt::PreciseTimer);
+        m_timer->setSingleShot(true);
+        connect(m_timer, &QTimer::timeout, this, &SendScheduler::onTimer);
+    }
+
+    m_statsTimer->setInterval(500);
+    connect(m_statsTimer, &QTimer::timeout, this, [this]() { emit statsUpdated(currentStats()); });
+    connect(m_worker, &SerialWorker::dataWritten, this, &SendScheduler::onDrained);
+}
+
+SendScheduler::~SendScheduler()
+{
+#ifdef Q_OS_LINUX
+    if (m_timerFd >= 0) ::close(m_timerFd);
+#endif
+}
+
+void SendScheduler::start(const SendPlan &plan)
+{
+    // 替换正在运行的计划时不发出 finished, 避免界面把新计划当成已结束
+    halt();
+    m_plan = plan;
+    m_index = 0;
+    m_loop = 0;
+    m_sent = 0;
+    m_bytes = 0;
+    m_stalls = 0;
+    m_jitterSumUs = 0;
+    m_jitterMaxUs = 0;
+    m_waitingForDrain = false;
+    m_startNs = SerialWorker::monotonicNs();
+    m_deadlineNs = m_startNs;
+
+    if (m_plan.isFileStream()) {
+        m_file.setFileName(m_plan.filePath);
+        if (!m_file.open(QIODevice::ReadOnly)) {
+            SendStats stats;
+            stats.finished = true;
+            emit finished(stats);
+            return;
+        }
+        m_running = true;
+        m_statsTimer->start();
+        pumpFile();
+        return;
+    }
+
+    if (m_plan.entries.isEmpty()) return;
+    m_running = true;
+    m_statsTimer->start();
+    sendDue();
+}
+
+void SendScheduler::stop()
+{
+    if (!m_running) return;
+    finish();
+}
+
+void SendScheduler::halt()
+{
+    m_running = false;
+    m_waitingForDrain = false;
+    disarmTimer();
+    m_statsTimer->stop();
+    if (m_file.isOpen()) m_file.close();
+}
+
+void SendScheduler::finish()
+{
+    halt();
+    SendStats stats = currentStats();
+    stats.finished = true;
+    emit finished(stats);
+}
+
+void SendScheduler::armTimer(qint64 deadlineNs)
+{
+#ifdef Q_OS_LINUX
+    if (m_timerFd >= 0) {
+        itimerspec spec = {};
+        spec.it_value.tv_sec = time_t(deadlineNs / 1000000000);
+        spec.it_value.tv_nsec = long(deadlineNs % 1000000000);
+        if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0) spec.it_value.tv_nsec = 1;
+        ::timerfd_settime(m_timerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+        m_notifier->setEnabled(true);
+        return;
+    }
+#endif
+    const qint64 remainingMs = (deadlineNs - SerialWorker::monotonicNs()) / 1000000;
+    m_timer->start(int(qMax<qint64>(0, remainingMs)));
+}
+
+void SendScheduler::disarmTimer()
+{
+#ifdef Q_OS_LINUX
+    if (m_timerFd >= 0) {
+        const itimerspec spec = {};
+        ::timerfd_settime(m_timerFd, 0, &spec, nullptr);
+        m_notifier->setEnabled(false);
+        return;
+    }
+#endif
+    m_timer->stop();
+}
+
+void SendScheduler::onTimer()
+{
+#ifdef Q_OS_LINUX
+    if (m_timerFd >= 0) {
+        quint64 expirations = 0;
+        if (::read(m_timerFd, &expirations, sizeof(expirations)) < 0) { /* 已被重新设定, 忽略 */ }
+        m_notifier->setEnabled(false);
+    }
+#endif
+    if (m_running && !m_plan.isFileStream()) sendDue();
+}
+
+void SendScheduler::onDrained()
+{
+    if (!m_running) return;
+    if (m_plan.isFileStream()) {
+        pumpFile();
+    } else if (m_waitingForDrain && m_worker->outstandingBytes() < kMaxOutstanding) {
+        m_waitingForDrain = false;
+        sendDue();
+    }
+}
+
+// 发送所有已到计划时刻的条目, 然后按下一条的计划时刻设定定时器
+void SendScheduler::sendDue()
+{
+    while (m_running) {
+        const qint64 now = SerialWorker::monotonicNs();
+        if (now < m_deadlineNs) {
+            armTimer(m_deadlineNs);
+            return;
+        }
+        if (m_worker->outstandingBytes() >= kMaxOutstanding) {
+            // 串口写不过来: 等 bytesWritten 后再发, 迟到的时间计入抖动
+            ++m_stalls;
+            m_waitingForDrain = true;
+            return;
+        }
+
+        const SendEntry &entry = m_plan.entries.at(m_index);
+        const double jitterUs = double(now - m_deadlineNs) / 1000.0;
+        m_jitterSumUs += jitterUs;
+        m_jitterMaxUs = qMax(m_jitterMaxUs, jitterUs);
+        m_worker->writeData(entry.payload);
+        ++m_sent;
+        m_bytes += quint64(entry.payload.size());
+
+        m_deadlineNs += entry.intervalNs;
+        if (++m_index == m_plan.entries.size()) {
+            m_index = 0;
+            if (m_plan.loops > 0 && ++m_loop >= m_plan.loops) {
+                finish();
+                return;
+            }
+        }
+    }
+}
+
+// 文件流模式: 只要写队列有空间就继续读文件发送, 以线路最大速率传输
+void SendScheduler::pumpFile()
+{
+    while (m_running && m_worker->outstandingBytes() < kMaxOutstanding) {
+        m_fileChunk.resize(m_plan.fileChunkSize);
+        const qint64 n = m_file.read(m_fileChunk.data(), m_fileChunk.size());
+        if (n <= 0) {
+            // 等最后的数据写完再结束, 速率统计才准确
+            if (m_worker->outstandingBytes() == 0) finish();
+            return;
+        }
+        m_fileChunk.resize(int(n));
+        m_worker->writeData(m_fileChunk);
+        ++m_sent;
+        m_bytes += quint64(n);
+    }
+}
+
+SendStats SendScheduler::currentStats() const
+{
+    SendStats stats;
+    stats.sent = m_sent;
+    stats.bytes = m_bytes;
+    stats.elapsedSec = double(SerialWorker::monotonicNs() - m_startNs) / 1e9;
+    stats.backpressureStalls = m_stalls;
+    stats.fileStream = m_plan.isFileStream();
+    if (stats.fileStream) {
+        stats.requestedRate = double(m_plan.lineRateBytesPerSec);
+        stats.achievedRate = stats.elapsedSec > 0 ? double(m_bytes) / stats.elapsedSec : 0;
+    } else {
+        qint64 cycleNs = 0;
+        for (const SendEntry &entry : m_plan.entries) cycleNs += entry.intervalNs;
+        stats.requestedRate = cycleNs > 0 ? double(m_plan.entries.size()) * 1e9 / double(cycleNs) : 0;
+        stats.achievedRate = stats.elapsedSec > 0 ? double(m_sent) / stats.elapsedSec : 0;
+        stats.jitterMeanUs = m_sent ? m_jitterSumUs / double(m_sent) : 0;
+        stats.jitterMaxUs = m_jitterMaxUs;
+    }
+    return stats;
+}
@@ -0,0 +1,106 @@
+#include "serialsession.h"
+#include "serialworker.h"
+
+SerialSession::SerialSession(quint8 portId, const PortSettings &settings, QObject *parent)
+    : QObject(parent)
+    , m_portId(portId)
+    , m_settings(settings)
+    , m_portTag("[" + settings.portName.toUtf8() + "] ")
+    , m_worker(new SerialWorker(portId))   // 由 SessionManager 移动到I/O线程
+{
+    m_staged.reserve(256);
+    m_arena.reserve(64 * 1024);
+    connect(m_worker, &SerialWorker::portOpened, this, [this](bool ok, const QString &error) {
+        m_open = ok;
+        emit opened(ok, error);
+    });
+    connect(m_worker, &SerialWorker::portClosed, this, [this]() {
+        m_open = false;
+        emit closed();
+    });
+    connect(m_worker, &SerialWorker::errorOccurred, this, &SerialSession::errorOccurred);
+    connect(m_worker->scheduler(), &SendScheduler::statsUpdated, this, &SerialSession::scheduleStats);
+    connect(m_worker->scheduler(), &SendScheduler::finished, this, [this](const SendStats &stats) {
+        m_scheduleRunning = false;
+        emit scheduleFinished(stats);
+    });
+}
+
+SerialSession::~SerialSession()
+{
+    // 工作对象属于I/O线程, 交给该线程的事件循环删除(析构时关闭串口)
+    m_worker->deleteLater();
+}
+
+void SerialSession::write(const QByteArray &data)
+{
+    // 交给I/O线程排队写出, 不在界面线程等待串口
+    m_worker->post(data);
+}
+
+qint64 SerialSession::queuedBytes() const
+{
+    return m_worker->queuedBytes();
+}
+
+void SerialSession::close()
+{
+    m_closeRequested = true;
+    QMetaObject::invokeMethod(m_worker, &SerialWorker::closePort, Qt::QueuedConnection);
+}
+
+void SerialSession::startSchedule(const SendPlan &plan)
+{
+    m_scheduleRunning = true;
+    SendScheduler *scheduler = m_worker->scheduler();
+    QMetaObject::invokeMethod(scheduler, [scheduler, plan]() { scheduler->start(plan); }, Qt::QueuedConnection);
+}
+
+void SerialSession::stopSchedule()
+{
+    QMetaObject::invokeMethod(m_worker->scheduler(), &SendScheduler::stop, Qt::QueuedConnection);
+}
+
+void SerialSession::setTransactionRule(const TransactionRule &rule)
+{
+    m_transactions.setRule(rule);
+    m_worker->setTransmitTap(m_transactions.isEnabled());
+    // 之前(规则不同或已关闭时)留下的发送记录不再有意义
+    SpscRingBuffer &ring = m_worker->txRing();
+    ring.skip(ring.readAvailable());
+}
+
+// 上一次 stage() 之前读到的接收数据都已交给跟踪器, 可以按那个时刻判断超时
+void SerialSession::stageTransmits()
+{
+    SpscRingBuffer &ring = m_worker->txRing();
+    const qint64 now = SerialWorker::monotonicNs();
+    m_transactions.expire(m_lastStageNs);
+    m_lastStageNs = now;
+
+    char payload[SerialWorker::kMaxTxTapBytes];
+    ChunkHeader header;
+    while (ring.readAvailable() >= sizeof(ChunkHeader)) {
+        ring.read(reinterpret_cast<char *>(&header), sizeof(ChunkHeader));
+        ring.read(payload, header.length);
+        m_transactions.onTransmit(header.timestampNs, payload, header.length);
+    }
+}
+
+void SerialSession::stage()
+{
+    if (m_transactions.isEnabled()) stageTransmits();
+    // resize(0) 保留容量, 缓冲区增长到峰值后不再分配
+    m_staged.resize(0);
+    m_arena.resize(0);
+    m_stagedPos = 0;
+    SpscRingBuffer &ring = m_worker->ring();
+    ChunkHeader header;
+    while (ring.readAvailable() >= sizeof(ChunkHeader)) {
+        ring.read(reinterpret_cast<char *>(&header), sizeof(ChunkHeader));
+        const int offset = m_arena.size();
+        m_arena.resize(offset + int(header.length));
+        ring.read(m_arena.data() + offset, header.length);
+        m_staged.append({header.timestampNs, offset, int(header.length)});
+    }
+}
@@ -0,0 +1,307 @@
+#include "serialworker.h"
+#include "triggercapture.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+#include <linux/serial.h>
+#include <sys/ioctl.h>
+#endif
+
+SerialWorker::SerialWorker(quint8 portId, size_t ringCapacity, QObject *parent)
+    : QObject(parent)
+    , m_serial(new QSerialPort(this))   // 作为子对象, moveToThread 时一起迁移到I/O线程
+    , m_retryTimer(new QTimer(this))
+    , m_ring(ringCapacity)
+    , m_txRing(256 * 1024)
+    , m_scratch(int(sizeof(ChunkHeader) + kMaxChunkSize), Qt::Uninitialized)
+    , m_scheduler(new SendScheduler(this))
+    , m_portId(portId)
+{
+    m_retryTimer->setSingleShot(true);
+    m_retryTimer->setInterval(5);
+
+    connect(m_serial, &QSerialPort::readyRead, this, &SerialWorker::onReadyRead);
+    connect(m_serial, &QSerialPort::bytesWritten, this, &SerialWorker::onBytesWritten);
+    connect(m_serial, &QSerialPort::errorOccurred, this, &SerialWorker::onError);
+    connect(m_retryTimer, &QTimer::timeout, this, &SerialWorker::onReadyRead);
+
+    m_counterTimer = new QTimer(this);
+    m_counterTimer->setInterval(1000);
+    connect(m_counterTimer, &QTimer::timeout, this, &SerialWorker::pollLineCounters);
+}
+
+SerialWorker::~SerialWorker()
+{
+    if (m_serial->isOpen()) m_serial->close();
+}
+
+qint64 SerialWorker::monotonicNs()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void SerialWorker::openPort(const PortSettings &settings)
+{
+    if (m_serial->isOpen()) m_serial->close();
+    clearPending();
+
+    QString error;
+    if (!settings.validate(&error)) {
+        emit portOpened(false, error);
+        return;
+    }
+
+    // 串口关闭时这些设置只是记录下来, 在 open() 中一次性写入驱动, 任何一项失败 open() 都会失败
+    m_serial->setPortName(settings.portName);
+    m_serial->setBaudRate(settings.baudRate);
+    m_serial->setDataBits(settings.dataBits);
+    m_serial->setStopBits(settings.stopBits);
+    m_serial->setParity(settings.parity);
+    m_serial->setFlowControl(settings.flowControl);
+    m_serial->setReadBufferSize(settings.readBufferSize);
+
+    if (m_serial->open(settings.openMode)) {
+        m_rxBytes.store(0, std::memory_order_relaxed);
+        m_txBytes.store(0, std::memory_order_relaxed);
+        for (auto &counter : m_lineCounters) counter.store(0, std::memory_order_relaxed);
+        for (quint64 &base : m_counterBase) base = 0;
+        m_counterBaseReady = false;
+        m_counterTimer->start();
+        pollLineCounters();   // 第一次读取作为基准; 驱动不支持时停止定时器
+        for (int i = 0; i < PortError; ++i) {
+            m_counterBase[i] = m_lineCounters[i].load(std::memory_order_relaxed);
+            m_lineCounters[i].store(0, std::memory_order_relaxed);
+        }
+        m_counterBaseReady = true;
+        emit portOpened(true, QString());
+        // 低延迟只影响响应时间, 设置失败(如没有写 sysfs 的权限)时串口照常使用
+        if (settings.lowLatency && !applyLowLatency(&error)) emit errorOccurred("低延迟模式未生效: " + error);
+    } else {
+        emit portOpened(false, m_serial->errorString());
+    }
+}
+
+// 普通串口驱动: ASYNC_LOW_LATENCY 让 tty 层立即把数据推给读者, 而不是攒到下一个调度节拍
+// FTDI 等 USB 适配器: 芯片默认攒 16 ms 才发一个 USB 包, 改为 1 ms
+bool SerialWorker::applyLowLatency(QString *errorString)
+{
+#ifdef Q_OS_LINUX
+    const int fd = int(m_serial->handle());
+    serial_struct serial;
+    bool ok = ::ioctl(fd, TIOCGSERIAL, &serial) == 0;
+    if (ok) {
+        serial.flags |= ASYNC_LOW_LATENCY;
+        ok = ::ioctl(fd, TIOCSSERIAL, &serial) == 0;
+    }
+    const int ioctlError = ok ? 0 : errno;
+
+    const QString name = QFileInfo(m_serial->portName()).fileName();
+    QFile timer(QString("/sys/bus/usb-serial/devices/%1/latency_timer").arg(name));
+    if (timer.exists()) {
+        if (timer.open(QIODevice::WriteOnly) && timer.write("1") == 1) return true;
+        if (errorString) *errorString = QString("无法写入 %1: %2").arg(timer.fileName(), timer.errorString());
+        return false;
+    }
+    if (!ok && errorString) *errorString = QString("驱动不支持 ASYNC_LOW_LATENCY: %1").arg(qt_error_string(ioctlError));
+    return ok;
+#else
+    if (errorString) *errorString = "当前平台不支持";
+    return false;
+#endif
+}
+
+void SerialWorker::openReplay()
+{
+    if (m_serial->isOpen()) m_serial->close();
+    m_replaying = true;
+    m_rxBytes.store(0, std::memory_order_relaxed);
+    m_txBytes.store(0, std::memory_order_relaxed);
+    emit portOpened(true, QString());
+}
+
+void SerialWorker::closePort()
+{
+    m_scheduler->stop();
+    m_retryTimer->stop();
+    if (m_counterTimer->isActive()) {
+        pollLineCounters();
+        m_counterTimer->stop();
+    }
+    clearPending();
+    if (m_serial->isOpen()) {
+        m_serial->close();
+        emit portClosed();
+    } else if (m_replaying) {
+        m_replaying = false;
+        emit portClosed();
+    }
+}
+
+void SerialWorker::writeData(const QByteArray &data)
+{
+    if (!m_serial->isOpen() || data.isEmpty()) return;
+    m_pendingWrites.enqueue(data);
+    m_pendingBytes += data.size();
+    m_queuedBytes.fetch_add(data.size(), std::memory_order_relaxed);
+    flushPending();
+}
+
+// 投递时就计入排队字节数, 发送方在数据到达I/O线程之前就能看到积压
+void SerialWorker::post(const QByteArray &data)
+{
+    m_queuedBytes.fetch_add(data.size(), std::memory_order_relaxed);
+    QMetaObject::invokeMethod(this, [this, data]() {
+        m_queuedBytes.fetch_sub(data.size(), std::memory_order_relaxed);
+        writeData(data);
+    }, Qt::QueuedConnection);
+}
+
+void SerialWorker::clearPending()
+{
+    m_pendingWrites.clear();
+    m_queuedBytes.fetch_sub(m_pendingBytes, std::memory_order_relaxed);
+    m_pendingBytes = 0;
+}
+
+qint64 SerialWorker::outstandingBytes() const
+{
+    return m_pendingBytes + (m_serial->isOpen() ? m_serial->bytesToWrite() : 0);
+}
+
+// 读取尽可能多的数据写入环形缓冲区; 缓冲区满时数据留在 QSerialPort 内部缓冲, 稍后重试
+void SerialWorker::onReadyRead()
+{
+    ChunkHeader *header = reinterpret_cast<ChunkHeader *>(m_scratch.data());
+    char *payload = m_scratch.data() + sizeof(ChunkHeader);
+
+    while (m_serial->bytesAvailable() > 0) {
+        const qint64 space = qint64(m_ring.writeAvailable()) - qint64(sizeof(ChunkHeader));
+        if (space <= 0) {
+            m_ringStalls.fetch_add(1, std::memory_order_relaxed);
+            m_retryTimer->start();
+            return;
+        }
+
+        const qint64 n = m_serial->read(payload, qMin(space, kMaxChunkSize));
+        if (n <= 0) break;
+
+        header->timestampNs = monotonicNs();
+        header->length = quint32(n);
+        m_ring.write(m_scratch.constData(), sizeof(ChunkHeader) + size_t(n));
+        m_rxBytes.fetch_add(quint64(n), std::memory_order_relaxed);
+        if (m_capture) m_capture->record(header->timestampNs, CaptureDirection::Rx, m_portId, payload, n);
+        if (m_trigger) m_trigger->record(header->timestampNs, CaptureDirection::Rx, m_portId, payload, n);
+    }
+}
+
+// 与 onReadyRead 相同, 头部和负载在暂存区中拼好后一次写入, 读取方不会看到不完整的记录
+qint64 SerialWorker::injectReceived(qint64 timestampNs, const char *data, qint64 size)
+{
+    ChunkHeader *header = reinterpret_cast<ChunkHeader *>(m_scratch.data());
+    char *payload = m_scratch.data() + sizeof(ChunkHeader);
+
+    qint64 written = 0;
+    while (written < size) {
+        const qint64 space = qint64(m_ring.writeAvailable()) - qint64(sizeof(ChunkHeader));
+        if (space <= 0) {
+            m_ringStalls.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+        const qint64 n = qMin(qMin(space, kMaxChunkSize), size - written);
+        std::memcpy(payload, data + written, size_t(n));
+        header->timestampNs = timestampNs;
+        header->length = quint32(n);
+        m_ring.write(m_scratch.constData(), sizeof(ChunkHeader) + size_t(n));
+        written += n;
+    }
+    m_rxBytes.fetch_add(quint64(written), std::memory_order_relaxed);
+    return written;
+}
+
+void SerialWorker::onBytesWritten(qint64 bytes)
+{
+    emit dataWritten(bytes);
+    flushPending();
+}
+
+// 控制交给驱动的在途数据量, 其余留在队列中等待 bytesWritten
+void SerialWorker::flushPending()
+{
+    while (!m_pendingWrites.isEmpty() && m_serial->bytesToWrite() < kMaxBytesInFlight) {
+        const QByteArray data = m_pendingWrites.dequeue();
+        m_pendingBytes -= data.size();
+        m_queuedBytes.fetch_sub(data.size(), std::memory_order_relaxed);
+        if (m_serial->write(data) != data.size()) {
+            emit errorOccurred(m_serial->errorString());
+            clearPending();
+            return;
+        }
+        m_txBytes.fetch_add(quint64(data.size()), std::memory_order_relaxed);
+        const qint64 now = monotonicNs();
+        if (m_capture) m_capture->record(now, CaptureDirection::Tx, m_portId, data.constData(), data.size());
+        if (m_trigger) m_trigger->record(now, CaptureDirection::Tx, m_portId, data.constData(), data.size());
+        if (m_txTap.load(std::memory_order_relaxed)) tapTransmit(now, data);
+    }
+}
+
+// 命令的类型和序号都在开头, 只保留前缀; 记录头和数据一次写入, 读端不会看到半条记录
+void SerialWorker::tapTransmit(qint64 timestampNs, const QByteArray &data)
+{
+    char record[sizeof(ChunkHeader) + kMaxTxTapBytes];
+    const quint32 length = quint32(qMin<qint64>(data.size(), kMaxTxTapBytes));
+    ChunkHeader header{timestampNs, length};
+    std::memcpy(record, &header, sizeof(ChunkHeader));
+    std::memcpy(record + sizeof(ChunkHeader), data.constData(), length);
+    if (!m_txRing.write(record, sizeof(ChunkHeader) + length)) m_txTapDrops.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SerialWorker::onError(QSerialPort::SerialPortError error)
+{
+    if (error == QSerialPort::NoError) return;
+    m_lineCounters[PortError].fetch_add(1, std::memory_order_relaxed);
+    if (m_trigger) m_trigger->trigger(TriggerReason::PortError, m_portId, monotonicNs());
+    emit errorOccurred(m_serial->errorString());
+    // 设备被拔出等致命错误: 关闭串口并通知界面
+    if (error == QSerialPort::ResourceError) closePort();
+}
+
+// 驱动的中断计数: 硬件溢出、校验错误等不会通过 QSerialPort 报告, 只能周期性查询
+void SerialWorker::pollLineCounters()
+{
+#ifdef Q_OS_LINUX
+    if (!m_serial->isOpen()) return;
+    serial_icounter_struct icount = {};
+    if (::ioctl(int(m_serial->handle()), TIOCGICOUNT, &icount) != 0) {
+        m_counterTimer->stop();   // USB转串口等驱动不支持, 不再查询
+        return;
+    }
+    const quint64 values[PortError] = {quint64(icount.overrun), quint64(icount.buf_overrun),
+                                       quint64(icount.parity), quint64(icount.frame), quint64(icount.brk)};
+    bool increased = false;
+    for (int i = 0; i < PortError; ++i) {
+        const quint64 count = values[i] - m_counterBase[i];
+        increased = increased || count > m_lineCounters[i].load(std::memory_order_relaxed);
+        m_lineCounters[i].store(count, std::memory_order_relaxed);
+    }
+    // 计数是周期查询的, 触发时刻最多晚一个查询周期
+    if (increased && m_counterBaseReady && m_trigger) m_trigger->trigger(TriggerReason::LineError, m_portId, monotonicNs());
+#endif
+}
+
+LineErrorCounts SerialWorker::lineErrors() const
+{
+    LineErrorCounts counts;
+    counts.overrun = m_lineCounters[Overrun].load(std::memory_order_relaxed);
+    counts.bufferOverrun = m_lineCounters[BufferOverrun].load(std::memory_order_relaxed);
+    counts.parity = m_lineCounters[Parity].load(std::memory_order_relaxed);
+    counts.framing = m_lineCounters[Framing].load(std::memory_order_relaxed);
+    counts.breaks = m_lineCounters[Break].load(std::memory_order_relaxed);
+    counts.portErrors = m_lineCounters[PortError].load(std::memory_order_relaxed);
+    return counts;
+}
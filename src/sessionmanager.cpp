@@ -0,0 +1,440 @@
+#include "sessionmanager.h"
+#include "capturefile.h"
+#include "serialsession.h"
+#include "serialworker.h"
+
+#include <QFileInfo>
+#include <QTimer>
+#include <algorithm>
+
+SessionManager::SessionManager(QObject *parent)
+    : QObject(parent)
+    , m_ioThread(new QThread(this))
+    , m_ioContext(new QObject)
+    , m_capture(new CaptureWriter)
+    , m_trigger(new TriggerCapture)
+{
+    m_ioContext->moveToThread(m_ioThread);
+    m_trigger->moveToThread(m_ioThread);
+    connect(m_trigger, &TriggerCapture::triggered, this, &SessionManager::triggerFired);
+    connect(m_trigger, &TriggerCapture::saved, this, &SessionManager::triggerSaved);
+    connect(m_trigger, &TriggerCapture::failed, this, &SessionManager::captureFailed);
+    m_ioThread->start();
+}
+
+SessionManager::~SessionManager()
+{
+    // 先在I/O线程中停止回放、关闭所有串口和捕获, 再删除工作对象并退出线程
+    // 触发捕获最后删除: 关闭串口时最后一次查询线路错误计数仍可能触发
+    CaptureWriter *capture = m_capture;
+    TriggerCapture *trigger = m_trigger;
+    m_trigger = nullptr;
+    CaptureReplayer *replayer = m_replayer;
+    m_replayer = nullptr;
+    QList<SerialWorker *> workers;
+    for (SerialSession *session : m_sessions) workers.append(session->worker());
+    QMetaObject::invokeMethod(m_ioContext, [workers, capture, replayer, trigger]() {
+        delete replayer;
+        for (SerialWorker *worker : workers) worker->closePort();
+        capture->close();
+        delete trigger;
+    }, Qt::BlockingQueuedConnection);
+
+    qDeleteAll(m_sessions);
+    m_sessions.clear();
+    m_ioContext->deleteLater();
+    m_ioThread->quit();
+    m_ioThread->wait();
+    delete m_capture;
+}
+
+QString SessionManager::perPortPath(const QString &path, const QString &portName)
+{
+    const QFileInfo info(path);
+    QString name = portName;
+    name.replace('/', '_');   // /dev/ttyUSB0 之类的完整路径
+    const QString suffix = info.suffix().isEmpty() ? QString() : "." + info.suffix();
+    return info.path() + "/" + info.completeBaseName() + "_" + name + suffix;
+}
+
+quint8 SessionManager::nextPortId() const
+{
+    for (int id = 0; id < 256; ++id) {
+        if (!session(quint8(id))) return quint8(id);
+    }
+    return 255;
+}
+
+SerialSession *SessionManager::openSession(const PortSettings &settings)
+{
+    if (SerialSession *existing = session(settings.portName)) return existing;
+
+    SerialSession *s = new SerialSession(nextPortId(), settings, this);
+    addSession(s);
+    SerialWorker *worker = s->worker();
+    CaptureWriter *capture = m_capture;
+    TriggerCapture *trigger = m_trigger;
+    QMetaObject::invokeMethod(worker, [worker, capture, trigger, settings]() {
+        worker->setCapture(capture);
+        worker->setTriggerCapture(trigger);
+        worker->openPort(settings);
+    }, Qt::QueuedConnection);
+    return s;
+}
+
+void SessionManager::addSession(SerialSession *s)
+{
+    s->worker()->moveToThread(m_ioThread);
+    m_sessions.append(s);
+
+    connect(s, &SerialSession::opened, this, [this, s](bool ok, const QString &error) { onSessionOpened(s, ok, error); });
+    connect(s, &SerialSession::closed, this, [this, s]() { onSessionClosed(s); });
+    connect(s, &SerialSession::errorOccurred, this, [this, s](const QString &error) { emit sessionError(s, error); });
+}
+
+bool SessionManager::openReplay(const QString &path, double speed, QString *errorString)
+{
+    if (m_replayer) {
+        if (errorString) *errorString = "已有回放正在进行";
+        return false;
+    }
+    CaptureReplayer *replayer = new CaptureReplayer;
+    if (!replayer->open(path, errorString)) {
+        delete replayer;
+        return false;
+    }
+    const QVector<quint8> portIds = replayer->receivePortIds();
+    if (portIds.isEmpty()) {
+        if (errorString) *errorString = "捕获中没有接收数据";
+        delete replayer;
+        return false;
+    }
+
+    m_replayer = replayer;
+    m_replaySpeed = speed;
+    m_replayStarted = false;
+    m_replayStats = ReplayStats();
+    m_replayFirstNs = replayer->reader().firstTimestampNs();
+    m_replayLastNs = replayer->reader().lastTimestampNs();
+
+    // 会话名中的端口号是捕获时的端口号, 会话自己的端口号另行分配, 不与已打开的串口冲突
+    QList<SerialWorker *> workers;
+    for (quint8 id : portIds) {
+        PortSettings settings;
+        settings.portName = QString("回放%1").arg(id);
+        settings.openMode = QIODevice::ReadOnly;
+        SerialSession *s = new SerialSession(nextPortId(), settings, this);
+        s->m_replay = true;
+        addSession(s);
+        m_replaySessions.append(s);
+        replayer->addTarget(id, s->worker());
+        workers.append(s->worker());
+    }
+
+    replayer->moveToThread(m_ioThread);
+    connect(replayer, &CaptureReplayer::progress, this, &SessionManager::replayProgress);
+    connect(replayer, &CaptureReplayer::finished, this, &SessionManager::onReplayStopped);
+    connect(replayer, &CaptureReplayer::seeked, this, [this]() {
+        for (SerialSession *s : m_replaySessions) {
+            s->frameParser().reset();
+            s->textDecoder().reset();
+        }
+    });
+    QMetaObject::invokeMethod(m_ioContext, [workers]() {
+        for (SerialWorker *worker : workers) worker->openReplay();
+    }, Qt::QueuedConnection);
+    return true;
+}
+
+void SessionManager::setReplaySpeed(double speed)
+{
+    if (!m_replayer) return;
+    m_replaySpeed = speed;
+    CaptureReplayer *replayer = m_replayer;
+    QMetaObject::invokeMethod(replayer, [replayer, speed]() { replayer->setSpeed(speed); }, Qt::QueuedConnection);
+}
+
+void SessionManager::setReplayPaused(bool paused)
+{
+    if (!m_replayer) return;
+    CaptureReplayer *replayer = m_replayer;
+    QMetaObject::invokeMethod(replayer, [replayer, paused]() { replayer->setPaused(paused); }, Qt::QueuedConnection);
+}
+
+void SessionManager::seekReplay(qint64 timestampNs)
+{
+    if (!m_replayer) return;
+    CaptureReplayer *replayer = m_replayer;
+    QMetaObject::invokeMethod(replayer, [replayer, timestampNs]() { replayer->seek(timestampNs); }, Qt::QueuedConnection);
+}
+
+void SessionManager::stopReplay()
+{
+    if (!m_replayer) return;
+    QMetaObject::invokeMethod(m_replayer, &CaptureReplayer::stop, Qt::QueuedConnection);
+}
+
+// 回放器已停止: 关闭回放会话, 会话关闭时取走环形缓冲区中剩余的数据, 全部关闭后才算结束
+void SessionManager::onReplayStopped(const ReplayStats &stats)
+{
+    m_replayStats = stats;
+    for (SerialSession *s : m_replaySessions) s->close();
+    finishReplayIfDone();
+}
+
+void SessionManager::finishReplayIfDone()
+{
+    if (!m_replayer || !m_replaySessions.isEmpty() || m_replayStats.finishedAtNs == 0) return;
+    ReplayStats stats = m_replayStats;
+    stats.elapsedNs += SerialWorker::monotonicNs() - stats.finishedAtNs;
+    m_replayer->deleteLater();
+    m_replayer = nullptr;
+    emit replayFinished(stats);
+}
+
+void SessionManager::closeSession(SerialSession *session)
+{
+    if (session && m_sessions.contains(session)) session->close();
+}
+
+void SessionManager::closeAll()
+{
+    for (SerialSession *s : m_sessions) s->close();
+}
+
+SerialSession *SessionManager::session(const QString &portName) const
+{
+    for (SerialSession *s : m_sessions) {
+        if (s->portName() == portName) return s;
+    }
+    return nullptr;
+}
+
+SerialSession *SessionManager::session(quint8 portId) const
+{
+    for (SerialSession *s : m_sessions) {
+        if (s->portId() == portId) return s;
+    }
+    return nullptr;
+}
+
+int SessionManager::openCount() const
+{
+    int count = 0;
+    for (SerialSession *s : m_sessions) count += s->isOpen();
+    return count;
+}
+
+// 原始捕获只记录真实串口
+int SessionManager::liveOpenCount() const
+{
+    int count = 0;
+    for (SerialSession *s : m_sessions) count += s->isOpen() && !s->isReplay();
+    return count;
+}
+
+void SessionManager::onSessionOpened(SerialSession *session, bool ok, const QString &errorString)
+{
+    const bool reconnecting = m_reconnects.contains(session);
+    const LostPort lost = m_reconnects.take(session);
+    if (!ok) {
+        if (reconnecting) {
+            // 重连失败不提示, 记回断开列表, 稍后或下一次设备事件时再试
+            m_lost.insert(lost.settings.portName, lost);
+            const QString name = lost.settings.portName;
+            if (lost.attempts < kReconnectAttempts)
+                QTimer::singleShot(kReconnectDelayMs, this, [this, name]() { retryReconnect(name); });
+        } else {
+            emit sessionFailed(session, errorString);
+        }
+        removeSession(session);
+        return;
+    }
+    if (session->isReplay()) {
+        emit sessionOpened(session);
+        // 所有回放会话都打开(接收方已准备好日志等)后才开始送数据
+        const bool ready = std::all_of(m_replaySessions.cbegin(), m_replaySessions.cend(),
+                                       [](SerialSession *s) { return s->isOpen(); });
+        if (m_replayer && ready && !m_replayStarted) {
+            m_replayStarted = true;
+            CaptureReplayer *replayer = m_replayer;
+            const double speed = m_replaySpeed;
+            QMetaObject::invokeMethod(replayer, [replayer, speed]() { replayer->start(speed); }, Qt::QueuedConnection);
+        }
+        return;
+    }
+    // 第一个串口打开时开始一个新的原始捕获
+    if (liveOpenCount() == 1) startCapture();
+    emit sessionOpened(session);
+}
+
+void SessionManager::onSessionClosed(SerialSession *session)
+{
+    if (session->isReplay()) {
+        emit sessionClosed(session);
+        m_replaySessions.removeOne(session);
+        removeSession(session);
+        // 单独关闭某个回放会话时整个回放停止, 回放器不再写入即将删除的工作对象
+        if (m_replayStats.finishedAtNs == 0) stopReplay();
+        finishReplayIfDone();
+        return;
+    }
+    if (m_discovery && !session->closeRequested()) {
+        LostPort lost;
+        lost.settings = session->settings();
+        lost.device = m_discovery->port(session->portName());
+        m_lost.insert(lost.settings.portName, lost);
+        // 关闭由I/O错误引起但设备仍在时不会有新增事件, 稍后直接重试
+        const QString name = lost.settings.portName;
+        QTimer::singleShot(kReconnectDelayMs, this, [this, name]() { retryReconnect(name); });
+    }
+    emit sessionClosed(session);   // 接收方在这里取走剩余数据
+    removeSession(session);
+    if (liveOpenCount() == 0) stopCapture();
+}
+
+void SessionManager::setAutoReconnect(PortDiscovery *discovery)
+{
+    if (m_discovery) disconnect(m_discovery, nullptr, this, nullptr);
+    m_discovery = discovery;
+    m_lost.clear();
+    if (discovery) {
+        connect(discovery, &PortDiscovery::portsChanged, this,
+                [this](const QList<PortInfo> &added, const QStringList &) { onPortsChanged(added); });
+    }
+}
+
+void SessionManager::cancelReconnect(const QString &portName)
+{
+    m_lost.remove(portName);
+}
+
+// 有序列号时按序列号匹配(允许设备名变化), 否则要求同名且 VID/PID 相同
+bool SessionManager::matchesLost(const LostPort &lost, const PortInfo &port)
+{
+    if (lost.device.portName.isEmpty()) return port.portName == lost.settings.portName;
+    if (!lost.device.serialNumber.isEmpty()) return lost.device.sameDevice(port);
+    return port.portName == lost.settings.portName
+        && port.vendorId == lost.device.vendorId && port.productId == lost.device.productId;
+}
+
+void SessionManager::onPortsChanged(const QList<PortInfo> &added)
+{
+    const QStringList names = m_lost.keys();
+    for (const QString &name : names) {
+        for (const PortInfo &port : added) {
+            if (matchesLost(m_lost.value(name), port)) {
+                m_lost[name].attempts = 0;   // 新的插入事件重新计算重试次数
+                reconnect(name, port.portName);
+                break;
+            }
+        }
+    }
+}
+
+void SessionManager::retryReconnect(const QString &lostName)
+{
+    if (!m_discovery || !m_lost.contains(lostName)) return;
+    const LostPort lost = m_lost.value(lostName);
+    for (const PortInfo &port : m_discovery->ports()) {
+        if (matchesLost(lost, port)) {
+            reconnect(lostName, port.portName);
+            return;
+        }
+    }
+}
+
+void SessionManager::reconnect(const QString &lostName, const QString &portName)
+{
+    if (session(portName)) return;   // 已被手动打开
+    LostPort lost = m_lost.take(lostName);
+    ++lost.attempts;
+    PortSettings settings = lost.settings;
+    settings.portName = portName;
+    SerialSession *s = openSession(settings);
+    m_reconnects.insert(s, lost);
+    emit reconnecting(s, lostName);
+}
+
+void SessionManager::removeSession(SerialSession *session)
+{
+    m_sessions.removeOne(session);
+    session->deleteLater();
+}
+
+void SessionManager::startCapture()
+{
+    if (m_capturePath.isEmpty()) return;
+    CaptureWriter *capture = m_capture;
+    const QString path = m_capturePath;
+    QMetaObject::invokeMethod(m_ioContext, [this, capture, path]() {
+        QString error;
+        if (!capture->open(path, &error)) {
+            QMetaObject::invokeMethod(this, [this, error]() { emit captureFailed(error); }, Qt::QueuedConnection);
+        }
+    }, Qt::QueuedConnection);
+}
+
+quint64 SessionManager::captureDroppedRecords() const
+{
+    return m_capture->droppedRecords();
+}
+
+void SessionManager::stopCapture()
+{
+    CaptureWriter *capture = m_capture;
+    QMetaObject::invokeMethod(m_ioContext, [this, capture]() {
+        capture->close();
+        const quint64 dropped = capture->droppedRecords();
+        if (dropped == 0) return;
+        const QString error = QString("写盘过慢, 捕获文件中缺少 %1 条记录").arg(dropped);
+        QMetaObject::invokeMethod(this, [this, error]() { emit captureFailed(error); }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
+
+void SessionManager::enableTriggerCapture(const TriggerSpec &spec, const QString &directory)
+{
+    m_triggerEnabled = true;
+    TriggerCapture *trigger = m_trigger;
+    QMetaObject::invokeMethod(trigger, [trigger, spec, directory]() { trigger->configure(spec, directory); },
+                              Qt::QueuedConnection);
+}
+
+void SessionManager::disableTriggerCapture()
+{
+    m_triggerEnabled = false;
+    TriggerCapture *trigger = m_trigger;
+    QMetaObject::invokeMethod(trigger, [trigger]() { trigger->disable(); }, Qt::QueuedConnection);
+}
+
+void SessionManager::fireTrigger(TriggerReason reason, quint8 portId, qint64 timestampNs)
+{
+    if (!m_triggerEnabled) return;
+    if (timestampNs == 0) timestampNs = SerialWorker::monotonicNs();
+    TriggerCapture *trigger = m_trigger;
+    QMetaObject::invokeMethod(trigger, [trigger, reason, portId, timestampNs]() {
+        trigger->trigger(reason, portId, timestampNs);
+    }, Qt::QueuedConnection);
+}
+
+// 各会话内部已按时间排序, 这里做k路归并
+void SessionManager::drain(const ChunkHandler &handler)
+{
+    for (SerialSession *s : m_sessions) s->stage();
+
+    for (;;) {
+        SerialSession *earliest = nullptr;
+        qint64 earliestNs = 0;
+        for (SerialSession *s : m_sessions) {
+            if (s->m_stagedPos >= s->m_staged.size()) continue;
+            const qint64 ts = s->m_staged.at(s->m_stagedPos).timestampNs;
+            if (!earliest || ts < earliestNs) {
+                earliest = s;
+                earliestNs = ts;
+            }
+        }
+        if (!earliest) break;
+        const SerialSession::StagedChunk &chunk = earliest->m_staged.at(earliest->m_stagedPos++);
+        handler(earliest, chunk.timestampNs, earliest->m_arena.constData() + chunk.offset, chunk.length);
+    }
+}
@@ -1,9 +1,12 @@
 #include "settingspanel.h"
 
+#include <QFileInfo>
+#include <QIntValidator>
+
 SettingsPanel::SettingsPanel(QWidget *parent)
     : QWidget(parent),
     m_expanded(false),
-    m_expandedHeight(100)
+    m_expandedHeight(160)
 {
     setFixedHeight(0);
     setMinimumWidth(200);
@@ -23,8 +26,12 @@ SettingsPanel::SettingsPanel(QWidget *parent)
 
 void SettingsPanel::initUI()
 {
+    // 可直接输入任意波特率, 高速控制器常用 460800/921600/2M
     m_baudRateBox = new QComboBox(this);
-    m_baudRateBox->addItems({"9600", "19200", "38400", "57600", "115200"});
+    m_baudRateBox->setEditable(true);
+    m_baudRateBox->addItems({"9600", "19200", "38400", "57600", "115200", "230400", "460800", "921600",
+                             "1000000", "1500000", "2000000", "3000000", "4000000"});
+    m_baudRateBox->setValidator(new QIntValidator(PortSettings::kMinBaudRate, PortSettings::kMaxBaudRate, this));
     m_baudRateBox->setCurrentText("115200");
 
     m_openModeBox = new QComboBox(this);
@@ -35,10 +42,30 @@ void SettingsPanel::initUI()
     m_dataBitsBox->addItems({"5", "6", "7", "8"});
     m_dataBitsBox->setCurrentText("8");
 
+    // 停止位和校验位的枚举值不连续, 用条目数据保存, 不能用下标换算
     m_stopBitsBox = new QComboBox(this);
-    m_stopBitsBox->addItems({"1", "1.5", "2"});
+    m_stopBitsBox->addItem("1", int(QSerialPort::OneStop));
+    m_stopBitsBox->addItem("1.5", int(QSerialPort::OneAndHalfStop));
+    m_stopBitsBox->addItem("2", int(QSerialPort::TwoStop));
     m_stopBitsBox->setCurrentText("1");
 
+    m_flowControlBox = new QComboBox(this);
+    m_flowControlBox->addItem("无", int(QSerialPort::NoFlowControl));
+    m_flowControlBox->addItem("RTS/CTS", int(QSerialPort::HardwareControl));
+    m_flowControlBox->addItem("XON/XOFF", int(QSerialPort::SoftwareControl));
+    m_flowControlBox->setToolTip("高波特率下用 RTS/CTS 防止接收方溢出; XON/XOFF 会占用 0x11/0x13, 不适合二进制数据");
+
+    m_readBufferBox = new QSpinBox(this);
+    m_readBufferBox->setRange(0, 1024 * 1024);
+    m_readBufferBox->setSuffix(" KB");
+    m_readBufferBox->setSpecialValueText("不限");
+    m_readBufferBox->setValue(0);
+    m_readBufferBox->setFixedWidth(90);
+    m_readBufferBox->setToolTip("QSerialPort 内部读缓冲上限, 满后不再从驱动读取, 由 RTS/CTS 通知对方暂停");
+
+    m_lowLatencyCheckbox = new QCheckBox("低延迟", this);
+    m_lowLatencyCheckbox->setToolTip("Linux: 设置 ASYNC_LOW_LATENCY, 并把 FTDI 适配器的 latency_timer 改为 1 ms");
+
     m_showCtrlCharsCheckbox = new QCheckBox(tr("显示控制字符"), this);
     m_showCtrlCharsCheckbox->setChecked(false);
 
@@ -47,7 +74,11 @@ void SettingsPanel::initUI()
 
     // 无校验(NoParity)适用于大多数现代通信（因为硬件可靠性高）
     m_parityBox = new QComboBox(this);
-    m_parityBox->addItems({"None", "Even", "Odd", "Mark", "Space"});
+    m_parityBox->addItem("None", int(QSerialPort::NoParity));
+    m_parityBox->addItem("Even", int(QSerialPort::EvenParity));
+    m_parityBox->addItem("Odd", int(QSerialPort::OddParity));
+    m_parityBox->addItem("Mark", int(QSerialPort::MarkParity));
+    m_parityBox->addItem("Space", int(QSerialPort::SpaceParity));
     m_parityBox->setCurrentText("None");
 
     m_togglePanelButton = new QPushButton(this);
@@ -59,12 +90,81 @@ void SettingsPanel::initUI()
     m_logFilePathEdit->setPlaceholderText("未设置日志文件路径");
     m_logFilePathEdit->setReadOnly(true);
 
+    m_frameSpecEdit = new QLineEdit(this);
+    m_frameSpecEdit->setFixedWidth(200);
+    m_frameSpecEdit->setPlaceholderText("帧格式, 如 head=AA55;len=2:1;adj=5;check=sum8");
+    m_frameSpecEdit->setClearButtonEnabled(true);
+
     m_browseLogFileBtn = new QPushButton("...", this);
     m_browseLogFileBtn->setFixedWidth(30);
 
     m_appendLogCheckbox = new QCheckBox("追加", this);
     m_appendLogCheckbox->setChecked(true);
 
+    m_captureFilePathEdit = new QLineEdit(this);
+    m_captureFilePathEdit->setFixedWidth(120);
+    m_captureFilePathEdit->setPlaceholderText("未设置捕获文件");
+    m_captureFilePathEdit->setClearButtonEnabled(true);
+
+    m_browseCaptureFileBtn = new QPushButton("...", this);
+    m_browseCaptureFileBtn->setFixedWidth(30);
+
+    m_triggerSpecEdit = new QLineEdit(this);
+    m_triggerSpecEdit->setFixedWidth(200);
+    m_triggerSpecEdit->setPlaceholderText("触发捕获, 如 buffer=64;pre=30;post=10;pattern=55AA;error");
+    m_triggerSpecEdit->setClearButtonEnabled(true);
+    m_triggerSpecEdit->setToolTip("收发数据只保存在内存环中, 出现指定字节序列、串口错误(error)、"
+                                  "帧校验失败(checksum)或手动触发时写出触发前后的窗口");
+
+    m_alarmRulesEdit = new QLineEdit(this);
+    m_alarmRulesEdit->setFixedWidth(160);
+    m_alarmRulesEdit->setPlaceholderText("未设置报警规则文件");
+    m_alarmRulesEdit->setClearButtonEnabled(true);
+    m_alarmRulesEdit->setToolTip("每行一条规则, 如 name=超压;text=E201;action=status,highlight,sound");
+
+    m_browseAlarmRulesBtn = new QPushButton("...", this);
+    m_browseAlarmRulesBtn->setFixedWidth(30);
+
+    // 显示区回滚上限: 超出后丢弃最旧的行, 长时间运行内存保持平稳
+    m_maxLinesBox = new QSpinBox(this);
+    m_maxLinesBox->setRange(1000, 10000000);
+    m_maxLinesBox->setSingleStep(10000);
+    m_maxLinesBox->setValue(100000);
+    m_maxLinesBox->setFixedWidth(100);
+
+    m_maxMemoryBox = new QSpinBox(this);
+    m_maxMemoryBox->setRange(1, 4096);
+    m_maxMemoryBox->setSuffix(" MB");
+    m_maxMemoryBox->setValue(64);
+    m_maxMemoryBox->setFixedWidth(80);
+
+    // 日志分段: 长时间运行时限制单个文件大小和总磁盘占用, 关闭的分段在后台压缩
+    m_segmentSizeBox = new QSpinBox(this);
+    m_segmentSizeBox->setRange(0, 4096);
+    m_segmentSizeBox->setSuffix(" MB");
+    m_segmentSizeBox->setSpecialValueText("不限");
+    m_segmentSizeBox->setValue(0);
+    m_segmentSizeBox->setFixedWidth(80);
+
+    m_segmentMinutesBox = new QSpinBox(this);
+    m_segmentMinutesBox->setRange(0, 7 * 24 * 60);
+    m_segmentMinutesBox->setSuffix(" 分钟");
+    m_segmentMinutesBox->setSpecialValueText("不限");
+    m_segmentMinutesBox->setValue(0);
+    m_segmentMinutesBox->setFixedWidth(90);
+
+    m_compressLogCheckbox = new QCheckBox("压缩旧分段", this);
+    m_compressLogCheckbox->setChecked(true);
+    m_compressLogCheckbox->setToolTip("关闭的分段压缩为 .gz, 可直接用 gunzip 解压, 也可在本程序中查看和搜索");
+
+    m_retentionBox = new QSpinBox(this);
+    m_retentionBox->setRange(0, 1024 * 1024);
+    m_retentionBox->setSuffix(" MB");
+    m_retentionBox->setSpecialValueText("不限");
+    m_retentionBox->setValue(0);
+    m_retentionBox->setFixedWidth(90);
+    m_retentionBox->setToolTip("同一日志所有分段的总大小上限, 超出时删除最旧的分段");
+
     QVBoxLayout *mainLayout = new QVBoxLayout(this);
     mainLayout->setSpacing(5);
     mainLayout->setContentsMargins(10, 10, 10, 10);
@@ -72,6 +172,7 @@ void SettingsPanel::initUI()
     QHBoxLayout *row1Layout = new QHBoxLayout();
     addLabelAndCombo(row1Layout, "波特率  :", m_baudRateBox, 100);
     addLabelAndCombo(row1Layout, "数据位  :", m_dataBitsBox, 60);
+    addLabelAndCombo(row1Layout, "流控:", m_flowControlBox, 90);
     m_showCtrlCharsCheckbox->setFixedWidth(100);
     row1Layout->addWidget(m_showCtrlCharsCheckbox);
     row1Layout->addSpacing(1);
@@ -80,6 +181,11 @@ void SettingsPanel::initUI()
     QHBoxLayout *row2Layout = new QHBoxLayout();
     addLabelAndCombo(row2Layout, "校验位  :", m_parityBox, 100);
     addLabelAndCombo(row2Layout, "停止位  :", m_stopBitsBox,60);
+    QLabel *readBufferLabel = new QLabel("读缓冲:", this);
+    readBufferLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    row2Layout->addWidget(readBufferLabel);
+    row2Layout->addWidget(m_readBufferBox);
+    row2Layout->addWidget(m_lowLatencyCheckbox);
     m_showTimeStampsCheckbox->setFixedWidth(100);
     row2Layout->addWidget(m_showTimeStampsCheckbox);
     row2Layout->addSpacing(1);
@@ -90,21 +196,83 @@ void SettingsPanel::initUI()
     row3Layout->addWidget(m_logFilePathEdit);
     row3Layout->addWidget(m_browseLogFileBtn);
     row3Layout->addWidget(m_appendLogCheckbox);
+    row3Layout->addWidget(m_frameSpecEdit);
     row3Layout->addStretch();
     m_togglePanelButton->setFixedSize(30, 30);
     row3Layout->addWidget(m_togglePanelButton);
     row3Layout->addSpacing(1);
 
-    // 将三行添加到主布局
+    QHBoxLayout *row4Layout = new QHBoxLayout();
+    QLabel *maxLinesLabel = new QLabel("最大行数:", this);
+    maxLinesLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    row4Layout->addWidget(maxLinesLabel);
+    row4Layout->addWidget(m_maxLinesBox);
+    row4Layout->addSpacing(1);
+    QLabel *maxMemoryLabel = new QLabel("最大内存:", this);
+    maxMemoryLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    row4Layout->addWidget(maxMemoryLabel);
+    row4Layout->addWidget(m_maxMemoryBox);
+    row4Layout->addWidget(m_captureFilePathEdit);
+    row4Layout->addWidget(m_browseCaptureFileBtn);
+    row4Layout->addWidget(m_triggerSpecEdit);
+    row4Layout->addStretch();
+
+    QHBoxLayout *row5Layout = new QHBoxLayout();
+    QLabel *segmentLabel = new QLabel("日志分段:", this);
+    segmentLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    row5Layout->addWidget(segmentLabel);
+    row5Layout->addWidget(m_segmentSizeBox);
+    row5Layout->addWidget(m_segmentMinutesBox);
+    row5Layout->addWidget(m_compressLogCheckbox);
+    QLabel *retentionLabel = new QLabel("总大小上限:", this);
+    retentionLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    row5Layout->addWidget(retentionLabel);
+    row5Layout->addWidget(m_retentionBox);
+    QLabel *alarmLabel = new QLabel("报警规则:", this);
+    alarmLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    row5Layout->addWidget(alarmLabel);
+    row5Layout->addWidget(m_alarmRulesEdit);
+    row5Layout->addWidget(m_browseAlarmRulesBtn);
+    row5Layout->addStretch();
+
+    // 将五行添加到主布局
     mainLayout->addLayout(row1Layout);
     mainLayout->addLayout(row2Layout);
     mainLayout->addLayout(row3Layout);
+    mainLayout->addLayout(row4Layout);
+    mainLayout->addLayout(row5Layout);
 }
 
 void SettingsPanel::initConnections()
 {
     connect(m_togglePanelButton, &QPushButton::clicked, this, &SettingsPanel::togglePanel);
     connect(m_browseLogFileBtn, &QPushButton::clicked, this, &SettingsPanel::browseLogFile);
+    connect(m_browseCaptureFileBtn, &QPushButton::clicked, this, &SettingsPanel::browseCaptureFile);
+    connectAppliedEdit(m_frameSpecEdit, &m_appliedFrameSpec, &SettingsPanel::frameSpecChanged);
+    connectAppliedEdit(m_triggerSpecEdit, &m_appliedTriggerSpec, &SettingsPanel::triggerSpecChanged);
+    connectAppliedEdit(m_alarmRulesEdit, &m_appliedAlarmRules, &SettingsPanel::alarmRulesChanged);
+    connect(m_browseAlarmRulesBtn, &QPushButton::clicked, this, &SettingsPanel::browseAlarmRules);
+    auto emitLimits = [this]() { emit scrollbackLimitsChanged(scrollbackMaxLines(), scrollbackMaxBytes()); };
+    connect(m_maxLinesBox, QOverload<int>::of(&QSpinBox::valueChanged), this, emitLimits);
+    connect(m_maxMemoryBox, QOverload<int>::of(&QSpinBox::valueChanged), this, emitLimits);
+}
+
+// 失去焦点时也会发出 editingFinished; 内容未变时不发出信号, 以免重建分帧器、触发环或报警自动机并清零计数
+void SettingsPanel::connectAppliedEdit(QLineEdit *edit, QString *applied, TextSignal signal)
+{
+    *applied = edit->text().trimmed();
+    connect(edit, &QLineEdit::editingFinished, this, [this, edit, applied, signal]() {
+        applyEdit(edit, applied, signal, false);
+    });
+}
+
+// force 为 true 时即使内容未变也发出, 用于重新选择同一个文件
+void SettingsPanel::applyEdit(QLineEdit *edit, QString *applied, TextSignal signal, bool force)
+{
+    const QString text = edit->text().trimmed();
+    if (!force && text == *applied) return;
+    *applied = text;
+    emit (this->*signal)(text);
 }
 
 void SettingsPanel::addLabelAndCombo(QHBoxLayout* layout, const QString& labelText, QComboBox*& comboBox, int width)
@@ -142,12 +310,45 @@ QSerialPort::DataBits SettingsPanel::getdataBits() const
 
 QSerialPort::Parity SettingsPanel::getparity() const
 {
-    return static_cast<QSerialPort::Parity>(m_stopBitsBox->currentIndex());
+    return static_cast<QSerialPort::Parity>(m_parityBox->currentData().toInt());
 }
 
 QSerialPort::StopBits SettingsPanel::getstopBits() const
 {
-    return static_cast<QSerialPort::StopBits>(m_parityBox->currentIndex() + 1);
+    return static_cast<QSerialPort::StopBits>(m_stopBitsBox->currentData().toInt());
+}
+
+QSerialPort::FlowControl SettingsPanel::getflowControl() const
+{
+    return static_cast<QSerialPort::FlowControl>(m_flowControlBox->currentData().toInt());
+}
+
+// 一次读出全部串口参数, 由调用方校验后整体交给I/O线程
+PortSettings SettingsPanel::portSettings(const QString &portName) const
+{
+    PortSettings settings;
+    settings.portName = portName;
+    settings.baudRate = getbaudRate();
+    settings.dataBits = getdataBits();
+    settings.parity = getparity();
+    settings.stopBits = getstopBits();
+    settings.flowControl = getflowControl();
+    settings.openMode = getopenMode();
+    settings.readBufferSize = qint64(m_readBufferBox->value()) * 1024;
+    settings.lowLatency = m_lowLatencyCheckbox->isChecked();
+    return settings;
+}
+
+// 切换串口时显示该串口上次使用的参数; 打开方式不随串口保存
+void SettingsPanel::setPortSettings(const PortSettings &settings)
+{
+    m_baudRateBox->setCurrentText(QString::number(settings.baudRate));
+    m_dataBitsBox->setCurrentText(QString::number(int(settings.dataBits)));
+    m_parityBox->setCurrentIndex(qMax(0, m_parityBox->findData(int(settings.parity))));
+    m_stopBitsBox->setCurrentIndex(qMax(0, m_stopBitsBox->findData(int(settings.stopBits))));
+    m_flowControlBox->setCurrentIndex(qMax(0, m_flowControlBox->findData(int(settings.flowControl))));
+    m_readBufferBox->setValue(int(settings.readBufferSize / 1024));
+    m_lowLatencyCheckbox->setChecked(settings.lowLatency);
 }
 
 bool SettingsPanel::showControlCharacters() const
@@ -222,6 +423,52 @@ void SettingsPanel::browseLogFile() {
     }
 }
 
+void SettingsPanel::browseCaptureFile() {
+    QString fileName = QFileDialog::getSaveFileName(
+        this,
+        "选择捕获文件",
+        QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation),
+        "捕获文件 (*.pyrocap);;所有文件 (*.*)");
+
+    if (!fileName.isEmpty()) {
+        m_captureFilePathEdit->setText(fileName);
+    }
+}
+
+void SettingsPanel::browseAlarmRules() {
+    QString fileName = QFileDialog::getOpenFileName(
+        this,
+        "选择报警规则文件",
+        QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation),
+        "规则文件 (*.txt *.rules);;所有文件 (*.*)");
+
+    if (!fileName.isEmpty()) {
+        m_alarmRulesEdit->setText(fileName);
+        applyEdit(m_alarmRulesEdit, &m_appliedAlarmRules, &SettingsPanel::alarmRulesChanged, true);
+    }
+}
+
+QString SettingsPanel::frameSpec() const {
+    return m_frameSpecEdit->text().trimmed();
+}
+
+QString SettingsPanel::triggerSpec() const {
+    return m_triggerSpecEdit->text().trimmed();
+}
+
+QString SettingsPanel::alarmRulesPath() const {
+    return m_alarmRulesEdit->text().trimmed();
+}
+
+QString SettingsPanel::triggerDirectory() const {
+    if (!captureFilePath().isEmpty()) return QFileInfo(captureFilePath()).absolutePath();
+    return QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
+}
+
+QString SettingsPanel::captureFilePath() const {
+    return m_captureFilePathEdit->text();
+}
+
 QString SettingsPanel::logFilePath() const {
     return m_logFilePathEdit->text();
 }
@@ -229,3 +476,21 @@ QString SettingsPanel::logFilePath() const {
 bool SettingsPanel::isAppendMode() const {
     return m_appendLogCheckbox->isChecked();
 }
+
+// 分段设置在打开日志时读取, 对已打开的日志不生效
+LogRotation SettingsPanel::logRotation() const {
+    LogRotation rotation;
+    rotation.maxSegmentBytes = qint64(m_segmentSizeBox->value()) * 1024 * 1024;
+    rotation.maxSegmentSeconds = m_segmentMinutesBox->value() * 60;
+    rotation.compress = m_compressLogCheckbox->isChecked();
+    rotation.retentionBytes = qint64(m_retentionBox->value()) * 1024 * 1024;
+    return rotation;
+}
+
+int SettingsPanel::scrollbackMaxLines() const {
+    return m_maxLinesBox->value();
+}
+
+qint64 SettingsPanel::scrollbackMaxBytes() const {
+    return qint64(m_maxMemoryBox->value()) * 1024 * 1024;
+}
@@ -0,0 +1,199 @@
+#include "statscollector.h"
+#include "serialsession.h"
+#include "sessionmanager.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+double StatsSnapshot::totalRxBytesPerSec() const
+{
+    double total = 0;
+    for (const PortStatsSample &port : ports) total += port.rxBytesPerSec;
+    return total;
+}
+
+double StatsSnapshot::totalTxBytesPerSec() const
+{
+    double total = 0;
+    for (const PortStatsSample &port : ports) total += port.txBytesPerSec;
+    return total;
+}
+
+StatsCollector::StatsCollector(SessionManager *sessions, QObject *parent)
+    : QObject(parent)
+    , m_sessions(sessions)
+    , m_timer(new QTimer(this))
+{
+    m_timer->setInterval(1000);
+    connect(m_timer, &QTimer::timeout, this, &StatsCollector::sample);
+    // 会话关闭后不再保留上一周期的计数, 同名串口重新打开时从0开始
+    connect(m_sessions, &SessionManager::sessionClosed, this, [this](SerialSession *session) {
+        m_previous.remove(session);
+    });
+}
+
+void StatsCollector::start()
+{
+    if (m_timer->isActive()) return;
+    m_lastSampleNs = SerialWorker::monotonicNs();
+    m_latency.reset();
+    m_timer->start();
+}
+
+void StatsCollector::stop()
+{
+    m_timer->stop();
+}
+
+StatsCollector::ExportFormat StatsCollector::formatForPath(const QString &path)
+{
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    return suffix == "json" || suffix == "jsonl" ? ExportFormat::JsonLines : ExportFormat::Csv;
+}
+
+bool StatsCollector::setExportPath(const QString &path, ExportFormat format, QString *errorString)
+{
+    m_export.close();
+    if (path.isEmpty()) return true;
+
+    // 追加写入, 长时间运行中途重新开始导出也不会覆盖已有数据
+    const bool needsHeader = format == ExportFormat::Csv && QFileInfo(path).size() == 0;
+    if (!m_export.open(path, true, errorString)) return false;
+    m_exportFormat = format;
+    if (needsHeader) m_export.append(csvHeader());
+    return true;
+}
+
+void StatsCollector::sample()
+{
+    const qint64 now = SerialWorker::monotonicNs();
+    const double interval = double(now - m_lastSampleNs) / 1e9;
+    m_lastSampleNs = now;
+    if (interval <= 0) return;
+
+    StatsSnapshot snapshot;
+    snapshot.timestampMs = QDateTime::currentMSecsSinceEpoch();
+    snapshot.intervalSec = interval;
+
+    for (SerialSession *session : m_sessions->sessions()) {
+        if (!session->isOpen()) continue;
+        SerialWorker *worker = session->worker();
+        PortStatsSample port;
+        port.portName = session->portName();
+        port.rxBytes = worker->rxBytes();
+        port.txBytes = worker->txBytes();
+        port.frames = session->frameParser().frameCount();
+        port.checksumErrors = session->frameParser().checksumErrors();
+        port.ringHighWater = worker->ring().highWaterMark();
+        port.ringCapacity = worker->ring().capacity();
+        port.ringStalls = worker->ringStalls();
+        port.errors = worker->lineErrors();
+        port.logQueueBytes = session->logWriter().queueDepth();
+        port.logDropped = session->logWriter().droppedRecords();
+        port.logWriteErrors = session->logWriter().writeErrors();
+        port.logRotationFailures = session->logWriter().rotationFailures();
+
+        // 第一次采样到的会话没有上一周期, 速率按0计算
+        auto previous = m_previous.find(session);
+        if (previous != m_previous.end()) {
+            port.rxBytesPerSec = double(port.rxBytes - previous->rxBytes) / interval;
+            port.txBytesPerSec = double(port.txBytes - previous->txBytes) / interval;
+            // 修改帧格式时分帧计数会清零
+            if (port.frames >= previous->frames)
+                port.rxFramesPerSec = double(port.frames - previous->frames) / interval;
+        }
+        m_previous[session] = {port.rxBytes, port.txBytes, port.frames};
+        snapshot.ports.append(port);
+    }
+
+    snapshot.latencySamples = m_latency.count();
+    snapshot.latencyP50Us = double(m_latency.percentileNs(50)) / 1000.0;
+    snapshot.latencyP99Us = double(m_latency.percentileNs(99)) / 1000.0;
+    snapshot.latencyMaxUs = double(m_latency.maxNs()) / 1000.0;
+    m_latency.reset();
+
+    if (m_export.isOpen()) {
+        m_export.append(m_exportFormat == ExportFormat::Csv ? toCsv(snapshot) : toJsonLine(snapshot));
+    }
+
+    m_last = snapshot;
+    emit sampled(m_last);
+}
+
+QByteArray StatsCollector::csvHeader()
+{
+    return "timestamp_ms,port,rx_bytes_per_sec,tx_bytes_per_sec,rx_frames_per_sec,rx_bytes,tx_bytes,"
+           "frames,checksum_errors,latency_p50_us,latency_p99_us,latency_max_us,ring_high_water,"
+           "ring_capacity,ring_stalls,overrun,buffer_overrun,parity,framing,break,port_errors,"
+           "log_queue_bytes,log_dropped,log_write_errors\n";
+}
+
+// 每个串口一行, 延迟是所有串口共用的显示延迟
+QByteArray StatsCollector::toCsv(const StatsSnapshot &snapshot)
+{
+    QByteArray out;
+    for (const PortStatsSample &port : snapshot.ports) {
+        out += QString("%1,%2,%3,%4,%5,%6,%7,%8,%9,")
+                   .arg(snapshot.timestampMs).arg(port.portName)
+                   .arg(port.rxBytesPerSec, 0, 'f', 1).arg(port.txBytesPerSec, 0, 'f', 1)
+                   .arg(port.rxFramesPerSec, 0, 'f', 1).arg(port.rxBytes).arg(port.txBytes)
+                   .arg(port.frames).arg(port.checksumErrors).toUtf8();
+        out += QString("%1,%2,%3,%4,%5,%6,")
+                   .arg(snapshot.latencyP50Us, 0, 'f', 1).arg(snapshot.latencyP99Us, 0, 'f', 1)
+                   .arg(snapshot.latencyMaxUs, 0, 'f', 1).arg(port.ringHighWater)
+                   .arg(port.ringCapacity).arg(port.ringStalls).toUtf8();
+        out += QString("%1,%2,%3,%4,%5,%6,%7,%8,%9\n")
+                   .arg(port.errors.overrun).arg(port.errors.bufferOverrun).arg(port.errors.parity)
+                   .arg(port.errors.framing).arg(port.errors.breaks).arg(port.errors.portErrors)
+                   .arg(port.logQueueBytes).arg(port.logDropped).arg(port.logWriteErrors).toUtf8();
+    }
+    return out;
+}
+
+QByteArray StatsCollector::toJsonLine(const StatsSnapshot &snapshot)
+{
+    QJsonArray ports;
+    for (const PortStatsSample &port : snapshot.ports) {
+        QJsonObject errors;
+        errors["overrun"] = double(port.errors.overrun);
+        errors["buffer_overrun"] = double(port.errors.bufferOverrun);
+        errors["parity"] = double(port.errors.parity);
+        errors["framing"] = double(port.errors.framing);
+        errors["break"] = double(port.errors.breaks);
+        errors["port_errors"] = double(port.errors.portErrors);
+
+        QJsonObject object;
+        object["port"] = port.portName;
+        object["rx_bytes_per_sec"] = port.rxBytesPerSec;
+        object["tx_bytes_per_sec"] = port.txBytesPerSec;
+        object["rx_frames_per_sec"] = port.rxFramesPerSec;
+        object["rx_bytes"] = double(port.rxBytes);
+        object["tx_bytes"] = double(port.txBytes);
+        object["frames"] = double(port.frames);
+        object["checksum_errors"] = double(port.checksumErrors);
+        object["ring_high_water"] = double(port.ringHighWater);
+        object["ring_capacity"] = double(port.ringCapacity);
+        object["ring_stalls"] = double(port.ringStalls);
+        object["errors"] = errors;
+        object["log_queue_bytes"] = double(port.logQueueBytes);
+        object["log_dropped"] = double(port.logDropped);
+        object["log_write_errors"] = double(port.logWriteErrors);
+        ports.append(object);
+    }
+
+    QJsonObject latency;
+    latency["samples"] = double(snapshot.latencySamples);
+    latency["p50_us"] = snapshot.latencyP50Us;
+    latency["p99_us"] = snapshot.latencyP99Us;
+    latency["max_us"] = snapshot.latencyMaxUs;
+
+    QJsonObject root;
+    root["timestamp_ms"] = double(snapshot.timestampMs);
+    root["interval_sec"] = snapshot.intervalSec;
+    root["latency"] = latency;
+    root["ports"] = ports;
+    return QJsonDocument(root).toJson(QJsonDocument::Compact) + '\n';
+}
@@ -0,0 +1,124 @@
+#include "statsdock.h"
+
+#include <QFileDialog>
+#include <QHeaderView>
+#include <QMessageBox>
+#include <QVBoxLayout>
+
+namespace {
+
+enum Row {
+    RxRate, TxRate, FrameRate, RxTotal, TxTotal, ChecksumErrors,
+    RingHighWater, RingStalls, Overrun, BufferOverrun, Parity, Framing, Break, PortErrors,
+    LogQueue, LogDropped, LogWriteErrors, RowCount
+};
+
+const char *const kRowNames[RowCount] = {
+    "接收 KB/s", "发送 KB/s", "帧/s", "累计接收", "累计发送", "校验错误",
+    "缓冲区峰值", "缓冲区满", "硬件溢出", "驱动缓冲溢出", "校验位错误", "帧错误", "Break", "串口错误",
+    "日志队列", "日志丢弃", "日志写入失败"
+};
+
+QString formatBytes(double bytes)
+{
+    if (bytes >= 1048576.0) return QString("%1 MB").arg(bytes / 1048576.0, 0, 'f', 1);
+    if (bytes >= 1024.0) return QString("%1 KB").arg(bytes / 1024.0, 0, 'f', 1);
+    return QString("%1 B").arg(bytes, 0, 'f', 0);
+}
+
+} // namespace
+
+StatsDock::StatsDock(StatsCollector *collector, QWidget *parent)
+    : QDockWidget("统计", parent)
+    , m_collector(collector)
+    , m_table(new QTableWidget(RowCount, 0, this))
+    , m_latencyLabel(new QLabel(this))
+    , m_exportButton(new QPushButton("导出...", this))
+{
+    setObjectName("statsDock");
+    setFeatures(QDockWidget::DockWidgetClosable | QDockWidget::DockWidgetMovable | QDockWidget::DockWidgetFloatable);
+
+    QStringList rowNames;
+    for (const char *name : kRowNames) rowNames.append(name);
+    m_table->setVerticalHeaderLabels(rowNames);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+
+    QWidget *content = new QWidget(this);
+    QVBoxLayout *layout = new QVBoxLayout(content);
+    layout->setContentsMargins(5, 5, 5, 5);
+    layout->addWidget(m_latencyLabel);
+    layout->addWidget(m_table);
+    layout->addWidget(m_exportButton);
+    setWidget(content);
+
+    connect(m_collector, &StatsCollector::sampled, this, &StatsDock::onSampled);
+    connect(m_exportButton, &QPushButton::clicked, this, &StatsDock::onExportClicked);
+}
+
+void StatsDock::setCell(int row, int column, const QString &text)
+{
+    QTableWidgetItem *item = m_table->item(row, column);
+    if (!item) {
+        item = new QTableWidgetItem;
+        item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        m_table->setItem(row, column, item);
+    }
+    item->setText(text);
+}
+
+void StatsDock::onSampled(const StatsSnapshot &snapshot)
+{
+    m_latencyLabel->setText(QString("读取到显示延迟: p50 %1 ms  p99 %2 ms  最大 %3 ms  (%4 个数据块)")
+                                .arg(snapshot.latencyP50Us / 1000.0, 0, 'f', 2)
+                                .arg(snapshot.latencyP99Us / 1000.0, 0, 'f', 2)
+                                .arg(snapshot.latencyMaxUs / 1000.0, 0, 'f', 2)
+                                .arg(snapshot.latencySamples));
+
+    // 只在串口增减时重建列, 平时只更新单元格文字
+    if (m_table->columnCount() != snapshot.ports.size()) m_table->setColumnCount(snapshot.ports.size());
+    for (int column = 0; column < snapshot.ports.size(); ++column) {
+        const PortStatsSample &port = snapshot.ports.at(column);
+        QTableWidgetItem *header = m_table->horizontalHeaderItem(column);
+        if (!header || header->text() != port.portName) m_table->setHorizontalHeaderItem(column, new QTableWidgetItem(port.portName));
+
+        setCell(RxRate, column, QString::number(port.rxBytesPerSec / 1024.0, 'f', 1));
+        setCell(TxRate, column, QString::number(port.txBytesPerSec / 1024.0, 'f', 1));
+        setCell(FrameRate, column, QString::number(port.rxFramesPerSec, 'f', 1));
+        setCell(RxTotal, column, formatBytes(double(port.rxBytes)));
+        setCell(TxTotal, column, formatBytes(double(port.txBytes)));
+        setCell(ChecksumErrors, column, QString::number(port.checksumErrors));
+        setCell(RingHighWater, column, QString("%1 / %2").arg(formatBytes(double(port.ringHighWater)))
+                                                          .arg(formatBytes(double(port.ringCapacity))));
+        setCell(RingStalls, column, QString::number(port.ringStalls));
+        setCell(Overrun, column, QString::number(port.errors.overrun));
+        setCell(BufferOverrun, column, QString::number(port.errors.bufferOverrun));
+        setCell(Parity, column, QString::number(port.errors.parity));
+        setCell(Framing, column, QString::number(port.errors.framing));
+        setCell(Break, column, QString::number(port.errors.breaks));
+        setCell(PortErrors, column, QString::number(port.errors.portErrors));
+        setCell(LogQueue, column, formatBytes(double(port.logQueueBytes)));
+        setCell(LogDropped, column, QString::number(port.logDropped));
+        setCell(LogWriteErrors, column, QString::number(port.logWriteErrors));
+    }
+}
+
+void StatsDock::onExportClicked()
+{
+    if (!m_collector->exportPath().isEmpty()) {
+        m_collector->setExportPath(QString(), StatsCollector::ExportFormat::Csv);
+        m_exportButton->setText("导出...");
+        return;
+    }
+
+    const QString path = QFileDialog::getSaveFileName(this, "导出统计", QString(),
+                                                      "CSV (*.csv);;JSON Lines (*.jsonl *.json)");
+    if (path.isEmpty()) return;
+
+    QString error;
+    if (!m_collector->setExportPath(path, StatsCollector::formatForPath(path), &error)) {
+        QMessageBox::warning(this, "警告", "无法打开导出文件: " + error);
+        return;
+    }
+    m_exportButton->setText("停止导出");
+}
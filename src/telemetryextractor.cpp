@@ -0,0 +1,164 @@
+#include "telemetryextractor.h"
+
+#include <cstring>
+
+int TelemetryField::size() const
+{
+    switch (type) {
+    case Type::U8:
+    case Type::I8:  return 1;
+    case Type::U16:
+    case Type::I16: return 2;
+    case Type::U32:
+    case Type::I32:
+    case Type::F32: return 4;
+    }
+    return 1;
+}
+
+namespace {
+
+bool parseFieldType(QString name, TelemetryField *field)
+{
+    name = name.toLower();
+    field->bigEndian = name.endsWith("be");
+    if (field->bigEndian || name.endsWith("le")) name.chop(2);
+    if (name == "u8")       field->type = TelemetryField::Type::U8;
+    else if (name == "i8")  field->type = TelemetryField::Type::I8;
+    else if (name == "u16") field->type = TelemetryField::Type::U16;
+    else if (name == "i16") field->type = TelemetryField::Type::I16;
+    else if (name == "u32") field->type = TelemetryField::Type::U32;
+    else if (name == "i32") field->type = TelemetryField::Type::I32;
+    else if (name == "f32") field->type = TelemetryField::Type::F32;
+    else return false;
+    return true;
+}
+
+quint32 readUnsigned(const uchar *p, int size, bool bigEndian)
+{
+    quint32 value = 0;
+    for (int i = 0; i < size; ++i) {
+        const int shift = bigEndian ? (size - 1 - i) * 8 : i * 8;
+        value |= quint32(p[i]) << shift;
+    }
+    return value;
+}
+
+double decodeField(const TelemetryField &field, const uchar *p)
+{
+    const quint32 raw = readUnsigned(p, field.size(), field.bigEndian);
+    double value = 0;
+    switch (field.type) {
+    case TelemetryField::Type::U8:  value = double(quint8(raw)); break;
+    case TelemetryField::Type::I8:  value = double(qint8(raw)); break;
+    case TelemetryField::Type::U16: value = double(quint16(raw)); break;
+    case TelemetryField::Type::I16: value = double(qint16(raw)); break;
+    case TelemetryField::Type::U32: value = double(raw); break;
+    case TelemetryField::Type::I32: value = double(qint32(raw)); break;
+    case TelemetryField::Type::F32: {
+        float f;
+        std::memcpy(&f, &raw, sizeof(f));
+        value = double(f);
+        break;
+    }
+    }
+    return value * field.scale;
+}
+
+} // namespace
+
+TelemetrySpec TelemetrySpec::parse(const QString &text, QString *errorString)
+{
+    TelemetrySpec spec;
+    const QString trimmed = text.trimmed();
+    if (trimmed.isEmpty()) return spec;
+
+    if (trimmed.startsWith("re:")) {
+        spec.regex.setPattern(trimmed.mid(3));
+        if (!spec.regex.isValid()) {
+            if (errorString) *errorString = "无效的正则表达式: " + spec.regex.errorString();
+            return TelemetrySpec();
+        }
+        spec.regex.optimize();
+        // 没有捕获组时整个匹配就是数值
+        const QStringList groups = spec.regex.namedCaptureGroups();
+        if (groups.size() <= 1) {
+            spec.channelNames << "值";
+        } else {
+            for (int i = 1; i < groups.size(); ++i)
+                spec.channelNames << (groups.at(i).isEmpty() ? QString("值%1").arg(i) : groups.at(i));
+        }
+        spec.kind = Kind::Regex;
+        return spec;
+    }
+
+    const QStringList entries = trimmed.split(';', Qt::SkipEmptyParts);
+    for (const QString &entry : entries) {
+        const int eq = entry.indexOf('=');
+        const QStringList parts = entry.mid(eq + 1).split(':');
+        TelemetryField field;
+        field.name = entry.left(eq).trimmed();
+        bool ok = eq > 0 && !field.name.isEmpty() && parts.size() >= 2 && parts.size() <= 3;
+        if (ok) field.offset = parts.at(0).trimmed().toInt(&ok);
+        ok = ok && field.offset >= 0 && parseFieldType(parts.at(1).trimmed(), &field);
+        if (ok && parts.size() == 3) field.scale = parts.at(2).trimmed().toDouble(&ok);
+        if (!ok) {
+            if (errorString) *errorString = QString("无效的字段: %1 (格式为 名字=偏移:类型[:系数])").arg(entry);
+            return TelemetrySpec();
+        }
+        spec.fields.append(field);
+        spec.channelNames << field.name;
+    }
+    if (spec.fields.isEmpty()) {
+        if (errorString) *errorString = "没有字段";
+        return TelemetrySpec();
+    }
+    spec.kind = Kind::Fields;
+    return spec;
+}
+
+void TelemetryExtractor::setSpec(const TelemetrySpec &spec)
+{
+    m_spec = spec;
+    m_values.fill(0.0, spec.channelNames.size());
+    m_present.fill(false, spec.channelNames.size());
+    reset();
+}
+
+void TelemetryExtractor::reset()
+{
+    m_carry.clear();
+    m_matched = 0;
+    m_unmatched = 0;
+}
+
+int TelemetryExtractor::extractLine(const char *line, qsizetype n)
+{
+    const QRegularExpressionMatch match = m_spec.regex.match(QString::fromUtf8(line, int(n)));
+    if (!match.hasMatch()) return 0;
+
+    int found = 0;
+    const int groups = m_spec.regex.captureCount();
+    for (int i = 0; i < m_values.size(); ++i) {
+        bool ok = false;
+        m_values[i] = match.captured(groups == 0 ? 0 : i + 1).toDouble(&ok);
+        m_present[i] = ok;
+        found += ok;
+    }
+    return found;
+}
+
+int TelemetryExtractor::extractFrame(const char *data, qsizetype n)
+{
+    const uchar *p = reinterpret_cast<const uchar *>(data);
+    int found = 0;
+    for (int i = 0; i < m_spec.fields.size(); ++i) {
+        const TelemetryField &field = m_spec.fields.at(i);
+        m_present[i] = field.offset + field.size() <= n;
+        if (m_present.at(i)) {
+            m_values[i] = decodeField(field, p + field.offset);
+            ++found;
+        }
+    }
+    return found;
+}
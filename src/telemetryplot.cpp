@@ -0,0 +1,171 @@
+#include "telemetryplot.h"
+#include "serialworker.h"
+
+#include <QElapsedTimer>
+#include <QPainter>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr int kLeftMargin = 60;
+constexpr int kBottomMargin = 20;
+constexpr int kTopMargin = 8;
+constexpr int kRightMargin = 8;
+constexpr int kGridLines = 5;
+
+} // namespace
+
+TelemetryPlot::TelemetryPlot(TelemetryStore *store, QWidget *parent)
+    : QWidget(parent)
+    , m_store(store)
+    , m_frameTimer(new QTimer(this))
+{
+    setMinimumSize(200, 120);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setFrameRate(30);
+    connect(m_frameTimer, &QTimer::timeout, this, &TelemetryPlot::onFrameTimer);
+}
+
+void TelemetryPlot::setWindowSeconds(double seconds)
+{
+    m_windowSeconds = qMax(0.01, seconds);
+    update();
+}
+
+void TelemetryPlot::setPaused(bool paused)
+{
+    m_paused = paused;
+    if (paused) m_pausedAtNs = SerialWorker::monotonicNs();
+    update();
+}
+
+void TelemetryPlot::setFrameRate(int hz)
+{
+    m_frameTimer->setInterval(1000 / qMax(1, hz));
+}
+
+void TelemetryPlot::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    m_frameTimer->start();
+}
+
+void TelemetryPlot::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    m_frameTimer->stop();
+}
+
+// 跟随模式下横轴随时间滚动, 有通道就要重绘; 暂停时只在数据变化(如清空)时重绘
+void TelemetryPlot::onFrameTimer()
+{
+    if (m_store->channelCount() == 0 && m_paintedGeneration == m_store->generation()) return;
+    if (m_paused && m_paintedGeneration == m_store->generation()) return;
+    update();
+}
+
+QColor TelemetryPlot::channelColor(int channel)
+{
+    static const QColor colors[] = {
+        QColor(31, 119, 180), QColor(255, 127, 14), QColor(44, 160, 44), QColor(214, 39, 40),
+        QColor(148, 103, 189), QColor(140, 86, 75), QColor(227, 119, 194), QColor(127, 127, 127),
+    };
+    return colors[channel % int(sizeof(colors) / sizeof(colors[0]))];
+}
+
+void TelemetryPlot::paintEvent(QPaintEvent *)
+{
+    QElapsedTimer timer;
+    timer.start();
+    m_paintedGeneration = m_store->generation();
+
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().base());
+    const QRect area = rect().adjusted(kLeftMargin, kTopMargin, -kRightMargin, -kBottomMargin);
+    if (area.width() < 2 || area.height() < 2) return;
+
+    const qint64 t1 = m_paused ? m_pausedAtNs : SerialWorker::monotonicNs();
+    const qint64 t0 = t1 - qint64(m_windowSeconds * 1e9);
+    const int columns = area.width();
+
+    // 先对所有通道做抽取, 同时得到纵轴范围
+    const int channels = m_store->channelCount();
+    m_buckets.resize(channels);
+    double yMin = std::numeric_limits<double>::infinity();
+    double yMax = -yMin;
+    for (int ch = 0; ch < channels; ++ch) {
+        m_store->decimate(ch, t0, t1, columns, &m_buckets[ch]);
+        for (const TelemetryStore::Bucket &bucket : m_buckets.at(ch)) {
+            if (bucket.count == 0) continue;
+            yMin = qMin(yMin, bucket.min);
+            yMax = qMax(yMax, bucket.max);
+        }
+    }
+    if (!(yMin <= yMax)) {
+        yMin = 0;
+        yMax = 1;
+    } else if (yMax - yMin < 1e-12) {
+        yMin -= 1;
+        yMax += 1;
+    } else {
+        const double pad = (yMax - yMin) * 0.05;
+        yMin -= pad;
+        yMax += pad;
+    }
+    const double yScale = area.height() / (yMax - yMin);
+    auto yPixel = [&](double value) { return area.bottom() - (value - yMin) * yScale; };
+
+    // 网格和坐标
+    painter.setPen(palette().mid().color());
+    painter.drawRect(area);
+    for (int i = 0; i <= kGridLines; ++i) {
+        const double value = yMin + (yMax - yMin) * i / kGridLines;
+        const int y = int(yPixel(value));
+        painter.setPen(QPen(palette().midlight().color(), 0, Qt::DotLine));
+        painter.drawLine(area.left(), y, area.right(), y);
+        painter.setPen(palette().text().color());
+        painter.drawText(QRect(0, y - 8, kLeftMargin - 4, 16), Qt::AlignRight | Qt::AlignVCenter,
+                         QString::number(value, 'g', 4));
+    }
+    for (int i = 0; i <= kGridLines; ++i) {
+        const int x = area.left() + area.width() * i / kGridLines;
+        const double seconds = -m_windowSeconds * (kGridLines - i) / kGridLines;
+        painter.drawText(QRect(x - 30, area.bottom() + 2, 60, kBottomMargin - 2), Qt::AlignCenter,
+                         QString("%1 s").arg(seconds, 0, 'g', 3));
+    }
+
+    // 每列按 最小->最大 两个点连成折线, 列与列之间自然相连
+    painter.setClipRect(area);
+    int pointCount = 0;
+    for (int ch = 0; ch < channels; ++ch) {
+        m_points.resize(0);
+        const QVector<TelemetryStore::Bucket> &buckets = m_buckets.at(ch);
+        for (int col = 0; col < buckets.size(); ++col) {
+            const TelemetryStore::Bucket &bucket = buckets.at(col);
+            if (bucket.count == 0) continue;
+            const double x = area.left() + col + 0.5;
+            m_points.append(QPointF(x, yPixel(bucket.min)));
+            if (bucket.max != bucket.min) m_points.append(QPointF(x, yPixel(bucket.max)));
+        }
+        painter.setPen(QPen(channelColor(ch), 0));
+        if (m_points.size() == 1) painter.drawPoint(m_points.first());
+        else painter.drawPolyline(m_points.constData(), m_points.size());
+        pointCount += m_points.size();
+    }
+    painter.setClipping(false);
+
+    // 图例: 通道名和最新值
+    int legendY = area.top() + 4;
+    for (int ch = 0; ch < channels; ++ch) {
+        const QString text = m_store->size(ch) > 0
+            ? QString("%1 = %2").arg(m_store->channelName(ch)).arg(m_store->lastValue(ch), 0, 'g', 6)
+            : m_store->channelName(ch);
+        painter.setPen(channelColor(ch));
+        painter.drawText(QRect(area.left() + 6, legendY, area.width() - 12, 16), Qt::AlignLeft | Qt::AlignVCenter, text);
+        legendY += 16;
+    }
+
+    m_lastPointCount = pointCount;
+    m_lastPaintMs = timer.nsecsElapsed() / 1e6;
+}
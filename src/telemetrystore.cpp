@@ -0,0 +1,144 @@
+#include "telemetrystore.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+constexpr double kInf = std::numeric_limits<double>::infinity();
+
+} // namespace
+
+TelemetryStore::TelemetryStore(int capacity)
+    : m_capacity(qMax(kBlockSize, (capacity + kBlockSize - 1) / kBlockSize * kBlockSize))
+{
+}
+
+int TelemetryStore::addChannel(const QString &name)
+{
+    Channel ch;
+    ch.name = name;
+    ch.timestamps.resize(size_t(m_capacity));
+    ch.values.resize(size_t(m_capacity));
+    ch.blockMin.assign(size_t(m_capacity / kBlockSize), kInf);
+    ch.blockMax.assign(size_t(m_capacity / kBlockSize), -kInf);
+    m_channels.push_back(std::move(ch));
+    ++m_generation;
+    return int(m_channels.size()) - 1;
+}
+
+void TelemetryStore::clear()
+{
+    m_channels.clear();
+    ++m_generation;
+}
+
+void TelemetryStore::append(int channel, qint64 timestampNs, double value)
+{
+    Channel &ch = m_channels[size_t(channel)];
+    // 保持时间戳单调, 二分查找依赖于此
+    if (ch.count > 0) timestampNs = qMax(timestampNs, lastTimestampNs(channel));
+
+    const qsizetype pos = ch.head;
+    const size_t block = size_t(pos / kBlockSize);
+    // 进入一个块时重置它的摘要; 块内尚未覆盖的旧样本只会被逐个扫描, 不会用到摘要
+    if (pos % kBlockSize == 0) {
+        ch.blockMin[block] = kInf;
+        ch.blockMax[block] = -kInf;
+    }
+    ch.timestamps[size_t(pos)] = timestampNs;
+    ch.values[size_t(pos)] = value;
+    ch.blockMin[block] = qMin(ch.blockMin[block], value);
+    ch.blockMax[block] = qMax(ch.blockMax[block], value);
+
+    ch.head = pos + 1 == m_capacity ? 0 : pos + 1;
+    if (ch.count < m_capacity) ++ch.count;
+    ++m_generation;
+}
+
+qint64 TelemetryStore::lastTimestampNs(int channel) const
+{
+    const Channel &ch = m_channels[size_t(channel)];
+    return ch.count ? ch.timestamps[size_t(physical(ch, ch.count - 1))] : 0;
+}
+
+double TelemetryStore::lastValue(int channel) const
+{
+    const Channel &ch = m_channels[size_t(channel)];
+    return ch.count ? ch.values[size_t(physical(ch, ch.count - 1))] : 0.0;
+}
+
+// 逻辑序号(0 为最旧)到数组下标
+qsizetype TelemetryStore::physical(const Channel &ch, qsizetype logical)
+{
+    const qsizetype capacity = qsizetype(ch.timestamps.size());
+    const qsizetype start = ch.count < capacity ? 0 : ch.head;
+    const qsizetype pos = start + logical;
+    return pos >= capacity ? pos - capacity : pos;
+}
+
+// [from, count) 中第一个时间戳 >= timestampNs 的逻辑序号
+qsizetype TelemetryStore::lowerBound(const Channel &ch, qsizetype from, qint64 timestampNs)
+{
+    qsizetype lo = from, hi = ch.count;
+    while (lo < hi) {
+        const qsizetype mid = lo + (hi - lo) / 2;
+        if (ch.timestamps[size_t(physical(ch, mid))] < timestampNs) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// 数组下标 [from, to) 内的最小/最大值: 两端不足一块的部分逐个扫描, 中间整块使用摘要
+// 调用方保证区间不跨越写入位置, 因此区间内的完整块摘要都是有效的
+void TelemetryStore::scanRange(const Channel &ch, qsizetype from, qsizetype to, double *min, double *max)
+{
+    double lo = *min, hi = *max;
+    qsizetype pos = from;
+    const qsizetype firstBlockEnd = qMin(to, (from + kBlockSize - 1) / kBlockSize * kBlockSize);
+    for (; pos < firstBlockEnd; ++pos) {
+        lo = qMin(lo, ch.values[size_t(pos)]);
+        hi = qMax(hi, ch.values[size_t(pos)]);
+    }
+    for (; pos + kBlockSize <= to; pos += kBlockSize) {
+        const size_t block = size_t(pos / kBlockSize);
+        lo = qMin(lo, ch.blockMin[block]);
+        hi = qMax(hi, ch.blockMax[block]);
+    }
+    for (; pos < to; ++pos) {
+        lo = qMin(lo, ch.values[size_t(pos)]);
+        hi = qMax(hi, ch.values[size_t(pos)]);
+    }
+    *min = lo;
+    *max = hi;
+}
+
+void TelemetryStore::decimate(int channel, qint64 t0Ns, qint64 t1Ns, int buckets, QVector<Bucket> *out) const
+{
+    out->resize(buckets);
+    if (buckets <= 0) return;
+    std::fill(out->begin(), out->end(), Bucket{0.0, 0.0, 0});
+    const Channel &ch = m_channels[size_t(channel)];
+    if (ch.count == 0 || t1Ns <= t0Ns) return;
+
+    const qsizetype capacity = qsizetype(ch.timestamps.size());
+    const double span = double(t1Ns - t0Ns);
+    qsizetype begin = lowerBound(ch, 0, t0Ns);
+    for (int b = 0; b < buckets && begin < ch.count; ++b) {
+        const qint64 edge = t0Ns + qint64(span * (b + 1) / buckets);
+        const qsizetype end = lowerBound(ch, begin, b + 1 == buckets ? t1Ns : edge);
+        if (end == begin) continue;
+
+        double min = kInf, max = -kInf;
+        const qsizetype p0 = physical(ch, begin);
+        const qsizetype n = end - begin;
+        if (p0 + n <= capacity) {
+            scanRange(ch, p0, p0 + n, &min, &max);
+        } else {
+            scanRange(ch, p0, capacity, &min, &max);
+            scanRange(ch, 0, p0 + n - capacity, &min, &max);
+        }
+        (*out)[b] = Bucket{min, max, int(qMin<qsizetype>(n, std::numeric_limits<int>::max()))};
+        begin = end;
+    }
+}
@@ -0,0 +1,99 @@
+#include "timestampformatter.h"
+#include "serialworker.h"
+
+#include <QDate>
+#include <QDateTime>
+#include <cstring>
+
+namespace {
+
+constexpr qint64 kMsPerDay = 24 * 3600 * 1000;
+constexpr qint64 kResyncIntervalNs = 60LL * 1000 * 1000 * 1000;
+
+inline void put2(char *p, int v)
+{
+    p[0] = char('0' + v / 10);
+    p[1] = char('0' + v % 10);
+}
+
+// 向下取整的除法, 1970年以前的时间也能得到正确的天数
+inline qint64 floorDiv(qint64 a, qint64 b)
+{
+    return a / b - ((a % b) < 0 ? 1 : 0);
+}
+
+} // namespace
+
+void TimestampFormatter::resync(qint64 monotonicNs)
+{
+    const QDateTime now = QDateTime::currentDateTime();
+    const qint64 localNowMs = now.toMSecsSinceEpoch() + qint64(now.offsetFromUtc()) * 1000;
+    m_offsetMs = localNowMs - SerialWorker::monotonicNs() / 1000000;
+    m_nextResyncNs = monotonicNs + kResyncIntervalNs;
+    m_synced = true;
+}
+
+qint64 TimestampFormatter::localMs(qint64 monotonicNs)
+{
+    if (!m_synced || monotonicNs >= m_nextResyncNs) resync(monotonicNs);
+    return monotonicNs / 1000000 + m_offsetMs;
+}
+
+void TimestampFormatter::updateDate(qint64 day)
+{
+    // 1970-01-01 的儒略日为 2440588
+    const QDate date = QDate::fromJulianDay(2440588 + day);
+    const int year = date.year();
+    m_date[0] = char('0' + year / 1000 % 10);
+    m_date[1] = char('0' + year / 100 % 10);
+    m_date[2] = char('0' + year / 10 % 10);
+    m_date[3] = char('0' + year % 10);
+    m_date[4] = '-';
+    put2(m_date + 5, date.month());
+    m_date[7] = '-';
+    put2(m_date + 8, date.day());
+    m_day = day;
+}
+
+void TimestampFormatter::appendTime(QByteArray *out, qint64 monotonicNs)
+{
+    const qint64 ms = localMs(monotonicNs);
+    const qint64 msOfDay = ms - floorDiv(ms, kMsPerDay) * kMsPerDay;
+    const int seconds = int(msOfDay / 1000);
+
+    char buffer[kTimeSize];
+    buffer[0] = '[';
+    put2(buffer + 1, seconds / 3600);
+    buffer[3] = ':';
+    put2(buffer + 4, seconds / 60 % 60);
+    buffer[6] = ':';
+    put2(buffer + 7, seconds % 60);
+    buffer[9] = '.';
+    const int millis = int(msOfDay % 1000);
+    buffer[10] = char('0' + millis / 100);
+    put2(buffer + 11, millis % 100);
+    buffer[13] = ']';
+    buffer[14] = ' ';
+    out->append(buffer, kTimeSize);
+}
+
+void TimestampFormatter::appendDateTime(QByteArray *out, qint64 monotonicNs)
+{
+    const qint64 ms = localMs(monotonicNs);
+    const qint64 day = floorDiv(ms, kMsPerDay);
+    if (day != m_day) updateDate(day);
+    const int seconds = int((ms - day * kMsPerDay) / 1000);
+
+    char buffer[kDateTimeSize];
+    buffer[0] = '[';
+    std::memcpy(buffer + 1, m_date, sizeof(m_date));
+    buffer[11] = ' ';
+    put2(buffer + 12, seconds / 3600);
+    buffer[14] = ':';
+    put2(buffer + 15, seconds / 60 % 60);
+    buffer[17] = ':';
+    put2(buffer + 18, seconds % 60);
+    buffer[20] = ']';
+    buffer[21] = ' ';
+    out->append(buffer, kDateTimeSize);
+}
@@ -0,0 +1,187 @@
+#include "transactiondock.h"
+#include "serialsession.h"
+#include "sessionmanager.h"
+
+#include <QFile>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QMessageBox>
+#include <QTimer>
+#include <QVBoxLayout>
+
+namespace {
+
+enum Column { Port, Type, Sent, Matched, Timeouts, P50, P90, P99, P999, Max, ColumnCount };
+
+const char *const kColumnNames[ColumnCount] = {
+    "串口", "类型", "发送", "响应", "超时", "p50 ms", "p90 ms", "p99 ms", "p99.9 ms", "最大 ms"
+};
+
+QString formatMs(qint64 ns)
+{
+    return QString::number(ns / 1e6, 'f', 3);
+}
+
+} // namespace
+
+TransactionDock::TransactionDock(SessionManager *sessions, QWidget *parent)
+    : QDockWidget("事务", parent)
+    , m_sessions(sessions)
+    , m_ruleEdit(new QLineEdit(this))
+    , m_applyButton(new QPushButton("应用", this))
+    , m_resetButton(new QPushButton("清零", this))
+    , m_exportButton(new QPushButton("导出...", this))
+    , m_table(new QTableWidget(0, ColumnCount, this))
+    , m_statusLabel(new QLabel(this))
+{
+    setObjectName("transactionDock");
+    setFeatures(QDockWidget::DockWidgetClosable | QDockWidget::DockWidgetMovable | QDockWidget::DockWidgetFloatable);
+
+    m_ruleEdit->setPlaceholderText("match=seq;op=2:1;seq=3:1;timeout=200");
+    m_ruleEdit->setToolTip("match: seq 按序号匹配 / echo 响应回显命令类型 / first 命令后的第一帧\n"
+                           "op/seq: 命令中类型/序号字段的 偏移:字节数; rxop/rxseq: 响应中的位置(默认相同)\n"
+                           "timeout: 超时毫秒数, 默认1000; 启用分帧时偏移相对帧首; 留空停止跟踪");
+
+    QStringList columnNames;
+    for (const char *name : kColumnNames) columnNames.append(name);
+    m_table->setHorizontalHeaderLabels(columnNames);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->verticalHeader()->hide();
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+
+    QWidget *content = new QWidget(this);
+    QVBoxLayout *layout = new QVBoxLayout(content);
+    layout->setContentsMargins(5, 5, 5, 5);
+    QHBoxLayout *ruleRow = new QHBoxLayout;
+    ruleRow->addWidget(m_ruleEdit, 1);
+    ruleRow->addWidget(m_applyButton);
+    layout->addLayout(ruleRow);
+    layout->addWidget(m_table, 1);
+    QHBoxLayout *controlRow = new QHBoxLayout;
+    controlRow->addWidget(m_statusLabel, 1);
+    controlRow->addWidget(m_resetButton);
+    controlRow->addWidget(m_exportButton);
+    layout->addLayout(controlRow);
+    setWidget(content);
+
+    connect(m_applyButton, &QPushButton::clicked, this, &TransactionDock::onApplyClicked);
+    connect(m_ruleEdit, &QLineEdit::returnPressed, this, &TransactionDock::onApplyClicked);
+    connect(m_resetButton, &QPushButton::clicked, this, &TransactionDock::onResetClicked);
+    connect(m_exportButton, &QPushButton::clicked, this, &TransactionDock::onExportClicked);
+
+    QTimer *refreshTimer = new QTimer(this);
+    connect(refreshTimer, &QTimer::timeout, this, &TransactionDock::refresh);
+    refreshTimer->start(500);
+}
+
+void TransactionDock::attach(SerialSession *session)
+{
+    if (m_rule.isValid() && !session->isReplay()) session->setTransactionRule(m_rule);
+}
+
+void TransactionDock::onApplyClicked()
+{
+    const QString text = m_ruleEdit->text().trimmed();
+    if (text.isEmpty()) {
+        m_rule = TransactionRule();   // 无效规则, 各会话停止跟踪
+    } else {
+        QString error;
+        const TransactionRule rule = TransactionRule::parse(text, &error);
+        if (!rule.isValid()) {
+            QMessageBox::warning(this, "警告", "无效的匹配规则: " + error);
+            return;
+        }
+        m_rule = rule;
+    }
+    for (SerialSession *session : m_sessions->sessions()) {
+        if (!session->isReplay()) session->setTransactionRule(m_rule);
+    }
+    refresh();
+}
+
+void TransactionDock::onResetClicked()
+{
+    for (SerialSession *session : m_sessions->sessions()) session->transactions().reset();
+    refresh();
+}
+
+// 导出当前汇总: 每个 串口×类型 一行, 按扩展名选择 CSV 或 JSON Lines(每个串口一行)
+void TransactionDock::onExportClicked()
+{
+    const QString path = QFileDialog::getSaveFileName(this, "导出事务统计", QString(),
+                                                      "CSV (*.csv);;JSON Lines (*.jsonl *.json)");
+    if (path.isEmpty()) return;
+
+    const bool json = path.endsWith(".json", Qt::CaseInsensitive) || path.endsWith(".jsonl", Qt::CaseInsensitive);
+    QByteArray out = json ? QByteArray() : TransactionTracker::csvHeader();
+    for (SerialSession *session : m_sessions->sessions()) {
+        const TransactionTracker &tracker = session->transactions();
+        if (!tracker.isEnabled()) continue;
+        out += json ? tracker.toJson(session->portName()) : tracker.toCsv(session->portName());
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(out) != out.size()) {
+        QMessageBox::warning(this, "警告", "无法写入导出文件: " + file.errorString());
+    }
+}
+
+void TransactionDock::setCell(int row, int column, const QString &text, bool highlight)
+{
+    QTableWidgetItem *item = m_table->item(row, column);
+    if (!item) {
+        item = new QTableWidgetItem;
+        item->setTextAlignment(column <= Type ? Qt::AlignLeft | Qt::AlignVCenter : Qt::AlignRight | Qt::AlignVCenter);
+        m_table->setItem(row, column, item);
+    }
+    item->setText(text);
+    item->setForeground(highlight ? QBrush(Qt::red) : QBrush());
+}
+
+void TransactionDock::refresh()
+{
+    if (!isVisible()) return;
+
+    int row = 0;
+    quint64 pending = 0, unmatched = 0;
+    QString lastTimeout;
+    qint64 lastTimeoutNs = 0;
+    for (SerialSession *session : m_sessions->sessions()) {
+        const TransactionTracker &tracker = session->transactions();
+        if (!tracker.isEnabled()) continue;
+        pending += tracker.pendingCount();
+        unmatched += tracker.unmatchedResponses();
+        const QVector<TransactionTracker::Timeout> timeouts = tracker.recentTimeouts();
+        if (!timeouts.isEmpty() && timeouts.last().sentNs > lastTimeoutNs) {
+            lastTimeoutNs = timeouts.last().sentNs;
+            lastTimeout = QString("%1 类型 0x%2 序号 %3").arg(session->portName())
+                              .arg(timeouts.last().type, 0, 16).arg(timeouts.last().sequence);
+        }
+
+        for (const TransactionTypeStats &stats : tracker.types()) {
+            if (row >= m_table->rowCount()) m_table->setRowCount(row + 1);
+            const LatencyHistogram &h = stats.latency;
+            setCell(row, Port, session->portName());
+            setCell(row, Type, stats.label());
+            setCell(row, Sent, QString::number(stats.sent));
+            setCell(row, Matched, QString::number(stats.matched));
+            setCell(row, Timeouts, QString::number(stats.timeouts), stats.timeouts > 0);
+            setCell(row, P50, formatMs(h.percentileNs(50)));
+            setCell(row, P90, formatMs(h.percentileNs(90)));
+            setCell(row, P99, formatMs(h.percentileNs(99)));
+            setCell(row, P999, formatMs(h.percentileNs(99.9)));
+            setCell(row, Max, formatMs(h.maxNs()));
+            ++row;
+        }
+    }
+    m_table->setRowCount(row);
+
+    if (!m_rule.isValid()) {
+        m_statusLabel->setText("未启用");
+        return;
+    }
+    QString status = QString("等待响应 %1  未匹配的接收 %2").arg(pending).arg(unmatched);
+    if (!lastTimeout.isEmpty()) status += "  最近超时: " + lastTimeout;
+    m_statusLabel->setText(status);
+}
@@ -0,0 +1,269 @@
+#include "transactiontracker.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+
+// ---------------------------------------------------------------- TransactionRule
+
+bool TransactionRule::isValid() const
+{
+    if (match == Match::None || timeoutNs <= 0) return false;
+    for (const Field *field : {&opcode, &sequence, &rxOpcode, &rxSequence}) {
+        if (field->isSet() && (field->size < 1 || field->size > 4)) return false;
+    }
+    if (match == Match::SequenceId) return sequence.isSet();
+    if (match == Match::OpcodeEcho) return opcode.isSet();
+    return true;
+}
+
+TransactionRule TransactionRule::parse(const QString &text, QString *errorString)
+{
+    TransactionRule rule;
+    rule.match = Match::FirstFrame;
+    auto fail = [&](const QString &message) {
+        if (errorString) *errorString = message;
+        return TransactionRule();
+    };
+    auto parseField = [](const QString &value, Field *field) {
+        const QStringList parts = value.split(':');
+        bool ok = true, ok2 = true;
+        field->offset = parts[0].toInt(&ok);
+        field->size = parts.size() > 1 ? parts[1].toInt(&ok2) : 1;
+        return ok && ok2 && field->offset >= 0;
+    };
+
+    const QStringList items = text.split(';', Qt::SkipEmptyParts);
+    for (const QString &item : items) {
+        const int eq = item.indexOf('=');
+        if (eq <= 0) return fail("缺少'=': " + item);
+        const QString key = item.left(eq).trimmed().toLower();
+        const QString value = item.mid(eq + 1).trimmed();
+        bool ok = true;
+
+        if (key == "match") {
+            const QString name = value.toLower();
+            if (name == "seq")        rule.match = Match::SequenceId;
+            else if (name == "echo")  rule.match = Match::OpcodeEcho;
+            else if (name == "first") rule.match = Match::FirstFrame;
+            else ok = false;
+        } else if (key == "op") {
+            ok = parseField(value, &rule.opcode);
+        } else if (key == "seq") {
+            ok = parseField(value, &rule.sequence);
+        } else if (key == "rxop") {
+            ok = parseField(value, &rule.rxOpcode);
+        } else if (key == "rxseq") {
+            ok = parseField(value, &rule.rxSequence);
+        } else if (key == "timeout") {
+            const double ms = value.toDouble(&ok);
+            rule.timeoutNs = qint64(ms * 1e6);
+        } else {
+            return fail("未知的键: " + key);
+        }
+        if (!ok) return fail("无效的值: " + item);
+    }
+
+    if (!rule.rxOpcode.isSet()) rule.rxOpcode = rule.opcode;
+    if (!rule.rxSequence.isSet()) rule.rxSequence = rule.sequence;
+    if (!rule.isValid()) {
+        return fail(rule.match == Match::SequenceId ? "match=seq 需要 seq 字段"
+                    : rule.match == Match::OpcodeEcho ? "match=echo 需要 op 字段"
+                                                      : "字段长度必须为 1-4 字节, 超时必须大于0");
+    }
+    return rule;
+}
+
+// ---------------------------------------------------------------- TransactionTypeStats
+
+QString TransactionTypeStats::label() const
+{
+    if (overflow) return "其他";
+    if (typeSize == 0) return "全部";
+    return "0x" + QString::number(type, 16).rightJustified(typeSize * 2, '0').toUpper();
+}
+
+// ---------------------------------------------------------------- TransactionTracker
+
+void TransactionTracker::setRule(const TransactionRule &rule)
+{
+    m_rule = rule;
+    m_enabled = rule.isValid();
+    reset();
+}
+
+void TransactionTracker::reset()
+{
+    m_pending.clear();
+    m_pending.reserve(kMaxPending);
+    m_types.clear();
+    m_types.reserve(kMaxTypes);
+    m_timeouts.clear();
+    m_timeoutHead = 0;
+    m_unmatched = 0;
+}
+
+// 多字节字段按高字节在前组合, 只用作键和显示
+bool TransactionTracker::readField(const TransactionRule::Field &field, const char *data, qsizetype size,
+                                   quint32 *value)
+{
+    *value = 0;
+    if (!field.isSet()) return true;
+    if (field.offset + field.size > size) return false;
+    for (int i = 0; i < field.size; ++i) *value = (*value << 8) | quint8(data[field.offset + i]);
+    return true;
+}
+
+// 类型数达到上限后, 新类型都计入最后一个"其他"条目
+int TransactionTracker::typeIndex(quint32 type)
+{
+    for (int i = 0; i < m_types.size(); ++i) {
+        if (!m_types[i].overflow && m_types[i].type == type) return i;
+    }
+    if (m_types.size() >= kMaxTypes - 1) {
+        if (m_types.size() == kMaxTypes - 1) {
+            m_types.append(TransactionTypeStats());
+            m_types.last().overflow = true;
+        }
+        return kMaxTypes - 1;
+    }
+    m_types.append(TransactionTypeStats());
+    TransactionTypeStats &stats = m_types.last();
+    stats.type = type;
+    stats.typeSize = m_rule.opcode.isSet() ? m_rule.opcode.size : 0;
+    return m_types.size() - 1;
+}
+
+void TransactionTracker::onTransmit(qint64 timestampNs, const char *data, qsizetype size)
+{
+    if (!m_enabled) return;
+    quint32 type = 0, sequence = 0;
+    // 太短, 读不到字段的发送(如单独的换行)不算命令
+    if (!readField(m_rule.opcode, data, size, &type) || !readField(m_rule.sequence, data, size, &sequence)) return;
+
+    if (m_pending.size() >= kMaxPending) timeOut(0);
+    const int index = typeIndex(type);
+    ++m_types[index].sent;
+    m_pending.append({timestampNs, type, sequence, index});
+}
+
+void TransactionTracker::onReceive(qint64 timestampNs, const char *data, qsizetype size)
+{
+    if (!m_enabled) return;
+    quint32 type = 0, sequence = 0;
+    const bool hasType = readField(m_rule.rxOpcode, data, size, &type);
+    const bool hasSequence = readField(m_rule.rxSequence, data, size, &sequence);
+
+    // 只匹配在响应之前发出的命令; 同一批数据中先收到、后发送的不算
+    for (int i = 0; i < m_pending.size(); ++i) {
+        const Pending &pending = m_pending.at(i);
+        if (pending.sentNs > timestampNs) break;
+        bool matches = true;
+        switch (m_rule.match) {
+        case TransactionRule::Match::SequenceId:
+            matches = hasSequence && pending.sequence == sequence
+                   && (!m_rule.rxOpcode.isSet() || (hasType && pending.type == type));
+            break;
+        case TransactionRule::Match::OpcodeEcho:
+            matches = hasType && pending.type == type;
+            break;
+        case TransactionRule::Match::FirstFrame:
+        case TransactionRule::Match::None:
+            break;
+        }
+        if (matches) {
+            complete(i, timestampNs - pending.sentNs);
+            return;
+        }
+    }
+    ++m_unmatched;
+}
+
+void TransactionTracker::complete(int pendingIndex, qint64 latencyNs)
+{
+    TransactionTypeStats &stats = m_types[m_pending.at(pendingIndex).typeIndex];
+    // 超时之后才到的响应也记录延迟, 但按超时计数
+    if (latencyNs > m_rule.timeoutNs) ++stats.timeouts;
+    else ++stats.matched;
+    stats.latency.record(latencyNs);
+    m_pending.remove(pendingIndex);
+}
+
+void TransactionTracker::timeOut(int pendingIndex)
+{
+    const Pending pending = m_pending.at(pendingIndex);
+    ++m_types[pending.typeIndex].timeouts;
+    const Timeout timeout{pending.sentNs, pending.type, pending.sequence};
+    if (m_timeouts.size() < kRecentTimeouts) {
+        m_timeouts.append(timeout);
+    } else {
+        m_timeouts[m_timeoutHead] = timeout;
+        m_timeoutHead = (m_timeoutHead + 1) % kRecentTimeouts;
+    }
+    m_pending.remove(pendingIndex);
+}
+
+void TransactionTracker::expire(qint64 cutoffNs)
+{
+    if (!m_enabled) return;
+    // 表按发送时间排序, 只需检查开头
+    while (!m_pending.isEmpty() && cutoffNs - m_pending.first().sentNs > m_rule.timeoutNs) timeOut(0);
+}
+
+QVector<TransactionTracker::Timeout> TransactionTracker::recentTimeouts() const
+{
+    QVector<Timeout> result;
+    result.reserve(m_timeouts.size());
+    for (int i = 0; i < m_timeouts.size(); ++i) result.append(m_timeouts.at((m_timeoutHead + i) % m_timeouts.size()));
+    return result;
+}
+
+QByteArray TransactionTracker::csvHeader()
+{
+    return "port,type,sent,matched,timeouts,min_us,p50_us,p90_us,p99_us,p999_us,max_us,mean_us\n";
+}
+
+// 每个命令类型一行
+QByteArray TransactionTracker::toCsv(const QString &portName) const
+{
+    QByteArray out;
+    for (const TransactionTypeStats &stats : m_types) {
+        const LatencyHistogram &h = stats.latency;
+        out += QString("%1,%2,%3,%4,%5,").arg(portName, stats.label()).arg(stats.sent).arg(stats.matched)
+                   .arg(stats.timeouts).toUtf8();
+        out += QString("%1,%2,%3,%4,%5,%6,%7\n")
+                   .arg(h.minNs() / 1000.0, 0, 'f', 1).arg(h.percentileNs(50) / 1000.0, 0, 'f', 1)
+                   .arg(h.percentileNs(90) / 1000.0, 0, 'f', 1).arg(h.percentileNs(99) / 1000.0, 0, 'f', 1)
+                   .arg(h.percentileNs(99.9) / 1000.0, 0, 'f', 1).arg(h.maxNs() / 1000.0, 0, 'f', 1)
+                   .arg(h.meanNs() / 1000.0, 0, 'f', 1).toUtf8();
+    }
+    return out;
+}
+
+QByteArray TransactionTracker::toJson(const QString &portName) const
+{
+    QJsonArray types;
+    for (const TransactionTypeStats &stats : m_types) {
+        const LatencyHistogram &h = stats.latency;
+        QJsonObject object;
+        object["type"] = stats.label();
+        object["sent"] = double(stats.sent);
+        object["matched"] = double(stats.matched);
+        object["timeouts"] = double(stats.timeouts);
+        object["min_us"] = h.minNs() / 1000.0;
+        object["p50_us"] = h.percentileNs(50) / 1000.0;
+        object["p90_us"] = h.percentileNs(90) / 1000.0;
+        object["p99_us"] = h.percentileNs(99) / 1000.0;
+        object["p999_us"] = h.percentileNs(99.9) / 1000.0;
+        object["max_us"] = h.maxNs() / 1000.0;
+        object["mean_us"] = h.meanNs() / 1000.0;
+        types.append(object);
+    }
+    QJsonObject root;
+    root["port"] = portName;
+    root["pending"] = double(m_pending.size());
+    root["unmatched_responses"] = double(m_unmatched);
+    root["types"] = types;
+    return QJsonDocument(root).toJson(QJsonDocument::Compact) + '\n';
+}
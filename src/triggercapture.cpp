@@ -0,0 +1,319 @@
+#include "triggercapture.h"
+#include "serialworker.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QStringList>
+#include <QTimer>
+#include <chrono>
+#include <cstring>
+
+bool TriggerSpec::parse(const QString &text, TriggerSpec *spec, QString *errorString)
+{
+    TriggerSpec result;
+    auto fail = [&](const QString &message) {
+        if (errorString) *errorString = message;
+        return false;
+    };
+
+    const QStringList items = text.split(';', Qt::SkipEmptyParts);
+    for (const QString &item : items) {
+        const int eq = item.indexOf('=');
+        const QString key = (eq < 0 ? item : item.left(eq)).trimmed().toLower();
+        const QString value = eq < 0 ? QString() : item.mid(eq + 1).trimmed();
+        bool ok = true;
+
+        // error / checksum 是开关, 不需要值
+        if (key == "error") {
+            result.onError = true;
+            continue;
+        }
+        if (key == "checksum") {
+            result.onChecksum = true;
+            continue;
+        }
+        if (eq <= 0) return fail("缺少'=': " + item);
+
+        if (key == "buffer") {
+            const double mb = value.toDouble(&ok);
+            result.bufferBytes = qint64(mb * 1048576);
+            ok = ok && result.bufferBytes >= kMinBufferBytes && result.bufferBytes <= kMaxBufferBytes;
+        } else if (key == "pre") {
+            const double seconds = value.toDouble(&ok);
+            result.preNs = qint64(seconds * 1e9);
+            ok = ok && seconds >= 0;
+        } else if (key == "post") {
+            const double seconds = value.toDouble(&ok);
+            result.postNs = qint64(seconds * 1e9);
+            ok = ok && seconds >= 0;
+        } else if (key == "pattern") {
+            result.pattern = QByteArray::fromHex(value.toLatin1());
+            ok = !result.pattern.isEmpty();
+        } else {
+            return fail("未知的键: " + key);
+        }
+        if (!ok) return fail("无效的值: " + item);
+    }
+
+    *spec = result;
+    return true;
+}
+
+TriggerCapture::TriggerCapture(QObject *parent)
+    : QObject(parent)
+    , m_windowTimer(new QTimer(this))
+{
+    qRegisterMetaType<TriggerReason>();
+    // 写盘线程是窗口文件唯一的生产者, 队列满时让它等待, 内存环里的数据不会丢
+    m_writer.setBlocking(true);
+    m_writer.setMaxQueueBytes(kDumpQueueBytes);
+    m_windowTimer->setSingleShot(true);
+    connect(m_windowTimer, &QTimer::timeout, this, &TriggerCapture::finishWindow);
+}
+
+TriggerCapture::~TriggerCapture()
+{
+    disable();
+}
+
+QString TriggerCapture::reasonName(TriggerReason reason)
+{
+    switch (reason) {
+    case TriggerReason::Manual:    return "manual";
+    case TriggerReason::Pattern:   return "pattern";
+    case TriggerReason::PortError: return "error";
+    case TriggerReason::LineError: return "line";
+    case TriggerReason::Checksum:  return "checksum";
+    }
+    return "unknown";
+}
+
+// 内存在这里一次分配并写零, 页面立即提交, 之后的占用不随数据量变化
+void TriggerCapture::configure(const TriggerSpec &spec, const QString &directory)
+{
+    disable();
+    m_spec = spec;
+    m_spec.bufferBytes = qBound(TriggerSpec::kMinBufferBytes, spec.bufferBytes, TriggerSpec::kMaxBufferBytes);
+    m_directory = directory.isEmpty() ? QDir::currentPath() : directory;
+    m_buffer = QByteArray(int(m_spec.bufferBytes), '\0');
+    m_payload = QByteArray(int(kMaxRecordPayload), Qt::Uninitialized);
+    m_capacity = m_spec.bufferBytes;
+    m_head = m_tail = 0;
+    m_matcher.setPattern(m_spec.pattern);
+    // 各端口的末尾字节和拼接区一次预留, 接收时原地更新不再分配
+    const int keep = qMax(0, int(m_spec.pattern.size()) - 1);
+    for (QByteArray &carry : m_carry) {
+        carry.reserve(keep);
+        carry.resize(0);
+    }
+    m_seam.reserve(keep * 2);
+    m_publishedHead.store(0, std::memory_order_relaxed);
+    m_capacityBytes.store(m_capacity, std::memory_order_relaxed);
+    m_bufferedBytes.store(0, std::memory_order_relaxed);
+}
+
+void TriggerCapture::disable()
+{
+    finishWindow();
+    waitForWindow();
+    m_capacity = 0;
+    m_head = m_tail = 0;
+    m_buffer = QByteArray();
+    m_payload = QByteArray();
+    for (QByteArray &carry : m_carry) carry = QByteArray();
+    m_capacityBytes.store(0, std::memory_order_relaxed);
+    m_bufferedBytes.store(0, std::memory_order_relaxed);
+}
+
+void TriggerCapture::record(qint64 timestampNs, CaptureDirection direction, quint8 portId,
+                            const char *data, qsizetype len)
+{
+    if (m_capacity <= 0 || len <= 0) return;
+
+    // 窗口到期后的数据不再属于窗口; 没有新数据时由定时器结束
+    if (timestampNs > m_deadlineNs && isWindowOpen()) finishWindow();
+
+    for (qsizetype done = 0; done < len;) {
+        const qsizetype n = qMin<qsizetype>(len - done, kMaxRecordPayload);
+        const RecordHeader header{timestampNs, quint32(n), quint8(direction), portId, 0};
+        if (!append(header, data + done)) m_windowDropped.fetch_add(n, std::memory_order_relaxed);
+        done += n;
+    }
+    m_publishedHead.store(m_head, std::memory_order_release);
+    m_bufferedBytes.store(m_head - m_tail, std::memory_order_relaxed);
+
+    if (direction == CaptureDirection::Rx && !m_spec.pattern.isEmpty() && matchPattern(portId, data, len))
+        trigger(TriggerReason::Pattern, portId, timestampNs);
+}
+
+void TriggerCapture::trigger(TriggerReason reason, quint8 portId, qint64 timestampNs)
+{
+    if (m_capacity <= 0 || !enabledFor(reason)) return;
+    m_triggers.fetch_add(1, std::memory_order_relaxed);
+    if (isWindowOpen()) return;
+    waitForWindow();   // 回收已经写完的上一个窗口的线程
+
+    const QString name = QString("trigger_%1_%2.pyrocap")
+                             .arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss_zzz"), reasonName(reason));
+    const QString path = QDir(m_directory).filePath(name);
+    QDir().mkpath(m_directory);
+    QString error;
+    if (!m_writer.open(path, &error)) {
+        emit failed(error);
+        return;
+    }
+
+    // 这里只记下窗口, 从最旧的记录开始, 时间戳早于 触发时刻 - pre 的由写盘线程跳过
+    m_windowPath = path;
+    m_startNs = timestampNs - m_spec.preNs;
+    m_deadlineNs = timestampNs + m_spec.postNs;
+    m_windowEnd.store(-1, std::memory_order_relaxed);
+    m_windowDropped.store(0, std::memory_order_relaxed);
+    m_dumpCursor.store(m_tail, std::memory_order_relaxed);
+    m_dumpDone.store(false, std::memory_order_release);
+    m_dumper = std::thread(&TriggerCapture::dumpWindow, this);
+    m_windowTimer->start(int(qMax<qint64>(0, m_deadlineNs - SerialWorker::monotonicNs()) / 1000000) + 1);
+    emit triggered(reason, portId, path);
+}
+
+bool TriggerCapture::enabledFor(TriggerReason reason) const
+{
+    switch (reason) {
+    case TriggerReason::Manual:    return true;
+    case TriggerReason::Pattern:   return !m_spec.pattern.isEmpty();
+    case TriggerReason::PortError:
+    case TriggerReason::LineError: return m_spec.onError;
+    case TriggerReason::Checksum:  return m_spec.onChecksum;
+    }
+    return false;
+}
+
+// 写盘线程写完窗口内的记录、关闭文件后才算结束
+bool TriggerCapture::isWindowOpen() const
+{
+    return !m_dumpDone.load(std::memory_order_acquire);
+}
+
+void TriggerCapture::finishWindow()
+{
+    if (!isWindowOpen() || m_windowEnd.load(std::memory_order_relaxed) >= 0) return;
+    m_windowTimer->stop();
+    m_windowEnd.store(m_head, std::memory_order_release);
+}
+
+void TriggerCapture::waitForWindow()
+{
+    if (m_dumper.joinable()) m_dumper.join();
+}
+
+// 写盘线程: 从内存环中按片读出记录交给 CaptureWriter, 每片之后发布读到的位置,
+// I/O线程随即可以覆盖这之前的空间; 赶上写入位置后短暂休眠再看
+void TriggerCapture::dumpWindow()
+{
+    qint64 cursor = m_dumpCursor.load(std::memory_order_relaxed);
+    for (;;) {
+        const qint64 end = m_windowEnd.load(std::memory_order_acquire);
+        const qint64 limit = end >= 0 ? end : m_publishedHead.load(std::memory_order_acquire);
+        if (cursor >= limit) {
+            if (end >= 0) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(kDumpIdleMs));
+            continue;
+        }
+        // limit 总是记录边界, 片尾按整条记录越过 sliceEnd 也不会超出 limit
+        const qint64 sliceEnd = qMin(limit, cursor + kDumpSliceBytes);
+        while (cursor < sliceEnd) {
+            const RecordHeader header = headerAt(cursor);
+            const qint64 payloadPosition = cursor + kRecordHeaderSize;
+            cursor = payloadPosition + header.length;
+            if (header.timestampNs < m_startNs) continue;
+            const qint64 offset = payloadPosition % m_capacity;
+            const char *payload = m_buffer.constData() + offset;
+            if (offset + header.length > m_capacity) {
+                copyOut(payloadPosition, m_payload.data(), header.length);
+                payload = m_payload.constData();
+            }
+            m_writer.record(header.timestampNs, CaptureDirection(header.direction), header.portId, payload, header.length);
+        }
+        m_dumpCursor.store(cursor, std::memory_order_release);
+    }
+
+    const qint64 bytes = m_writer.bytesCaptured();
+    m_writer.close();
+    m_saved.fetch_add(1, std::memory_order_relaxed);
+    const qint64 dropped = m_windowDropped.load(std::memory_order_relaxed);
+    if (dropped > 0) emit failed(QString("写盘跟不上, 触发窗口 %1 中丢弃了 %2 字节").arg(m_windowPath).arg(dropped));
+    emit saved(m_windowPath, bytes);
+    m_dumpDone.store(true, std::memory_order_release);
+}
+
+// 空间不够时从最旧的记录开始丢弃; 单条记录不超过 kMaxRecordPayload, 远小于内存环
+// 窗口写盘期间不能覆盖写盘线程还没读到的记录, 此时放不下就丢弃新记录
+bool TriggerCapture::append(const RecordHeader &header, const char *payload)
+{
+    const qint64 need = kRecordHeaderSize + qint64(header.length);
+    if (isWindowOpen() && m_capacity - (m_head - m_dumpCursor.load(std::memory_order_acquire)) < need) return false;
+    while (m_capacity - (m_head - m_tail) < need) evictOldest();
+    copyIn(m_head, reinterpret_cast<const char *>(&header), kRecordHeaderSize);
+    copyIn(m_head + kRecordHeaderSize, payload, header.length);
+    m_head += need;
+    return true;
+}
+
+void TriggerCapture::evictOldest()
+{
+    m_tail += kRecordHeaderSize + qint64(headerAt(m_tail).length);
+}
+
+TriggerCapture::RecordHeader TriggerCapture::headerAt(qint64 position) const
+{
+    RecordHeader header;
+    copyOut(position, reinterpret_cast<char *>(&header), kRecordHeaderSize);
+    return header;
+}
+
+// 记录可能跨过内存环末尾, 分两段复制
+void TriggerCapture::copyOut(qint64 position, char *dest, qint64 len) const
+{
+    const qint64 offset = position % m_capacity;
+    const qint64 first = qMin(len, m_capacity - offset);
+    std::memcpy(dest, m_buffer.constData() + offset, size_t(first));
+    std::memcpy(dest + first, m_buffer.constData(), size_t(len - first));
+}
+
+void TriggerCapture::copyIn(qint64 position, const char *src, qint64 len)
+{
+    const qint64 offset = position % m_capacity;
+    const qint64 first = qMin(len, m_capacity - offset);
+    std::memcpy(m_buffer.data() + offset, src, size_t(first));
+    std::memcpy(m_buffer.data(), src + first, size_t(len - first));
+}
+
+// 先查上次末尾与本次开头拼接处, 再查本次数据; 末尾保留 pattern.size()-1 字节供下次使用
+bool TriggerCapture::matchPattern(quint8 portId, const char *data, qsizetype len)
+{
+    const int keep = m_spec.pattern.size() - 1;
+    QByteArray &carry = m_carry[portId];
+    bool found = false;
+    if (!carry.isEmpty()) {
+        const int head = int(qMin<qsizetype>(len, keep));
+        m_seam.resize(carry.size() + head);
+        std::memcpy(m_seam.data(), carry.constData(), size_t(carry.size()));
+        std::memcpy(m_seam.data() + carry.size(), data, size_t(head));
+        found = m_matcher.indexIn(m_seam) >= 0;
+    }
+    if (!found) found = m_matcher.indexIn(data, int(len)) >= 0;
+
+    if (keep > 0) {
+        if (len >= keep) {
+            carry.resize(keep);
+            std::memcpy(carry.data(), data + len - keep, size_t(keep));
+        } else {
+            // 旧的末尾字节前移, 腾出位置给本次数据, 总长不超过 keep
+            const int old = int(qMin<qsizetype>(carry.size(), keep - len));
+            std::memmove(carry.data(), carry.constData() + carry.size() - old, size_t(old));
+            carry.resize(old + int(len));
+            std::memcpy(carry.data() + old, data, size_t(len));
+        }
+    }
+    return found;
+}
@@ -0,0 +1,124 @@
+#include "utf8decoder.h"
+
+#include <cstring>
+
+namespace {
+
+const char kReplacement[] = "\xEF\xBF\xBD";   // U+FFFD
+
+// 检查 p 开始的一个序列(Unicode 表3-7), avail 为可用字节数:
+//   >0  合法序列的长度
+//    0  目前为止合法但数据不够, 需要后续字节
+//   <0  非法, 绝对值为应替换的最大有效前缀长度(至少1)
+int checkSequence(const uchar *p, qsizetype avail)
+{
+    const uchar lead = p[0];
+    int length;
+    uchar lo = 0x80, hi = 0xBF;      // 第二字节的范围, 排除过长编码、代理区和超出 U+10FFFF
+    if (lead < 0x80) return 1;
+    if (lead < 0xC2) return -1;
+    if (lead < 0xE0) {
+        length = 2;
+    } else if (lead < 0xF0) {
+        length = 3;
+        if (lead == 0xE0) lo = 0xA0;
+        else if (lead == 0xED) hi = 0x9F;
+    } else if (lead < 0xF5) {
+        length = 4;
+        if (lead == 0xF0) lo = 0x90;
+        else if (lead == 0xF4) hi = 0x8F;
+    } else {
+        return -1;
+    }
+
+    for (int i = 1; i < length; ++i) {
+        if (i >= avail) return 0;
+        const uchar c = p[i];
+        if (i == 1 ? (c < lo || c > hi) : (c & 0xC0) != 0x80) return -i;
+    }
+    return length;
+}
+
+// 从 p 开始的连续ASCII字节数
+inline qsizetype asciiRun(const uchar *p, qsizetype n)
+{
+    qsizetype i = 0;
+    for (; i + 8 <= n; i += 8) {
+        quint64 word;
+        std::memcpy(&word, p + i, 8);
+        if (word & Q_UINT64_C(0x8080808080808080)) break;
+    }
+    while (i < n && p[i] < 0x80) ++i;
+    return i;
+}
+
+} // namespace
+
+void Utf8StreamDecoder::appendReplacement(QByteArray *out)
+{
+    out->append(kReplacement, 3);
+    ++m_invalid;
+}
+
+void Utf8StreamDecoder::decode(QByteArray *out, const char *data, qsizetype n)
+{
+    const uchar *p = reinterpret_cast<const uchar *>(data);
+    qsizetype pos = 0;
+
+    // 先补全上一块留下的序列; 暂存的字节已确认是合法前缀
+    if (m_partialSize > 0) {
+        uchar joined[4];
+        std::memcpy(joined, m_partial, size_t(m_partialSize));
+        const int taken = int(qMin<qsizetype>(4 - m_partialSize, n));
+        std::memcpy(joined + m_partialSize, p, size_t(taken));
+        const int result = checkSequence(joined, m_partialSize + taken);
+        if (result == 0) {
+            std::memcpy(m_partial + m_partialSize, p, size_t(taken));
+            m_partialSize += taken;
+            return;
+        }
+        if (result > 0) {
+            out->append(reinterpret_cast<const char *>(joined), result);
+            pos = result - m_partialSize;
+        } else {
+            appendReplacement(out);
+            pos = qMax(0, -result - m_partialSize);
+        }
+        m_partialSize = 0;
+    }
+
+    // 合法数据整段拷贝, 只在非法序列和末尾处断开
+    qsizetype runStart = pos;
+    while (pos < n) {
+        pos += asciiRun(p + pos, n - pos);
+        if (pos >= n) break;
+        const int result = checkSequence(p + pos, n - pos);
+        if (result > 0) {
+            pos += result;
+            continue;
+        }
+        out->append(data + runStart, int(pos - runStart));
+        if (result == 0) {
+            m_partialSize = int(n - pos);
+            std::memcpy(m_partial, p + pos, size_t(m_partialSize));
+            return;
+        }
+        appendReplacement(out);
+        pos += -result;
+        runStart = pos;
+    }
+    out->append(data + runStart, int(n - runStart));
+}
+
+void Utf8StreamDecoder::flush(QByteArray *out)
+{
+    if (m_partialSize == 0) return;
+    appendReplacement(out);
+    m_partialSize = 0;
+}
+
+void Utf8StreamDecoder::takePending(QByteArray *out)
+{
+    out->append(m_partial, m_partialSize);
+    m_partialSize = 0;
+}